@@ -29,6 +29,12 @@
 #include "Physical_Layer.h"
 #include "MODULATION_TABLES.h"
 
+/* BER curve of 802.15.4, sampled the first time it is used */
+static Util_dB_Table	ber_802_15_4_table;
+static Boolean			ber_802_15_4_table_built = OPC_FALSE;
+
+static double			ber_802_15_4_curve (double sirDB);
+
 /*
  * Function:	bit_error_rate_802_15_4
  *
@@ -48,6 +54,38 @@
  */
 
 double bit_error_rate_802_15_4 (double sirDB) 
+{
+  double ber;
+
+  FIN (bit_error_rate_802_15_4 (sirDB));
+
+  if (ber_802_15_4_table_built == OPC_FALSE)
+    {
+    util_dB_table_build (&ber_802_15_4_table, DB_TABLE_MIN, DB_TABLE_MAX, DB_TABLE_STEP, ber_802_15_4_curve);
+    ber_802_15_4_table_built = OPC_TRUE;
+    }
+
+  if (sirDB >= DB_TABLE_MIN && sirDB <= DB_TABLE_MAX)
+    ber = util_dB_table_lookup (&ber_802_15_4_table, sirDB);
+  else
+    ber = ber_802_15_4_curve (sirDB);
+
+  FRET (ber);
+}
+
+/*
+ * Function:	ber_802_15_4_curve
+ *
+ * Description:	BER of 802.15.4 read from the CustomPPM modulation curve
+ *
+ * ParamIn:		double sirDB
+ *				Signal To Interference (dB)
+ *
+ * ParamOut:	double ber
+ *				Bit Error rate
+ */
+
+static double ber_802_15_4_curve (double sirDB) 
 {
   double EbN0, ber;
   double snr = util_inverse_dB (sirDB);
@@ -60,7 +98,7 @@ double bit_error_rate_802_15_4 (double sirDB)
   Modulation_Handle			modulation_table;
   double EbN0dB;
 
-  FIN (bit_error_rate_802_15_4 (sirDB));
+  FIN (ber_802_15_4_curve (sirDB));
   
   EbN0 = snr + sqrt(snr*(snr+(Tint*BW))); 	//conversion from SNR to EbN0
   /*
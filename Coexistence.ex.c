@@ -27,6 +27,35 @@
 
 /* include the header */
 #include "Physical_Layer.h"
+
+/* couplings between the masks of a receiver and of an interferer */
+typedef enum {
+  COUPLING_15D4R_11BI,
+  COUPLING_15D4RI,
+  COUPLING_11BR_15D4I,
+  COUPLING_11BRI
+} Coupling_Type;
+
+/* couplings already computed, recorded by (type, receiver freq, interferer freq) in a hash table of cells */
+#define COUPLING_NB_BUCKETS	256
+
+typedef struct T_coupling_cell {
+  Coupling_Type				type;
+  double					receiver_freq;
+  double					interferer_freq;
+  double					coupling;
+  struct T_coupling_cell *	next_cell;
+} Coupling_Cell;
+
+static Coupling_Cell *	coupling_buckets [COUPLING_NB_BUCKETS];
+
+/* local function prototypes */
+static double	coexistence_coupling_cached (Coupling_Type type, double Receiver_Freq, double Interferer_Freq);
+static double	coexistence_coupling_15d4r_11bi_compute (double Receiver_Freq, double Interferer_Freq);
+static double	coexistence_coupling_15d4ri_compute (double Receiver_Freq, double Interferer_Freq);
+static double	coexistence_coupling_11br_15d4i_compute (double Receiver_Freq, double Interferer_Freq);
+static double	coexistence_coupling_11bri_compute (double Receiver_Freq, double Interferer_Freq);
+
 /*
  * Function:	coexistence_ri
  *
@@ -236,16 +265,40 @@ double coexistence_15d4ri (double receiver_freq, double t_power, double t_distan
  */
 
 double snr_15_4a (double receiver_freq, double t_power, double t_distance)
+{
+  FIN (snr_15_4a (receiver_freq, t_power, t_distance));
+  
+  FRET (snr_15_4a_path_loss (t_power, path_loss_attenuation (t_distance, receiver_freq)));
+}
+
+
+/*
+ * Function:	snr_15_4a_path_loss
+ *
+ * Description:	The SnR for 802.15.4a as a function of the attenuation
+ * 				of the path between tx and receiver (802.15.4)
+ *
+ * ParamIn:		double t_power
+ *				power tx(802.15.4) in mW
+ *
+ *				double path_loss
+ *				attenuation due to the path loss (dB)
+ *
+ * ParamOut:	double snrDB
+ *				signal to noise ratio (dB)
+ */
+
+double snr_15_4a_path_loss (double t_power, double path_loss)
 {
   double signal, snrDB , noise , noisedB;
   double BW=499.2e6; //bandwith UWB PHY 15.4a (except for channels 4,7,11,15)
   
   //the following costants have been defined in lr_wpan_support_15_4a: double k=1.38065e-23; double T=290.0;  
   
-  FIN (snr_15_4a (receiver_freq, t_power, t_distance));
+  FIN (snr_15_4a_path_loss (t_power, path_loss));
 	
   /* SIGNAL */
-  signal = util_dB(t_power/1000) - path_loss_attenuation (t_distance, receiver_freq); //convert from mW to W
+  signal = util_dB(t_power/1000) - path_loss; //convert from mW to W
   
   /* Noise */
   noise = K_BOLTZMANN*T*BW;
@@ -258,6 +311,151 @@ double snr_15_4a (double receiver_freq, double t_power, double t_distance)
 }
 
 
+/*
+ * Function:	snr_batch_clear
+ *
+ * Description:	empty a batch of transmitters, keeping its memory
+ *
+ * ParamIn:		Snr_Batch * batch
+ *				batch of transmitters
+ */
+
+void snr_batch_clear (Snr_Batch * batch)
+{
+  FIN (snr_batch_clear (batch));
+  
+  batch->size = 0;
+  
+  FOUT;
+}
+
+
+/*
+ * Function:	snr_batch_add
+ *
+ * Description:	add a transmitter (802.15.4a) to a batch
+ *
+ * ParamIn:		Snr_Batch * batch
+ *				batch of transmitters
+ *
+ *				double tx_x, double tx_y
+ *				coordinates of the transmitter
+ *
+ *				double t_power
+ *				power tx in mW
+ *
+ *				double frequency
+ *				frequency center of the transmission
+ */
+
+void snr_batch_add (Snr_Batch * batch, double tx_x, double tx_y, double t_power, double frequency)
+{
+  FIN (snr_batch_add (batch, tx_x, tx_y, t_power, frequency));
+  
+  if (batch->size == batch->capacity)
+	{
+	batch->capacity = (batch->capacity == 0) ? 16 : 2 * batch->capacity;
+	batch->tx_x = (double *) op_prg_mem_realloc (batch->tx_x, batch->capacity * sizeof (double));
+	batch->tx_y = (double *) op_prg_mem_realloc (batch->tx_y, batch->capacity * sizeof (double));
+	batch->power = (double *) op_prg_mem_realloc (batch->power, batch->capacity * sizeof (double));
+	batch->frequency = (double *) op_prg_mem_realloc (batch->frequency, batch->capacity * sizeof (double));
+	batch->distance = (double *) op_prg_mem_realloc (batch->distance, batch->capacity * sizeof (double));
+	batch->snr = (double *) op_prg_mem_realloc (batch->snr, batch->capacity * sizeof (double));
+	}
+  
+  batch->tx_x[batch->size] = tx_x;
+  batch->tx_y[batch->size] = tx_y;
+  batch->power[batch->size] = t_power;
+  batch->frequency[batch->size] = frequency;
+  batch->size++;
+  
+  FOUT;
+}
+
+
+/*
+ * Function:	snr_15_4a_batch
+ *
+ * Description:	snr_15_4a for all the transmitters of a batch, and their
+ *				aggregate power at the receiver. The loops only call sqrt,
+ *				log and exp and have no branches (the two slopes of the
+ *				path loss are selected), so that the compiler can
+ *				vectorize them with a vector math library. The values
+ *				are the ones of snr_15_4a.
+ *
+ * ParamIn:		Snr_Batch * batch
+ *				batch of transmitters, distance and snr are filled
+ *
+ *				double rx_x, double rx_y
+ *				coordinates of the receiver
+ *
+ * ParamOut:	double snrDB
+ *				sum of the SNRs of the transmitters (dB)
+ */
+
+double snr_15_4a_batch (Snr_Batch * batch, double rx_x, double rx_y)
+{
+  double delta_x, delta_y, near, far, pathloss, sum;
+  double BW=499.2e6; //bandwith UWB PHY 15.4a (except for channels 4,7,11,15)
+  double noisedB = log (K_BOLTZMANN*T*BW) * RATIO_TO_DB;
+  int i;
+  
+  FIN (snr_15_4a_batch (batch, rx_x, rx_y));
+  
+  for (i = 0; i < batch->size; i++)
+	{
+	delta_x = rx_x - batch->tx_x[i];
+	delta_y = rx_y - batch->tx_y[i];
+	batch->distance[i] = sqrt (delta_x * delta_x + delta_y * delta_y);
+	}
+  
+  /* path_loss_attenuation: d^-2 up to 8 meters, d^-3.3 beyond */
+  for (i = 0; i < batch->size; i++)
+	{
+	near = (batch->distance[i] <= 8.0) ? batch->distance[i] : 8.0;
+	far = (batch->distance[i] <= 8.0) ? 8.0 : batch->distance[i];
+	pathloss = 2.0 * (log (4.0*PI*batch->frequency[i]*near/LIGHT_SPEED) * RATIO_TO_DB) + 3.3 * (log (far/8.0) * RATIO_TO_DB);
+	batch->snr[i] = (log (batch->power[i]/1000) * RATIO_TO_DB - pathloss) - noisedB;
+	}
+  
+  sum = 0.0;
+  for (i = 0; i < batch->size; i++)
+	sum += exp (batch->snr[i] * DB_TO_RATIO);
+  
+  FRET (log (sum) * RATIO_TO_DB);
+}
+
+
+/*
+ * Function:	snr_batch_release
+ *
+ * Description:	give back the memory of a batch of transmitters
+ *
+ * ParamIn:		Snr_Batch * batch
+ *				batch of transmitters
+ */
+
+void snr_batch_release (Snr_Batch * batch)
+{
+  FIN (snr_batch_release (batch));
+  
+  if (batch->capacity > 0)
+	{
+	op_prg_mem_free (batch->tx_x);
+	op_prg_mem_free (batch->tx_y);
+	op_prg_mem_free (batch->power);
+	op_prg_mem_free (batch->frequency);
+	op_prg_mem_free (batch->distance);
+	op_prg_mem_free (batch->snr);
+	}
+  batch->size = 0;
+  batch->capacity = 0;
+  batch->tx_x = batch->tx_y = batch->power = batch->frequency = batch->distance = batch->snr = NULL;
+  
+  FOUT;
+}
+
+
 
 
 /*
@@ -380,9 +578,153 @@ double coexistence_11bri( double receiver_freq,	double t_power, double t_distanc
 
 
 
+/*
+ * Function:	coexistence_coupling_cached
+ *
+ * Description:	coupling between the masks of a receiver and of an
+ *				interferer. It only depends on the two frequencies, so
+ *				it is computed once for each pair of channels.
+ *
+ * ParamIn:		Coupling_Type type
+ *				masks of the receiver and of the interferer
+ *
+ *				double Receiver_Freq
+ *				Frequency center of the receiver
+ *
+ *				double Interferer_Freq
+ *				Frequency center of the interferer
+ *
+ * ParamOut:	double coupling
+ *				amount of coupling between interferer's generated spectrum and
+ *				receiver's input filter.
+ */
+
+static double coexistence_coupling_cached (Coupling_Type type, double Receiver_Freq, double Interferer_Freq)
+{
+  Coupling_Cell * cell;
+  unsigned int hash;
+  
+  FIN (coexistence_coupling_cached (type, Receiver_Freq, Interferer_Freq));
+  
+  hash = ((unsigned int) type * 2654435761u) ^ ((unsigned int) (Receiver_Freq * 10.0) * 73856093u) ^ ((unsigned int) (Interferer_Freq * 10.0) * 19349663u);
+  hash &= COUPLING_NB_BUCKETS - 1;
+  
+  for (cell = coupling_buckets[hash]; cell != NULL; cell = cell->next_cell)
+    {
+    if (cell->type == type && cell->receiver_freq == Receiver_Freq && cell->interferer_freq == Interferer_Freq)
+      FRET (cell->coupling);
+    }
+  
+  cell = (Coupling_Cell *) op_prg_mem_alloc (sizeof (Coupling_Cell));
+  cell->type = type;
+  cell->receiver_freq = Receiver_Freq;
+  cell->interferer_freq = Interferer_Freq;
+  
+  switch (type)
+    {
+    case COUPLING_15D4R_11BI:
+      cell->coupling = coexistence_coupling_15d4r_11bi_compute (Receiver_Freq, Interferer_Freq);
+      break;
+    
+    case COUPLING_15D4RI:
+      cell->coupling = coexistence_coupling_15d4ri_compute (Receiver_Freq, Interferer_Freq);
+      break;
+    
+    case COUPLING_11BR_15D4I:
+      cell->coupling = coexistence_coupling_11br_15d4i_compute (Receiver_Freq, Interferer_Freq);
+      break;
+    
+    default:
+      cell->coupling = coexistence_coupling_11bri_compute (Receiver_Freq, Interferer_Freq);
+      break;
+    }
+  
+  cell->next_cell = coupling_buckets[hash];
+  coupling_buckets[hash] = cell;
+  
+  FRET (cell->coupling);
+}
+
+
 /*
  * Function:	coexistence_coupling_15d4r_11bi
  *
+ * Description:	coupling of an 802.15.4 receiver with an 802.11b interferer,
+ *				computed once per pair of frequencies
+ */
+
+double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_Freq)
+{
+  double coupling;
+  
+  FIN (coexistence_coupling_15d4r_11bi (Receiver_Freq, Interferer_Freq));
+  
+  coupling = coexistence_coupling_cached (COUPLING_15D4R_11BI, Receiver_Freq, Interferer_Freq);
+  
+  FRET (coupling);
+}
+
+
+/*
+ * Function:	coexistence_coupling_15d4ri
+ *
+ * Description:	coupling of an 802.15.4 receiver with an 802.15.4 interferer,
+ *				computed once per pair of frequencies
+ */
+
+double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq)
+{
+  double coupling;
+  
+  FIN (coexistence_coupling_15d4ri (Receiver_Freq, Interferer_Freq));
+  
+  coupling = coexistence_coupling_cached (COUPLING_15D4RI, Receiver_Freq, Interferer_Freq);
+  
+  FRET (coupling);
+}
+
+
+/*
+ * Function:	coexistence_coupling_11br_15d4i
+ *
+ * Description:	coupling of an 802.11b receiver with an 802.15.4 interferer,
+ *				computed once per pair of frequencies
+ */
+
+double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_Freq)
+{
+  double coupling;
+  
+  FIN (coexistence_coupling_11br_15d4i (Receiver_Freq, Interferer_Freq));
+  
+  coupling = coexistence_coupling_cached (COUPLING_11BR_15D4I, Receiver_Freq, Interferer_Freq);
+  
+  FRET (coupling);
+}
+
+
+/*
+ * Function:	coexistence_coupling_11bri
+ *
+ * Description:	coupling of an 802.11b receiver with an 802.11b interferer,
+ *				computed once per pair of frequencies
+ */
+
+double coexistence_coupling_11bri (double Receiver_Freq, double Interferer_Freq)
+{
+  double coupling;
+  
+  FIN (coexistence_coupling_11bri (Receiver_Freq, Interferer_Freq));
+  
+  coupling = coexistence_coupling_cached (COUPLING_11BRI, Receiver_Freq, Interferer_Freq);
+  
+  FRET (coupling);
+}
+
+
+/*
+ * Function:	coexistence_coupling_15d4r_11bi_compute
+ *
  * Description:	Given frequencies center for receiver and interferer and their respective
  *				center frequencies, compute a Spectrum Factor that reflects the
  *				amount of coupling between interferer's generated spectrum and
@@ -399,7 +741,7 @@ double coexistence_11bri( double receiver_freq,	double t_power, double t_distanc
  *				receiver's input filter.
  */
 
-double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_Freq)
+static double coexistence_coupling_15d4r_11bi_compute (double Receiver_Freq, double Interferer_Freq)
 {
   int i; // loop variable
   /* 
@@ -427,11 +769,11 @@ double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_
 			     {12.0, -30.0}, {22.0, -30.0}, 
 			     {23.0, -55.3}, {27.5, -55.3}};
 
-  double prod_spectrum[14][2];
+  double prod_area;
   double normalized_area;
   double coupling = 0;
 
-  FIN (coexistence_coupling_15d4r_11bi (Receiver_Freq, Interferer_Freq));
+  FIN (coexistence_coupling_15d4r_11bi_compute (Receiver_Freq, Interferer_Freq));
 
   /* compute the spectrum of the receiver */
   for (i=0; i<4; i++)
@@ -448,15 +790,11 @@ double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_
    * inteferer's spectrum.
    */
 
-  spectrum_multiply (mask_11bi, 10, mask_15d4r, 4, &prod_spectrum);
-
-  /* Sort the product of the two spectra */
-  spectrum_sort (&prod_spectrum, 14);
+  spectrum_product (mask_11bi, 10, mask_15d4r, 4, OPC_NIL, &prod_area);
 
   /* display spectrum */
   /*spectrum_display (mask_15d4r, 4);
-    spectrum_display (mask_11bi, 10);
-    spectrum_display (prod_spectrum, 14);*/
+    spectrum_display (mask_11bi, 10);*/
 
   /* 
    * If the interferer has a 10Mhz spectrum and the receiver a 2MHz
@@ -464,7 +802,7 @@ double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_
    * past the receiver's filter.  Normalize accordingly (### and 
    * fix this comment).
    */
-  normalized_area = spectrum_area(prod_spectrum, 14)/spectrum_area(mask_11bi, 10);
+  normalized_area = prod_area / spectrum_area (mask_11bi, 10);
   coupling = util_dB (normalized_area);
 
   FRET (coupling);
@@ -472,7 +810,7 @@ double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_
 
 
 /*
- * Function:	coexistence_coupling_15d4ri
+ * Function:	coexistence_coupling_15d4ri_compute
  *
  * Description:	Given frequencies center for receiver and interferer and their respective
  *				center frequencies, compute a Spectrum Factor that reflects the
@@ -490,7 +828,7 @@ double coexistence_coupling_15d4r_11bi (double Receiver_Freq, double Interferer_
  *				receiver's input filter.
  */
 
-double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq)
+static double coexistence_coupling_15d4ri_compute (double Receiver_Freq, double Interferer_Freq)
 {
   int i; // loop variable
   /* 
@@ -510,11 +848,11 @@ double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq
   double mask_15d4i[4][2] = {{-7.0, -20.0}, {-3.5, 0.0}, 
 			     {3.5, 0.0}, {7.0, -20.0}};
 
-  double prod_spectrum[8][2];
+  double prod_area;
   double normalized_area;
   double coupling = 0;
 
-  FIN (coexistence_coupling_15d4ri (Receiver_Freq, Interferer_Freq));
+  FIN (coexistence_coupling_15d4ri_compute (Receiver_Freq, Interferer_Freq));
 
   /* compute the spectrum of the receiver */
   for (i=0; i<4; i++)
@@ -531,15 +869,11 @@ double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq
    * inteferer's spectrum.
    */
 
-  spectrum_multiply (mask_15d4i, 4, mask_15d4r, 4, &prod_spectrum);
-
-  /* Sort the product of the two spectra */
-  spectrum_sort (&prod_spectrum, 8);
+  spectrum_product (mask_15d4i, 4, mask_15d4r, 4, OPC_NIL, &prod_area);
 
   /* display spectrum */
   /*spectrum_display (mask_15d4r, 4);
-    spectrum_display (mask_15d4i, 4);
-    spectrum_display (prod_spectrum, 8);*/
+    spectrum_display (mask_15d4i, 4);*/
 
   /* 
    * If the interferer has a 10Mhz spectrum and the receiver a 2MHz
@@ -547,7 +881,7 @@ double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq
    * past the receiver's filter.  Normalize accordingly (### and 
    * fix this comment).
    */
-  normalized_area = spectrum_area (prod_spectrum, 8) / spectrum_area (mask_15d4i, 4);
+  normalized_area = prod_area / spectrum_area (mask_15d4i, 4);
   coupling = util_dB (normalized_area);
 
   FRET (coupling);
@@ -556,7 +890,7 @@ double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq
 
 
 /*
- * Function:	coexistence_coupling_11br_15d4i
+ * Function:	coexistence_coupling_11br_15d4i_compute
  *
  * Description:	Given frequencies center for receiver and interferer and their respective
  *				center frequencies, compute a Spectrum Factor that reflects the
@@ -574,7 +908,7 @@ double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq
  *				receiver's input filter.
  */
 
-double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_Freq)
+static double coexistence_coupling_11br_15d4i_compute (double Receiver_Freq, double Interferer_Freq)
 {
   int i; // loop variable
   /* 
@@ -594,11 +928,11 @@ double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_
   double mask_15d4i[4][2] = {{-7.0, -20.0}, {-3.5, 0.0}, 
 			     {3.5, 0.0}, {7.0, -20.0}};
 
-  double prod_spectrum[8][2];
+  double prod_area;
   double normalized_area;
   double coupling = 0;
 
-  FIN (coexistence_coupling_11br_15d4i (Receiver_Freq, Interferer_Freq));
+  FIN (coexistence_coupling_11br_15d4i_compute (Receiver_Freq, Interferer_Freq));
 
   /* compute the spectrum of the receiver */
   for (i=0; i<4; i++)
@@ -615,15 +949,11 @@ double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_
    * inteferer's spectrum.
    */
 
-  spectrum_multiply (mask_15d4i, 4, mask_11br, 4, &prod_spectrum);
-
-  /* Sort the product of the two spectra */
-  spectrum_sort (&prod_spectrum, 8);
+  spectrum_product (mask_15d4i, 4, mask_11br, 4, OPC_NIL, &prod_area);
 
   /* display spectrum */
   /*spectrum_display (mask_15d4r, 4);
-    spectrum_display (mask_11bi, 10);
-    spectrum_display (prod_spectrum, 14);*/
+    spectrum_display (mask_11bi, 10);*/
 
   /* 
    * If the interferer has a 10Mhz spectrum and the receiver a 2MHz
@@ -631,7 +961,7 @@ double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_
    * past the receiver's filter.  Normalize accordingly (### and 
    * fix this comment).
    */
-  normalized_area = spectrum_area(prod_spectrum, 8)/spectrum_area(mask_15d4i, 4);
+  normalized_area = prod_area / spectrum_area (mask_15d4i, 4);
   coupling = util_dB (normalized_area);
 
 			 
@@ -640,7 +970,7 @@ double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_
 
 
 /*
- * Function:	coexistence_coupling_11bri
+ * Function:	coexistence_coupling_11bri_compute
  *
  * Description:	Given frequencies center for receiver and interferer and their respective
  *				center frequencies, compute a Spectrum Factor that reflects the
@@ -658,7 +988,7 @@ double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_
  *				receiver's input filter.
  */
 
-double coexistence_coupling_11bri (double Receiver_Freq, double Interferer_Freq)
+static double coexistence_coupling_11bri_compute (double Receiver_Freq, double Interferer_Freq)
 {
   int i; // loop variable
   /* 
@@ -687,11 +1017,11 @@ double coexistence_coupling_11bri (double Receiver_Freq, double Interferer_Freq)
 			     {12.0, -30.0}, {22.0, -30.0}, 
 			     {23.0, -55.3}, {27.5, -55.3}};
 
-  double prod_spectrum[14][2];
+  double prod_area;
   double normalized_area;
   double coupling = 0;
 
-  FIN (coexistence_coupling_11br_15d4i (Receiver_Freq, Interferer_Freq));
+  FIN (coexistence_coupling_11bri_compute (Receiver_Freq, Interferer_Freq));
 
   /* compute the spectrum of the receiver */
   for (i=0; i<4; i++)
@@ -708,16 +1038,12 @@ double coexistence_coupling_11bri (double Receiver_Freq, double Interferer_Freq)
    * inteferer's spectrum.
    */
 
-  spectrum_multiply (mask_11bi, 10, mask_11br, 4, &prod_spectrum);
+  spectrum_product (mask_11bi, 10, mask_11br, 4, OPC_NIL, &prod_area);
 			 
 
-  /* Sort the product of the two spectra */
-  spectrum_sort (&prod_spectrum, 14);
-
   /* display spectrum */
   /*spectrum_display (mask_11br, 4);
-    spectrum_display (mask_11bi, 10);
-    spectrum_display (prod_spectrum, 14);*/
+    spectrum_display (mask_11bi, 10);*/
 
   /* 
    * If the interferer has a 10Mhz spectrum and the receiver a 2MHz
@@ -725,7 +1051,7 @@ double coexistence_coupling_11bri (double Receiver_Freq, double Interferer_Freq)
    * past the receiver's filter.  Normalize accordingly (### and 
    * fix this comment).
    */
-  normalized_area = spectrum_area (prod_spectrum, 14) / spectrum_area (mask_11bi, 10);
+  normalized_area = prod_area / spectrum_area (mask_11bi, 10);
   coupling = util_dB (normalized_area);
 
 			 
@@ -67,12 +67,40 @@ typedef enum {
 	NAKAGAMI_15_4A
 } Channel_Model;
 
+/* transmitters interfering with a reception, stored by field for the batch computations */
+typedef struct {
+	int			size;
+	int			capacity;
+	double *	tx_x;
+	double *	tx_y;
+	double *	power;
+	double *	frequency;
+	double *	distance;
+	double *	snr;
+} Snr_Batch;
+
+/* dense table of a curve sampled with a constant step in dB */
+typedef struct {
+	double		min_dB;
+	double		max_dB;
+	double		inv_step;
+	int			size;
+	double *	values;
+} Util_dB_Table;
+
+/* range and step of the BER and Pmd tables (dB) */
+#define DB_TABLE_MIN		-30.0
+#define DB_TABLE_MAX		40.0
+#define DB_TABLE_STEP		0.01
+
 /* function prototypes */
 
 /* Util functions: file Util.ex.c */
 double	util_dB (double ratio);
 double	util_inverse_dB (double dB);
 double path_loss_attenuation (double separation, double frequency);
+void	util_dB_table_build (Util_dB_Table * table, double min_dB, double max_dB, double step, double (*curve) (double));
+double	util_dB_table_lookup (const Util_dB_Table * table, double dB);
 
 /* Binomial functions: file Binomial.ex.c */
 double	binomial_factorial (int m);
@@ -108,14 +136,18 @@ double coexistence_coupling_15d4ri (double Receiver_Freq, double Interferer_Freq
 double coexistence_coupling_11br_15d4i (double Receiver_Freq, double Interferer_Freq);
 double coexistence_coupling_11bri (double Receiver_Freq, double Interferer_Freq);
 double snr_15_4a (double receiver_freq, double t_power, double t_distance);
+double snr_15_4a_path_loss (double t_power, double path_loss);
+void	snr_batch_clear (Snr_Batch * batch);
+void	snr_batch_add (Snr_Batch * batch, double tx_x, double tx_y, double t_power, double frequency);
+double	snr_15_4a_batch (Snr_Batch * batch, double rx_x, double rx_y);
+void	snr_batch_release (Snr_Batch * batch);
 
 /* Spectrum functions: file Spectrum.ex.c */
-void	spectrum_multiply (double ispectrum[][2], int isize, double rspectrum[][2], int rsize, double (*prod_spectrum)[][2]);
+int		spectrum_product (double ispectrum[][2], int isize, double rspectrum[][2], int rsize, double prod_spectrum[][2], double * area_ptr);
 double	spectrum_find_gain_at (double frequency, double spectrum[][2], int size);
 double	spectrum_lerp (double x, double x0, double x1, double y0, double y1);
 double	spectrum_area (double spectrum[][2], int size);
 double	spectrum_db_trapezoid (double d0, double d1, double width);
-void	spectrum_sort (double (*spectrum)[][2], int size);
 void	spectrum_display (double spectrum[][2], int size);
 
 
@@ -51,7 +51,7 @@
 
 double qerf_Q (double x)
 {
-  double r; // return value
+  double r = 0.0; // return value
   
   FIN (qerf_Q (x));
 
@@ -27,80 +27,138 @@
 /* include the header */
 #include "Physical_Layer.h"
 
+/* local function prototypes */
+static double	spectrum_gain_walk (double frequency, double spectrum[][2], int size, int * cursor_ptr);
+
 
 /*
- * Function:	spectrum_multiply
+ * Function:	spectrum_product
  *
- * Description:	Create a filter that is the product of the interferer's spectrum and
- *				the receiver input filter. The resulting filter has the same min
- *				and max frequencies as the interferer's spectrum.
+ * Description:	Product of the interferer's spectrum and the receiver input
+ *				filter, sorted by frequency, and its area (spectrum_area),
+ *				in a single merge of the two sorted spectra. The gains are
+ *				found by walking the other spectrum along with the
+ *				frequencies, so the cost is linear and the spectra can
+ *				have any size.
  *
  * ParamIn:		double ispectrum[][2]
- *				interferer's spectrum
+ *				interferer's spectrum (sorted)
  *
  *				int isize
  *				size of the interferer spectrum (number of pairs)
  *
  *				double rspectrum[][2]
- *				receiver's filter
+ *				receiver's filter (sorted)
  *
  *				int rsize
  *				size of the receiver's spectrum (number of pairs)
  *
- *				double (*prod_spectrum)[][2]
- *				pointer to the product spectrum
+ *				double prod_spectrum[][2]
+ *				product spectrum, of isize+rsize pairs at most
+ *				(OPC_NIL if only the area is needed)
+ *
+ * ParamOut:	double * area_ptr
+ *				area under the product spectrum
+ *
+ *				int size
+ *				size of the product spectrum
  */
 
-void spectrum_multiply (double ispectrum[][2], int isize, double rspectrum[][2], int rsize, double (*prod_spectrum)[][2])
+int spectrum_product (double ispectrum[][2], int isize, double rspectrum[][2], int rsize, double prod_spectrum[][2], double * area_ptr)
 {
-  int i, j; // loop variables
+  int i = 0, j = 0; // positions in the spectra
+  int icursor = 1, rcursor = 1; // positions of the gain walks
+  int size = 0;
   double fLow = ispectrum[0][0];
   double fHigh = ispectrum[isize-1][0];
+  double frequency, gain;
+  double prev_frequency = 0.0, prev_gain = 0.0;
 
-  FIN (spectrum_multiply (ispectrum, isize, rspectrum, rsize, prod_spectrum));
+  FIN (spectrum_product (ispectrum, isize, rspectrum, rsize, prod_spectrum, area_ptr));
 
-  /* init the prod spectrum */
-  for (i=0; i<isize+rsize; i++)
-    {
-      (*prod_spectrum)[i][0] = INFINITY_FREQ;
-      (*prod_spectrum)[i][1] = 0.0;
-    }
+  *area_ptr = 0.0;
 
-  /* 
-   * first multiply breakpoints of this filter with interpolated
-   * values from the other filter
-   */
-  for (i=0; i<isize; i++)
-    {
-      /* copy the frequency of the ispectrum to the prod */
-      (*prod_spectrum)[i][0] = ispectrum[i][0];
-      /* compute a Gain */
-      (*prod_spectrum)[i][1] = ispectrum[i][1] + spectrum_find_gain_at (ispectrum[i][0], rspectrum, rsize);
-    }
+  /* only the breakpoints of the receiver between fLow and fHigh are kept */
+  while (j < rsize && rspectrum[j][0] <= fLow)
+    j++;
+  if (j < rsize && rspectrum[j][0] >= fHigh)
+    j = rsize;
 
-  /*
-   * now multiply breakpoints from other filter with
-   * interpolated values from this filter, but only those that
-   * fall within fLow and fHigh of this filter
-   */
-  for (i=0; i<rsize; i++)
+  while (i < isize)
     {
-      j = i + isize;
-
-      if (rspectrum[i][0] >= fHigh)
+      if (j < rsize && rspectrum[j][0] < ispectrum[i][0])
 	{
-	  break;
+	  /* breakpoint of the receiver */
+	  frequency = rspectrum[j][0];
+	  gain = rspectrum[j][1] + spectrum_gain_walk (frequency, ispectrum, isize, &icursor);
+	  j++;
 	}
-      else if (rspectrum[i][0] > fLow)
+      else
 	{
-	  /* copy the frequency of the rspectrum to the prod */
-	  (*prod_spectrum)[j][0] = rspectrum[i][0];
-	  /* compute a Gain */
-	  (*prod_spectrum)[j][1] = rspectrum[i][1] + spectrum_find_gain_at (rspectrum[i][0], ispectrum, isize);
+	  /* breakpoint of the interferer (a receiver one at the same frequency is merged) */
+	  frequency = ispectrum[i][0];
+	  gain = ispectrum[i][1] + spectrum_gain_walk (frequency, rspectrum, rsize, &rcursor);
+	  if (j < rsize && rspectrum[j][0] == frequency)
+	    j++;
+	  i++;
 	}
+
+      if (j < rsize && rspectrum[j][0] >= fHigh)
+	j = rsize;
+
+      if (size > 0)
+	*area_ptr += spectrum_db_trapezoid (prev_gain, gain, frequency - prev_frequency);
+
+      if (prod_spectrum != OPC_NIL)
+	{
+	  prod_spectrum[size][0] = frequency;
+	  prod_spectrum[size][1] = gain;
+	}
+
+      prev_frequency = frequency;
+      prev_gain = gain;
+      size++;
     }
 
-  FOUT;
+  FRET (size);
+}
+
+/*
+ * Function:	spectrum_gain_walk
+ *
+ * Description:	spectrum_find_gain_at for increasing frequencies: the
+ *				search starts from the breakpoint found by the previous
+ *				call (cursor, 1 for the first call).
+ */
+
+static double spectrum_gain_walk (double frequency, double spectrum[][2], int size, int * cursor_ptr)
+{
+  double gain;
+  int i = *cursor_ptr; // loop variable
+
+  FIN (spectrum_gain_walk (frequency, spectrum, size, cursor_ptr));
+
+  if (frequency < spectrum[0][0]) 
+    {
+      gain = spectrum[0][1];
+    } 
+  else if (frequency >= spectrum[size-1][0])
+    {
+      gain = spectrum[size-1][1];
+    }
+  else
+    {
+      while (spectrum[i][0] < frequency)
+	i++;
+      *cursor_ptr = i;
+
+      if (frequency == spectrum[i][0]) 
+	gain = spectrum[i][1];
+      else
+	gain = spectrum_lerp (frequency, spectrum[i-1][0], spectrum[i][0], spectrum[i-1][1], spectrum[i][1]);
+    }
+
+  FRET (gain);
 }
 
 /*
@@ -269,43 +327,6 @@ double spectrum_db_trapezoid (double d0, double d1, double width)
   FRET (fabs(area));
 }
 
-/*
- * Function:	sort_spectrum
- */
-
-void spectrum_sort (double (*spectrum)[][2], int size)
-{
-  int i,j; // loop variables
-  double tmp;
-
-  FIN (sort_spectrum (spectrum, size));
-
-  /* */
-  for (i=0; i<size; i++)
-    for (j=i+1; j<size; j++)
-      {
-	if ((*spectrum)[j][0] < (*spectrum)[i][0])
-	  {
-	    /* permute the two pairs */
-	    tmp = (*spectrum)[j][0];
-	    (*spectrum)[j][0] = (*spectrum)[i][0];
-	    (*spectrum)[i][0] = tmp;
-
-	    tmp = (*spectrum)[j][1];
-	    (*spectrum)[j][1] = (*spectrum)[i][1];
-	    (*spectrum)[i][1] = tmp;
-	  }
-	else if ((*spectrum)[j][0] == (*spectrum)[i][0])
-	  {
-	    (*spectrum)[j][0] = INFINITY_FREQ; // erase the pairs
-	    (*spectrum)[i][1] = (*spectrum)[j][1];
-	    (*spectrum)[j][1] = 0.0;
-	    }
-      }
-
-  FOUT;
-}
-
 /*
  * Function:	spectrum_display
  */
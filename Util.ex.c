@@ -76,6 +76,74 @@ double	util_inverse_dB (double dB)
 }
 
 
+/*
+ * function:	util_dB_table_build
+ *
+ * Description:	sample a curve every step dB between min_dB and max_dB,
+ *		so that it can be read with util_dB_table_lookup.
+ *
+ * ParamIn:	Util_dB_Table * table
+ *		table to fill
+ *
+ *		double min_dB, double max_dB, double step
+ *		range and step of the samples (dB)
+ *
+ *		double (*curve) (double)
+ *		function sampled
+ */
+
+void util_dB_table_build (Util_dB_Table * table, double min_dB, double max_dB, double step, double (*curve) (double))
+{
+  int i;
+
+  FIN (util_dB_table_build (table, min_dB, max_dB, step, curve));
+
+  table->min_dB = min_dB;
+  table->max_dB = max_dB;
+  table->inv_step = 1.0 / step;
+  table->size = (int) floor ((max_dB - min_dB) * table->inv_step + 0.5) + 1;
+
+  /* one more sample, so that the last interval can be read at max_dB */
+  table->values = (double *) op_prg_mem_alloc ((table->size + 1) * sizeof (double));
+
+  for (i = 0; i < table->size; i++)
+    table->values[i] = curve (min_dB + i * step);
+  table->values[table->size] = table->values[table->size - 1];
+
+  FOUT;
+}
+
+/*
+ * function:	util_dB_table_lookup
+ *
+ * Description:	linear interpolation of a sampled curve. The value must be
+ *		in the range of the table.
+ *
+ * ParamIn:	const Util_dB_Table * table
+ *		sampled curve
+ *
+ *		double dB
+ *		abscissa (dB)
+ *
+ * ParamOut:	double value
+ *		value of the curve
+ */
+
+double util_dB_table_lookup (const Util_dB_Table * table, double dB)
+{
+  double x, value;
+  int i;
+
+  FIN (util_dB_table_lookup (table, dB));
+
+  x = (dB - table->min_dB) * table->inv_step;
+  i = (int) x;
+  value = table->values[i] + (x - i) * (table->values[i+1] - table->values[i]);
+
+  FRET (value);
+}
+
+
 /*
  * Function:	path_loss_attenuation
  *
@@ -94,12 +94,12 @@ const char WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_pr_c [] = "MIL
 #define min(a,b)	(a < b)?a:b
 #endif
 
-/* debugging Macro */
-#define ENTER_STATE_ODB_PRINTING(a) if (STATE_PRINT_STATUS)\
+/* debugging Macro, on the traces of the current event */
+#define ENTER_STATE_ODB_PRINTING(a) if (WPAN_TRACE_ACTIVE (trace_mask, WPAN_TRACE_STATE))\
 	printf ("%s MAC layer (%d): %.9f s: %s\n",\
 	lr_wpan_node_name, my_parameters->mac_address, op_sim_time (), a)
 
-#define FLAG_ODB_PRINTING		if (FLAG_PRINT_STATUS)\
+#define FLAG_ODB_PRINTING		if (WPAN_TRACE_ACTIVE (trace_mask, WPAN_TRACE_FLAG))\
 	printf ("%s MAC layer (%d): flag status:\n\t%s\n\t%s\n\t%s\n\t%s\n",\
 	lr_wpan_node_name, my_parameters->mac_address,\
 	(channel_flag.tx_idle)?"TX is idle":"TX is busy",\
@@ -109,15 +109,41 @@ const char WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_pr_c [] = "MIL
 
 /* structure definition */
 
+/* traffic classes of the subqueues, the emergency traffic is served first */
+typedef enum {
+	Regular_Traffic,				//0
+	Emergency_Traffic,				//1
+} Wpan_Traffic_Class;
+
+#define WPAN_NB_TRAFFIC_CLASSES	2
+
 /* structure to create the MAC subqueues system */
 typedef struct t_Wpan_Queue {
 	List * subqueue;
 	int mac_address;
+	int traffic_class;
+	int position;	// position in the chain of the subqueues
 	int size;
 	int nb_element;
 	struct t_Wpan_Queue * next;
 } Wpan_Queue;
 
+/*
+ * index of the MAC subqueues: open addressing hash table of the
+ * subqueues (linear probing on the destination and traffic class),
+ * subqueues by position and bitmaps of the non-empty subqueues
+ */
+typedef struct {
+	Wpan_Queue **	slots;
+	int				nb_slots;								// power of 2
+	Wpan_Queue **	chain;									// subqueues by position
+	int				nb_subqueues;
+	int				capacity;
+	unsigned int *	active[WPAN_NB_TRAFFIC_CLASSES];		// one bit per position
+	int				nb_active[WPAN_NB_TRAFFIC_CLASSES];		// non-empty subqueues of each class
+	int				nb_packets;								// packets of all the subqueues
+} Wpan_Queue_Index;
+
 /* define the codes for the interruptions */
 typedef enum {
 	Backoff_Time_Out,				//0
@@ -192,8 +218,6 @@ typedef struct {
 
 } Wpan_Stat_Vector;
 
-Wpan_Stat_Vector Wpan_Superframe_Statistics;
-
 /* define a statistic vector */
 typedef struct {
 	int Segments_Bits_Generated;
@@ -223,9 +247,6 @@ typedef struct {
 Wpan_CCA_Vector Global_CCA_Statistics;
 
 
-Wpan_CCA_Vector Superframe_CCA_Statistics;
-
-
 /* define a global statistic vector */
 typedef struct {
 	int Data_Pkt_Rcv; 
@@ -258,7 +279,21 @@ typedef struct {
 } Global_Stat_Vector;
 Global_Stat_Vector global_statistics;
 
-Global_Stat_Vector superframe_statistics;
+/* shard of the global statistics: each MAC writes its own counters */
+/* and the shards are summed when the totals are read */
+typedef struct {
+	Global_Stat_Vector	global;
+	Wpan_CCA_Vector		cca;
+	
+	/* totals of all the MACs and statistics of the coordinator at the */
+	/* last superframe report, only kept in the shard of the coordinator */
+	Global_Stat_Vector	superframe;
+	Wpan_CCA_Vector		superframe_cca;
+	Wpan_Stat_Vector	superframe_node;
+} Wpan_Stat_Shard;
+
+/* shards of all the MACs */
+List * stat_shard_list = OPC_NIL;
 
 /* define the channel flag */
 typedef struct {
@@ -268,12 +303,6 @@ typedef struct {
 	Boolean data_is_sending;
 } Wpan_Chan_Flag;
 
-/* define the Data Rx Seqn */
-typedef struct {
-	int mac_address;
-	int seqn;
-} Mac_Data_Seqn;
-
 /* define the backoff parameters */
 typedef struct {
 	int max_backoff; // maximum number of Backoff
@@ -319,8 +348,8 @@ typedef struct {
 
 //List* list_tx_ptr_global;
 //List* list_retx_ptr_global;
-List* list_stack_change_ptr;
-List* list_traffic_snr_ptr;
+Wpan_Record_Stream* stack_change_stream = OPC_NIL;
+Wpan_Record_Stream* traffic_snr_stream = OPC_NIL;
 
 int    aBaseSlotDuration = 0;
 int    aUnitBackoffPeriod = 0;
@@ -353,7 +382,6 @@ FILE* fp_debug;
 char file_name[100] = "C:\\Users\\bgebreme\\op_reports\\Simulation.txt";
 
 FILE* fp_service_time;
-char file_service_time[100] = "C:\\Users\\bgebreme\\op_reports\\";
 char service_name[100] = "service_time.txt";
 
 /*service time statistics*/
@@ -450,6 +478,7 @@ static void			lr_wpan_cancel_TAT (TxRx_Management code);
 static void			lr_wpan_cca_init (void);
 static void 		lr_wpan_mac_backoff (void);
 static void 		lr_wpan_intrpt_check (const char * state_name);
+static void			lr_wpan_trace_mask_update (void);
 static void			lr_wpan_generate_beacon (void);
 static void			lr_wpan_generate_data_request (void);
 static void 		higher_layer_pkt_recv (void);
@@ -460,30 +489,37 @@ static void			lr_wpan_ack_to_transmit (void);
 static void 		lr_wpan_debug_state_msg (const char * state_name, Boolean exit);
 static void			lr_wpan_drop_higher_layer_pkt (void);
 static int			lr_wpan_destroy_retransmission (void);
+static Ici *		lr_wpan_tx_ici_create (int dest_address, double txrx_distance, const Wpan_Node_Param * rxptr, Wpan_Pkt_Format format);
 static void 		lr_wpan_print_queue (void);
 static int			lr_wpan_get_beacon_size (Addressing_Field * address);
-static void 		lr_wpan_enqueue_packet (int mac_address, Packet * pkptr);
-static Wpan_Queue * lr_wpan_allocate_subqueue (int mac_address, Packet * pkptr);
+static void 		lr_wpan_enqueue_packet (int mac_address, int traffic_class, Packet * pkptr);
+static Wpan_Queue * lr_wpan_allocate_subqueue (int mac_address, int traffic_class);
+static int			lr_wpan_subqueue_slot (int mac_address, int traffic_class);
+static Wpan_Queue *	lr_wpan_subqueue_search (int mac_address, int traffic_class);
+static void			lr_wpan_subqueue_register (Wpan_Queue * queue);
+static void			lr_wpan_subqueue_size_update (Wpan_Queue * queue);
+static int			lr_wpan_subqueue_next_active (int traffic_class, int from, int to);
 //static void		lr_wpan_subq_allocation (void);
 static void			lr_wpan_subq_checking (void);
+static int *		lr_wpan_rx_seqn_entry (int mac_address);
+static Boolean		lr_wpan_rx_seqn_check (int mac_address, int seqn);
 static int 			lr_wpan_get_rx_seqn (int mac_address);
-static void 		lr_wpan_set_rx_seqn (int mac_address, int seqn);
 
 static void 		lr_wpan_collect_stat (void);
 static void  		lr_wpan_collect_performance_info1 ();
 static void  		lr_wpan_collect_performance_info2 ();
 static void 		lr_wpan_collect_stat_nodes (void);
 static void 		lr_wpan_collect_stat_global (void);
+static void 		lr_wpan_sum_stat_shards (Global_Stat_Vector * global_ptr, Wpan_CCA_Vector * cca_ptr);
 
 static void			lr_wpan_process_rcvd_beacon_frame (Packet * wpan_rcvd_frame_ptr);
 static Boolean 		lr_wpan_csma_can_proceed (void);
 static int 			lr_wpan_get_tx_packet_size (void);
+static double		lr_wpan_next_backoff_boundary (void);
+static int			lr_wpan_remaining_CAP_backoff_periods (void);
 static void 		lr_wpan_cca_evaluation(void);
-static double 		lr_wpan_locate_backoff_period_boundary(void);
 
-static double 		lr_wpan_slotted_boundary_time (void);
 
-static double		lr_wpan_slotted_boundary_time_modified (void);
 static void 		lr_wpan_cca_failure (void);
 static void 		lr_wpan_cca2_success (void);
 
@@ -494,6 +530,7 @@ static void 		s_aloha_set_flags(void);
 
 static void 		update_retransmissions_list();
 static void 		update_transmissions_list();
+static void 		write_stack_change_record (FILE * fp, const void * record);
 
 
 
@@ -530,7 +567,8 @@ typedef struct
 	Stathandle	             		nb_pkt_recv                                     ;	/* Number of packet received */
 	Stathandle	             		nb_pkt_send                                     ;	/* Number of packet send */
 	Packet *	               		retransmission_ptr                              ;	/* Copy of the current packet to transmit for retransmission */
-	List *	                 		Mac_Data_Rx_Seqn                                ;	/* Data sequence number (DSN) defined in the IEEE 802.15.4 */
+	int *	                  		Mac_Data_Rx_Seqn                                ;	/* Data sequence number (DSN) defined in the IEEE 802.15.4, by position of the source in the node list */
+	int	                    		Mac_Data_Rx_Seqn_Size                           ;	/* number of devices in the table of the received sequence numbers */
 	Boolean	                		Rx_Ack_Expected                                 ;	/* flag to know whether we are waiting for an acknowledgment */
 	Boolean	                		Tx_Ack_Require                                  ;	/* flag to know whether we have to send an acknowledgment */
 	Evhandle	               		Ack_TimeOut_Evhandle                            ;	/* Handle for the interruption of the acknowledgment time out */
@@ -543,6 +581,8 @@ typedef struct
 	Evhandle	               		TAT_RX_Evhandle                                 ;	/* Handle for the interruption of the turn around time of the RX */
 	Boolean	                		wpan_transmission_required                      ;	/* Indicate that some packets need to be transmitted */
 	Wpan_Queue *	           		current_queue                                   ;	/* mark the queue using to send the packets */
+	Wpan_Queue_Index	       		queue_index                                     ;	/* index of the subqueues by destination and of the non-empty subqueues */
+	int	                    		trace_mask                                      ;	/* traces active for the current event (WPAN_TRACE_*) */
 	int	                    		max_frame_retries                               ;	/* Number of maximum transmission retries */
 	int	                    		nb_transmission_retries                         ;	/* Number of current transmission retries */
 	OmsT_Pr_Handle	         		own_process_record_handle                       ;	/* Used to record the MAC process in the model wide registry */
@@ -581,9 +621,9 @@ typedef struct
 	Stathandle	             		BE_handle                                       ;
 	Stathandle	             		backoff_interval_handle                         ;
 	Stathandle	             		cca_stat_handle                                 ;
-	List *	                 		statistic_retx_list_ptr                         ;
+	Wpan_Time_Histogram *	  		statistic_retx_hist                             ;
 	int	                    		aloha_cw                                        ;
-	List *	                 		statistic_tx_list_ptr                           ;
+	Wpan_Time_Histogram *	  		statistic_tx_hist                               ;
 	Boolean	                		ideal_poisson_traffic                           ;
 	Boolean	                		GADGET_enabled                                  ;
 	double	                 		GADGET_snr                                      ;
@@ -591,6 +631,7 @@ typedef struct
 	double	                 		GADGET_sma_snr                                  ;
 	double	                 		GADGET_sma_traffic                              ;
 	int	                    		GADGET_sma_counter                              ;
+	Wpan_Stat_Shard *	      		stat_shard                                      ;	/* Shard of the global statistics written by this MAC */
 	Boolean	                		lecim_enabled                                   ;
 	Boolean	                		pca_used_enabled                                ;
 	int	                    		data_rate                                       ;
@@ -614,6 +655,7 @@ typedef struct
 #define nb_pkt_send             		op_sv_ptr->nb_pkt_send
 #define retransmission_ptr      		op_sv_ptr->retransmission_ptr
 #define Mac_Data_Rx_Seqn        		op_sv_ptr->Mac_Data_Rx_Seqn
+#define Mac_Data_Rx_Seqn_Size   		op_sv_ptr->Mac_Data_Rx_Seqn_Size
 #define Rx_Ack_Expected         		op_sv_ptr->Rx_Ack_Expected
 #define Tx_Ack_Require          		op_sv_ptr->Tx_Ack_Require
 #define Ack_TimeOut_Evhandle    		op_sv_ptr->Ack_TimeOut_Evhandle
@@ -626,6 +668,8 @@ typedef struct
 #define TAT_RX_Evhandle         		op_sv_ptr->TAT_RX_Evhandle
 #define wpan_transmission_required		op_sv_ptr->wpan_transmission_required
 #define current_queue           		op_sv_ptr->current_queue
+#define queue_index             		op_sv_ptr->queue_index
+#define trace_mask              		op_sv_ptr->trace_mask
 #define max_frame_retries       		op_sv_ptr->max_frame_retries
 #define nb_transmission_retries 		op_sv_ptr->nb_transmission_retries
 #define own_process_record_handle		op_sv_ptr->own_process_record_handle
@@ -664,9 +708,9 @@ typedef struct
 #define BE_handle               		op_sv_ptr->BE_handle
 #define backoff_interval_handle 		op_sv_ptr->backoff_interval_handle
 #define cca_stat_handle         		op_sv_ptr->cca_stat_handle
-#define statistic_retx_list_ptr 		op_sv_ptr->statistic_retx_list_ptr
+#define statistic_retx_hist     		op_sv_ptr->statistic_retx_hist
 #define aloha_cw                		op_sv_ptr->aloha_cw
-#define statistic_tx_list_ptr   		op_sv_ptr->statistic_tx_list_ptr
+#define statistic_tx_hist       		op_sv_ptr->statistic_tx_hist
 #define ideal_poisson_traffic   		op_sv_ptr->ideal_poisson_traffic
 #define GADGET_enabled          		op_sv_ptr->GADGET_enabled
 #define GADGET_snr              		op_sv_ptr->GADGET_snr
@@ -674,6 +718,7 @@ typedef struct
 #define GADGET_sma_snr          		op_sv_ptr->GADGET_sma_snr
 #define GADGET_sma_traffic      		op_sv_ptr->GADGET_sma_traffic
 #define GADGET_sma_counter      		op_sv_ptr->GADGET_sma_counter
+#define stat_shard              		op_sv_ptr->stat_shard
 #define lecim_enabled           		op_sv_ptr->lecim_enabled
 #define pca_used_enabled        		op_sv_ptr->pca_used_enabled
 #define data_rate               		op_sv_ptr->data_rate
@@ -719,6 +764,10 @@ static void lr_wpan_mac_init ()
 	char scenario_buffer[64];
 	
 	char error_message[256];
+	char report_name[128];
+	char report_header[256];
+	double stat_bin_width;
+	int trace_buffer_size;
 	Wpan_Node_Param * element;
 	
 	Objid superframe_parameters_comp_id;
@@ -742,6 +791,20 @@ static void lr_wpan_mac_init ()
 	wpan_queue = NULL;
 	current_queue = NULL;
 	
+	/* the index of the subqueues is allocated with the first subqueue */
+	queue_index.slots = NULL;
+	queue_index.nb_slots = 0;
+	queue_index.chain = NULL;
+	queue_index.nb_subqueues = 0;
+	queue_index.capacity = 0;
+	queue_index.nb_packets = 0;
+	
+	for (k = 0; k < WPAN_NB_TRAFFIC_CLASSES; k++)
+		{
+		queue_index.active[k] = NULL;
+		queue_index.nb_active[k] = 0;
+		}
+	
 	/* set the type of the node */
 	strcpy (my_parameters->type, "wpan");
 	
@@ -836,6 +899,16 @@ static void lr_wpan_mac_init ()
 	op_ima_obj_attr_get (my_parameters->objid, "Ideal_Poisson_Traffic", &ideal_poisson_traffic);
 	op_ima_obj_attr_get (my_parameters->objid, "GADGET_enabled", &GADGET_enabled);
 	
+	/* get the time resolution of the transmissions lists (optional, every frame by default) */
+	if (op_ima_obj_attr_exists (my_parameters->objid, "Statistic bin width") == OPC_FALSE ||
+		op_ima_obj_attr_get (my_parameters->objid, "Statistic bin width", &stat_bin_width) == OPC_COMPCODE_FAILURE)
+		stat_bin_width = 0.0;
+	
+	/* get the number of MAC events kept by the binary trace (optional, no trace by default) */
+	if (op_ima_obj_attr_exists (my_parameters->objid, "Trace buffer size") == OPC_FALSE ||
+		op_ima_obj_attr_get (my_parameters->objid, "Trace buffer size", &trace_buffer_size) == OPC_COMPCODE_FAILURE)
+		trace_buffer_size = 0;
+	
 	//create a file for printing debug informations
 	if(DEBUG_test || DEBUG_BEACON_RCVD || DEBUG_Backoff || DEBUG_Tx_Beacon || DEBUG_State || DEBUG_Rx_Ack || DEBUG_Rx_Data || DEBUG_Data_Tx || DEBUG_Idle_State || DEBUG_MAC_Application)
 		{
@@ -892,7 +965,7 @@ static void lr_wpan_mac_init ()
 			if ((index_wpan = wpan_search_mac_address (mac_address)) != -1)
 				{
 				/* get the element with the same MAC address */
-				element = op_prg_list_access (wpan_node_param_list, index_wpan);
+				element = wpan_node_get (index_wpan);
 				
 				/* get the name of this node */
 				op_ima_obj_attr_get_str (op_topo_parent (element->objid), "name", 64, buffer);
@@ -913,12 +986,15 @@ static void lr_wpan_mac_init ()
 	/* Set the WLAN field to NULL */
 	my_parameters->wlan_info = NULL;
 		
-	/* initialize the node list if it is not done */
-	if (wpan_node_param_list == OPC_NIL)
-		wpan_node_param_list = op_prg_list_create ();
-	
 	/* register the node into the list */
-	op_prg_list_insert (wpan_node_param_list, my_parameters, OPC_LISTPOS_TAIL);
+	wpan_node_register (my_parameters);
+	
+	/* register the shard of the global statistics written by this MAC */
+	stat_shard = (Wpan_Stat_Shard *) op_prg_mem_alloc (sizeof (Wpan_Stat_Shard));
+	memset (stat_shard, 0, sizeof (Wpan_Stat_Shard));
+	if (stat_shard_list == OPC_NIL)
+		stat_shard_list = op_prg_list_create ();
+	op_prg_list_insert (stat_shard_list, stat_shard, OPC_LISTPOS_TAIL);
 	
 	/* set the backoff parameters */
 	csma_parameters.Be = csma_parameters.min_BE;
@@ -942,7 +1018,8 @@ static void lr_wpan_mac_init ()
 	Tx_Ack_Require 					= OPC_FALSE;
 	Mac_Data_Tx_Seqn 				= rand () % MAX_MAC_SEQN;
 	Mac_Beacon_Tx_Seqn				= 0;
-	Mac_Data_Rx_Seqn 				= op_prg_list_create ();
+	Mac_Data_Rx_Seqn 				= OPC_NIL;
+	Mac_Data_Rx_Seqn_Size			= 0;
 	channel_flag.tx_idle 			= OPC_TRUE;
 	channel_flag.rx_idle 			= OPC_TRUE;
 	channel_flag.LIFS_on 			= OPC_FALSE;
@@ -1004,8 +1081,15 @@ static void lr_wpan_mac_init ()
 	
 	can_proceed_index = 0;
 	
-	statistic_tx_list_ptr = op_prg_list_create ();
-	statistic_retx_list_ptr = op_prg_list_create ();
+	/* the transmissions and retransmissions are written in the reports during the simulation,
+	   for every frame or for every bin of stat_bin_width seconds */
+	sprintf (report_name, "\\retransmissions\\%s_transmission_list.txt", lr_wpan_node_name);
+	sprintf (report_header, "\n\t*** Information about transmissions for the node %s ***\n\tTime\t transmissions\t %s\n\n", lr_wpan_node_name, (stat_bin_width > 0.0) ? "events\t " : "");
+	statistic_tx_hist = lr_wpan_time_histogram_create (report_name, report_header, stat_bin_width);
+	
+	sprintf (report_name, "\\retransmissions\\%s_retransmission_list.txt", lr_wpan_node_name);
+	sprintf (report_header, "\n\t*** Information about retransmissions for the node %s ***\n\tTime\t retransmissions\t %s\n\n", lr_wpan_node_name, (stat_bin_width > 0.0) ? "events\t " : "");
+	statistic_retx_hist = lr_wpan_time_histogram_create (report_name, report_header, stat_bin_width);
 	
 	
 	
@@ -1088,7 +1172,6 @@ static void lr_wpan_mac_init ()
  	sf_param.CAP_period_length_seconds = 0.0;
 	
 	sf_param.CAP_start_time = 0.0;
-	sf_param.remaining_CAP_backoff_periods = 0;
 	sf_param.end_of_the_CAP_period = 0.0;
 	sf_param.GTS_period_length_symbols = 0;
 	sf_param.GTS_period_length_seconds = 0.0;
@@ -1105,12 +1188,6 @@ static void lr_wpan_mac_init ()
 	sf_param.CPA4_ACTIVE = OPC_FALSE;
 	sf_param.GTS_PERIOD_ACTIVE = OPC_FALSE;
 	sf_param.INACTIVE_PERIOD = OPC_FALSE;
-	sf_param.backoff_period_boundary_symbols = NULL;
-	sf_param.time_slot_boundary_symbols = NULL;
-	
-	
-	sf_param.backoff_period_boundary_symbols = (int *) op_prg_mem_alloc (MAX_NUMBER_OF_BACKOFF_PERIODS * sizeof(int));
-	sf_param.time_slot_boundary_symbols = (int *) op_prg_mem_alloc ((aNumSuperframeSlots+1)* sizeof(int));
 	
 	/* Initialize the superframe specification fields */
 	sf_spec.beacon_order = 0;
@@ -1177,32 +1254,51 @@ static void lr_wpan_mac_init ()
 		//list_retx_ptr_global = op_prg_list_create ();
 		//list_tx_ptr_global = op_prg_list_create ();
 		if (GADGET_enabled)
-			list_stack_change_ptr = op_prg_list_create ();
+			{
+			sprintf (report_name, "%s_stack_changes.txt", lr_wpan_scenario);
+			sprintf (report_header, "\n\t*** Global information about protocol stack changes for the scenario %s ***\n\tTime\t Slotted ALOHA\t PSMA\t Observed Traffic\t Observed SNR\n\n", lr_wpan_scenario);
+			stack_change_stream = lr_wpan_record_stream_create (report_name, report_header, sizeof (stack_change), write_stack_change_record);
+			}
 
 		}
-		list_traffic_snr_ptr = op_prg_list_create ();
+	
+	if (traffic_snr_stream == OPC_NIL)
+		{
+		sprintf (report_name, "%s_superframe_Traffic_and_SNR.txt", lr_wpan_scenario);
+		sprintf (report_header, "\n\t*** Global information about Traffic and SNR for the scenario %s ***\n\tTime\t Slotted ALOHA\t PSMA\t Observed Traffic\t Observed SNR\n\n", lr_wpan_scenario);
+		traffic_snr_stream = lr_wpan_record_stream_create (report_name, report_header, sizeof (stack_change), write_stack_change_record);
+		}
+	
+	/* binary trace of the MAC events, shared by the nodes */
+	if (trace_buffer_size > 0)
+		{
+		sprintf (report_name, "%s_trace.bin", lr_wpan_scenario);
+		lr_wpan_trace_buffer_create (report_name, trace_buffer_size);
+		}
+	
+	lr_wpan_trace_mask_update ();
 	
 	if(!strcmp(lr_wpan_node_name, "coordinator"))
 		{
-		superframe_statistics.Data_Pkt_Sent = 0;
-		superframe_statistics.Pkt_Dropped_CCA = 0;
-		Superframe_CCA_Statistics.First_CCA_Failure_Count = 0;
+		stat_shard->superframe.Data_Pkt_Sent = 0;
+		stat_shard->superframe.Pkt_Dropped_CCA = 0;
+		stat_shard->superframe_cca.First_CCA_Failure_Count = 0;
 		superframe_time_counter = op_sim_time ();
 		
-		Wpan_Superframe_Statistics.Data_Pkt_Rcv = statistic.Data_Pkt_Rcv;
-		Wpan_Superframe_Statistics.Total_MAC_Delay = statistic.Total_MAC_Delay;
-		superframe_statistics.Total_Delay_Dropped_packets = 0.0;
-		superframe_statistics.Application_generated = 0;
-		superframe_statistics.Segment_generated = 0;
-		superframe_statistics.Pkt_not_enqueued = 0;
-		superframe_statistics.Data_Pkt_Rcv = 0;
-		superframe_statistics.Pkt_Dropped = 0;
-		superframe_statistics.Pkt_Dropped_retx = 0;
-		superframe_statistics.Retransmission = 0;
-		superframe_statistics.Total_number_backoff_slots = 0;
-		superframe_statistics.Total_backoff_wait_for_beacon = 0;
-		Superframe_CCA_Statistics.First_CCA_count = 0;
-		global_statistics.Total_Ack_not_rcv = 0;
+		stat_shard->superframe_node.Data_Pkt_Rcv = statistic.Data_Pkt_Rcv;
+		stat_shard->superframe_node.Total_MAC_Delay = statistic.Total_MAC_Delay;
+		stat_shard->superframe.Total_Delay_Dropped_packets = 0.0;
+		stat_shard->superframe.Application_generated = 0;
+		stat_shard->superframe.Segment_generated = 0;
+		stat_shard->superframe.Pkt_not_enqueued = 0;
+		stat_shard->superframe.Data_Pkt_Rcv = 0;
+		stat_shard->superframe.Pkt_Dropped = 0;
+		stat_shard->superframe.Pkt_Dropped_retx = 0;
+		stat_shard->superframe.Retransmission = 0;
+		stat_shard->superframe.Total_number_backoff_slots = 0;
+		stat_shard->superframe.Total_backoff_wait_for_beacon = 0;
+		stat_shard->superframe_cca.First_CCA_count = 0;
+		stat_shard->global.Total_Ack_not_rcv = 0;
 		}
 	
 
@@ -1274,7 +1370,7 @@ static void lr_wpan_mac_address_resolve (void)
 	oms_aa_address_resolve (oms_aa_handle, my_parameters->objid, &mac_address);
 	
 	/* update the parameter of the MAC layer */
-	my_parameters->mac_address = mac_address;
+	wpan_node_mac_address_set (my_parameters, mac_address);
 	
 	/*
 	 * Register station's MAC address into model-wide
@@ -1353,7 +1449,7 @@ static void lr_wpan_cca_init (void)
 	if(CCA_stage == 1)
 		{
 		CCA_statistic.First_CCA_count++;
-		Global_CCA_Statistics.First_CCA_count++;
+		stat_shard->cca.First_CCA_count++;
 		/*CCA_statistic.Second_CCA_count++;
 		Global_CCA_Statistics.Second_CCA_count++;*/
 		}
@@ -1438,7 +1534,7 @@ static void lr_wpan_cca2_success (void)
 	FIN ( lr_wpan_cca2_success  ());
 	
 	CCA_statistic.Total_CCA_Success_Count ++;
-	Global_CCA_Statistics.Total_CCA_Success_Count ++;	
+	stat_shard->cca.Total_CCA_Success_Count ++;	
 	
 	FOUT;
 }
@@ -1464,7 +1560,7 @@ static void lr_wpan_cca_failure (void)
 	if(CCA_stage ==1)
 		{
 		CCA_statistic.First_CCA_Failure_Count++;
-		Global_CCA_Statistics.First_CCA_Failure_Count++;
+		stat_shard->cca.First_CCA_Failure_Count++;
 		/*CCA_statistic.Second_CCA_Failure_Count++;
 		Global_CCA_Statistics.Second_CCA_Failure_Count++;*/
 		}	
@@ -1497,7 +1593,7 @@ static void lr_wpan_ack_not_received(void)
 			}
 	
 		
-		global_statistics.Total_Ack_not_rcv ++;
+		stat_shard->global.Total_Ack_not_rcv ++;
 			
 	FOUT;
 }
@@ -1522,6 +1618,40 @@ static void lr_wpan_reset_backoff_parameters(void)
 	FOUT;
 }
 			
+/*
+ * Function:	lr_wpan_next_backoff_boundary
+ *
+ * description:	time of the next backoff period boundary of the
+ *				current superframe (slot clock), the current time
+ *				if it is on a boundary
+ *
+ * No parameters
+ */
+
+static double lr_wpan_next_backoff_boundary ()
+{
+	FIN (lr_wpan_next_backoff_boundary ());
+	
+	FRET (lr_wpan_slot_clock_next_boundary (sf_param.superframe_start_time, aUnitBackoffPeriod, op_sim_time ()));
+}
+
+/*
+ * Function:	lr_wpan_remaining_CAP_backoff_periods
+ *
+ * description:	number of whole backoff periods between the next
+ *				backoff period boundary and the end of the CAP
+ *				of the current superframe (slot clock)
+ *
+ * No parameters
+ */
+
+static int lr_wpan_remaining_CAP_backoff_periods ()
+{
+	FIN (lr_wpan_remaining_CAP_backoff_periods ());
+	
+	FRET (lr_wpan_slot_clock_remaining (sf_param.superframe_start_time, aUnitBackoffPeriod, sf_param.CAP_period_length_symbols, op_sim_time ()));
+}
+
 /*
  * Function:	lr_wpan_mac_backoff
  *
@@ -1534,6 +1664,7 @@ static void lr_wpan_mac_backoff ()
 {
 	int		cw;
 	int		backoff_periods = 0;
+	int		remaining_CAP_backoff_periods;
 	double 	backoff_time = 0.0;
 	double 	time_to_backoff_period_boundary=0.0;
 	double bckoff_temp = 0.0;
@@ -1587,13 +1718,14 @@ static void lr_wpan_mac_backoff ()
 			op_stat_write(backoff_interval_handle, backoff_periods);
 			
 			
-			if(backoff_periods > sf_param.remaining_CAP_backoff_periods)
+			remaining_CAP_backoff_periods = lr_wpan_remaining_CAP_backoff_periods ();
+			if(backoff_periods > remaining_CAP_backoff_periods)
 				{ /* No CCA evaluation in this superframe */
-				csma_operation_param.pending_backoff_periods = backoff_periods - sf_param.remaining_CAP_backoff_periods;
-				backoff_periods = sf_param.remaining_CAP_backoff_periods;
+				csma_operation_param.pending_backoff_periods = backoff_periods - remaining_CAP_backoff_periods;
+				backoff_periods = remaining_CAP_backoff_periods;
 				csma_operation_param.evaluate_after_backoff = OPC_FALSE;
 				
-				global_statistics.Total_backoff_wait_for_beacon++;
+				stat_shard->global.Total_backoff_wait_for_beacon++;
 				}
 			
 			else 
@@ -1608,10 +1740,10 @@ static void lr_wpan_mac_backoff ()
 			/* compute average backoff per packet */
 			statistic.total_backoff_time += backoff_time;
 			
-			global_statistics.Total_number_backoff_slots += backoff_periods;
+			stat_shard->global.Total_number_backoff_slots += backoff_periods;
  
 			
-			time_to_backoff_period_boundary = lr_wpan_slotted_boundary_time();
+			time_to_backoff_period_boundary = lr_wpan_next_backoff_boundary ();
 			
 			/* We are in a slotted mode, we start the backoff at the boundary */
 			op_intrpt_schedule_self (time_to_backoff_period_boundary + backoff_time , Backoff_Time_Out);
@@ -1658,16 +1790,17 @@ static void lr_wpan_mac_backoff ()
 			
 		op_stat_write(backoff_interval_handle, backoff_periods);
 		
-		if(backoff_periods > sf_param.remaining_CAP_backoff_periods)
+		remaining_CAP_backoff_periods = lr_wpan_remaining_CAP_backoff_periods ();
+		if(backoff_periods > remaining_CAP_backoff_periods)
 			{ /* No TX in this superframe */
-			csma_operation_param.pending_backoff_periods = backoff_periods - sf_param.remaining_CAP_backoff_periods;
-			backoff_periods = sf_param.remaining_CAP_backoff_periods;
+			csma_operation_param.pending_backoff_periods = backoff_periods - remaining_CAP_backoff_periods;
+			backoff_periods = remaining_CAP_backoff_periods;
 			csma_operation_param.evaluate_after_backoff = OPC_FALSE;
 			
-			global_statistics.Total_backoff_wait_for_beacon++;
+			stat_shard->global.Total_backoff_wait_for_beacon++;
 			
 			if(DEBUG_Backoff)
-					fprintf (fp_debug, "MAC MODULE: Node %s mac_backoff function  -- backoff_periods > sf_param.remaining_CAP_backoff_periods \n", lr_wpan_node_name);
+					fprintf (fp_debug, "MAC MODULE: Node %s mac_backoff function  -- backoff_periods > remaining_CAP_backoff_periods \n", lr_wpan_node_name);
 	
 			}
 		
@@ -1683,9 +1816,9 @@ static void lr_wpan_mac_backoff ()
 		/* compute average backoff per packet */
 		statistic.total_backoff_time += backoff_time;
 		
-		global_statistics.Total_number_backoff_slots += backoff_periods;
+		stat_shard->global.Total_number_backoff_slots += backoff_periods;
 		
-		time_to_backoff_period_boundary = lr_wpan_slotted_boundary_time();
+		time_to_backoff_period_boundary = lr_wpan_next_backoff_boundary ();
 		
 		/* We are in a slotted mode, we start the backoff at the boundary */
 		op_intrpt_schedule_self ((time_to_backoff_period_boundary + backoff_time) , Backoff_Time_Out);
@@ -1776,7 +1909,7 @@ static Boolean lr_wpan_csma_can_proceed()
 	
 	IFS_time = IFS*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE;
 	remaining_time = sf_param.end_of_the_CAP_period - op_sim_time();
-	time_to_backoff_period_boundary = lr_wpan_slotted_boundary_time_modified(); 
+	time_to_backoff_period_boundary = lr_wpan_next_backoff_boundary () - op_sim_time (); 
 	
 	packet_tx_time = packet_size/LR_WPAN_BIT_RATE;
 		
@@ -1799,7 +1932,7 @@ static Boolean lr_wpan_csma_can_proceed()
 	
 	if(psma_enabled) 
 		{
-			if (sf_param.remaining_CAP_backoff_periods<MIN_BACKOFF_PERIOD_TO_PROCEED_PSMA)
+			if (lr_wpan_remaining_CAP_backoff_periods ()<MIN_BACKOFF_PERIOD_TO_PROCEED_PSMA)
 				{
 				FRET (OPC_FALSE);
 				}
@@ -1811,7 +1944,7 @@ static Boolean lr_wpan_csma_can_proceed()
 	
 	if(s_aloha_enabled)
 		{
-			if (sf_param.remaining_CAP_backoff_periods<1)
+			if (lr_wpan_remaining_CAP_backoff_periods ()<1)
 				{
 				FRET (OPC_FALSE);
 				}
@@ -1826,101 +1959,6 @@ static Boolean lr_wpan_csma_can_proceed()
 }
 
 
-/*
- * Function:	lr_wpan_slotted_boundary_time
- *
- * Description:	compute the time to reach the boundary of
- *				one slot. (absolute time)
- */
-
-double lr_wpan_slotted_boundary_time (void)
-{
-	double time = op_sim_time ();
-	double remainder = time;
-	
-	const double unit = LR_WPAN_BACKOFF_UNIT; //WPAN_CCA_PERIOD + WPAN_TURN_AROUND_TIME;
-	
-	
-	FIN (lr_wpan_slotted_boundary_time ());
-	
-	/* compute the remainder */
-	while (remainder >= unit) remainder -= unit;
-	
-	/* if the remainder is not zero, we compute the next odd time */
-	if (remainder > 0.0000001)
-		time += (unit - remainder);
-	
-	FRET (time);
-}
-
-
-/*
- * Function:	lr_wpan_slotted_boundary_time_modified 
- *
- * Description:	compute the time to reach the boundary of
- *				one slot. (relative time)
- */
-
-static double lr_wpan_slotted_boundary_time_modified (void)
-{
-	double time;// = op_sim_time () - sf_param.superframe_start_time;
-	double remainder;// = time;
-	
-	const double unit = LR_WPAN_BACKOFF_UNIT; //WPAN_CCA_PERIOD + WPAN_TURN_AROUND_TIME;
-	
-	
-	FIN (lr_wpan_slotted_boundary_time_modified ());
-	
-	time = op_sim_time () - sf_param.superframe_start_time;
-	remainder = time;
-	
-	/* compute the remainder */
-	while (remainder >= unit) 
-		remainder -= unit;
-	
-	/* if the remainder is not zero, we compute the next odd time */
-	if (remainder > 0.0000001)
-	{
-		time = (unit - remainder);
-	}
-	else
-	{
-		time = 0.0; 
-	}
-	
-	FRET (time);
-}
-
-	  
-/* 
- * Function:	lr_wpan_locate_backoff_period_boundary
- *
- * Description:	Locate the next backoff boundary 
- *
-*/
-
-static double lr_wpan_locate_backoff_period_boundary()
-	{
-	int		next_backoff_period_boundary_symbols;
-	double	next_backoff_period_boundary_seconds;
-	double	time_to_next_backoff_period_boundary;
-	double	time_to_next_backoff_period_boundary1;
-	double	time_to_next_backoff_period_boundary2;
-		
-	FIN(lr_wpan_locate_backoff_period_boundary());
-
-	next_backoff_period_boundary_symbols = sf_param.backoff_period_boundary_symbols[sf_param.backoff_period_index];
-	next_backoff_period_boundary_seconds = next_backoff_period_boundary_symbols*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE; 
-	
-	time_to_next_backoff_period_boundary1 = (next_backoff_period_boundary_seconds + sf_param.superframe_start_time) - op_sim_time();
-    time_to_next_backoff_period_boundary2 = lr_wpan_slotted_boundary_time_modified();
-	time_to_next_backoff_period_boundary = time_to_next_backoff_period_boundary2;
-	
-	FRET(time_to_next_backoff_period_boundary);
-	 	
-	}
-
-
 /*
  * Get the size of the packet to be transmitted
  *
@@ -1974,6 +2012,35 @@ static int lr_wpan_get_tx_packet_size ()
 
 
 
+/*
+ * Function:	lr_wpan_trace_mask_update
+ *
+ * Description:	compute the mask of the traces active for the
+ *				current event. The ODB traces are only looked
+ *				up in debug mode.
+ */
+
+static void lr_wpan_trace_mask_update (void)
+{
+	FIN (lr_wpan_trace_mask_update ());
+	
+	trace_mask = 0;
+	
+	if (op_sim_debug () == OPC_TRUE)
+		{
+		if (STATE_PRINT_STATUS)
+			trace_mask |= WPAN_TRACE_STATE;
+		if (FLAG_PRINT_STATUS)
+			trace_mask |= WPAN_TRACE_FLAG;
+		}
+	
+	if (lr_wpan_trace_buffer_active () == OPC_TRUE)
+		trace_mask |= WPAN_TRACE_RECORD;
+	
+	FOUT;
+}
+
+
 /*
 Function: lr_wpan_intrpt_check
 */
@@ -1981,12 +2048,13 @@ Function: lr_wpan_intrpt_check
 static void lr_wpan_intrpt_check (const char * state_name)
 {
 	char odb_msg[128]; // debugging message
+	const char * intrpt_msg = ""; // description of the interruption
 	
 	
 	FIN (lr_wpan_intrpt_check ());
-		
-	/* compute the debugging message */
-	sprintf (odb_msg, "exit the \"%s\" state: ", state_name);
+	
+	/* the traces are checked once per event */
+	lr_wpan_trace_mask_update ();
 	FLAG_ODB_PRINTING;
 	
 	/* get the type of the interuption */
@@ -2000,7 +2068,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			
 			
 			case Backoff_Time_Out:
-			strcat (odb_msg, "backoff expired");
+			intrpt_msg = "backoff expired";
 			
 			if(my_parameters->slotted_enable == OPC_TRUE)
 				lr_wpan_cca_evaluation();
@@ -2008,14 +2076,14 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 				
 			case Data_Pkt_To_Send:
-			strcat (odb_msg, "transmission required");
+			intrpt_msg = "transmission required";
 			
 			/* set the flag */
 			wpan_transmission_required = OPC_TRUE;
 			break;
 			
 			case Ack_Time_Out:
-			strcat (odb_msg, "Ack period expired");
+			intrpt_msg = "Ack period expired";
 			
 			if(DEBUG_Rx_Ack) 
 				fprintf(fp_debug, "MAC MODULE: Node %s Ack not received at time %12f sec (Ack_Time_Out), with tx_idle flag = %d and rx_idle flag = %d\n", lr_wpan_node_name, op_sim_time(), channel_flag.tx_idle, channel_flag.rx_idle);
@@ -2031,7 +2099,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 			
 			case Ack_Received:
-			strcat (odb_msg, "Received an Ack");
+			intrpt_msg = "Received an Ack";
 
 			
 			/* turn on the LIFS period */
@@ -2049,13 +2117,13 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 			
 			case Wpan_Ack_Tx_Required:
-			strcat (odb_msg, "Transmit an Ack");
+			intrpt_msg = "Transmit an Ack";
 			
 			
 			break;
 			
 			case End_Of_Transmission:
-			strcat (odb_msg, "End of the transmission");
+			intrpt_msg = "End of the transmission";
 			
 			/* set the TX to idle */
 			channel_flag.tx_idle = OPC_TRUE;
@@ -2065,14 +2133,14 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 			
 			case CCA_Pkt_Detect:
-			strcat (odb_msg, "Packet detecting during the CCA");
+			intrpt_msg = "Packet detecting during the CCA";
 			
 			/* set the channel to busy */
 			channel_is_idle = OPC_FALSE;
 			break;
 			
 			case Wpan_CCA_Time_Out:
-			strcat (odb_msg, "CCA is over");
+			intrpt_msg = "CCA is over";
 			
 			/* schedule the release of TX (Turn Around Time) */
 			lr_wpan_schedule_TAT (TX_CODE);
@@ -2089,7 +2157,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break; 
 			
 			case Wpan_Rcv_Pkt:
-			strcat (odb_msg, "We're receiving a packet");
+			intrpt_msg = "We're receiving a packet";
 			
 			/* turn off the TX */
 			channel_flag.tx_idle = OPC_FALSE;
@@ -2099,7 +2167,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 			
 			case Wpan_Rx_TAT:
-			strcat (odb_msg, "End of the Turn Around Time, Rx is idle");
+			intrpt_msg = "End of the Turn Around Time, Rx is idle";
 			
 			/* set the RX to idle */
 			channel_flag.rx_idle    = OPC_TRUE;
@@ -2108,7 +2176,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 			
 			case Wpan_Tx_TAT:
-			strcat (odb_msg, "End of the Turn Around Time, Tx is idle");
+			intrpt_msg = "End of the Turn Around Time, Tx is idle";
 			
 			/* set the TX to idle */
 			channel_flag.tx_idle = OPC_TRUE;
@@ -2120,7 +2188,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 				lr_wpan_ack_to_transmit ();
 				
 				/* complete the ODB message */
-				strcat (odb_msg, "; send an acknoledge");
+				intrpt_msg = "End of the Turn Around Time, Tx is idle; send an acknoledge";
 				
 				/* turn off the flag */
 				Tx_Ack_Require = OPC_FALSE;
@@ -2128,7 +2196,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 			
 			case Wpan_LIFS_Over:
-			strcat (odb_msg, "End of the LIFS period, Tx is idle");
+			intrpt_msg = "End of the LIFS period, Tx is idle";
 			
 			/* turn off the LIFS Period */
 			channel_flag.LIFS_on = OPC_FALSE;
@@ -2150,13 +2218,12 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			case Wpan_Backoff_Period_Elapsed:
 			if(sf_param.backoff_period_index != (sf_param.backoff_periods_per_CAP-1)) //!!!!!!!!!!!!!!!!!!!!!!!!!
 				{
-				sf_param.remaining_CAP_backoff_periods--;
 				sf_param.backoff_period_index++;
 				
 				/*if(DEBUG_Backoff)
 					{ 
 						printf("MAC MODULE: node %s. At time %f\n", lr_wpan_node_name, op_sim_time()); 
-						printf("\t remaining_CAP_backoff_periods = %d -- backoff_period_index %d\n", sf_param.remaining_CAP_backoff_periods, sf_param.backoff_period_index);
+						printf("\t remaining_CAP_backoff_periods = %d -- backoff_period_index %d\n", lr_wpan_remaining_CAP_backoff_periods (), sf_param.backoff_period_index);
 					}
 				*/
 				if(  ((sf_param.backoff_period_index - 1) % sf_param.backoff_periods_per_slot) == 0)
@@ -2177,7 +2244,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 	
 					
 			default:
-			strcat (odb_msg, "unknown code");
+			intrpt_msg = "unknown code";
 			break;
 			}
 		break;
@@ -2192,13 +2259,13 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			/* we received a packet from the higher layer */
 			higher_layer_pkt_recv ();
 			
-			global_statistics.Application_generated++;
+			stat_shard->global.Application_generated++;
 				
-			strcat (odb_msg, "packet from the higher layer");
+			intrpt_msg = "packet from the higher layer";
 			break;
 				
 			case LOWER_LAYER_UP_STRM:
-			strcat (odb_msg, "packet from the physical layer: reception completed");
+			intrpt_msg = "packet from the physical layer: reception completed";
 			
 			/* we received a packet from the channel */
 			lower_layer_pkt_rcv ();
@@ -2208,7 +2275,7 @@ static void lr_wpan_intrpt_check (const char * state_name)
 			break;
 				
 			default:
-			strcat (odb_msg, "unknown stream");
+			intrpt_msg = "unknown stream";
 			break;
 			}
 		break;
@@ -2227,15 +2294,23 @@ static void lr_wpan_intrpt_check (const char * state_name)
 		break;
 		
 		default:
-		strcat (odb_msg, "unknown intrpt");
+		intrpt_msg = "unknown intrpt";
 		break;
 		}
 	
 	
-	/* print the debugging message */
-	ENTER_STATE_ODB_PRINTING (odb_msg);
+	/* the debugging message is only built if it is printed */
+	if (WPAN_TRACE_ACTIVE (trace_mask, WPAN_TRACE_STATE))
+		{
+		sprintf (odb_msg, "exit the \"%s\" state: %s", state_name, intrpt_msg);
+		ENTER_STATE_ODB_PRINTING (odb_msg);
+		}
 	FLAG_ODB_PRINTING;
 	
+	if (WPAN_TRACE_ACTIVE (trace_mask, WPAN_TRACE_RECORD))
+		lr_wpan_trace_record (op_sim_time (), my_parameters->mac_address, state_name, intrpt_type,
+			(intrpt_type == OPC_INTRPT_STRM) ? intrpt_stream : ((intrpt_type == OPC_INTRPT_SELF || intrpt_type == OPC_INTRPT_REMOTE) ? intrpt_code : -1));
+	
 	/* define a break point */
 	op_prg_odb_bkpt ("wpan_state");
 	FOUT;
@@ -2257,7 +2332,8 @@ lr_wpan_generate_beacon (void)
 {
 	Packet * beacon_ptr;
 	int i, j; // loop variables
-	int beacon_size, rx_index, protocol_used;
+	int beacon_size, rx_index;
+	int protocol_used = GADGET_USE_PSMA; // backup protocol, as when the thresholds vector is not full
 	double txrx_distance, average_snr, average_traffic;
 	Boolean condition;
 	Wpan_Node_Param * rxptr;
@@ -2276,6 +2352,8 @@ lr_wpan_generate_beacon (void)
 	char report_name[128];
 	Boolean exist;
 	double mac_delay,mac_delay_considering_dropped, G_channel, G_offered;
+	Global_Stat_Vector global_sum;
+	Wpan_CCA_Vector cca_sum;
 		
 	time_t date;
 	char date_str[32];
@@ -2326,7 +2404,10 @@ lr_wpan_generate_beacon (void)
 			else
 				GADGET_SMA_SNR_VECT[0] = 0;
 			
-			GADGET_SMA_TRAFFIC_VECT[0]=aBaseSlotDuration*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE*((double) (global_statistics.Data_Pkt_Sent-GADGET_SUPERFRAME_TRAFFIC)/(op_sim_time ()-single_superframe_time_counter));
+			/* totals of all the MACs */
+			lr_wpan_sum_stat_shards (&global_sum, &cca_sum);
+			
+			GADGET_SMA_TRAFFIC_VECT[0]=aBaseSlotDuration*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE*((double) (global_sum.Data_Pkt_Sent-GADGET_SUPERFRAME_TRAFFIC)/(op_sim_time ()-single_superframe_time_counter));
 			
 			average_snr+= (GADGET_SMA_SNR_VECT[0]);
 			average_traffic+= (GADGET_SMA_TRAFFIC_VECT[0]);
@@ -2340,21 +2421,19 @@ lr_wpan_generate_beacon (void)
 		
 			/*collect statistics on channel condition*/
 		
-			traffic_snr_ptr = (stack_change*) op_prg_mem_alloc( sizeof(stack_change) );
+			traffic_snr_ptr = (stack_change*) lr_wpan_record_stream_append (traffic_snr_stream);
 		
 			traffic_snr_ptr->time = op_sim_time();
 			traffic_snr_ptr->s_aloha_status = (int)s_aloha_enabled;
 			traffic_snr_ptr->psma_status = (int)psma_enabled;
 			traffic_snr_ptr->observed_traffic = average_traffic;
 			traffic_snr_ptr->observed_snr = average_snr;
-		
-			op_prg_list_insert(list_traffic_snr_ptr, traffic_snr_ptr, OPC_LISTPOS_TAIL);
 			
 			
 			GADGET_sma_counter = 1;
 			GADGET_snr = 0.0;
 			GADGET_pkt_per_superframe = 0;
-			GADGET_SUPERFRAME_TRAFFIC = global_statistics.Data_Pkt_Sent;		
+			GADGET_SUPERFRAME_TRAFFIC = global_sum.Data_Pkt_Sent;		
 			single_superframe_time_counter = op_sim_time ();
 			
 			}
@@ -2420,7 +2499,6 @@ lr_wpan_generate_beacon (void)
 			if ((s_aloha_enabled && protocol_used != GADGET_USE_S_ALOHA) || (psma_enabled && protocol_used != GADGET_USE_PSMA))
 				{
 				//printf("Latest SMA_vect = %f, moving average = %f\n",GADGET_SMA_TRAFFIC_VECT[0], average_traffic);
-				stack_ptr = (stack_change*) op_prg_mem_alloc( sizeof(stack_change) );	
 				
 				/* reset backoff parameters */
 				lr_wpan_reset_backoff_parameters();
@@ -2464,13 +2542,12 @@ lr_wpan_generate_beacon (void)
 					lr_wpan_mac_error ("lr_wpan_generate_beacon:", "Unable to assign appropriate protocol.", OPC_NIL);
 					}
 				
+				stack_ptr = (stack_change*) lr_wpan_record_stream_append (stack_change_stream);
 				stack_ptr->time = op_sim_time();
 				stack_ptr->s_aloha_status = (int)s_aloha_enabled;
 				stack_ptr->psma_status = (int)psma_enabled;
 				stack_ptr->observed_traffic = average_traffic; //latest SMA entry
 				stack_ptr->observed_snr =average_snr;
-	
-				op_prg_list_insert(list_stack_change_ptr, stack_ptr, OPC_LISTPOS_TAIL);
 				
 				
 				/*WARNING! SEVERE CROSS-INTERACTION WITH NODE CHANNEL IN THE top.OFFICE_NETWORK PROJECT*/
@@ -2541,6 +2618,9 @@ lr_wpan_generate_beacon (void)
 	
 	if (superframe_reporting_counter == 10)
 		{
+		/* totals of all the MACs */
+		lr_wpan_sum_stat_shards (&global_sum, &cca_sum);
+		
 		/* get the date of the day */
 		time (&date);
 		sprintf (date_str, "%s", ctime (&date));
@@ -2582,37 +2662,37 @@ lr_wpan_generate_beacon (void)
 		/*Compute offered traffic*/
 		
 		
-		G_channel = aBaseSlotDuration*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE*((double) (global_statistics.Data_Pkt_Sent-superframe_statistics.Data_Pkt_Sent)/(op_sim_time ()-superframe_time_counter));
-		G_offered = aBaseSlotDuration*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE*((double) (global_statistics.Data_Pkt_Sent-superframe_statistics.Data_Pkt_Sent)+(double)(global_statistics.Pkt_Dropped_CCA-superframe_statistics.Pkt_Dropped_CCA)+(double)(Global_CCA_Statistics.First_CCA_Failure_Count-Superframe_CCA_Statistics.First_CCA_Failure_Count))/(op_sim_time ()-superframe_time_counter);
+		G_channel = aBaseSlotDuration*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE*((double) (global_sum.Data_Pkt_Sent-stat_shard->superframe.Data_Pkt_Sent)/(op_sim_time ()-superframe_time_counter));
+		G_offered = aBaseSlotDuration*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE*((double) (global_sum.Data_Pkt_Sent-stat_shard->superframe.Data_Pkt_Sent)+(double)(global_sum.Pkt_Dropped_CCA-stat_shard->superframe.Pkt_Dropped_CCA)+(double)(cca_sum.First_CCA_Failure_Count-stat_shard->superframe_cca.First_CCA_Failure_Count))/(op_sim_time ()-superframe_time_counter);
 																		
 		
 		/* compute the MAC average delay */
-		mac_delay = (statistic.Data_Pkt_Rcv-Wpan_Superframe_Statistics.Data_Pkt_Rcv) ? (statistic.Total_MAC_Delay-Wpan_Superframe_Statistics.Total_MAC_Delay) / (double) (statistic.Data_Pkt_Rcv-Wpan_Superframe_Statistics.Data_Pkt_Rcv) : -1.0;
-		mac_delay_considering_dropped = (statistic.Data_Pkt_Rcv-Wpan_Superframe_Statistics.Data_Pkt_Rcv) ? ((statistic.Total_MAC_Delay-Wpan_Superframe_Statistics.Total_MAC_Delay)+(global_statistics.Total_Delay_Dropped_packets-superframe_statistics.Total_Delay_Dropped_packets)) / (double) (statistic.Data_Pkt_Rcv-Wpan_Superframe_Statistics.Data_Pkt_Rcv) : -1.0;
+		mac_delay = (statistic.Data_Pkt_Rcv-stat_shard->superframe_node.Data_Pkt_Rcv) ? (statistic.Total_MAC_Delay-stat_shard->superframe_node.Total_MAC_Delay) / (double) (statistic.Data_Pkt_Rcv-stat_shard->superframe_node.Data_Pkt_Rcv) : -1.0;
+		mac_delay_considering_dropped = (statistic.Data_Pkt_Rcv-stat_shard->superframe_node.Data_Pkt_Rcv) ? ((statistic.Total_MAC_Delay-stat_shard->superframe_node.Total_MAC_Delay)+(global_sum.Total_Delay_Dropped_packets-stat_shard->superframe.Total_Delay_Dropped_packets)) / (double) (statistic.Data_Pkt_Rcv-stat_shard->superframe_node.Data_Pkt_Rcv) : -1.0;
 																			
 		fprintf (fp, "%s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s",
 			double_to_string (G_channel, strlen ("Channel traffic")),
 			double_to_string (G_offered, strlen ("Offered traffic")),
-			integer_to_string ((int)(global_statistics.Application_generated-superframe_statistics.Application_generated), 15),
-			integer_to_string ((int)(global_statistics.Segment_generated-superframe_statistics.Segment_generated), strlen ("Packets enqueued at the MAC")),
-			integer_to_string ((int)(global_statistics.Pkt_not_enqueued-superframe_statistics.Pkt_not_enqueued), strlen ("Packets not enqueued at the MAC")),
-			integer_to_string ((int)(global_statistics.Data_Pkt_Sent-superframe_statistics.Data_Pkt_Sent), 8),
-			integer_to_string ((int)(global_statistics.Data_Pkt_Rcv-superframe_statistics.Data_Pkt_Rcv), 8),
-			integer_to_string ((int)(Global_CCA_Statistics.First_CCA_Failure_Count-Superframe_CCA_Statistics.First_CCA_Failure_Count), 11),
-			integer_to_string ((int)(global_statistics.Pkt_Dropped-superframe_statistics.Pkt_Dropped), 11),
-			integer_to_string ((int)(global_statistics.Pkt_Dropped_CCA-superframe_statistics.Pkt_Dropped_CCA), 16),
-			integer_to_string ((int)(global_statistics.Pkt_Dropped_retx-superframe_statistics.Pkt_Dropped_retx), 16),
-			integer_to_string ((int)(global_statistics.Retransmission-superframe_statistics.Retransmission), 10),
+			integer_to_string ((int)(global_sum.Application_generated-stat_shard->superframe.Application_generated), 15),
+			integer_to_string ((int)(global_sum.Segment_generated-stat_shard->superframe.Segment_generated), strlen ("Packets enqueued at the MAC")),
+			integer_to_string ((int)(global_sum.Pkt_not_enqueued-stat_shard->superframe.Pkt_not_enqueued), strlen ("Packets not enqueued at the MAC")),
+			integer_to_string ((int)(global_sum.Data_Pkt_Sent-stat_shard->superframe.Data_Pkt_Sent), 8),
+			integer_to_string ((int)(global_sum.Data_Pkt_Rcv-stat_shard->superframe.Data_Pkt_Rcv), 8),
+			integer_to_string ((int)(cca_sum.First_CCA_Failure_Count-stat_shard->superframe_cca.First_CCA_Failure_Count), 11),
+			integer_to_string ((int)(global_sum.Pkt_Dropped-stat_shard->superframe.Pkt_Dropped), 11),
+			integer_to_string ((int)(global_sum.Pkt_Dropped_CCA-stat_shard->superframe.Pkt_Dropped_CCA), 16),
+			integer_to_string ((int)(global_sum.Pkt_Dropped_retx-stat_shard->superframe.Pkt_Dropped_retx), 16),
+			integer_to_string ((int)(global_sum.Retransmission-stat_shard->superframe.Retransmission), 10),
 			double_to_string (mac_delay, 9),
 			double_to_string (mac_delay_considering_dropped, 10),
-			integer_to_string ((int)(global_statistics.Total_number_backoff_slots-superframe_statistics.Total_number_backoff_slots), 15),
-			integer_to_string ((int)(global_statistics.Total_backoff_wait_for_beacon-superframe_statistics.Total_backoff_wait_for_beacon), strlen ("Beacon rcv backoff")),
-			integer_to_string ((int)(Global_CCA_Statistics.First_CCA_count-Superframe_CCA_Statistics.First_CCA_count), 9),
-			integer_to_string ((int)(global_statistics.Total_Ack_not_rcv-superframe_statistics.Total_Ack_not_rcv), 10),
+			integer_to_string ((int)(global_sum.Total_number_backoff_slots-stat_shard->superframe.Total_number_backoff_slots), 15),
+			integer_to_string ((int)(global_sum.Total_backoff_wait_for_beacon-stat_shard->superframe.Total_backoff_wait_for_beacon), strlen ("Beacon rcv backoff")),
+			integer_to_string ((int)(cca_sum.First_CCA_count-stat_shard->superframe_cca.First_CCA_count), 9),
+			integer_to_string ((int)(global_sum.Total_Ack_not_rcv-stat_shard->superframe.Total_Ack_not_rcv), 10),
 			double_to_string ((op_sim_time ()-superframe_time_counter), strlen ("simulation time")),
 			date_str);
 	
-		fclose (fp);																		
+		lr_wpan_close_report_file (fp);																		
 		
 		
 		/* cretae a  .txt file without headers, for Matlab postprocessing */
@@ -2625,46 +2705,46 @@ lr_wpan_generate_beacon (void)
 		fprintf (fp, "%s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\t %s\n",
 			double_to_string (G_channel, strlen ("Channel traffic")),
 			double_to_string (G_offered, strlen ("Offered traffic")),
-			integer_to_string ((int)(global_statistics.Application_generated-superframe_statistics.Application_generated), 10),
-			integer_to_string ((int)(global_statistics.Segment_generated-superframe_statistics.Segment_generated), strlen ("Tot seg generated")),
-			integer_to_string ((int)(global_statistics.Pkt_not_enqueued-superframe_statistics.Pkt_not_enqueued), strlen ("Tot seg generated")),
-			integer_to_string ((int)(global_statistics.Data_Pkt_Sent-superframe_statistics.Data_Pkt_Sent), 8),
-			integer_to_string ((int)(global_statistics.Data_Pkt_Rcv-superframe_statistics.Data_Pkt_Rcv), 8),
-			integer_to_string ((int)(Global_CCA_Statistics.First_CCA_Failure_Count-Superframe_CCA_Statistics.First_CCA_Failure_Count), 11),
-			integer_to_string ((int)(global_statistics.Pkt_Dropped-superframe_statistics.Pkt_Dropped), 11),
-			integer_to_string ((int)(global_statistics.Pkt_Dropped_CCA-superframe_statistics.Pkt_Dropped_CCA), 16),
-			integer_to_string ((int)(global_statistics.Pkt_Dropped_retx-superframe_statistics.Pkt_Dropped_retx), 16),
-			integer_to_string ((int)(global_statistics.Retransmission-superframe_statistics.Retransmission), 10),
+			integer_to_string ((int)(global_sum.Application_generated-stat_shard->superframe.Application_generated), 10),
+			integer_to_string ((int)(global_sum.Segment_generated-stat_shard->superframe.Segment_generated), strlen ("Tot seg generated")),
+			integer_to_string ((int)(global_sum.Pkt_not_enqueued-stat_shard->superframe.Pkt_not_enqueued), strlen ("Tot seg generated")),
+			integer_to_string ((int)(global_sum.Data_Pkt_Sent-stat_shard->superframe.Data_Pkt_Sent), 8),
+			integer_to_string ((int)(global_sum.Data_Pkt_Rcv-stat_shard->superframe.Data_Pkt_Rcv), 8),
+			integer_to_string ((int)(cca_sum.First_CCA_Failure_Count-stat_shard->superframe_cca.First_CCA_Failure_Count), 11),
+			integer_to_string ((int)(global_sum.Pkt_Dropped-stat_shard->superframe.Pkt_Dropped), 11),
+			integer_to_string ((int)(global_sum.Pkt_Dropped_CCA-stat_shard->superframe.Pkt_Dropped_CCA), 16),
+			integer_to_string ((int)(global_sum.Pkt_Dropped_retx-stat_shard->superframe.Pkt_Dropped_retx), 16),
+			integer_to_string ((int)(global_sum.Retransmission-stat_shard->superframe.Retransmission), 10),
 			double_to_string (mac_delay, 9),
 			double_to_string (mac_delay_considering_dropped, 10),
-			integer_to_string ((int)(global_statistics.Total_number_backoff_slots-superframe_statistics.Total_number_backoff_slots), 15),
-			integer_to_string ((int)(global_statistics.Total_backoff_wait_for_beacon-superframe_statistics.Total_backoff_wait_for_beacon), strlen ("Beacon rcv backoff")),
-			integer_to_string ((int)(Global_CCA_Statistics.First_CCA_count-Superframe_CCA_Statistics.First_CCA_count), 9),
-			integer_to_string ((int)(global_statistics.Total_Ack_not_rcv-superframe_statistics.Total_Ack_not_rcv), 10),
+			integer_to_string ((int)(global_sum.Total_number_backoff_slots-stat_shard->superframe.Total_number_backoff_slots), 15),
+			integer_to_string ((int)(global_sum.Total_backoff_wait_for_beacon-stat_shard->superframe.Total_backoff_wait_for_beacon), strlen ("Beacon rcv backoff")),
+			integer_to_string ((int)(cca_sum.First_CCA_count-stat_shard->superframe_cca.First_CCA_count), 9),
+			integer_to_string ((int)(global_sum.Total_Ack_not_rcv-stat_shard->superframe.Total_Ack_not_rcv), 10),
 			double_to_string ((op_sim_time ()-superframe_time_counter), strlen ("simulation time")));
 	
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 	
 		
-		superframe_statistics.Data_Pkt_Sent = global_statistics.Data_Pkt_Sent;
-		superframe_statistics.Pkt_Dropped_CCA = global_statistics.Pkt_Dropped_CCA;
-		Superframe_CCA_Statistics.First_CCA_Failure_Count = Global_CCA_Statistics.First_CCA_Failure_Count;
+		stat_shard->superframe.Data_Pkt_Sent = global_sum.Data_Pkt_Sent;
+		stat_shard->superframe.Pkt_Dropped_CCA = global_sum.Pkt_Dropped_CCA;
+		stat_shard->superframe_cca.First_CCA_Failure_Count = cca_sum.First_CCA_Failure_Count;
 		superframe_time_counter = op_sim_time ();
 		
-		Wpan_Superframe_Statistics.Data_Pkt_Rcv = statistic.Data_Pkt_Rcv;
-		Wpan_Superframe_Statistics.Total_MAC_Delay = statistic.Total_MAC_Delay;
-		superframe_statistics.Total_Delay_Dropped_packets = global_statistics.Total_Delay_Dropped_packets;
-		superframe_statistics.Application_generated = global_statistics.Application_generated;
-		superframe_statistics.Segment_generated = global_statistics.Segment_generated;
-		superframe_statistics.Pkt_not_enqueued = global_statistics.Pkt_not_enqueued;
-		superframe_statistics.Data_Pkt_Rcv = global_statistics.Data_Pkt_Rcv;
-		superframe_statistics.Pkt_Dropped = global_statistics.Pkt_Dropped;
-		superframe_statistics.Pkt_Dropped_retx = global_statistics.Pkt_Dropped_retx;
-		superframe_statistics.Retransmission = global_statistics.Retransmission;
-		superframe_statistics.Total_number_backoff_slots = global_statistics.Total_number_backoff_slots;
-		superframe_statistics.Total_backoff_wait_for_beacon = global_statistics.Total_backoff_wait_for_beacon;
-		Superframe_CCA_Statistics.First_CCA_count = Global_CCA_Statistics.First_CCA_count;
-		superframe_statistics.Total_Ack_not_rcv = global_statistics.Total_Ack_not_rcv;
+		stat_shard->superframe_node.Data_Pkt_Rcv = statistic.Data_Pkt_Rcv;
+		stat_shard->superframe_node.Total_MAC_Delay = statistic.Total_MAC_Delay;
+		stat_shard->superframe.Total_Delay_Dropped_packets = global_sum.Total_Delay_Dropped_packets;
+		stat_shard->superframe.Application_generated = global_sum.Application_generated;
+		stat_shard->superframe.Segment_generated = global_sum.Segment_generated;
+		stat_shard->superframe.Pkt_not_enqueued = global_sum.Pkt_not_enqueued;
+		stat_shard->superframe.Data_Pkt_Rcv = global_sum.Data_Pkt_Rcv;
+		stat_shard->superframe.Pkt_Dropped = global_sum.Pkt_Dropped;
+		stat_shard->superframe.Pkt_Dropped_retx = global_sum.Pkt_Dropped_retx;
+		stat_shard->superframe.Retransmission = global_sum.Retransmission;
+		stat_shard->superframe.Total_number_backoff_slots = global_sum.Total_number_backoff_slots;
+		stat_shard->superframe.Total_backoff_wait_for_beacon = global_sum.Total_backoff_wait_for_beacon;
+		stat_shard->superframe_cca.First_CCA_count = cca_sum.First_CCA_count;
+		stat_shard->superframe.Total_Ack_not_rcv = global_sum.Total_Ack_not_rcv;
 		
 		
 																				
@@ -2750,29 +2830,13 @@ lr_wpan_generate_beacon (void)
 			lr_wpan_mac_error ("lr_wpan_generate_beacon:", "The MAC destination address doesn't exist.", OPC_NIL);
 	
 		/* get the parameter of the destination device */
-		rxptr = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, rx_index);
+		rxptr = wpan_node_get (rx_index);
 
 		/* compute the distance between the RX and TX */
 		txrx_distance = sqrt ((rxptr->x - my_parameters->x)*(rxptr->x - my_parameters->x) + (rxptr->y - my_parameters->y)*(rxptr->y - my_parameters->y));
 		
-		/* initialize the ICI structure */
-		ici_ptr = OPC_NIL;
-		
-		/* create ICI pointer */
-		ici_ptr = op_ici_create ("ici_channel");
-			
-		/* set the ICI pointer */
-		if (op_ici_attr_set_dbl (ici_ptr, "txrx distance", txrx_distance) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "bit rate", LR_WPAN_BIT_RATE) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "channel", wpan_frequency_center) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "power", my_parameters->power) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_int32 (ici_ptr, "packet type", WPAN_PKT_TYPE) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_int32 (ici_ptr, "dest address", address->dest_addr) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Tx x", my_parameters->x) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Tx y", my_parameters->y) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Rx x", rxptr->x) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Rx y", rxptr->y) == OPC_COMPCODE_FAILURE)
-			lr_wpan_mac_error ("lr_wpan_generate_beacon:", "Unable to set the ICI pointer.", OPC_NIL);
+		/* create the ICI with the description of the transmission */
+		ici_ptr = lr_wpan_tx_ici_create (address->dest_addr, txrx_distance, rxptr, WPAN_FORMAT_BEACON_GADGET);
 		
 		/* Associate the ICI pointer with the beacon packet */
 		op_pk_ici_set (beacon_ptr, ici_ptr);
@@ -2862,7 +2926,7 @@ lr_wpan_generate_data_request (void)
 		lr_wpan_mac_error ("lr_wpan_generate_data_request:", "The MAC destination address doesn't exist.", OPC_NIL);
 	
 	/* get the parameter of the destination device */
-	rxptr = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, rx_index);
+	rxptr = wpan_node_get (rx_index);
 	
 	/* compute the distance between the RX and TX */
 	deltax=rxptr->x - my_parameters->x;
@@ -2874,24 +2938,8 @@ lr_wpan_generate_data_request (void)
 	txrx_distance = sqrt(deltaxSquare + deltaySquare);
 	//txrx_distance = sqrt ((rxptr->x - my_parameters->x)*(rxptr->x - my_parameters->x) + (rxptr->y - my_parameters->y)*(rxptr->y - my_parameters->y));
 	
-	/* initialize the ICI structure */
-	ici_ptr = OPC_NIL;
-	
-	/* create ICI pointer */
-	ici_ptr = op_ici_create ("ici_channel");
-			
-	/* set the ICI pointer */
-	if (op_ici_attr_set_dbl (ici_ptr, "txrx distance", txrx_distance) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "bit rate", LR_WPAN_BIT_RATE) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "channel", wpan_frequency_center) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "power", my_parameters->power) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_int32 (ici_ptr, "packet type", WPAN_PKT_TYPE) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_int32 (ici_ptr, "dest address", address->dest_addr) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Tx x", my_parameters->x) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Tx y", my_parameters->y) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Rx x", rxptr->x) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Rx y", rxptr->y) == OPC_COMPCODE_FAILURE)
-		lr_wpan_mac_error ("lr_wpan_generate_beacon:", "Unable to set the ICI pointer.", OPC_NIL);
+	/* create the ICI with the description of the transmission */
+	ici_ptr = lr_wpan_tx_ici_create (address->dest_addr, txrx_distance, rxptr, WPAN_FORMAT_MAC);
 		
 	/* Associate the ICI pointer with the beacon packet */
 	op_pk_ici_set (lr_wpan_beacon_param.data_request, ici_ptr);
@@ -2931,6 +2979,9 @@ higher_layer_pkt_recv (void)
 	double deltaxSquare= 0.0;
 	double deltaySquare= 0.0;
 	Boolean packet_just_destroyed = OPC_FALSE;
+	Ici * traffic_ici_ptr;
+	int priority = WPAN_PRIORITY_REGULAR;
+	int traffic_class;
 	
 	
 	FIN (higher_layer_pkt_recv ());
@@ -2938,13 +2989,22 @@ higher_layer_pkt_recv (void)
 	/* get the packet from the stream */
 	higher_layer_pkptr = op_pk_get (intrpt_stream);
 	
+	/* the emergency sources mark their packets with the traffic ICI */
+	traffic_ici_ptr = op_intrpt_ici ();
+	if (traffic_ici_ptr != OPC_NIL && op_ici_attr_exists (traffic_ici_ptr, "Type of Priority"))
+		{
+		op_ici_attr_get (traffic_ici_ptr, "Type of Priority", &priority);
+		op_ici_destroy (traffic_ici_ptr);
+		}
+	traffic_class = (priority == WPAN_PRIORITY_EMERGENCY) ? Emergency_Traffic : Regular_Traffic;
+	
 	/* if you enable the below, then messages will not be queued, i.e. nodes accept only one packet at a time.*/
 	if(current_queue && ideal_poisson_traffic)	
 		{
 		if((current_queue->size>0)||((current_queue->size==0)&&(retransmission_ptr != OPC_NIL)))
 			{
 			op_pk_destroy(higher_layer_pkptr);
-			global_statistics.Pkt_not_enqueued++;
+			stat_shard->global.Pkt_not_enqueued++;
 			packet_just_destroyed = OPC_TRUE;
 			}
 		}
@@ -2999,7 +3059,7 @@ higher_layer_pkt_recv (void)
 			lr_wpan_mac_error ("higher_layer_pkt_recv:", "The MAC destination address doesn't exist.", OPC_NIL);
 	
 		/* get the parameter of the destination device */
-		rxptr = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, rx_index);
+		rxptr = wpan_node_get (rx_index);
 		
 		/* compute the distance between the RX and TX */
 		deltax=rxptr->x - my_parameters->x;
@@ -3047,24 +3107,8 @@ higher_layer_pkt_recv (void)
 	
 		for (i=0; i<pk_number; i++)
 			{
-			/* initialize the ICI structure */
-			ici_ptr = OPC_NIL;
-		
-			/* create ICI pointer */
-			ici_ptr = op_ici_create ("ici_channel");
-			
-			/* set the ICI pointer */
-			if (op_ici_attr_set_dbl (ici_ptr, "txrx distance", txrx_distance) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "bit rate", LR_WPAN_BIT_RATE) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "channel", wpan_frequency_center) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "power", my_parameters->power) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_int32 (ici_ptr, "packet type", WPAN_PKT_TYPE) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_int32 (ici_ptr, "dest address", dest_mac_address) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "Tx x", my_parameters->x) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "Tx y", my_parameters->y) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "Rx x", rxptr->x) == OPC_COMPCODE_FAILURE ||
-				op_ici_attr_set_dbl (ici_ptr, "Rx y", rxptr->y) == OPC_COMPCODE_FAILURE)
-				lr_wpan_mac_error ("higher_layer_pkt_recv:", "Unable to set the ICI pointer.", OPC_NIL);
+			/* create the ICI with the description of the transmission */
+			ici_ptr = lr_wpan_tx_ici_create (dest_mac_address, txrx_distance, rxptr, WPAN_FORMAT_MAC);
 		
 			/* create a MAC packet */
 			pkptr = op_pk_create_fmt ("lr_wpan_mac");
@@ -3085,28 +3129,12 @@ higher_layer_pkt_recv (void)
 			op_pk_ici_set (pkptr, ici_ptr);
 				
 			/* enqueue the packet */
-			lr_wpan_enqueue_packet (dest_mac_address, pkptr);
+			lr_wpan_enqueue_packet (dest_mac_address, traffic_class, pkptr);
 			}
 	
 		/* we create the last packet with a pointer to the real higher layer packet */
-		/* initialize the ICI structure */
-		ici_ptr = OPC_NIL;
-		
-		/* create ICI pointer */
-		ici_ptr = op_ici_create ("ici_channel");
-	
-		/* set the ICI pointer */
-		if (op_ici_attr_set_dbl (ici_ptr, "txrx distance", txrx_distance) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "bit rate", LR_WPAN_BIT_RATE) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "channel", wpan_frequency_center) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "power", my_parameters->power) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_int32 (ici_ptr, "packet type", WPAN_PKT_TYPE) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_int32 (ici_ptr, "dest address", address->dest_addr) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Tx x", my_parameters->x) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Tx y", my_parameters->y) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Rx x", rxptr->x) == OPC_COMPCODE_FAILURE ||
-			op_ici_attr_set_dbl (ici_ptr, "Rx y", rxptr->y) == OPC_COMPCODE_FAILURE)
-			lr_wpan_mac_error ("higher_layer_pkt_recv:", "Unable to set the ICI pointer.", OPC_NIL);
+		/* create the ICI with the description of the transmission */
+		ici_ptr = lr_wpan_tx_ici_create (address->dest_addr, txrx_distance, rxptr, WPAN_FORMAT_MAC);
 		
 		/* create a MAC packet */
 		pkptr = op_pk_create_fmt ("lr_wpan_mac");
@@ -3126,7 +3154,7 @@ higher_layer_pkt_recv (void)
 		op_pk_ici_set (pkptr, ici_ptr);
 		
 		/* enqueue the packet */
-		lr_wpan_enqueue_packet (dest_mac_address, pkptr);
+		lr_wpan_enqueue_packet (dest_mac_address, traffic_class, pkptr);
 		}
 	
 	FOUT;
@@ -3134,19 +3162,13 @@ higher_layer_pkt_recv (void)
 
 static void update_transmissions_list()
 {
-	tx* elem_ptr;
 	//tx* elem_ptr_global;
 
 	FIN (update_transmissions_list())
 	
-	elem_ptr = (tx*) op_prg_mem_alloc( sizeof(tx) );
+	lr_wpan_time_histogram_add (statistic_tx_hist, op_sim_time (), statistic.Segment_generated + 1);
 	//elem_ptr_global = (tx*) op_prg_mem_alloc( sizeof(tx) );
 	
-	elem_ptr->time = op_sim_time();
-	elem_ptr->transmissions = statistic.Segment_generated + 1;
-			
-	op_prg_list_insert(statistic_tx_list_ptr, elem_ptr, OPC_LISTPOS_TAIL);
-	
 	//elem_ptr_global->time = op_sim_time();
 	//elem_ptr_global->transmissions = global_statistics.Segment_generated + 1;
 	
@@ -3179,7 +3201,8 @@ lower_layer_pkt_rcv (void)
 	double service_time_duration;
 	Ici * ici_ptr;
 	Ici * ici_ptr_coordinator;
-	double rx_x, tx_x, rx_y, tx_y, power;
+	const Wpan_Tx_Descriptor * tx_descriptor;
+	double rx_x = 0.0, tx_x = 0.0, rx_y = 0.0, tx_y = 0.0, power = 0.0;
 	//int wpan_bulk_data_id;
 	
 	int packet_size;
@@ -3238,7 +3261,7 @@ lower_layer_pkt_rcv (void)
 			{
 			ENTER_STATE_ODB_PRINTING ("packet is  collided or bad");
 			(statistic.Pkt_Collided)++;
-			(global_statistics.Pkt_Collided)++;
+			(stat_shard->global.Pkt_Collided)++;
 			
 			//if(GADGET_enabled && !strcmp (format, "lr_wpan_mac")) 
 			//	GADGET_SUPERFRAME_TRAFFIC++;	//traffic perceived on the channel even though collision or bad
@@ -3250,7 +3273,7 @@ lower_layer_pkt_rcv (void)
 			{
 			ENTER_STATE_ODB_PRINTING ("packet is considered as noise");
 			(statistic.Pkt_Noise)++;
-			(global_statistics.Pkt_Noise)++;
+			(stat_shard->global.Pkt_Noise)++;
 			
 			if (!strcmp (format, "lr_wpan_beacon_GADGET")) 
 				(statistic.Beacon_Frame_Noise)++;  
@@ -3259,7 +3282,7 @@ lower_layer_pkt_rcv (void)
 			{
 			ENTER_STATE_ODB_PRINTING ("packet is lost due to interference");
 			(statistic.Pkt_Lost)++;	
-			(global_statistics.Pkt_Lost)++;
+			(stat_shard->global.Pkt_Lost)++;
 			
 			//if(GADGET_enabled && !strcmp (format, "lr_wpan_mac"))
 			//	GADGET_SUPERFRAME_TRAFFIC++;	//traffic perceived on the channel
@@ -3311,7 +3334,7 @@ lower_layer_pkt_rcv (void)
 		if (addr_field->packet_pending != 0)
 			{
 			/* schedule a data request to send if some packets are pending */
-			op_intrpt_schedule_self (lr_wpan_slotted_boundary_time (), Wpan_Data_Req_To_Send);
+			op_intrpt_schedule_self (lr_wpan_next_backoff_boundary (), Wpan_Data_Req_To_Send);
 			}
 		else if (wpan_transmission_required)
 			{
@@ -3320,7 +3343,7 @@ lower_layer_pkt_rcv (void)
 			 * we schedule the transmission
 			 */
 			//if(DEBUG_BEACON_RCVD) printf("MAC MODULE: Node %s At time %f sec schedule intrp code %d\n", lr_wpan_node_name,lr_wpan_slotted_boundary_time (), Data_Pkt_To_Send);
-			op_intrpt_schedule_self (lr_wpan_slotted_boundary_time (), Data_Pkt_To_Send);
+			op_intrpt_schedule_self (lr_wpan_next_backoff_boundary (), Data_Pkt_To_Send);
 			}
 		
 		/* destroy the packet */
@@ -3346,13 +3369,17 @@ lower_layer_pkt_rcv (void)
 					printf ("lr_wpan_chan_buffer_insert: Invalid ICI\n");
 	
 			
-				/* get information from the ici */
-				if (op_ici_attr_get (ici_ptr_coordinator, "power", &power) == OPC_COMPCODE_FAILURE ||
-					op_ici_attr_get (ici_ptr_coordinator, "Tx x", &tx_x) == OPC_COMPCODE_FAILURE ||
-					op_ici_attr_get (ici_ptr_coordinator, "Tx y", &tx_y) == OPC_COMPCODE_FAILURE ||
-					op_ici_attr_get (ici_ptr_coordinator, "Rx x", &rx_x) == OPC_COMPCODE_FAILURE ||
-					op_ici_attr_get (ici_ptr_coordinator, "Rx y", &rx_y) == OPC_COMPCODE_FAILURE)
+				/* get the description of the transmission */
+				if ((tx_descriptor = wpan_tx_descriptor_get (ici_ptr_coordinator)) == NULL)
 					printf ("lr_wpan_chan_buffer_insert cannot read the ICI attributes\n");
+				else
+					{
+					power = tx_descriptor->power;
+					tx_x = tx_descriptor->tx_x;
+					tx_y = tx_descriptor->tx_y;
+					rx_x = tx_descriptor->rx_x;
+					rx_y = tx_descriptor->rx_y;
+					}
 	
 				//op_ici_attr_get (ici_ptr, "piconet number", &piconet_number) == OPC_COMPCODE_FAILURE)
 				//lr_wpan_chan_error ("lr_wpan_chan_buffer_insert", "cannot read the ICI attributes", OPC_NIL);
@@ -3409,12 +3436,9 @@ lower_layer_pkt_rcv (void)
 			fprintf(fp_debug, "Node %s: Packet received from node %d at time %f\n", lr_wpan_node_name, addr_field->src_addr, op_sim_time());
 		
 		
-		/* if the packet sequence number is correct */
-		if (seqn != lr_wpan_get_rx_seqn (addr_field->src_addr))
+		/* if the packet is not a duplicate (its sequence number is recorded) */
+		if (lr_wpan_rx_seqn_check (addr_field->src_addr, seqn))
 			{
-			/* update the sequence number */
-			lr_wpan_set_rx_seqn (addr_field->src_addr, seqn);
-			
 					
 			/* update the statistic */
 			statistic.Data_Pkt_Rcv ++;
@@ -3423,8 +3447,8 @@ lower_layer_pkt_rcv (void)
 			op_stat_write(nb_pkt_recv, statistic.Data_Pkt_Rcv);
 			
 			
-			global_statistics.Data_Pkt_Rcv ++;  
-			global_statistics.Total_Bits_Rcv += packet_size;
+			stat_shard->global.Data_Pkt_Rcv ++;  
+			stat_shard->global.Total_Bits_Rcv += packet_size;
 			
 			
 			
@@ -3582,8 +3606,6 @@ static void lr_wpan_process_rcvd_beacon_frame(Packet * wpan_rcvd_frame_ptr)
 	int rcvd_sequence_number;
 	int rcvd_beacon_length;
 	int protocol_used;
-	int i = 0;
-	int j = 0;
 	Frame_Ctrl_Field *frame_ctrl_field;
 	Superframe_Spec_Field *superframe_spec_field;
 	double beacon_transmission_time;
@@ -3696,23 +3718,14 @@ static void lr_wpan_process_rcvd_beacon_frame(Packet * wpan_rcvd_frame_ptr)
 	  
 	  beacon_transmission_time = (op_sim_time() - sf_param.superframe_start_time)/LR_WPAN_BACKOFF_PERIOD_DURATION;
    	  backoff_periods_per_beacon = ceil (beacon_transmission_time);
-	  sf_param.remaining_CAP_backoff_periods = sf_param.backoff_periods_per_CAP - backoff_periods_per_beacon;
 	 	  
 	  op_intrpt_schedule_self(sf_param.superframe_start_time + backoff_periods_per_beacon*LR_WPAN_BACKOFF_PERIOD_DURATION, Wpan_Backoff_Period_Elapsed);
 	
 	if(DEBUG_BEACON_RCVD)
 	 fprintf (fp_debug, "MAC MODULE: Node %s -- Beacon reception time = %.12f -- Next backoff boundary at %.12f s\n", lr_wpan_node_name, op_sim_time(), (sf_param.superframe_start_time + backoff_periods_per_beacon*LR_WPAN_BACKOFF_PERIOD_DURATION));	
 
-	  for(i=0; i < sf_param.backoff_periods_per_superframe; i++)
-		  {
-		  sf_param.backoff_period_boundary_symbols[i] = aUnitBackoffPeriod*(i+1);
-		  if( ( ((aUnitBackoffPeriod*(i+1)) % sf_param.backoff_periods_per_slot) == 0) && j < 16 )
-			  {
-			  sf_param.time_slot_boundary_symbols[j] = aUnitBackoffPeriod*(i+1);
-			  j++;
-			  }
-		  }
-	
+	  /* the boundaries of the backoff periods and of the slots are computed */
+	  /* on demand from the superframe start (slot clock) */
 	  sf_param.backoff_period_index = backoff_periods_per_beacon -1;
 	  sf_param.time_slot_index = 0;
 		
@@ -3752,7 +3765,7 @@ static void lr_wpan_process_rcvd_beacon_frame(Packet * wpan_rcvd_frame_ptr)
 	    printf("(%s) Backoff periods per CAP = %d \n",   		lr_wpan_node_name , sf_param.backoff_periods_per_CAP );
 		printf("(%s) Beacon transmission time (seconds) = %f \n",   		lr_wpan_node_name , (op_sim_time() - sf_param.superframe_start_time) );
 		printf("(%s) Backoff periods per beacon = %d \n",   		lr_wpan_node_name , backoff_periods_per_beacon );
-	    printf("(%s) Remaining backoff periods = %d \n",   		lr_wpan_node_name , sf_param.remaining_CAP_backoff_periods); 
+	    printf("(%s) Remaining backoff periods = %d \n",   		lr_wpan_node_name , lr_wpan_remaining_CAP_backoff_periods ()); 
 	    printf("(%s) End of the CAP periods = %f \n",   		lr_wpan_node_name , sf_param.end_of_the_CAP_period); 
 	    printf("(%s) CAP period active = %s \n",   		lr_wpan_node_name , sf_param.CAP_PERIOD_ACTIVE ? "OPC_TRUE" : "OPC_FLASE");
 		printf("MAC MODULE: Node %s At time %f sec schedule intrp code %d (Wpan_CAP_Period_End)\n", lr_wpan_node_name,sf_param.superframe_start_time + sf_param.CAP_period_length_seconds, Wpan_CAP_Period_End);
@@ -3849,7 +3862,7 @@ static void lr_wpan_packet_to_transmit (void)
 		
 		
 		/* update the size of the list */
-		current_queue->size = op_prg_list_size (current_queue->subqueue);
+		lr_wpan_subqueue_size_update (current_queue);
 		
 		/* Set the sequence number of the packet */
 		op_pk_nfd_set_int32 (pkptr, "Seqn", Mac_Data_Tx_Seqn);
@@ -3868,7 +3881,7 @@ static void lr_wpan_packet_to_transmit (void)
 
 		/* compute the retransmission packet */
 		(statistic.Retransmission)++;
-		(global_statistics.Retransmission)++;
+		(stat_shard->global.Retransmission)++;
 		
 		/* set a break point for the retransmission */
 		op_prg_odb_bkpt ("retransmission");
@@ -3893,7 +3906,7 @@ static void lr_wpan_packet_to_transmit (void)
 	
 	op_stat_write(nb_pkt_send, statistic.Data_Pkt_Sent);
 	
-	global_statistics.Data_Pkt_Sent ++;
+	stat_shard->global.Data_Pkt_Sent ++;
 	
 	time_intrpt=(pktsize + (double) LR_WPAN_PHY_OVERHEAD)/LR_WPAN_BIT_RATE; 
 	
@@ -3933,19 +3946,13 @@ static void lr_wpan_packet_to_transmit (void)
 
 static void update_retransmissions_list()
 {
-	retx* elem_ptr;
 	//retx* elem_ptr_global;
 
 	FIN (update_retransmissions_list())
 	
-	elem_ptr = (retx*) op_prg_mem_alloc( sizeof(retx) );
+	lr_wpan_time_histogram_add (statistic_retx_hist, op_sim_time (), statistic.Retransmission);
 	//elem_ptr_global = (retx*) op_prg_mem_alloc( sizeof(retx) );
 	
-	elem_ptr->time = op_sim_time();
-	elem_ptr->retransmissions = statistic.Retransmission;
-		
-	op_prg_list_insert(statistic_retx_list_ptr, elem_ptr, OPC_LISTPOS_TAIL);
-	
 	//elem_ptr_global->time = op_sim_time();
 	//elem_ptr_global->retransmissions = global_statistics.Retransmission;
 	
@@ -3955,6 +3962,38 @@ static void update_retransmissions_list()
 }
 
 
+/*
+ * Function:	write_stack_change_record
+ *
+ * Description:	write a record of the protocol stack changes
+ *				or of the superframe traffic and SNR in its
+ *				report file
+ *
+ * ParamIn:		FILE * fp
+ *				the report file
+ *
+ *				const void * record
+ *				the stack_change record
+ */
+
+static void write_stack_change_record (FILE * fp, const void * record)
+{
+	const stack_change * elem_ptr = (const stack_change *) record;
+	
+	FIN (write_stack_change_record (fp, record));
+	
+	fprintf (fp, "%s\t %s\t %s\t %s\t %s\n",
+		double_to_string (elem_ptr->time,10),
+		integer_to_string ((int)elem_ptr->s_aloha_status, 10),
+		integer_to_string ((int)elem_ptr->psma_status, 10),
+		double_to_string (elem_ptr->observed_traffic,10),
+		double_to_string (elem_ptr->observed_snr,10)
+		);
+	
+	FOUT;
+}
+
+
 
 /*
  * Function:	lr_wpan_ack_to_transmit
@@ -3997,7 +4036,7 @@ static void lr_wpan_ack_to_transmit ()
 		lr_wpan_mac_error ("lr_wpan_ack_to_transmit:", "The MAC destination address doesn't exist.", OPC_NIL);
 	
 	/* get the parameter of the destination device */
-	rxptr = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, rx_index);
+	rxptr = wpan_node_get (rx_index);
 	
 	/* compute the distance between the RX and TX */
 	//if(DEBUG_Tx_Ack) printf("MAC MODULE: Node %s transmitting an Ack. Destination node coordinates: x = %f y = %f \n", lr_wpan_node_name, rxptr->x, rxptr->y);
@@ -4020,21 +4059,8 @@ static void lr_wpan_ack_to_transmit ()
     */
 	//if(DEBUG_Tx_Ack) printf("MAC MODULE: Node %s transmitting an Ack with Tx-Rx distance = %f m\n", lr_wpan_node_name, txrx_distance);
 	
-	/* create a new ICI */
-	ici_ptr = op_ici_create ("ici_channel");
-	
-	/* set the ICI pointer */
-	if (op_ici_attr_set_dbl (ici_ptr, "txrx distance", txrx_distance) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "bit rate", LR_WPAN_BIT_RATE) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "channel", wpan_frequency_center) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "power", my_parameters->power) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_int32 (ici_ptr, "packet type", WPAN_PKT_TYPE) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_int32 (ici_ptr, "dest address", Ack_Dest_Addr) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Tx x", my_parameters->x) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Tx y", my_parameters->y) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Rx x", rxptr->x) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_set_dbl (ici_ptr, "Rx y", rxptr->y) == OPC_COMPCODE_FAILURE)
-		lr_wpan_mac_error ("higher_layer_pkt_recv:", "Unable to set the ICI pointer.", OPC_NIL);
+	/* create the ICI with the description of the transmission */
+	ici_ptr = lr_wpan_tx_ici_create (Ack_Dest_Addr, txrx_distance, rxptr, WPAN_FORMAT_ACK);
 	
 	/* Associate the ICI pointer with this packet */
 	op_pk_ici_set (Ack_Pkptr, ici_ptr);
@@ -4094,7 +4120,7 @@ static void	lr_wpan_drop_higher_layer_pkt (void)
 			lr_wpan_mac_error ("lr_wpan_drop_higher_layer_pkt", "No ICI associates with the current packet", OPC_NIL);
 		
 		/* destroy the ICI */
-		op_ici_destroy (ici_ptr);
+		wpan_tx_ici_destroy (ici_ptr);
 				
 		/* get the higher layer packet if the segmentation flag is true */
 		op_pk_nfd_get_int32 (pkptr, "Segmentation", &last_packet);
@@ -4108,7 +4134,7 @@ static void	lr_wpan_drop_higher_layer_pkt (void)
 			op_pk_nfd_get_pkt (pkptr, "Higher Layer Pkt", &higher_layer_pkptr);
 			
 			// update statistic of delay for dropped packets
-			global_statistics.Total_Delay_Dropped_packets += op_sim_time () - op_pk_stamp_time_get (higher_layer_pkptr);
+			stat_shard->global.Total_Delay_Dropped_packets += op_sim_time () - op_pk_stamp_time_get (higher_layer_pkptr);
 			
 			/* destroy the higher layer packet */
 			op_pk_destroy (higher_layer_pkptr);
@@ -4122,7 +4148,7 @@ static void	lr_wpan_drop_higher_layer_pkt (void)
 		}
 	
 	/* update the size of the queue */
-	current_queue->size = op_prg_list_size (current_queue->subqueue);
+	lr_wpan_subqueue_size_update (current_queue);
 		
 	FOUT;
 }
@@ -4152,7 +4178,7 @@ static int	lr_wpan_destroy_retransmission (void)
 		lr_wpan_mac_error ("lr_wpan_destroy_retransmission:", "Unable to get the ICI pointer.", OPC_NIL);
 		
 	/* destroy the ICI structure */
-	op_ici_destroy (ici_ptr);
+	wpan_tx_ici_destroy (ici_ptr);
 	
 	/* get the segmentation flag */
 	op_pk_nfd_get_int32 (retransmission_ptr, "Segmentation", &last_packet);
@@ -4168,7 +4194,7 @@ static int	lr_wpan_destroy_retransmission (void)
 		
 		// update statistic of delay in case we are dropping a packet
 		if(nb_transmission_retries > max_frame_retries||csma_parameters.nb_backoff > csma_parameters.max_backoff)
-			global_statistics.Total_Delay_Dropped_packets += op_sim_time () - op_pk_stamp_time_get (higher_layer_pkptr);
+			stat_shard->global.Total_Delay_Dropped_packets += op_sim_time () - op_pk_stamp_time_get (higher_layer_pkptr);
 		
 		
 		/* destroy the higher layer packet */
@@ -4186,13 +4212,59 @@ static int	lr_wpan_destroy_retransmission (void)
 }
 
 
+/*
+ * Function:	lr_wpan_tx_ici_create
+ *
+ * Description:	create the ICI associated with a packet sent to the
+ *				channel, with the description of the transmission
+ *
+ * ParamIn:		int dest_address
+ *				MAC address of the destination
+ *
+ *				double txrx_distance
+ *				distance between the transmitter and the receiver
+ *
+ *				const Wpan_Node_Param * rxptr
+ *				parameters of the destination device
+ *
+ *				Wpan_Pkt_Format format
+ *				format of the packet
+ *
+ * ParamOut:	Ici * ici_ptr
+ *				ICI to associate with the packet
+ */
+
+static Ici * lr_wpan_tx_ici_create (int dest_address, double txrx_distance, const Wpan_Node_Param * rxptr, Wpan_Pkt_Format format)
+{
+	Wpan_Tx_Descriptor tx_descriptor;
+	
+	FIN (lr_wpan_tx_ici_create (dest_address, txrx_distance, rxptr, format));
+	
+	tx_descriptor.txrx_distance = txrx_distance;
+	tx_descriptor.bit_rate = LR_WPAN_BIT_RATE;
+	tx_descriptor.frequency = wpan_frequency_center;
+	tx_descriptor.power = my_parameters->power;
+	tx_descriptor.packet_type = WPAN_PKT_TYPE;
+	tx_descriptor.format = format;
+	tx_descriptor.dest_address = dest_address;
+	tx_descriptor.tx_x = my_parameters->x;
+	tx_descriptor.tx_y = my_parameters->y;
+	tx_descriptor.rx_x = rxptr->x;
+	tx_descriptor.rx_y = rxptr->y;
+	tx_descriptor.tx_node_index = my_parameters->node_index;
+	tx_descriptor.rx_node_index = rxptr->node_index;
+	
+	FRET (wpan_tx_ici_create (&tx_descriptor));
+}
+
+
 /*
  * Function:	lr_wpan_enqueue_packet
  *
  * Description:	subqueue mechanism:
  *				each packet is enqueue according to its destination
- *				MAC address. A structure has been made to record
- *				these information: "Wpan_queue"
+ *				MAC address and its traffic class. A structure has
+ *				been made to record these information: "Wpan_queue"
  *				this function enqueue a packet according to its
  *				destination MAC address. If no subqueue exists for
  *				the current MAC address, we create a new one.
@@ -4200,90 +4272,59 @@ static int	lr_wpan_destroy_retransmission (void)
  * ParamIn:		int mac_address
  *				Destination MAC address of the packet
  *
+ *				int traffic_class
+ *				traffic class of the packet (Wpan_Traffic_Class)
+ *
  *				Packet * pkptr
  *				pointer to the packet to enqueue
  *				
  */
 
-static void lr_wpan_enqueue_packet (int mac_address, Packet * pkptr)
+static void lr_wpan_enqueue_packet (int mac_address, int traffic_class, Packet * pkptr)
 {
-	Wpan_Queue * queue; // = wpan_queue;
-	
-	FIN (lr_wpan_enqueue_packet (mac_address, pkptr));
+	Wpan_Queue * queue;
 	
-	queue = wpan_queue;
+	FIN (lr_wpan_enqueue_packet (mac_address, traffic_class, pkptr));
 	
 	/* update the statistic */
 	statistic.Segment_generated ++;
 	node_statistics.Segments_Bits_Generated = node_statistics.Segments_Bits_Generated + op_pk_total_size_get (pkptr)  - WPAN_HEADER_SIZE;
 
-	global_statistics.Segment_generated ++ ; 
+	stat_shard->global.Segment_generated ++ ; 
 	
-	/* consider all the possibilities */
-	if (wpan_queue == NULL)
-		{
-		/* if the structure is not yet created */
-		wpan_queue = lr_wpan_allocate_subqueue (mac_address, pkptr);
-		
-		/* we make a loop */
-		wpan_queue->next = wpan_queue;
-		
-		
-		/* initialize the round robin if any */
-		current_queue = wpan_queue;
-
-		FOUT;
-		}
+	/* get the subqueue of the destination, create it if it doesn't exist */
+	if ((queue = lr_wpan_subqueue_search (mac_address, traffic_class)) == NULL)
+		queue = lr_wpan_allocate_subqueue (mac_address, traffic_class);
 	
-	while (queue != NULL)
-		{
-		/* */
-		if (queue->mac_address == mac_address)
-			{
-			op_prg_list_insert (queue->subqueue, pkptr, OPC_LISTPOS_TAIL);
-			queue->size = op_prg_list_size (queue->subqueue);
-			FOUT;
-			}
-		
-		if (queue->next == wpan_queue)
-			{
-			/* we are at the end of the chain */
-			queue->next = lr_wpan_allocate_subqueue (mac_address, pkptr);
-			
-			/* increase the number of elements */
-			wpan_queue->nb_element ++;
-			FOUT;
-			}
-		
-		queue = queue->next;
-		}
+	op_prg_list_insert (queue->subqueue, pkptr, OPC_LISTPOS_TAIL);
+	lr_wpan_subqueue_size_update (queue);
 	
-	/* we shouldn't be here, so we print out an error message */
-	lr_wpan_mac_error ("lr_wpan_enqueue_packet:", "Unable to enqueue the packet", OPC_NIL);
+	FOUT;
 }
 
 
 /*
  * Function:	lr_wpan_allocate_subqueue
  *
- * Description:	allocate a new subqueue for a new destination
- *				MAC address
+ * Description:	allocate a new (empty) subqueue for a new destination
+ *				MAC address, add it at the end of the chain of the
+ *				subqueues and into the index
  *
  * ParamIn:		int mac_address
  *				Destination MAC address of the packets in the subqueue
  *
- *				Packet * pkptr
- *				pointer to the packet to enqueue
+ *				int traffic_class
+ *				traffic class of the packets in the subqueue
  *
  * ParamOut:	Wpan_queue * queue
- *				New queue structure with the first pascket enqueue
+ *				New queue structure
  */
 
-static Wpan_Queue * lr_wpan_allocate_subqueue (int mac_address, Packet * pkptr)
+static Wpan_Queue * lr_wpan_allocate_subqueue (int mac_address, int traffic_class)
 {
 	Wpan_Queue * queue;
 	
-	FIN (lr_wpan_allocate_subqueue ());
+	FIN (lr_wpan_allocate_subqueue (mac_address, traffic_class));
 	
 	/* allocate the memory for the cell */
 	queue = (Wpan_Queue *) op_prg_mem_alloc (sizeof (Wpan_Queue));
@@ -4291,19 +4332,264 @@ static Wpan_Queue * lr_wpan_allocate_subqueue (int mac_address, Packet * pkptr)
 	/* create a the list attribute */
 	queue->subqueue = op_prg_list_create ();
 	
-	/* enqueue the packet */
-	op_prg_list_insert (queue->subqueue, pkptr, OPC_LISTPOS_TAIL);
-	
 	/* initialize the other fields */
 	queue->mac_address = mac_address;
-	queue->size = 1;
+	queue->traffic_class = traffic_class;
+	queue->position = queue_index.nb_subqueues;
+	queue->size = 0;
 	queue->nb_element = 1;
-	queue->next = wpan_queue;
+	
+	if (wpan_queue == NULL)
+		{
+		/* if the structure is not yet created, we make a loop */
+		wpan_queue = queue;
+		queue->next = queue;
+		
+		/* initialize the round robin if any */
+		current_queue = queue;
+		}
+	else
+		{
+		/* we add the subqueue at the end of the chain */
+		queue_index.chain[queue_index.nb_subqueues - 1]->next = queue;
+		queue->next = wpan_queue;
+		
+		/* increase the number of elements */
+		wpan_queue->nb_element ++;
+		}
+	
+	lr_wpan_subqueue_register (queue);
 	
 	FRET (queue);
 }
 
 
+/*
+ * Function:	lr_wpan_subqueue_slot
+ *
+ * Description:	get the first slot to probe for a subqueue
+ *				in the hash table of the subqueues
+ */
+
+static int lr_wpan_subqueue_slot (int mac_address, int traffic_class)
+{
+	unsigned int hash;
+	
+	FIN (lr_wpan_subqueue_slot (mac_address, traffic_class));
+	
+	/* multiplicative hashing (Knuth), the high bits are the most mixed */
+	hash = ((unsigned int) (mac_address * WPAN_NB_TRAFFIC_CLASSES + traffic_class) * 2654435761u);
+	hash ^= hash >> 16;
+	
+	FRET ((int) (hash & (unsigned int) (queue_index.nb_slots - 1)));
+}
+
+
+/*
+ * Function:	lr_wpan_subqueue_search
+ *
+ * Description:	search the subqueue of a destination MAC address
+ *
+ * ParamIn:		int mac_address
+ *				Destination MAC address of the packets
+ *
+ *				int traffic_class
+ *				traffic class of the packets
+ *
+ * ParamOut:	Wpan_Queue * queue
+ *				subqueue found, NULL otherwise
+ */
+
+static Wpan_Queue * lr_wpan_subqueue_search (int mac_address, int traffic_class)
+{
+	Wpan_Queue * queue;
+	int i;
+	
+	FIN (lr_wpan_subqueue_search (mac_address, traffic_class));
+	
+	if (queue_index.nb_subqueues == 0)
+		FRET (NULL);
+	
+	/* browse the cluster of the key until an empty slot */
+	for (i = lr_wpan_subqueue_slot (mac_address, traffic_class); (queue = queue_index.slots[i]) != NULL; i = (i + 1) & (queue_index.nb_slots - 1))
+		{
+		if (queue->mac_address == mac_address && queue->traffic_class == traffic_class)
+			FRET (queue);
+		}
+	
+	FRET (NULL);
+}
+
+
+/*
+ * Function:	lr_wpan_subqueue_register
+ *
+ * Description:	record a new subqueue into the index. The hash table
+ *				is enlarged when it is half full, the chain and the
+ *				bitmaps when they are full.
+ *
+ * ParamIn:		Wpan_Queue * queue
+ *				subqueue to record (its position must be set)
+ */
+
+static void lr_wpan_subqueue_register (Wpan_Queue * queue)
+{
+	Wpan_Queue ** old_chain;
+	unsigned int * old_active;
+	int old_nb_words, nb_words;
+	int i, j;
+	
+	FIN (lr_wpan_subqueue_register (queue));
+	
+	/* enlarge the chain and the bitmaps */
+	if (queue_index.nb_subqueues == queue_index.capacity)
+		{
+		old_chain = queue_index.chain;
+		old_nb_words = (queue_index.capacity + 31) / 32;
+		
+		queue_index.capacity = (queue_index.capacity == 0) ? 32 : 2 * queue_index.capacity;
+		nb_words = (queue_index.capacity + 31) / 32;
+		
+		queue_index.chain = (Wpan_Queue **) op_prg_mem_alloc (queue_index.capacity * sizeof (Wpan_Queue *));
+		
+		for (i = 0; i < queue_index.nb_subqueues; i++)
+			queue_index.chain[i] = old_chain[i];
+		
+		if (old_chain != NULL)
+			op_prg_mem_free (old_chain);
+		
+		for (j = 0; j < WPAN_NB_TRAFFIC_CLASSES; j++)
+			{
+			old_active = queue_index.active[j];
+			queue_index.active[j] = (unsigned int *) op_prg_mem_alloc (nb_words * sizeof (unsigned int));
+			
+			for (i = 0; i < nb_words; i++)
+				queue_index.active[j][i] = (i < old_nb_words) ? old_active[i] : 0;
+			
+			if (old_active != NULL)
+				op_prg_mem_free (old_active);
+			}
+		}
+	
+	queue_index.chain[queue_index.nb_subqueues++] = queue;
+	
+	/* build the hash table again from the chain when it is half full */
+	if (2 * queue_index.nb_subqueues > queue_index.nb_slots)
+		{
+		if (queue_index.slots != NULL)
+			op_prg_mem_free (queue_index.slots);
+		
+		queue_index.nb_slots = (queue_index.nb_slots == 0) ? 16 : 2 * queue_index.nb_slots;
+		queue_index.slots = (Wpan_Queue **) op_prg_mem_alloc (queue_index.nb_slots * sizeof (Wpan_Queue *));
+		
+		for (i = 0; i < queue_index.nb_slots; i++)
+			queue_index.slots[i] = NULL;
+		
+		for (j = 0; j < queue_index.nb_subqueues - 1; j++)
+			{
+			for (i = lr_wpan_subqueue_slot (queue_index.chain[j]->mac_address, queue_index.chain[j]->traffic_class); queue_index.slots[i] != NULL; i = (i + 1) & (queue_index.nb_slots - 1));
+			
+			queue_index.slots[i] = queue_index.chain[j];
+			}
+		}
+	
+	for (i = lr_wpan_subqueue_slot (queue->mac_address, queue->traffic_class); queue_index.slots[i] != NULL; i = (i + 1) & (queue_index.nb_slots - 1));
+	
+	queue_index.slots[i] = queue;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_subqueue_size_update
+ *
+ * Description:	update the size of a subqueue after an insertion or
+ *				a removal, the number of packets of the MAC and the
+ *				bitmap of the non-empty subqueues
+ *
+ * ParamIn:		Wpan_Queue * queue
+ *				subqueue modified
+ */
+
+static void lr_wpan_subqueue_size_update (Wpan_Queue * queue)
+{
+	int old_size;
+	unsigned int mask;
+	unsigned int * word;
+	
+	FIN (lr_wpan_subqueue_size_update (queue));
+	
+	old_size = queue->size;
+	queue->size = op_prg_list_size (queue->subqueue);
+	queue_index.nb_packets += queue->size - old_size;
+	
+	mask = 1u << (queue->position & 31);
+	word = &queue_index.active[queue->traffic_class][queue->position >> 5];
+	
+	if (old_size == 0 && queue->size > 0)
+		{
+		*word |= mask;
+		queue_index.nb_active[queue->traffic_class]++;
+		}
+	else if (old_size > 0 && queue->size == 0)
+		{
+		*word &= ~mask;
+		queue_index.nb_active[queue->traffic_class]--;
+		}
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_subqueue_next_active
+ *
+ * Description:	get the first non-empty subqueue of a traffic class
+ *				between two positions of the chain. The empty words
+ *				of the bitmap are skipped.
+ *
+ * ParamIn:		int traffic_class
+ *				traffic class of the subqueues
+ *
+ *				int from, int to
+ *				positions to check, from included, to excluded
+ *
+ * ParamOut:	int position
+ *				position of the subqueue found, -1 otherwise
+ */
+
+static int lr_wpan_subqueue_next_active (int traffic_class, int from, int to)
+{
+	unsigned int * active;
+	unsigned int word;
+	int position = from;
+	
+	FIN (lr_wpan_subqueue_next_active (traffic_class, from, to));
+	
+	active = queue_index.active[traffic_class];
+	
+	while (position < to)
+		{
+		word = active[position >> 5] >> (position & 31);
+		
+		/* go to the next word */
+		if (word == 0)
+			{
+			position = (position | 31) + 1;
+			continue;
+			}
+		
+		for (; !(word & 1); word >>= 1)
+			position++;
+		
+		FRET ((position < to) ? position : -1);
+		}
+	
+	FRET (-1);
+}
+
+
 /*
  * Function:	lr_wpan_print_queue
  *
@@ -4355,34 +4641,33 @@ lr_wpan_print_queue (void)
 static int
 lr_wpan_get_beacon_size (Addressing_Field * address)
 {
-	Wpan_Queue * queue; // = wpan_queue;
-	int i;
-	int beacon_size, nbPacket = 0;
+	Wpan_Queue * queue;
+	int traffic_class;
+	int beacon_size, nbPacket;
+	int packet_pending = 0;
+	Boolean subqueue_found = OPC_FALSE;
 	
 	const int address_size = 16; // size of the address field in bits
 	const int maximum_nbpacket = 7; // maximum number of packet
 	
 	FIN (lr_wpan_get_beacon_size ());
 	
-	queue = wpan_queue;
+	/* the number of packets is maintained by the subqueues */
+	nbPacket = queue_index.nb_packets;
 	
-	/* count the number of packets */
-	if (queue != NULL)
+	/* if we have packets for the particular source address */
+	for (traffic_class = 0; traffic_class < WPAN_NB_TRAFFIC_CLASSES; traffic_class++)
 		{
-		for (i=0; i<wpan_queue->nb_element; i++)
+		if ((queue = lr_wpan_subqueue_search (address->src_addr, traffic_class)) != NULL)
 			{
-			/* increase the number of total packet */
-			nbPacket += queue->size;
-			
-			/* if we have a packet for the particular source address */
-			if (address->src_addr == queue->mac_address)
-				address->packet_pending = queue->size;
-			
-			/* get the next queue */
-			queue = queue->next;
+			packet_pending += queue->size;
+			subqueue_found = OPC_TRUE;
 			}
 		}
 	
+	if (subqueue_found)
+		address->packet_pending = packet_pending;
+	
 	/* compute the Beacon packet size */
 	if (nbPacket < maximum_nbpacket)
 		beacon_size = 104 + nbPacket * address_size;
@@ -4396,50 +4681,50 @@ lr_wpan_get_beacon_size (Addressing_Field * address)
 
 /*
  * Function:	lr_wpan_subq_checking
+ *
+ * Description:	round robin over the non-empty subqueues, starting
+ *				after the current subqueue. The emergency subqueues
+ *				are served before the regular ones.
  */
 
 static void lr_wpan_subq_checking ()
 {
-	int i = 0;
-	Wpan_Queue * queue;// = current_queue;
-	Boolean subq_empty;
+	int traffic_class;
+	int position = -1;
+	int last_position;
 	
 	FIN (lr_wpan_subq_checking ());
 	
-	queue = current_queue;
-	
 	/*
  	 * if no transmission is already scheduled, we check
 	 * the subqueues for the next transmission
 	 */
-	/* initialize the flag subqueue empty */
-	if (queue != NULL)
-		{
-		queue = queue->next;
-		subq_empty = (queue->size == 0);
-		}
-	else
-		{
+	if (current_queue == NULL)
 		FOUT;
-		}
 	
-	/* check the subqueues */
-	while (subq_empty && queue->next != current_queue)
+	/*
+	 * check the subqueues after the current one, as the former scan
+	 * of the chain: the current subqueue is only checked when it is
+	 * the only one
+	 */
+	last_position = (queue_index.nb_subqueues == 1) ? 1 : current_queue->position;
+	
+	for (traffic_class = Emergency_Traffic; traffic_class >= Regular_Traffic && position == -1; traffic_class--)
 		{
-		/* get the next subqueue index */
-		queue = queue->next;
+		if (queue_index.nb_active[traffic_class] == 0)
+			continue;
 		
-		/* check if the subqueue is empty */
-		subq_empty = (queue->size == 0);
+		if ((position = lr_wpan_subqueue_next_active (traffic_class, current_queue->position + 1, queue_index.nb_subqueues)) == -1)
+			position = lr_wpan_subqueue_next_active (traffic_class, 0, last_position);
 		}
 	
-	if (!subq_empty)
+	if (position != -1)
 		{
 		/* schedule an interuption for the next transmission */
 		op_intrpt_schedule_self (op_sim_time (), Data_Pkt_To_Send);
 		
 		/* get the subqueue */
-		current_queue = queue;
+		current_queue = queue_index.chain[position];
 		}
 	
 	FOUT;
@@ -4447,74 +4732,110 @@ static void lr_wpan_subq_checking ()
 
 
 /*
- * Function:	lr_wpan_get_rx_seqn
+ * Function:	lr_wpan_rx_seqn_entry
+ *
+ * Description:	get the entry of a source device in the table of the
+ *				received sequence numbers. The table is indexed by the
+ *				position of the devices in the node list, it is sized
+ *				from the node list on the first reception and enlarged
+ *				if devices are recorded later.
+ *
+ * ParamIn:		int mac_address
+ *				MAC address of the source device
+ *
+ * ParamOut:	int * entry
+ *				last sequence number received from the device (-1 if none)
  */
 
-static int lr_wpan_get_rx_seqn (int mac_address)
+static int * lr_wpan_rx_seqn_entry (int mac_address)
 {
-	Mac_Data_Seqn * element;
-	int list_size; // = op_prg_list_size (Mac_Data_Rx_Seqn);
-	int i; // loop variable
-	
+	int node_index;
+	int old_size;
+	int * old_table;
+	int i;
 	
-	FIN (lr_wpan_get_rx_seqn (mac_address));
+	FIN (lr_wpan_rx_seqn_entry (mac_address));
 	
-	list_size = op_prg_list_size (Mac_Data_Rx_Seqn);
+	if ((node_index = wpan_search_mac_address (mac_address)) == -1)
+		lr_wpan_mac_error ("lr_wpan_rx_seqn_entry:", "The MAC source address doesn't exist.", OPC_NIL);
 	
-	for (i=0; i<list_size; i++)
+	if (node_index >= Mac_Data_Rx_Seqn_Size)
 		{
-		/* get the ith element */
-		element = op_prg_list_access (Mac_Data_Rx_Seqn, i);
+		old_table = Mac_Data_Rx_Seqn;
+		old_size = Mac_Data_Rx_Seqn_Size;
+		
+		Mac_Data_Rx_Seqn_Size = op_prg_list_size (wpan_node_param_list);
+		if (Mac_Data_Rx_Seqn_Size < 2 * old_size)
+			Mac_Data_Rx_Seqn_Size = 2 * old_size;
+		if (Mac_Data_Rx_Seqn_Size <= node_index)
+			Mac_Data_Rx_Seqn_Size = node_index + 1;
 		
-		if (element->mac_address == mac_address)
-			FRET (element->seqn);
+		Mac_Data_Rx_Seqn = (int *) op_prg_mem_alloc (Mac_Data_Rx_Seqn_Size * sizeof (int));
+		
+		/* no sequence number received from the new devices */
+		for (i = 0; i < Mac_Data_Rx_Seqn_Size; i++)
+			Mac_Data_Rx_Seqn[i] = (i < old_size) ? old_table[i] : -1;
+		
+		if (old_table != OPC_NIL)
+			op_prg_mem_free (old_table);
 		}
 	
-	/* if the MAC address is not present, we initialize it */
-	lr_wpan_set_rx_seqn (mac_address, -1);
-	
-	FRET (-1);
+	FRET (&Mac_Data_Rx_Seqn[node_index]);
 }
 
 
 /*
- * Function:	lr_wpan_set_rx_seqn
+ * Function:	lr_wpan_rx_seqn_check
+ *
+ * Description:	duplicate detection of the received data frames: the
+ *				frame is new if its sequence number is not the last
+ *				one received from the source device. The sequence
+ *				number of a new frame is recorded.
+ *
+ * ParamIn:		int mac_address
+ *				MAC address of the source device
+ *
+ *				int seqn
+ *				sequence number of the received frame
+ *
+ * ParamOut:	Boolean new_frame
+ *				OPC_TRUE if the frame is not a duplicate
  */
 
-static void lr_wpan_set_rx_seqn (int mac_address, int seqn)
+static Boolean lr_wpan_rx_seqn_check (int mac_address, int seqn)
 {
-	Mac_Data_Seqn * element;
-	int list_size; // = op_prg_list_size (Mac_Data_Rx_Seqn);
-	int i; // loop variable
+	int * entry;
 	
-	FIN (lr_wpan_set_rx_seqn (mac_address, seqn));
+	FIN (lr_wpan_rx_seqn_check (mac_address, seqn));
 	
-	list_size = op_prg_list_size (Mac_Data_Rx_Seqn);
-	
-	/* search for an existing element */
-	for (i=0; i<list_size; i++)
-		{
-		/* get the ith element */
-		element = op_prg_list_access (Mac_Data_Rx_Seqn, i);
-		
-		if (element->mac_address == mac_address)
-			{
-			element->seqn = seqn;
-			FOUT;
-			}
-		}
+	entry = lr_wpan_rx_seqn_entry (mac_address);
 	
-	/* if we are here, no sequence number exist yet */
-	/* we create a new one */
-	element = (Mac_Data_Seqn *) op_prg_mem_alloc (sizeof (Mac_Data_Seqn));
+	if (*entry == seqn)
+		FRET (OPC_FALSE);
 	
-	element->mac_address = mac_address;
-	element->seqn = seqn;
+	*entry = seqn;
 	
-	/* insert this element into the list */
-	op_prg_list_insert (Mac_Data_Rx_Seqn, element, OPC_LISTPOS_TAIL);
+	FRET (OPC_TRUE);
+}
+
+
+/*
+ * Function:	lr_wpan_get_rx_seqn
+ *
+ * Description:	get the last sequence number received from a device
+ *
+ * ParamIn:		int mac_address
+ *				MAC address of the source device
+ *
+ * ParamOut:	int seqn
+ *				sequence number, -1 if no frame has been received
+ */
+
+static int lr_wpan_get_rx_seqn (int mac_address)
+{
+	FIN (lr_wpan_get_rx_seqn (mac_address));
 	
-	FOUT;
+	FRET (*lr_wpan_rx_seqn_entry (mac_address));
 }
 
 
@@ -4661,7 +4982,7 @@ static void lr_wpan_collect_stat ()
 	
 	original end*/
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	/* get the report name */
 	sprintf (report_name, "%s%s", lr_wpan_node_name, packet_sent);
@@ -4694,7 +5015,7 @@ static void lr_wpan_collect_stat ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 
 		
 	/*ORIGINAL sprintf (report_name, "%s%s", lr_wpan_node_name, packet_rcv);
@@ -4734,7 +5055,7 @@ static void lr_wpan_collect_stat ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	
 	
@@ -4766,7 +5087,7 @@ static void lr_wpan_collect_stat ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
      ORIGINAL END*/
 	
 	
@@ -4804,7 +5125,7 @@ static void lr_wpan_collect_stat ()
 		/* print the return char */
 		fprintf (fp, "%s, %s", double_to_string (op_sim_time (), strlen ("simulation time")), date_str);
 		
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 		}
 	
 	
@@ -4836,7 +5157,7 @@ static void lr_wpan_collect_stat ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	if (!bulk_data_source)
 		{
@@ -4871,7 +5192,7 @@ static void lr_wpan_collect_stat ()
 			double_to_string (op_sim_time (), strlen ("simulation time")),
 			date_str);
 		
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 		}
 	
 	/***************************************************************************************************/	
@@ -4890,7 +5211,7 @@ static void lr_wpan_collect_stat ()
 		}
 	fprintf (fp, "%s\t %s\t %s", integer_to_string (statistic.Beacon_Frame_Sent, strlen ("Beacon frame sent")),
 		double_to_string (op_sim_time (), strlen ("simulation time")), date_str);
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 
 	
 	/* Report the number of beacons received */
@@ -4917,7 +5238,7 @@ static void lr_wpan_collect_stat ()
 		integer_to_string (statistic.Beacon_Frame_Lost, strlen ("Beacon Frame Lostt")),
 		double_to_string  (op_sim_time (), 
 		strlen ("simulation time")), date_str);
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 
 	FOUT;
 }
@@ -4998,7 +5319,7 @@ static void lr_wpan_collect_performance_info1 ()
 			date_str
 			);
 		
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 
 	}
 
@@ -5047,7 +5368,7 @@ static void lr_wpan_collect_performance_info2 ()
 			double_to_string (packet_loss,  7),					
 			double_to_string (mac_delay,   10)			
 			);
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	/* Report the global statistics (By the PNC)*/
 	
@@ -5078,7 +5399,7 @@ static void lr_wpan_collect_performance_info2 ()
 			double_to_string (global_mac_delay,   10)			
 			);
 
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 	}
 	
 	FOUT;
@@ -5118,7 +5439,6 @@ static void lr_wpan_collect_stat_nodes ()
 	double mac_delay;
 	
 	const char * subdirectory	= "\\nodes\\";
-	const char * subdirectory_retx	= "\\retransmissions\\";
 	
 	const char * packet_rcv        = "_pkt_rcv.txt";
 	const char * packet_sent       = "_pkt_sent.txt";
@@ -5128,17 +5448,11 @@ static void lr_wpan_collect_stat_nodes ()
 	const char * beacon_frame_sent = "_beacon_frame_sent.txt";
 	const char * beacon_frame_rcv  = "_beacon_frame_rcv.txt";
 	
-	const char * retransmission_list = "_retransmission_list.txt";
-	const char * transmission_list = "_transmission_list.txt";
-	
 	Wpan_Queue * queue;
 	int i; // loop variable
 	time_t date;
 	char date_str[32];
 	
-	retx* elem_ptr;
-	tx* elem1_ptr;
-	
 	FIN (lr_wpan_collect_stat_nodes ());
 	
 	//printf("starting ENDSIM of node %s\n", lr_wpan_node_name);
@@ -5180,7 +5494,7 @@ static void lr_wpan_collect_stat_nodes ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	
 	/* PACKET SENT -- get the report name */
@@ -5217,7 +5531,7 @@ static void lr_wpan_collect_stat_nodes ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	/* QUEUES */
 	if (wpan_queue != NULL)
@@ -5253,7 +5567,7 @@ static void lr_wpan_collect_stat_nodes ()
 		/* print the return char */
 		fprintf (fp, "%s\t %s", double_to_string (op_sim_time (), strlen ("simulation time")), date_str);
 		
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 		}
 	
 	
@@ -5285,7 +5599,7 @@ static void lr_wpan_collect_stat_nodes ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	
 	if (!bulk_data_source)
@@ -5320,7 +5634,7 @@ static void lr_wpan_collect_stat_nodes ()
 			double_to_string (op_sim_time (), strlen ("simulation time")),
 			date_str);
 		
-		fclose (fp);
+		lr_wpan_close_report_file (fp);
 		}
 	
 	
@@ -5341,7 +5655,7 @@ static void lr_wpan_collect_stat_nodes ()
 		}
 	fprintf (fp, "%s\t %s\t %s", integer_to_string (statistic.Beacon_Frame_Sent, strlen ("Beacon frame sent")),
 		double_to_string (op_sim_time (), strlen ("simulation time")), date_str);
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 
 	
 	/* Report the number of BEACONS RECEIVED */
@@ -5369,69 +5683,94 @@ static void lr_wpan_collect_stat_nodes ()
 		integer_to_string (statistic.Beacon_Frame_Lost, strlen ("Beacon Frame Lost")),
 		double_to_string  (op_sim_time (), 
 		strlen ("simulation time")), date_str);
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 
 	
-	/* Report information about the RETRANSMISSIONS */
-	/* get the report name */
-	sprintf (report_name, "%s%s%s", subdirectory_retx, lr_wpan_node_name, retransmission_list);
-	
-	/* open the report file */
-	
-	fp = lr_wpan_open_report_file (report_name, &exist);
-	
-	/* write a header in the file if it has been created now */
-	
-	if (!exist)
-		{
-		fprintf (fp, "\n\t*** Information about retransmissions for the node %s ***\n", lr_wpan_node_name);
-		fprintf (fp, "\tTime\t retransmissions\t \n\n");
-		}
-	
-	elem_ptr = (retx*) op_prg_mem_alloc( sizeof(retx) );
-	/*if(!strcmp(lr_wpan_node_name,"coordinator"))
-		printf("stat node intermediate 2.3: %s\n", lr_wpan_node_name);*/
-	for(i=0; i<op_prg_list_size (statistic_retx_list_ptr); i++)
-		{
-		elem_ptr = op_prg_list_access (statistic_retx_list_ptr, i);
-		fprintf (fp, "%s\t %s\n",
-			double_to_string (elem_ptr->time,10),
-			integer_to_string ((int)elem_ptr->retransmissions, 10)
-			);
-		}
-	fprintf(fp, "--------------------------------------------------\n");
-	
-	fclose (fp);
-	
-	/* get the report name */
-	sprintf (report_name, "%s%s%s", subdirectory_retx, lr_wpan_node_name, transmission_list);
-	/* open the report file */
-	fp = lr_wpan_open_report_file (report_name, &exist);
-	/* write a header in the file if it has been created now */
-	if (!exist)
-		{
-		fprintf (fp, "\n\t*** Information about transmissions for the node %s ***\n", lr_wpan_node_name);
-		fprintf (fp, "\tTime\t transmissions\t \n\n");
-		}
+	/* write the last records of the RETRANSMISSIONS and TRANSMISSIONS lists */
+	lr_wpan_time_histogram_close (statistic_retx_hist);
+	statistic_retx_hist = OPC_NIL;
 	
-	elem1_ptr = (tx*) op_prg_mem_alloc( sizeof(tx) );
-	for(i=0; i<op_prg_list_size (statistic_tx_list_ptr); i++)
-		{
-		elem1_ptr = op_prg_list_access (statistic_tx_list_ptr, i);
-		fprintf (fp, "%s\t %s\n",
-			double_to_string (elem1_ptr->time,10),
-			integer_to_string ((int)elem1_ptr->transmissions, 10)
-			);
-		}
-	fprintf(fp, "--------------------------------------------------\n");
+	lr_wpan_time_histogram_close (statistic_tx_hist);
+	statistic_tx_hist = OPC_NIL;
 	
-	fclose (fp);
 	if(!strcmp(lr_wpan_node_name,"coordinator"))
 		printf("stat node: %s\n", lr_wpan_node_name);
 	FOUT;
 }
 
 
+/*
+ * Function:	lr_wpan_sum_stat_shards
+ *
+ * Description:	sum the shards of all the MACs. A MAC only writes in its
+ *				own shard and the sums are built aside before being
+ *				copied, so the reader never modifies the counters of
+ *				the MACs
+ *
+ * ParamOut:	Global_Stat_Vector * global_ptr
+ *				sum of the global statistics
+ *
+ *				Wpan_CCA_Vector * cca_ptr
+ *				sum of the CCA statistics
+ */
+
+static void lr_wpan_sum_stat_shards (Global_Stat_Vector * global_ptr, Wpan_CCA_Vector * cca_ptr)
+{
+	Wpan_Stat_Shard * shard;
+	Global_Stat_Vector global_sum;
+	Wpan_CCA_Vector cca_sum;
+	int i, nb_shards;
+	
+	FIN (lr_wpan_sum_stat_shards (global_ptr, cca_ptr));
+	
+	memset (&global_sum, 0, sizeof (Global_Stat_Vector));
+	memset (&cca_sum, 0, sizeof (Wpan_CCA_Vector));
+	
+	nb_shards = (stat_shard_list == OPC_NIL) ? 0 : op_prg_list_size (stat_shard_list);
+	
+	for (i = 0; i < nb_shards; i++)
+		{
+		shard = (Wpan_Stat_Shard *) op_prg_list_access (stat_shard_list, i);
+		
+		global_sum.Data_Pkt_Rcv += shard->global.Data_Pkt_Rcv;
+		global_sum.Segment_generated += shard->global.Segment_generated;
+		global_sum.Data_Pkt_Sent += shard->global.Data_Pkt_Sent;
+		global_sum.Data_Req_Send += shard->global.Data_Req_Send;
+		global_sum.Ack_Pkt_Rcv += shard->global.Ack_Pkt_Rcv;
+		global_sum.Ack_Pkt_Sent += shard->global.Ack_Pkt_Sent;
+		global_sum.Pkt_Lost += shard->global.Pkt_Lost;
+		global_sum.Pkt_Collided += shard->global.Pkt_Collided;
+		global_sum.Pkt_Noise += shard->global.Pkt_Noise;
+		global_sum.Pkt_Dropped += shard->global.Pkt_Dropped;
+		global_sum.Pkt_Dropped_CCA += shard->global.Pkt_Dropped_CCA;
+		global_sum.Pkt_Dropped_retx += shard->global.Pkt_Dropped_retx;
+		global_sum.Segment_Dropped += shard->global.Segment_Dropped;
+		global_sum.Retransmission += shard->global.Retransmission;
+		global_sum.Total_Bits_Rcv += shard->global.Total_Bits_Rcv;
+		global_sum.Total_number_backoff_slots += shard->global.Total_number_backoff_slots;
+		global_sum.Total_Ack_not_rcv += shard->global.Total_Ack_not_rcv;
+		global_sum.Total_backoff_wait_for_beacon += shard->global.Total_backoff_wait_for_beacon;
+		global_sum.Total_Delay_Dropped_packets += shard->global.Total_Delay_Dropped_packets;
+		global_sum.Pkt_not_enqueued += shard->global.Pkt_not_enqueued;
+		global_sum.Application_generated += shard->global.Application_generated;
+		
+		cca_sum.First_CCA_count += shard->cca.First_CCA_count;
+		cca_sum.First_CCA_Success_Count += shard->cca.First_CCA_Success_Count;
+		cca_sum.First_CCA_Failure_Count += shard->cca.First_CCA_Failure_Count;
+		cca_sum.Second_CCA_count += shard->cca.Second_CCA_count;
+		cca_sum.Second_CCA_Success_Count += shard->cca.Second_CCA_Success_Count;
+		cca_sum.Second_CCA_Failure_Count += shard->cca.Second_CCA_Failure_Count;
+		cca_sum.Total_CCA_Count += shard->cca.Total_CCA_Count;
+		cca_sum.Total_CCA_Success_Count += shard->cca.Total_CCA_Success_Count;
+		}
+	
+	*global_ptr = global_sum;
+	*cca_ptr = cca_sum;
+	
+	FOUT;
+}
+
+
 /*
  * Function:	lr_wpan_collect_stat_global (coded by Flavia Martelli)
  *
@@ -5454,24 +5793,17 @@ static void lr_wpan_collect_stat_global ()
 	time_t date;
 	char date_str[32];
 	
-	retx* elem_ptr;
-	tx* elem1_ptr;
-	stack_change* elem2_ptr;
-	stack_change* elem3_ptr;
 	int i;
 	//char traffic_name[10] = "G_";
-	char service_str[100];
 	
 	
 	
 	
 	FIN (lr_wpan_collect_stat_global ());
-	printf("node %s goes collect stat global\n", lr_wpan_node_name);
 	
-	elem_ptr = (retx*) op_prg_mem_alloc( sizeof(retx) );
-	elem1_ptr = (tx*) op_prg_mem_alloc( sizeof(tx) );
-	elem2_ptr = (stack_change*) op_prg_mem_alloc( sizeof(stack_change) );
-	elem3_ptr = (stack_change*) op_prg_mem_alloc( sizeof(stack_change) );
+	/* sum the statistics of all the MACs, once they are all stopped */
+	lr_wpan_sum_stat_shards (&global_statistics, &Global_CCA_Statistics);
+	printf("node %s goes collect stat global\n", lr_wpan_node_name);
 	
 	/* get the date of the day */
 	time (&date);
@@ -5556,7 +5888,7 @@ static void lr_wpan_collect_stat_global ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 		
 	/* cretae a  .txt file without headers, for Matlab postprocessing */
@@ -5587,65 +5919,24 @@ static void lr_wpan_collect_stat_global ()
 		integer_to_string ((int)global_statistics.Total_Ack_not_rcv, 10),
 		double_to_string (op_sim_time (), strlen ("simulation time")));
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
-	/* create a file with information about protocol stack changes*/
-	if(GADGET_enabled)
+	/* write the last protocol stack changes*/
+	if(GADGET_enabled && stack_change_stream != OPC_NIL)
 		{
-		sprintf (report_name, "%s_stack_changes.txt", lr_wpan_scenario);
-		
-		/* open the report file */
-		fp = lr_wpan_open_report_file (report_name, &exist);
-		if (!exist)
-			{
-			fprintf (fp, "\n\t*** Global information about protocol stack changes for the scenario %s ***\n", lr_wpan_scenario);
-			fprintf (fp, "\tTime\t Slotted ALOHA\t PSMA\t Observed Traffic\t Observed SNR\n\n");
-			}
-		for(i=0; i<op_prg_list_size (list_stack_change_ptr); i++)
-			{
-			//printf("printing stack changes\n");
-			elem2_ptr = op_prg_list_access (list_stack_change_ptr, i);
-			fprintf (fp, "%s\t %s\t %s\t %s\t %s\n",
-				double_to_string (elem2_ptr->time,10),
-				integer_to_string ((int)elem2_ptr->s_aloha_status, 10),
-				integer_to_string ((int)elem2_ptr->psma_status, 10),
-				double_to_string (elem2_ptr->observed_traffic,10),
-				double_to_string (elem2_ptr->observed_snr,10)
-				);
-			}
-	
-		fprintf(fp, "--------------------------------------------------\n");
-	
-		fclose (fp);
+		lr_wpan_record_stream_close (stack_change_stream);
+		stack_change_stream = OPC_NIL;
 		}
 	
-	/* create a file with information about superframe average SNR and Traffic*/
-	
-	sprintf (report_name, "%s_superframe_Traffic_and_SNR.txt", lr_wpan_scenario);
-		
-	/* open the report file */
-	fp = lr_wpan_open_report_file (report_name, &exist);
-	if (!exist)
+	/* write the last superframe average SNR and Traffic*/
+	if (traffic_snr_stream != OPC_NIL)
 		{
-		fprintf (fp, "\n\t*** Global information about Traffic and SNR for the scenario %s ***\n", lr_wpan_scenario);
-		fprintf (fp, "\tTime\t Slotted ALOHA\t PSMA\t Observed Traffic\t Observed SNR\n\n");
-		}
-	for(i=0; i<op_prg_list_size (list_traffic_snr_ptr); i++)
-		{
-		//printf("printing traffic and SNR\n");
-		elem3_ptr = op_prg_list_access (list_traffic_snr_ptr, i);
-		fprintf (fp, "%s\t %s\t %s\t %s\t %s\n",
-			double_to_string (elem3_ptr->time,10),
-			integer_to_string ((int)elem3_ptr->s_aloha_status, 10),
-			integer_to_string ((int)elem3_ptr->psma_status, 10),
-			double_to_string (elem3_ptr->observed_traffic,10),
-			double_to_string (elem3_ptr->observed_snr,10)
-		);
+		lr_wpan_record_stream_close (traffic_snr_stream);
+		traffic_snr_stream = OPC_NIL;
 		}
 	
-	fprintf(fp, "--------------------------------------------------\n");
-	
-	fclose (fp);
+	/* write the binary trace of the MAC events */
+	lr_wpan_trace_buffer_close ();
 
 	
 	/* create a file with information about retransmissions*/
@@ -5672,7 +5963,7 @@ static void lr_wpan_collect_stat_global ()
 	
 	fprintf(fp, "--------------------------------------------------\n");
 	
-	fclose (fp);*/
+	lr_wpan_close_report_file (fp);*/
 	
 	/* get the report name */
 	//sprintf (report_name, "%s_transmissions.txt", lr_wpan_scenario);
@@ -5697,14 +5988,13 @@ static void lr_wpan_collect_stat_global ()
 	
 	fprintf(fp, "--------------------------------------------------\n");
 	
-	fclose (fp);*/
+	lr_wpan_close_report_file (fp);*/
 	
 	// method to create separate files with traffic as identifier in file name
 	// sprintf (service_str, "%s%s%.2f_%s", file_service_time, traffic_name, G_offered, service_name);
 	
-	sprintf (service_str, "%s%s", file_service_time, service_name);
-	
-	fp_service_time = fopen (service_str, "a");
+	/* the service times are written with the other reports, under the "Report Path" of the channel */
+	fp_service_time = lr_wpan_open_report_file (service_name, &exist);
 	
 	for (i=0;i<MAX_SERV_TIME;i++)
 		{
@@ -5713,7 +6003,7 @@ static void lr_wpan_collect_stat_global ()
 		}
 	fprintf(fp_service_time, "\n");
 	
-	fclose (fp_service_time);
+	lr_wpan_close_report_file (fp_service_time);
 	
 	FOUT;
 }
@@ -5821,7 +6111,7 @@ WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET (OP_SIM_CONTEXT_ARG_OPT)
 					lr_wpan_slotted_generate_addr_table (my_parameters, &lr_wpan_beacon_param);
 				
 					/* schedule the first Beacon packet */
-					op_intrpt_schedule_self (lr_wpan_slotted_boundary_time (), Wpan_Beacon_To_Send);
+					op_intrpt_schedule_self (lr_wpan_next_backoff_boundary (), Wpan_Beacon_To_Send);
 					}
 				
 				
@@ -5885,10 +6175,10 @@ WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET (OP_SIM_CONTEXT_ARG_OPT)
 							
 								/* update the statistic */
 								statistic.Pkt_Dropped ++;
-								global_statistics.Pkt_Dropped ++;
+								stat_shard->global.Pkt_Dropped ++;
 								
 								statistic.Pkt_Dropped_retx ++;
-								global_statistics.Pkt_Dropped_retx ++;
+								stat_shard->global.Pkt_Dropped_retx ++;
 								/*
 								* we have to count the segment dropped
 								* in the function "lr_wpan_destroy_retransmission"
@@ -6100,7 +6390,7 @@ WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET (OP_SIM_CONTEXT_ARG_OPT)
 					if (my_parameters->slotted_enable)
 						{
 						/* if we are in the slotted mode, we start the timer at the boundary 
-						Ack_TimeOut_Evhandle = op_intrpt_schedule_self (lr_wpan_slotted_boundary_time () + MAC_ACK_WAIT_DURATION, Ack_Time_Out);
+						Ack_TimeOut_Evhandle = op_intrpt_schedule_self (lr_wpan_next_backoff_boundary () + MAC_ACK_WAIT_DURATION, Ack_Time_Out);
 						}
 					else
 						Ack_TimeOut_Evhandle = op_intrpt_schedule_self (op_sim_time () + MAC_ACK_WAIT_DURATION, Ack_Time_Out);
@@ -6197,10 +6487,10 @@ WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET (OP_SIM_CONTEXT_ARG_OPT)
 						}
 					/* update the statistic */
 					statistic.Pkt_Dropped ++;
-					global_statistics.Pkt_Dropped ++;
+					stat_shard->global.Pkt_Dropped ++;
 					
 					statistic.Pkt_Dropped_CCA ++;
-					global_statistics.Pkt_Dropped_CCA ++;
+					stat_shard->global.Pkt_Dropped_CCA ++;
 					
 					
 					
@@ -6220,12 +6510,12 @@ WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET (OP_SIM_CONTEXT_ARG_OPT)
 					if(CCA_stage ==2)
 						{
 						CCA_statistic.Second_CCA_Success_Count++;
-						Global_CCA_Statistics.Second_CCA_Success_Count++;
+						stat_shard->cca.Second_CCA_Success_Count++;
 						}
 					else if(CCA_stage ==1)
 						{
 						CCA_statistic.First_CCA_Success_Count++;
-						Global_CCA_Statistics.First_CCA_Success_Count++;
+						stat_shard->cca.First_CCA_Success_Count++;
 						}
 				
 					}
@@ -6234,13 +6524,13 @@ WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET (OP_SIM_CONTEXT_ARG_OPT)
 					if(CCA_stage ==2)
 						{
 						CCA_statistic.Second_CCA_Failure_Count++;
-						Global_CCA_Statistics.Second_CCA_Failure_Count++;
+						stat_shard->cca.Second_CCA_Failure_Count++;
 				 
 						}
 					else if(CCA_stage ==1)
 						{
 						CCA_statistic.First_CCA_Failure_Count++;
-						Global_CCA_Statistics.First_CCA_Failure_Count++;
+						stat_shard->cca.First_CCA_Failure_Count++;
 				 
 						}
 					}
@@ -6472,6 +6762,7 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_terminate (OP_SIM_CON
 #undef nb_pkt_send
 #undef retransmission_ptr
 #undef Mac_Data_Rx_Seqn
+#undef Mac_Data_Rx_Seqn_Size
 #undef Rx_Ack_Expected
 #undef Tx_Ack_Require
 #undef Ack_TimeOut_Evhandle
@@ -6484,6 +6775,8 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_terminate (OP_SIM_CON
 #undef TAT_RX_Evhandle
 #undef wpan_transmission_required
 #undef current_queue
+#undef queue_index
+#undef trace_mask
 #undef max_frame_retries
 #undef nb_transmission_retries
 #undef own_process_record_handle
@@ -6522,9 +6815,9 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_terminate (OP_SIM_CON
 #undef BE_handle
 #undef backoff_interval_handle
 #undef cca_stat_handle
-#undef statistic_retx_list_ptr
+#undef statistic_retx_hist
 #undef aloha_cw
-#undef statistic_tx_list_ptr
+#undef statistic_tx_hist
 #undef ideal_poisson_traffic
 #undef GADGET_enabled
 #undef GADGET_snr
@@ -6532,6 +6825,7 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_terminate (OP_SIM_CON
 #undef GADGET_sma_snr
 #undef GADGET_sma_traffic
 #undef GADGET_sma_counter
+#undef stat_shard
 #undef lecim_enabled
 #undef pca_used_enabled
 #undef data_rate
@@ -6665,6 +6959,11 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_svar (void * gen_ptr,
 		*var_p_ptr = (void *) (&prs_ptr->Mac_Data_Rx_Seqn);
 		FOUT
 		}
+	if (strcmp ("Mac_Data_Rx_Seqn_Size" , var_name) == 0)
+		{
+		*var_p_ptr = (void *) (&prs_ptr->Mac_Data_Rx_Seqn_Size);
+		FOUT
+		}
 	if (strcmp ("Rx_Ack_Expected" , var_name) == 0)
 		{
 		*var_p_ptr = (void *) (&prs_ptr->Rx_Ack_Expected);
@@ -6725,6 +7024,16 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_svar (void * gen_ptr,
 		*var_p_ptr = (void *) (&prs_ptr->current_queue);
 		FOUT
 		}
+	if (strcmp ("queue_index" , var_name) == 0)
+		{
+		*var_p_ptr = (void *) (&prs_ptr->queue_index);
+		FOUT
+		}
+	if (strcmp ("trace_mask" , var_name) == 0)
+		{
+		*var_p_ptr = (void *) (&prs_ptr->trace_mask);
+		FOUT
+		}
 	if (strcmp ("max_frame_retries" , var_name) == 0)
 		{
 		*var_p_ptr = (void *) (&prs_ptr->max_frame_retries);
@@ -6915,9 +7224,9 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_svar (void * gen_ptr,
 		*var_p_ptr = (void *) (&prs_ptr->cca_stat_handle);
 		FOUT
 		}
-	if (strcmp ("statistic_retx_list_ptr" , var_name) == 0)
+	if (strcmp ("statistic_retx_hist" , var_name) == 0)
 		{
-		*var_p_ptr = (void *) (&prs_ptr->statistic_retx_list_ptr);
+		*var_p_ptr = (void *) (&prs_ptr->statistic_retx_hist);
 		FOUT
 		}
 	if (strcmp ("aloha_cw" , var_name) == 0)
@@ -6925,9 +7234,9 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_svar (void * gen_ptr,
 		*var_p_ptr = (void *) (&prs_ptr->aloha_cw);
 		FOUT
 		}
-	if (strcmp ("statistic_tx_list_ptr" , var_name) == 0)
+	if (strcmp ("statistic_tx_hist" , var_name) == 0)
 		{
-		*var_p_ptr = (void *) (&prs_ptr->statistic_tx_list_ptr);
+		*var_p_ptr = (void *) (&prs_ptr->statistic_tx_hist);
 		FOUT
 		}
 	if (strcmp ("ideal_poisson_traffic" , var_name) == 0)
@@ -6965,6 +7274,11 @@ _op_WPAN_802_15_4a_MAC_PSMA_LECIM_and_Slotted_ALOHA_GADGET_svar (void * gen_ptr,
 		*var_p_ptr = (void *) (&prs_ptr->GADGET_sma_counter);
 		FOUT
 		}
+	if (strcmp ("stat_shard" , var_name) == 0)
+		{
+		*var_p_ptr = (void *) (&prs_ptr->stat_shard);
+		FOUT
+		}
 	if (strcmp ("lecim_enabled" , var_name) == 0)
 		{
 		*var_p_ptr = (void *) (&prs_ptr->lecim_enabled);
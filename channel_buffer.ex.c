@@ -56,10 +56,344 @@ void	channel_buffer_error (char * fcnt, char * msg, char * opt)
 }
 
 
+/* last cell of the buffer list, to append the packets in constant time */
+static Buff_Info_Packet *	channel_buffer_tail = NULL;
+
+/* delivery heap: in-flight packets ordered by delivery time */
+static Buff_Info_Packet **	channel_buffer_heap = NULL;
+static int					channel_buffer_heap_size = 0;
+static int					channel_buffer_heap_capacity = 0;
+static unsigned int			channel_buffer_heap_order = 0;
+
+/* hash table of the in-flight packets indexed by packet ID (the number of buckets is a power of 2) */
+static Buff_Info_Packet **	channel_buffer_hash = NULL;
+static int					channel_buffer_hash_buckets = 0;
+static int					channel_buffer_hash_count = 0;
+
+#define CHANNEL_BUFFER_INIT_CAPACITY	64
+
+/* pools of fixed size objects (buffer cells and collision references), allocated by slabs */
+#define CHANNEL_BUFFER_SLAB_OBJECTS		256
+
+typedef struct T_buffer_slab {
+  struct T_buffer_slab *	next_slab;
+  double					align; // keep the objects aligned after the header
+} Buff_Slab;
+
+typedef struct {
+  size_t			object_size; // size of the objects
+  void *			free_objects; // free objects, linked by their first word
+  Buff_Slab *		slabs; // allocated slabs
+  Buff_Pool_Stat	stat;
+} Buff_Pool;
+
+static Buff_Pool	channel_buffer_cell_pool = {sizeof (Buff_Info_Packet), NULL, NULL};
+static Buff_Pool	channel_buffer_collision_pool = {sizeof (Buff_Collision), NULL, NULL};
+
+/* local function prototypes */
+static void *	channel_buffer_pool_alloc (Buff_Pool * pool);
+static void		channel_buffer_pool_free (Buff_Pool * pool, void * object);
+static void		channel_buffer_pool_release (Buff_Pool * pool);
+static void		channel_buffer_pool_reset_stat (Buff_Pool * pool);
+static void		channel_buffer_collision_add (Buff_Info_Packet * packet, Buff_Info_Packet * interferer);
+static void		channel_buffer_cell_release (Buff_Info_Packet * packet);
+static void		channel_buffer_heap_insert (Buff_Info_Packet * packet);
+static void		channel_buffer_heap_remove (Buff_Info_Packet * packet);
+static void		channel_buffer_heap_sift_up (int index);
+static void		channel_buffer_heap_sift_down (int index);
+static Boolean	channel_buffer_heap_before (const Buff_Info_Packet * packet_a, const Buff_Info_Packet * packet_b);
+static void		channel_buffer_hash_insert (Buff_Info_Packet * packet);
+static void		channel_buffer_hash_remove (Buff_Info_Packet * packet);
+static void		channel_buffer_hash_resize (int nb_buckets);
+
+
+/*
+ * Function:	channel_buffer_init
+ *
+ * Description:	reset the channel buffer. Must be called by the channel
+ *				process before the first packet is registered.
+ */
+
+void channel_buffer_init (void)
+{
+	int i;
+	
+	FIN (channel_buffer_init ());
+	
+	/* empty the buffer list */
+	channel_buffer_ptr = NULL;
+	channel_buffer_tail = NULL;
+	
+	/* empty the delivery heap */
+	if (channel_buffer_heap == NULL)
+		{
+		channel_buffer_heap_capacity = CHANNEL_BUFFER_INIT_CAPACITY;
+		channel_buffer_heap = (Buff_Info_Packet **) op_prg_mem_alloc (channel_buffer_heap_capacity * sizeof (Buff_Info_Packet *));
+		}
+	
+	channel_buffer_heap_size = 0;
+	channel_buffer_heap_order = 0;
+	
+	/* empty the packet ID hash table */
+	if (channel_buffer_hash == NULL)
+		{
+		channel_buffer_hash_buckets = CHANNEL_BUFFER_INIT_CAPACITY;
+		channel_buffer_hash = (Buff_Info_Packet **) op_prg_mem_alloc (channel_buffer_hash_buckets * sizeof (Buff_Info_Packet *));
+		}
+	
+	for (i = 0; i < channel_buffer_hash_buckets; i++)
+		channel_buffer_hash[i] = NULL;
+	
+	channel_buffer_hash_count = 0;
+	
+	/* reset the statistics of the pools */
+	channel_buffer_pool_reset_stat (&channel_buffer_cell_pool);
+	channel_buffer_pool_reset_stat (&channel_buffer_collision_pool);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_release
+ *
+ * Description:	empty the channel buffer and give back to the
+ *				heap all the memory used by the buffer at once
+ *				(cell slabs and indexes).
+ */
+
+void channel_buffer_release (void)
+{
+	FIN (channel_buffer_release ());
+	
+	/* free all the slabs of cells and collision references */
+	channel_buffer_pool_release (&channel_buffer_cell_pool);
+	channel_buffer_pool_release (&channel_buffer_collision_pool);
+	
+	/* free the indexes */
+	if (channel_buffer_heap != NULL)
+		op_prg_mem_free (channel_buffer_heap);
+	
+	if (channel_buffer_hash != NULL)
+		op_prg_mem_free (channel_buffer_hash);
+	
+	channel_buffer_heap = NULL;
+	channel_buffer_heap_size = 0;
+	channel_buffer_heap_capacity = 0;
+	channel_buffer_hash = NULL;
+	channel_buffer_hash_buckets = 0;
+	channel_buffer_hash_count = 0;
+	
+	/* empty the buffer list */
+	channel_buffer_ptr = NULL;
+	channel_buffer_tail = NULL;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_pool_stat_get
+ *
+ * Description:	get the statistics of the pools of the buffer
+ *
+ * ParamOut:	Buff_Pool_Stat * cell_stat_ptr
+ *				copy of the statistics of the packet cells
+ *
+ *				Buff_Pool_Stat * collision_stat_ptr
+ *				copy of the statistics of the collision references
+ */
+
+void channel_buffer_pool_stat_get (Buff_Pool_Stat * cell_stat_ptr, Buff_Pool_Stat * collision_stat_ptr)
+{
+	FIN (channel_buffer_pool_stat_get (cell_stat_ptr, collision_stat_ptr));
+	
+	*cell_stat_ptr = channel_buffer_cell_pool.stat;
+	*collision_stat_ptr = channel_buffer_collision_pool.stat;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_pool_alloc
+ *
+ * Description:	take an object from a pool, allocating
+ *				a new slab when the pool is empty
+ *
+ * ParamIn:		Buff_Pool * pool
+ *				pool of the object
+ *
+ * ParamOut:	void * object
+ *				pointer to the object
+ */
+
+static void * channel_buffer_pool_alloc (Buff_Pool * pool)
+{
+	Buff_Slab * slab;
+	char * object;
+	int i;
+	
+	FIN (channel_buffer_pool_alloc (pool));
+	
+	if (pool->free_objects == NULL)
+		{
+		/* allocate a new slab */
+		slab = (Buff_Slab *) op_prg_mem_alloc (sizeof (Buff_Slab) + CHANNEL_BUFFER_SLAB_OBJECTS * pool->object_size);
+		slab->next_slab = pool->slabs;
+		pool->slabs = slab;
+		pool->stat.nb_slabs++;
+		
+		/* chain its objects into the free list */
+		object = (char *) (slab + 1);
+		
+		for (i = 0; i < CHANNEL_BUFFER_SLAB_OBJECTS; i++, object += pool->object_size)
+			{
+			*((void **) object) = pool->free_objects;
+			pool->free_objects = object;
+			}
+		}
+	
+	/* take the first free object */
+	object = (char *) pool->free_objects;
+	pool->free_objects = *((void **) object);
+	
+	/* update the statistics */
+	pool->stat.nb_alloc++;
+	
+	if (++pool->stat.nb_in_use > pool->stat.max_in_use)
+		pool->stat.max_in_use = pool->stat.nb_in_use;
+	
+	FRET ((void *) object);
+}
+
+
+/*
+ * Function:	channel_buffer_pool_free
+ *
+ * Description:	give back an object to its pool
+ */
+
+static void channel_buffer_pool_free (Buff_Pool * pool, void * object)
+{
+	FIN (channel_buffer_pool_free (pool, object));
+	
+	*((void **) object) = pool->free_objects;
+	pool->free_objects = object;
+	
+	/* update the statistics */
+	pool->stat.nb_free++;
+	pool->stat.nb_in_use--;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_pool_release
+ *
+ * Description:	give back all the slabs of a pool to the heap
+ */
+
+static void channel_buffer_pool_release (Buff_Pool * pool)
+{
+	Buff_Slab * slab;
+	
+	FIN (channel_buffer_pool_release (pool));
+	
+	while ((slab = pool->slabs) != NULL)
+		{
+		pool->slabs = slab->next_slab;
+		op_prg_mem_free (slab);
+		}
+	
+	pool->free_objects = NULL;
+	pool->stat.nb_in_use = 0;
+	pool->stat.nb_slabs = 0;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_pool_reset_stat
+ *
+ * Description:	reset the allocation counters of a pool
+ */
+
+static void channel_buffer_pool_reset_stat (Buff_Pool * pool)
+{
+	FIN (channel_buffer_pool_reset_stat (pool));
+	
+	pool->stat.nb_alloc = 0.0;
+	pool->stat.nb_free = 0.0;
+	pool->stat.max_in_use = pool->stat.nb_in_use;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_collision_add
+ *
+ * Description:	record an interfering packet at the end of
+ *				the collision list of a packet
+ *
+ * ParamIn:		Buff_Info_Packet * packet
+ *				packet suffering the collision
+ *
+ *				Buff_Info_Packet * interferer
+ *				interfering packet
+ */
+
+static void channel_buffer_collision_add (Buff_Info_Packet * packet, Buff_Info_Packet * interferer)
+{
+	Buff_Collision * collision;
+	
+	FIN (channel_buffer_collision_add (packet, interferer));
+	
+	/* the interferer is shared, not copied */
+	collision = (Buff_Collision *) channel_buffer_pool_alloc (&channel_buffer_collision_pool);
+	collision->packet = interferer;
+	collision->next_collision = NULL;
+	(interferer->nb_references)++;
+	
+	if (packet->last_collision == NULL)
+		packet->collisions = collision;
+	else
+		packet->last_collision->next_collision = collision;
+	
+	packet->last_collision = collision;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_cell_release
+ *
+ * Description:	drop a reference to a packet cell and give
+ *				the cell back to the pool when it is no more used
+ */
+
+static void channel_buffer_cell_release (Buff_Info_Packet * packet)
+{
+	FIN (channel_buffer_cell_release (packet));
+	
+	if (--(packet->nb_references) == 0)
+		channel_buffer_pool_free (&channel_buffer_cell_pool, packet);
+	
+	FOUT;
+}
+
+
 /*
  * Function:	channel_buffer_register_packet
  *
- * Description:	record a packet into the channel buffer
+ * Description:	record a packet into the channel buffer.
+ *				A packet leaves the buffer when it is delivered, so
+ *				every packet of the buffer is still in the air and is
+ *				checked for a collision with the new one.
  *
  * ParamIn:		Buff_Info_Packet * packet
  *				pointer to the packet to be registered
@@ -75,29 +409,24 @@ void channel_buffer_register_packet (Buff_Info_Packet * packet)
 	if (packet == NULL)
 		channel_buffer_error ("channel_buffer_register_packet:", "The pointer to the packet to register is null.", OPC_NIL);
 	
-	/* initialize the packet browser */
-	if ((packet_browser = channel_buffer_ptr) == NULL)
-		{
-		/* copy the packet into the first cell */
+	/* check if the packets of the buffer overlap with the packet to register */
+	for (packet_browser = channel_buffer_ptr; packet_browser != NULL; packet_browser = packet_browser->next_packet)
+		channel_buffer_register_collision (packet_browser, packet);
+	
+	/* append the packet at the end of the buffer list */
+	packet->next_packet = NULL;
+	packet->prev_packet = channel_buffer_tail;
+	
+	if (channel_buffer_tail == NULL)
 		channel_buffer_ptr = packet;
-		}
 	else
-		{
-		while (packet_browser->next_packet != NULL)
-			{
-			/* check if the current packet is overlap with the packet to register */ 
-			channel_buffer_register_collision (packet_browser, packet);
-			
-			/* get the next cell */
-			packet_browser = packet_browser->next_packet;
-			}
-		
-		/* register the collision for the last current packet */
-		channel_buffer_register_collision (packet_browser, packet);
-		
-		/* copy the packet */
-		packet_browser->next_packet = packet;
-		}
+		channel_buffer_tail->next_packet = packet;
+	
+	channel_buffer_tail = packet;
+	
+	/* index the packet according to its delivery time and its ID */
+	channel_buffer_heap_insert (packet);
+	channel_buffer_hash_insert (packet);
 
 	FOUT;
 }
@@ -111,59 +440,293 @@ void channel_buffer_register_packet (Buff_Info_Packet * packet)
 
 void channel_buffer_remove_packet (Buff_Info_Packet * packet)
 {
-	Buff_Info_Packet * packet_browser;
+	Buff_Collision * collision;
 	
 	FIN (channel_buffer_remove_packet (packet));
 	
-	/* initialize the packet browser */
-	packet_browser = channel_buffer_ptr;
+	/* check if the packet is recorded in the buffer */
+	if (packet == NULL || (packet != channel_buffer_ptr && packet->prev_packet == NULL))
+		channel_buffer_error ("channel_buffer_remove_packet", "the packet to remove doesn't exixt", OPC_NIL);
 	
-	/* special case: if the packet to remove is the first one of the buffer */
-	if (packet_browser == packet)
-		{
-		/* remove the packet from the list */
+	/* remove the packet from the buffer list */
+	if (packet->prev_packet == NULL)
 		channel_buffer_ptr = packet->next_packet;
+	else
+		packet->prev_packet->next_packet = packet->next_packet;
+	
+	if (packet->next_packet == NULL)
+		channel_buffer_tail = packet->prev_packet;
+	else
+		packet->next_packet->prev_packet = packet->prev_packet;
+	
+	/* remove the packet from the indexes */
+	channel_buffer_heap_remove (packet);
+	channel_buffer_hash_remove (packet);
+	
+	packet->next_packet = NULL;
+	packet->prev_packet = NULL;
+	
+	/* drop the references to the interfering packets, the list is no more read once the packet is delivered */
+	while ((collision = packet->collisions) != NULL)
+		{
+		packet->collisions = collision->next_collision;
 		
-		/* free the memory */
-		while (packet != NULL)
-			{
-			/* keep a pointer to the packet */
-			packet_browser = packet;
+		channel_buffer_cell_release (collision->packet);
+		channel_buffer_pool_free (&channel_buffer_collision_pool, collision);
+		}
+	
+	packet->last_collision = NULL;
+	
+	/* drop the reference of the buffer, the cell stays alive while
+	   some packets still in the air record it as interferer */
+	channel_buffer_cell_release (packet);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_heap_insert
+ *
+ * Description:	insert a packet into the delivery heap
+ *
+ * ParamIn:		Buff_Info_Packet * packet
+ *				pointer to the packet to insert
+ */
+
+static void channel_buffer_heap_insert (Buff_Info_Packet * packet)
+{
+	FIN (channel_buffer_heap_insert (packet));
+	
+	/* double the size of the heap if it is full */
+	if (channel_buffer_heap_size == channel_buffer_heap_capacity)
+		{
+		channel_buffer_heap_capacity *= 2;
+		channel_buffer_heap = (Buff_Info_Packet **) op_prg_mem_realloc (channel_buffer_heap, channel_buffer_heap_capacity * sizeof (Buff_Info_Packet *));
+		}
+	
+	/* the registration order breaks the ties between equal delivery times */
+	packet->heap_order = channel_buffer_heap_order++;
+	packet->heap_index = channel_buffer_heap_size;
+	
+	channel_buffer_heap[channel_buffer_heap_size++] = packet;
+	channel_buffer_heap_sift_up (packet->heap_index);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_heap_remove
+ *
+ * Description:	remove a packet from the delivery heap
+ *
+ * ParamIn:		Buff_Info_Packet * packet
+ *				pointer to the packet to remove
+ */
+
+static void channel_buffer_heap_remove (Buff_Info_Packet * packet)
+{
+	int index = packet->heap_index;
+	
+	FIN (channel_buffer_heap_remove (packet));
+	
+	if (index < 0 || index >= channel_buffer_heap_size || channel_buffer_heap[index] != packet)
+		channel_buffer_error ("channel_buffer_heap_remove:", "The packet is not in the delivery heap.", OPC_NIL);
+	
+	/* move the last packet of the heap in place of the removed one */
+	channel_buffer_heap_size--;
+	
+	if (index < channel_buffer_heap_size)
+		{
+		channel_buffer_heap[index] = channel_buffer_heap[channel_buffer_heap_size];
+		channel_buffer_heap[index]->heap_index = index;
 		
-			/* get the next collision packet */
-			packet = packet->next_collision;
+		channel_buffer_heap_sift_up (index);
+		channel_buffer_heap_sift_down (channel_buffer_heap[index]->heap_index);
+		}
+	
+	packet->heap_index = -1;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_heap_before
+ *
+ * Description:	check if a packet must be delivered before another one
+ */
+
+static Boolean channel_buffer_heap_before (const Buff_Info_Packet * packet_a, const Buff_Info_Packet * packet_b)
+{
+	FIN (channel_buffer_heap_before (packet_a, packet_b));
+	
+	if (packet_a->delivery_time != packet_b->delivery_time)
+		FRET (packet_a->delivery_time < packet_b->delivery_time);
+	
+	FRET (packet_a->heap_order < packet_b->heap_order);
+}
+
+
+/*
+ * Function:	channel_buffer_heap_sift_up
+ *
+ * Description:	move up a packet of the delivery heap to its position
+ */
+
+static void channel_buffer_heap_sift_up (int index)
+{
+	Buff_Info_Packet * packet = channel_buffer_heap[index];
+	int parent;
+	
+	FIN (channel_buffer_heap_sift_up (index));
+	
+	while (index > 0)
+		{
+		parent = (index - 1) / 2;
 		
-			/* free the memory for the previous packet */
-			op_prg_mem_free (packet_browser);
-			}
+		if (!channel_buffer_heap_before (packet, channel_buffer_heap[parent]))
+			break;
 		
-		FOUT;
+		channel_buffer_heap[index] = channel_buffer_heap[parent];
+		channel_buffer_heap[index]->heap_index = index;
+		index = parent;
 		}
 	
-	/* search the position of the packet to remove inside the buffer */
-	while (packet_browser != NULL && packet_browser->next_packet != NULL && packet_browser->next_packet != packet)
-		packet_browser = packet_browser->next_packet;
+	channel_buffer_heap[index] = packet;
+	packet->heap_index = index;
 	
-	/* check if the selected packet precedes the packet to remove */
-	if (packet_browser->next_packet != packet)
-		channel_buffer_error ("channel_buffer_remove_packet", "the packet to remove doesn't exixt", OPC_NIL);
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_heap_sift_down
+ *
+ * Description:	move down a packet of the delivery heap to its position
+ */
+
+static void channel_buffer_heap_sift_down (int index)
+{
+	Buff_Info_Packet * packet = channel_buffer_heap[index];
+	int child;
 	
-	/* remove the packet from the buffer list */
-	packet_browser->next_packet = packet->next_packet;
+	FIN (channel_buffer_heap_sift_down (index));
 	
-	/* free the memory */
-	while (packet != NULL)
+	while ((child = 2 * index + 1) < channel_buffer_heap_size)
 		{
-		/* keep a pointer to the packet */
-		packet_browser = packet;
+		/* select the child delivered first */
+		if (child + 1 < channel_buffer_heap_size &&
+			channel_buffer_heap_before (channel_buffer_heap[child + 1], channel_buffer_heap[child]))
+			child++;
 		
-		/* get the next collision packet */
-		packet = packet->next_collision;
+		if (!channel_buffer_heap_before (channel_buffer_heap[child], packet))
+			break;
 		
-		/* free the memory for the previous packet */
-		op_prg_mem_free (packet_browser);
+		channel_buffer_heap[index] = channel_buffer_heap[child];
+		channel_buffer_heap[index]->heap_index = index;
+		index = child;
+		}
+	
+	channel_buffer_heap[index] = packet;
+	packet->heap_index = index;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_hash_insert
+ *
+ * Description:	record a packet into the packet ID hash table
+ */
+
+static void channel_buffer_hash_insert (Buff_Info_Packet * packet)
+{
+	int bucket;
+	
+	FIN (channel_buffer_hash_insert (packet));
+	
+	/* keep less than one packet per bucket on average */
+	if (channel_buffer_hash_count >= channel_buffer_hash_buckets)
+		channel_buffer_hash_resize (2 * channel_buffer_hash_buckets);
+	
+	bucket = (int) (packet->packet_id & (channel_buffer_hash_buckets - 1));
+	
+	packet->hash_next = channel_buffer_hash[bucket];
+	channel_buffer_hash[bucket] = packet;
+	channel_buffer_hash_count++;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_hash_remove
+ *
+ * Description:	remove a packet from the packet ID hash table
+ */
+
+static void channel_buffer_hash_remove (Buff_Info_Packet * packet)
+{
+	Buff_Info_Packet ** link_ptr;
+	
+	FIN (channel_buffer_hash_remove (packet));
+	
+	link_ptr = &channel_buffer_hash[(int) (packet->packet_id & (channel_buffer_hash_buckets - 1))];
+	
+	while (*link_ptr != NULL && *link_ptr != packet)
+		link_ptr = &((*link_ptr)->hash_next);
+	
+	if (*link_ptr == NULL)
+		channel_buffer_error ("channel_buffer_hash_remove:", "The packet is not in the hash table.", OPC_NIL);
+	
+	*link_ptr = packet->hash_next;
+	packet->hash_next = NULL;
+	channel_buffer_hash_count--;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	channel_buffer_hash_resize
+ *
+ * Description:	rehash the packets into a new number of buckets
+ */
+
+static void channel_buffer_hash_resize (int nb_buckets)
+{
+	Buff_Info_Packet ** new_hash;
+	Buff_Info_Packet * packet;
+	int i, bucket;
+	
+	FIN (channel_buffer_hash_resize (nb_buckets));
+	
+	new_hash = (Buff_Info_Packet **) op_prg_mem_alloc (nb_buckets * sizeof (Buff_Info_Packet *));
+	
+	for (i = 0; i < nb_buckets; i++)
+		new_hash[i] = NULL;
+	
+	/* move each packet into its new bucket */
+	for (i = 0; i < channel_buffer_hash_buckets; i++)
+		{
+		while ((packet = channel_buffer_hash[i]) != NULL)
+			{
+			channel_buffer_hash[i] = packet->hash_next;
+			
+			bucket = (int) (packet->packet_id & (nb_buckets - 1));
+			packet->hash_next = new_hash[bucket];
+			new_hash[bucket] = packet;
+			}
 		}
 	
+	op_prg_mem_free (channel_buffer_hash);
+	
+	channel_buffer_hash = new_hash;
+	channel_buffer_hash_buckets = nb_buckets;
+	
 	FOUT;
 }
 
@@ -180,18 +743,22 @@ void channel_buffer_remove_packet (Buff_Info_Packet * packet)
  *				pointer to the found packet. Pointer is null if no packet fit the ID.
  */
 
-Buff_Info_Packet * channel_buffer_search_by_id (int packet_id)
+Buff_Info_Packet * channel_buffer_search_by_id (OpT_Packet_Id packet_id)
 {
 	Buff_Info_Packet * packet_browser;
 	
 	FIN (channel_buffer_search_by_id (packet_id));
 	
-	/* initialize the packet pointer */
-	packet_browser = channel_buffer_ptr;
+	/* check if the buffer is initialized */
+	if (channel_buffer_hash == NULL)
+		FRET (NULL);
+	
+	/* browse the bucket of the packet ID */
+	packet_browser = channel_buffer_hash[(int) (packet_id & (channel_buffer_hash_buckets - 1))];
 	
 	/* search the good packet */
 	while (packet_browser != NULL && packet_browser->packet_id != packet_id)
-		packet_browser = packet_browser->next_packet;
+		packet_browser = packet_browser->hash_next;
 	
 	FRET (packet_browser);
 }
@@ -212,12 +779,15 @@ Buff_Info_Packet * create_info_packet_cell ()
 	
 	FIN (allocate_info_packet_cell ());
 	
-	/* allocate the memory */
-	pkptr = (Buff_Info_Packet *) op_prg_mem_alloc (sizeof (Buff_Info_Packet));
+	/* take a cell from the pool */
+	pkptr = (Buff_Info_Packet *) channel_buffer_pool_alloc (&channel_buffer_cell_pool);
 	
 	/* make default value */
 	pkptr->packet_id 		= 0;
 	pkptr->packet_type 		= 0.0;
+	pkptr->format			= WPAN_FORMAT_OTHER;
+	pkptr->tx_node_index	= -1;
+	pkptr->rx_node_index	= -1;
 	pkptr->packet_size 		= 0.0;
 	pkptr->power 			= 0.0;
 	pkptr->txrx_distance 	= 0.0;
@@ -233,10 +803,18 @@ Buff_Info_Packet * create_info_packet_cell ()
 	pkptr->delivery_time	= 0.0;
 	pkptr->frequency 		= 0.0;
 	pkptr->nb_collisions 	= 1;
+	pkptr->noise			= OPC_FALSE;
 	
 	/* initialize the pointer to null */
 	pkptr->next_packet = NULL;
-	pkptr->next_collision = NULL;
+	pkptr->prev_packet = NULL;
+	pkptr->collisions = NULL;
+	pkptr->last_collision = NULL;
+	pkptr->nb_references = 1;
+	pkptr->pkptr = OPC_NIL;
+	pkptr->heap_index = -1;
+	pkptr->heap_order = 0;
+	pkptr->hash_next = NULL;
 	
 	FRET (pkptr);
 }
@@ -245,8 +823,8 @@ Buff_Info_Packet * create_info_packet_cell ()
 /*
  * Function:	channel_buffer_register_collision
  *
- * Description:	if the two packet in parameters are in collision, we record a copy
- *				of each one into the packet cells.
+ * Description:	if the two packet in parameters are in collision, we record a reference
+ *				to each one into the collision list of the other.
  *
  * ParamIn:		Buff_Info_Packet * current_packet
  *				pointer to a packet already record in the channel buffer
@@ -257,9 +835,6 @@ Buff_Info_Packet * create_info_packet_cell ()
 
 void channel_buffer_register_collision (Buff_Info_Packet * current_packet, Buff_Info_Packet * packet_to_register)
 {
-	Buff_Info_Packet * collision_browser;
-	
-	
 	FIN (channel_buffer_register_collision (current_packet, packet_to_register));
 	
 	/* check the both pointers */
@@ -300,25 +875,13 @@ void channel_buffer_register_collision (Buff_Info_Packet * current_packet, Buff_
 		
 		if (op_topo_parent(current_packet->dest_objid) != op_topo_parent(packet_to_register->src_objid))
 			{
-			/* initialize the pointer to the first collision */
-			collision_browser = current_packet;
-		
-			/* we get the last collision registered */
-			while (collision_browser->next_collision != NULL)
-				collision_browser = collision_browser->next_collision;
-		
-			/* copy the packet information at the end of the list */
-			collision_browser->next_collision = copy_packet_info_cell (packet_to_register);
+			/* record the packet to register as collision of the current packet */
+			channel_buffer_collision_add (current_packet, packet_to_register);
 			}
 		
 		if (op_topo_parent(packet_to_register->dest_objid) != op_topo_parent(current_packet->src_objid))
-			{/* copy the current packet as collision of the packet to register */
-			collision_browser = packet_to_register;
-			
-			while (collision_browser->next_collision != NULL)
-				collision_browser = collision_browser->next_collision;
-			
-			collision_browser->next_collision = copy_packet_info_cell (current_packet);
+			{/* record the current packet as collision of the packet to register */
+			channel_buffer_collision_add (packet_to_register, current_packet);
 		
 			/* update the number of collision of each packet */
 			(current_packet->nb_collisions)++;
@@ -330,72 +893,26 @@ void channel_buffer_register_collision (Buff_Info_Packet * current_packet, Buff_
 }
 
 
-/*
- * Function:	copy_packet_info_cell
- *
- * Description:	copy a info packet cell into another cell
- *
- * ParamIn:		Buff_Info_Packet * packet
- *				pointer to the packet to copy
- *
- * ParamOut:	Buff_Info_Packet * copy_ptr
- *				pointer to the copy of the cell
- */
-
-Buff_Info_Packet * copy_packet_info_cell (Buff_Info_Packet * packet)
-{
-	Buff_Info_Packet * copy_ptr;
-	
-	FIN (copy_packet_info_cell (packet));
-	
-	/* create a new cell */
-	copy_ptr = create_info_packet_cell ();
-	
-	/* copy the value */
-	copy_ptr->packet_id 	= packet->packet_id;
-	copy_ptr->packet_type 	= packet->packet_type;
-	copy_ptr->packet_size 	= packet->packet_size;
-	copy_ptr->power 		= packet->power;
-	copy_ptr->txrx_distance = packet->txrx_distance;
-	copy_ptr->tx_x			= packet->tx_x;
-	copy_ptr->tx_y			= packet->tx_y;
-	copy_ptr->rx_x			= packet->rx_x;
-	copy_ptr->rx_y			= packet->rx_y;
-	copy_ptr->dest_objid	= packet->dest_objid;
-	copy_ptr->src_objid		= packet->src_objid;
-	copy_ptr->frequency 	= packet->frequency;
-	copy_ptr->tx_time 		= packet->tx_time;
-	copy_ptr->tx_delay 		= packet->tx_delay;
-	copy_ptr->prop_delay 	= packet->prop_delay;
-	copy_ptr->delivery_time = packet->delivery_time;
-	
-		
-	FRET (copy_ptr);
-}
-
-
 /*
  * Function:	search_pkt_id_for_delivery
  *
- * Description:	
+ * Description:	return the packet to deliver at the current time, i.e.
+ *				the first registered packet of the delivery heap
  */
 
 Buff_Info_Packet * search_pkt_info_for_delivery ()
 {
-	Buff_Info_Packet * element;
+	Buff_Info_Packet * element = NULL;
 	
 	
 	FIN (search_pkt_info_for_delivery ());
 	
-	/* initialize the element */
-	element = channel_buffer_ptr;
-	
-	/* we search the packet with a delivery time equal to the current time */
-	while (element != NULL && element->delivery_time != op_sim_time ())
-		element = element->next_packet;
+	/* the next packet to deliver is on the top of the heap */
+	if (channel_buffer_heap_size > 0)
+		element = channel_buffer_heap[0];
 	
-	/* check if the element is NULL */
-	if (element == NULL)
+	/* check the packet must be delivered now */
+	if (element == NULL || element->delivery_time != op_sim_time ())
 		channel_buffer_error ("search_pkt_id_for_delivery:", "No packet found for delivery.", OPC_NIL);
 	
 	FRET (element);
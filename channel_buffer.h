@@ -31,10 +31,19 @@
 #include <opnet.h>
 #include "lr_wpan_support_15_4a.h"
 
+/* reference to an interfering packet of the buffer */
+typedef struct T_collision {
+  struct T_buffer *		packet; // interfering packet (shared, not copied)
+  struct T_collision *	next_collision;
+} Buff_Collision;
+
 /* declare the buffer structure */
 typedef struct T_buffer {
   OpT_Packet_Id		packet_id; // Packet ID
   Wpan_Pkt_Type		packet_type; // type of packet
+  Wpan_Pkt_Format	format; // format of the packet
+  int				tx_node_index; // position of the transmitter in the node list (-1 if unknown)
+  int				rx_node_index; // position of the receiver in the node list (-1 if unknown)
   double			packet_size; // size of packet
   double 			power; // TX power
   double			tx_x;	// coordinates of
@@ -52,20 +61,38 @@ typedef struct T_buffer {
   int				nb_collisions; // number of collisions
   Boolean			noise;// categorize the packet as noise (true) or valid (false)
   struct T_buffer *	next_packet;
-  struct T_buffer *	next_collision;
+  struct T_buffer *	prev_packet;
+  Buff_Collision *	collisions; // packets interfering with this one
+  Buff_Collision *	last_collision;
+  int				nb_references; // references to the cell (buffer and collision lists)
+  Packet *			pkptr; // packet delivered at delivery_time
+  int				heap_index; // position in the delivery heap (-1 if not queued)
+  unsigned int		heap_order; // registration order, breaks the delivery time ties
+  struct T_buffer *	hash_next; // next cell with the same packet ID hash
 } Buff_Info_Packet;
 
+/* statistics of the pool of buffer cells */
+typedef struct {
+  double			nb_alloc; // number of cells taken from the pool
+  double			nb_free; // number of cells given back to the pool
+  int				nb_in_use; // number of cells currently used
+  int				max_in_use; // maximum number of cells used at the same time
+  int				nb_slabs; // number of slabs allocated
+} Buff_Pool_Stat;
+
 /* declare the first cell */
 Buff_Info_Packet * channel_buffer_ptr;
 
 /* function prototypes */
+void				channel_buffer_init (void);
+void				channel_buffer_release (void);
+void				channel_buffer_pool_stat_get (Buff_Pool_Stat * cell_stat_ptr, Buff_Pool_Stat * collision_stat_ptr);
 void				channel_buffer_error (char * fcnt, char * msg, char * opt);
 void 				channel_buffer_register_packet (Buff_Info_Packet * packet);
 void 				channel_buffer_remove_packet (Buff_Info_Packet * packet);
-Buff_Info_Packet *	channel_buffer_search_by_id (int packet_id);
+Buff_Info_Packet *	channel_buffer_search_by_id (OpT_Packet_Id packet_id);
 Buff_Info_Packet *	create_info_packet_cell (void);
 void 				channel_buffer_register_collision (Buff_Info_Packet * current_packet, Buff_Info_Packet * packet_to_register);
-Buff_Info_Packet * 	copy_packet_info_cell (Buff_Info_Packet * packet);
 Buff_Info_Packet *	search_pkt_info_for_delivery (void);
 void 				chan_buffer_print_info_pkt (Buff_Info_Packet * packet);
 
@@ -185,6 +185,7 @@ static void
 lr_wpan_ss_pkt_generate (void)
 {
 	Packet*				pkptr;
+	Ici*				iciptr;
 	double				pksize;
 	int					address; // = mac_destination_preference;
 
@@ -235,8 +236,14 @@ lr_wpan_ss_pkt_generate (void)
 	statistic.emergency_Pkt_Sent++;
 	statistic.emergency_Bits_Sent += (int) pksize;
 
+	/* mark the packet as emergency traffic for the MAC */
+	iciptr = op_ici_create ("lr_wpan_traffic_ici_format");
+	op_ici_attr_set (iciptr, "Type of Priority", WPAN_PRIORITY_EMERGENCY);
+
 	/* Send the packet via the stream to the lower layer.	*/
+	op_ici_install (iciptr);
 	op_pk_send (pkptr, EMERGENCY_DATA_SSC_STRM_TO_LOW);
+	op_ici_install (OPC_NIL);
 
 	FOUT;
 }	
@@ -353,7 +360,7 @@ lr_wpan_ss_pkt_recv (void)
 		lr_wpan_mac_error ("lr_wpan_ss_pkt_recv:", "Cannot access the source node parameters.", OPC_NIL);
 		
 	/* get the information */
-	element = op_prg_list_access (wpan_node_param_list, pos_index);
+	element = wpan_node_get (pos_index);
 	
 	/* update the share statistic */
 	element->share_statistic ++;
@@ -416,7 +423,7 @@ lr_wpan_ss_collect_stat (void)
 		lr_wpan_mac_error ("lr_wpan_ss_pkt_recv:", "Cannot access the curent node parameters.", OPC_NIL);
 		
 	/* get the information */
-	element = op_prg_list_access (wpan_node_param_list, pos_index);
+	element = wpan_node_get (pos_index);
 	
 	/* start printing report */
 	/* get the report name */
@@ -447,7 +454,7 @@ lr_wpan_ss_collect_stat (void)
 		double_to_string (op_sim_time (), strlen ("Simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
   
 	
 	FOUT;
@@ -102,6 +102,10 @@ long int busy_period[STAT_FILE_LENGTH];
 long int idle_period[STAT_FILE_LENGTH];
 
 
+/* interferers of the packet evaluated by compute_accept_flag */
+static Snr_Batch interferer_batch;
+
+
 /* File for debug information */
 FILE* fp_channel_debug;
 char pippo[100] = "C:\\Documents and Settings\\fmartell\\op_reports\\Simulation_channel.txt";
@@ -111,9 +115,10 @@ char pippo[100] = "C:\\Documents and Settings\\fmartell\\op_reports\\Simulation_
 static void 		wpan_channel_init (void);
 static void 		lr_wpan_chan_error (const char * fcnt, const char * msg, const char * opt);
 static void 		lr_wpan_chan_buffer_insert (void);
-static int			channel_queue_search_pkt (OpT_Packet_Id pkt_id);
 static void 		lr_wpan_channel_pk_send (void);
 static int			compute_accept_flag (Buff_Info_Packet * info_packet);
+static double		compute_link_snr (const Buff_Info_Packet * tx_packet, const Buff_Info_Packet * rx_packet, double * prop_delay_ptr);
+static double		compute_interference_snr (const Buff_Info_Packet * info_packet, double prop_delay_transmitter, double * prop_delay_ptr);
 static int 			fec (double ber, int packet_size);
 static void 		wlan_flag_transmission (const Buff_Info_Packet * info_packet);
 static void 		wlan_flag_transmission_nico (const Buff_Info_Packet * info_packet);
@@ -153,7 +158,6 @@ typedef struct
 	int	                    		intrpt_type                                     ;	/* type of the current interruption */
 	int	                    		intrpt_stream                                   ;	/* stream of the current interruption */
 	int	                    		intrpt_code                                     ;	/* code of the current interruption */
-	List *	                 		channel_pkt_queue                               ;	/* queue for the received packet */
 	Boolean	                		DEBUG_Channel                                   ;
 	Stathandle	             		buffer_size_handle                              ;
 	int	                    		buffer_size_pkts                                ;
@@ -164,6 +168,8 @@ typedef struct
 	double	                 		last_time_inc_N_occ                             ;
 	int	                    		N_occupied_slots_PSMA                           ;
 	Boolean	                		capture_effect_enabled                          ;
+	double	                 		cca_sensing_radius                              ;	/* CCA sensing radius around the transmitter (unlimited if not positive) */
+	Boolean	                		multi_interferer_capture                        ;	/* capture effect evaluated with several interferers */
 	int	                    		useful_slots                                    ;
 	int	                    		busy_slots                                      ;
 	int	                    		idle_slots                                      ;
@@ -177,7 +183,6 @@ typedef struct
 #define intrpt_type             		op_sv_ptr->intrpt_type
 #define intrpt_stream           		op_sv_ptr->intrpt_stream
 #define intrpt_code             		op_sv_ptr->intrpt_code
-#define channel_pkt_queue       		op_sv_ptr->channel_pkt_queue
 #define DEBUG_Channel           		op_sv_ptr->DEBUG_Channel
 #define buffer_size_handle      		op_sv_ptr->buffer_size_handle
 #define buffer_size_pkts        		op_sv_ptr->buffer_size_pkts
@@ -188,6 +193,8 @@ typedef struct
 #define last_time_inc_N_occ     		op_sv_ptr->last_time_inc_N_occ
 #define N_occupied_slots_PSMA   		op_sv_ptr->N_occupied_slots_PSMA
 #define capture_effect_enabled  		op_sv_ptr->capture_effect_enabled
+#define cca_sensing_radius      		op_sv_ptr->cca_sensing_radius
+#define multi_interferer_capture		op_sv_ptr->multi_interferer_capture
 #define useful_slots            		op_sv_ptr->useful_slots
 #define busy_slots              		op_sv_ptr->busy_slots
 #define idle_slots              		op_sv_ptr->idle_slots
@@ -258,15 +265,12 @@ wpan_channel_init (void)
 	
 	FIN (wpan_channel_init ());
 	
-	/* initialize the pointer to the channel buffer */
-	channel_buffer_ptr = NULL;
+	/* initialize the channel buffer */
+	channel_buffer_init ();
 	
 	/* record the channel node id */
 	wpan_channel_objid = my_objid;
 	
-	/* init the channel queue */
-	channel_pkt_queue = op_prg_list_create ();
-	
 	/* get the WPAN Parameters Object ID */
 	op_ima_obj_attr_get (my_objid, "CCA Parameters", &cca_param_comp_objid);
 	cca_param_objid = op_topo_child (cca_param_comp_objid, OPC_OBJTYPE_GENERIC, 0);
@@ -281,6 +285,16 @@ wpan_channel_init (void)
 	
 	op_ima_obj_attr_get (my_objid, "Capture_effect_enabled", &capture_effect_enabled);
 	
+	/* get the CCA sensing radius (optional, unlimited by default) */
+	if (op_ima_obj_attr_exists (my_objid, "CCA Sensing Radius") == OPC_FALSE ||
+		op_ima_obj_attr_get (my_objid, "CCA Sensing Radius", &cca_sensing_radius) == OPC_COMPCODE_FAILURE)
+		cca_sensing_radius = 0.0;
+	
+	/* get the capture mode with several interferers (optional, the packet is lost by default) */
+	if (op_ima_obj_attr_exists (my_objid, "Multi-Interferer Capture") == OPC_FALSE ||
+		op_ima_obj_attr_get (my_objid, "Multi-Interferer Capture", &multi_interferer_capture) == OPC_COMPCODE_FAILURE)
+		multi_interferer_capture = OPC_FALSE;
+	
 	
 	buffer_size_pkts = 0;
 	buffer_size_handle = op_stat_reg ("channel.Buffer Size (pkts)", OPC_STAT_INDEX_NONE, OPC_STAT_LOCAL);
@@ -343,11 +357,11 @@ lr_wpan_chan_buffer_insert (void)
 {
 	Packet * rcv_pkptr;
 	Ici *	ici_ptr;
+	const Wpan_Tx_Descriptor * descriptor;
 	Buff_Info_Packet * info_packet;
 	double bit_rate;
 	int dest_address, pos_index;
 	Wpan_Node_Param * element;
-	char format[64];
 	
 	
 	FIN (lr_wpan_chan_buffer_insert ());
@@ -366,24 +380,44 @@ lr_wpan_chan_buffer_insert (void)
 	/* create the info packet cell */
 	info_packet = create_info_packet_cell ();
 	
-	/* get information from the ici */
-	if (op_ici_attr_get (ici_ptr, "txrx distance", &info_packet->txrx_distance) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "bit rate", &bit_rate) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "channel", &info_packet->frequency) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "power", &info_packet->power) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "packet type", &info_packet->packet_type) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "dest address", &dest_address) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "Tx x", &info_packet->tx_x) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "Tx y", &info_packet->tx_y) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "Rx x", &info_packet->rx_x) == OPC_COMPCODE_FAILURE ||
-		op_ici_attr_get (ici_ptr, "Rx y", &info_packet->rx_y) == OPC_COMPCODE_FAILURE)
-		lr_wpan_chan_error ("lr_wpan_chan_buffer_insert", "cannot read the ICI attributes", OPC_NIL);
-	
-		//op_ici_attr_get (ici_ptr, "piconet number", &piconet_number) == OPC_COMPCODE_FAILURE)
-		//lr_wpan_chan_error ("lr_wpan_chan_buffer_insert", "cannot read the ICI attributes", OPC_NIL);
-	
-	/* get the packet format */
-	op_pk_format (rcv_pkptr, format);
+	/* the WPAN MAC layer gives the description of the transmission with the ICI */
+	if ((descriptor = wpan_tx_descriptor_get (ici_ptr)) != NULL)
+		{
+		info_packet->txrx_distance	= descriptor->txrx_distance;
+		bit_rate					= descriptor->bit_rate;
+		info_packet->frequency		= descriptor->frequency;
+		info_packet->power			= descriptor->power;
+		info_packet->packet_type	= descriptor->packet_type;
+		dest_address				= descriptor->dest_address;
+		info_packet->tx_x			= descriptor->tx_x;
+		info_packet->tx_y			= descriptor->tx_y;
+		info_packet->rx_x			= descriptor->rx_x;
+		info_packet->rx_y			= descriptor->rx_y;
+		info_packet->format			= descriptor->format;
+		info_packet->tx_node_index	= descriptor->tx_node_index;
+		info_packet->rx_node_index	= descriptor->rx_node_index;
+		}
+	else
+		{
+		/* get information from the ici */
+		if (op_ici_attr_get (ici_ptr, "txrx distance", &info_packet->txrx_distance) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "bit rate", &bit_rate) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "channel", &info_packet->frequency) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "power", &info_packet->power) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "packet type", &info_packet->packet_type) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "dest address", &dest_address) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "Tx x", &info_packet->tx_x) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "Tx y", &info_packet->tx_y) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "Rx x", &info_packet->rx_x) == OPC_COMPCODE_FAILURE ||
+			op_ici_attr_get (ici_ptr, "Rx y", &info_packet->rx_y) == OPC_COMPCODE_FAILURE)
+			lr_wpan_chan_error ("lr_wpan_chan_buffer_insert", "cannot read the ICI attributes", OPC_NIL);
+	
+			//op_ici_attr_get (ici_ptr, "piconet number", &piconet_number) == OPC_COMPCODE_FAILURE)
+			//lr_wpan_chan_error ("lr_wpan_chan_buffer_insert", "cannot read the ICI attributes", OPC_NIL);
+		
+		/* get the packet format */
+		info_packet->format = wpan_pkt_format_get (rcv_pkptr);
+		}
 	
 	/* 
 	 * destroy the ICI pointer if the packet comes from a WLAN
@@ -391,8 +425,8 @@ lr_wpan_chan_buffer_insert (void)
 	 * If the packet is a WPAN data, the ICI will be destroyed
 	 * with the copy of the packet used for the retransmission
 	 */
-	if (strcmp (format, "lr_wpan_mac"))
-		op_ici_destroy (ici_ptr);
+	if (info_packet->format != WPAN_FORMAT_MAC)
+		wpan_tx_ici_destroy (ici_ptr);
 	
 	/* a priori, the packet is valid until the opposite statment is made */
 	if (info_packet->packet_type == WPAN_PKT_TYPE)
@@ -421,7 +455,7 @@ lr_wpan_chan_buffer_insert (void)
 
 	pos_index = wpan_search_mac_address (dest_address);
 	/* get the information */
-	element = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, pos_index);
+	element = wpan_node_get (pos_index);
 	
 		
 	/* complete the info packet pointer */
@@ -459,6 +493,9 @@ lr_wpan_chan_buffer_insert (void)
 		op_intrpt_schedule_remote (op_sim_time () + info_packet->tx_delay, 0, info_packet->src_objid);
 		}
 	
+	/* keep the packet with its information until its delivery */
+	info_packet->pkptr = rcv_pkptr;
+	
 	/* schedule the interuption to send the packet to its destination */
 	op_intrpt_schedule_self (info_packet->delivery_time, PKT_DELIVERY_CODE);
 
@@ -468,7 +505,7 @@ lr_wpan_chan_buffer_insert (void)
 	buffer_size_pkts++;
 	op_stat_write(buffer_size_handle, buffer_size_pkts);
 	
-	if (!strcmp (format, "lr_wpan_mac"))
+	if (info_packet->format == WPAN_FORMAT_MAC)
 		{
 		channel_pkt_forwarded++;
 		
@@ -486,9 +523,6 @@ lr_wpan_chan_buffer_insert (void)
 			}
 		}
 	
-	/* insert the packet into the queue */
-	op_prg_list_insert (channel_pkt_queue, rcv_pkptr, OPC_LISTPOS_TAIL);
-	
 	/* debug informations */
 	if (ODB_CHANNEL_BUFFER)
 		{
@@ -504,52 +538,6 @@ lr_wpan_chan_buffer_insert (void)
 }
 
 
-/*
- * Function:	channel_queue_search_pkt
- *
- * Description:	search a packet in the channel queue, according
- *				to the packet ID in parameter and return the
- *				index of this packet in the list if it exists,
- *				otherwise return -1
- *
- * ParamIn:		OpT_Packet_Id pkt_id
- *				ID of the packet to search
- *
- * ParamOut:	int pos_index
- *				position index of the element
- */
-
-static int 
-channel_queue_search_pkt (OpT_Packet_Id pkt_id)
-{
-	int i, pos_index = -1;
-	Packet * element;
-	int nbElement; // = op_prg_list_size (channel_pkt_queue);
-	
-	
-	FIN (channel_queue_search_pkt (pkt_id));
-	
-	nbElement = op_prg_list_size (channel_pkt_queue);
-	
-	/* chack if the list is not null */
-	if (!nbElement)
-		lr_wpan_chan_error ("channel_queue_search_pkt:", "No packet registered.", OPC_NIL);
-
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
-		{
-		/* access the element */
-		element = op_prg_list_access (channel_pkt_queue, i);
-		
-		/* check the MAC address*/
-		if (op_pk_id(element) == pkt_id)
-			pos_index = i;
-		}
-		
-	FRET (pos_index);
-}
-
-
 /*
  * Function:	lr_wpan_channel_pk_send
  */
@@ -560,8 +548,7 @@ lr_wpan_channel_pk_send (void)
 	Buff_Info_Packet * info_packet;
 	Packet * pkptr;
 	//Frame_Ctrl_Field * ctrl_field_ptr;
-	char format[64];
-	int pos_index;
+	Wpan_Pkt_Format format;
 	int accept;
 	
 	FIN (lr_wpan_channel_pk_send ());
@@ -572,12 +559,10 @@ lr_wpan_channel_pk_send (void)
 	info_packet = search_pkt_info_for_delivery ();
 	
 	/* get the packet according to the information cell */
-	if ((pos_index = channel_queue_search_pkt (info_packet->packet_id)) == -1)
+	if ((pkptr = info_packet->pkptr) == OPC_NIL)
 		lr_wpan_chan_error ("lr_wpan_channel_pk_send:", "No packet found in the queue.", OPC_NIL);
 	
-	/* remove the packet from the channel queue */
-	if ((pkptr = op_prg_list_remove (channel_pkt_queue, pos_index)) == OPC_NIL)
-		lr_wpan_chan_error ("lr_wpan_channel_pk_send:", "Cannot remove packet from the queue.", OPC_NIL);
+	info_packet->pkptr = OPC_NIL;
 	
 	/*
 	ctrl_field_ptr = (Frame_Ctrl_Field *) op_prg_mem_alloc (sizeof (Frame_Ctrl_Field));
@@ -589,10 +574,10 @@ lr_wpan_channel_pk_send (void)
 	
 		
 	/* compute the accept flag ONLY FOR DATA */
-	op_pk_format(pkptr, format);
+	format = info_packet->format;
 	
 	//if (ctrl_field_ptr->frame_type == WPAN_Beacon) accept= 1;	
-	if (!strcmp (format, "lr_wpan_beacon") || !strcmp (format, "lr_wpan_ack")) accept= 1;	
+	if (format == WPAN_FORMAT_BEACON || format == WPAN_FORMAT_ACK) accept= 1;	
 	 else accept = compute_accept_flag (info_packet);
 
 	/* set the accept flag */
@@ -633,7 +618,7 @@ lr_wpan_channel_pk_send (void)
 	buffer_size_pkts--;
 	op_stat_write(buffer_size_handle, buffer_size_pkts);
 	
-	if (!strcmp (format, "lr_wpan_mac"))
+	if (format == WPAN_FORMAT_MAC)
 		{
 				
 		if (accept == 1) 	channel_pkt_accepted++;
@@ -658,12 +643,11 @@ lr_wpan_channel_pk_send (void)
 static int compute_accept_flag (Buff_Info_Packet * info_packet)
 {	
 	double ber = 0.0, pmd = 0.0, snr = 0.0, snr_i=0.0, snr_lin = 0.0, snr_i_lin= 0.0, SINR=0.0, SINR_dB=0.0;
-	double power_packet_w, power_packet_interferer_w;
-	double distance_interferer, distance_transmitter, delta_x, delta_y, delta_dist;
+	double prop_delay_interferer, prop_delay_transmitter;
 	double delta_delay, overlap;
 	double int_window = 32.05e-9;
 
-	Buff_Info_Packet * info_packet_interferer = info_packet->next_collision;
+	Buff_Info_Packet * info_packet_interferer = (info_packet->collisions != NULL) ? info_packet->collisions->packet : NULL;
 	
 	int packet_size = (int) info_packet->packet_size;
 	int Errors, correct ;
@@ -671,17 +655,11 @@ static int compute_accept_flag (Buff_Info_Packet * info_packet)
 			
 	FIN (compute_accept_flag (info_packet));
 	
-	//Buff_Info_Packet * info_packet_interferer = info_packet->next_collision;
+	//Buff_Info_Packet * info_packet_interferer = info_packet->collisions->packet;
 	
 	/* compute snr*/
-	delta_x = info_packet->rx_x - info_packet->tx_x;
-	delta_y = info_packet->rx_y - info_packet->tx_y;
-	distance_transmitter = sqrt (delta_x * delta_x + delta_y * delta_y);
-		
-	power_packet_w = info_packet->power;
-	
 	//It gives the SNR in dB
-	snr = snr_15_4a (info_packet->frequency, power_packet_w, distance_transmitter);
+	snr = compute_link_snr (info_packet, info_packet, &prop_delay_transmitter);
 		
 	//to compute average snr
 	accumulate_snr = accumulate_snr + snr;
@@ -731,18 +709,15 @@ static int compute_accept_flag (Buff_Info_Packet * info_packet)
 	
 		
 	else	
-		if((info_packet->nb_collisions == 2)&&(capture_effect_enabled == OPC_TRUE))	//one collision && capture effect enabled
+		if(((info_packet->nb_collisions == 2) || (info_packet->nb_collisions > 2 && multi_interferer_capture == OPC_TRUE))&&(capture_effect_enabled == OPC_TRUE))	//one collision (or several, added up) && capture effect enabled
 			
 	   			{  
 	         	/* compute the distance beetween the interferer and the receiver*/
-				delta_x = info_packet->rx_x - info_packet_interferer->tx_x;
-				delta_y = info_packet->rx_y - info_packet_interferer->tx_y;
-				distance_interferer = sqrt (delta_x * delta_x + delta_y * delta_y);
-				
-				power_packet_interferer_w = info_packet_interferer->power;
-				
 				//SNR of the interfering packet
-				snr_i =snr_15_4a (info_packet_interferer->frequency, power_packet_interferer_w, distance_interferer);
+				if (info_packet->nb_collisions == 2)
+					snr_i = compute_link_snr (info_packet_interferer, info_packet, &prop_delay_interferer);
+				else
+					snr_i = compute_interference_snr (info_packet, prop_delay_transmitter, &prop_delay_interferer);
 				
 				if(snr_i > snr) 
 					{
@@ -752,13 +727,11 @@ static int compute_accept_flag (Buff_Info_Packet * info_packet)
 				
 				else
 					{
-					/*compute relative distance*/
-					if(distance_transmitter <= distance_interferer) 
-						delta_dist= distance_interferer - distance_transmitter;
+					/*compute relative delay*/
+					if(prop_delay_transmitter <= prop_delay_interferer) 
+						delta_delay = prop_delay_interferer - prop_delay_transmitter;
 					else 
-						delta_dist = distance_transmitter - distance_interferer;
-					
-					delta_delay = delta_dist/ LIGHT_SPEED;
+						delta_delay = prop_delay_transmitter - prop_delay_interferer;
 					
 					/*compare delta delay with int_window: if the delay is equal or greater than the Int.Window compute miss detection and ber*/
 					if(delta_delay >= int_window)
@@ -823,18 +796,128 @@ static int compute_accept_flag (Buff_Info_Packet * info_packet)
 
 						 
 
+/*
+ * Function:	compute_link_snr
+ *
+ * Description:	compute the SNR of a transmission at the receiver of a
+ *				packet. The link budget between the two nodes is used
+ *				when both of them are registered.
+ *
+ * ParamIn:		const Buff_Info_Packet * tx_packet
+ *				packet of the transmitter
+ *
+ *				const Buff_Info_Packet * rx_packet
+ *				packet of the receiver
+ *
+ * ParamOut:	double * prop_delay_ptr
+ *				propagation delay between the transmitter and the receiver
+ *
+ *				double snr
+ *				SNR at the receiver (dB)
+ */
+
+static double compute_link_snr (const Buff_Info_Packet * tx_packet, const Buff_Info_Packet * rx_packet, double * prop_delay_ptr)
+{
+	const Wpan_Link_Budget * link = NULL;
+	double delta_x, delta_y, distance;
+	
+	FIN (compute_link_snr (tx_packet, rx_packet, prop_delay_ptr));
+	
+	if (tx_packet->tx_node_index >= 0 && rx_packet->rx_node_index >= 0)
+		link = wpan_link_budget_get (tx_packet->tx_node_index, rx_packet->rx_node_index, tx_packet->frequency, tx_packet->power);
+	
+	/* the positions recorded with the packets must be the ones of the budget */
+	if (link != NULL &&
+		link->tx_x == tx_packet->tx_x && link->tx_y == tx_packet->tx_y &&
+		link->rx_x == rx_packet->rx_x && link->rx_y == rx_packet->rx_y)
+		{
+		*prop_delay_ptr = link->prop_delay;
+		FRET (link->snr);
+		}
+	
+	delta_x = rx_packet->rx_x - tx_packet->tx_x;
+	delta_y = rx_packet->rx_y - tx_packet->tx_y;
+	distance = sqrt (delta_x * delta_x + delta_y * delta_y);
+	*prop_delay_ptr = distance / LIGHT_SPEED;
+	
+	FRET (snr_15_4a (tx_packet->frequency, tx_packet->power, distance));
+}
+
+
+/*
+ * Function:	compute_interference_snr
+ *
+ * Description:	add up the packets interfering with a packet at its
+ *				receiver. The interferer which arrives the closest to the
+ *				packet gives the overlap in the integration window.
+ *
+ * ParamIn:		const Buff_Info_Packet * info_packet
+ *				packet received
+ *
+ *				double prop_delay_transmitter
+ *				propagation delay between the transmitter and the receiver
+ *
+ * ParamOut:	double * prop_delay_ptr
+ *				propagation delay between the closest interferer and the receiver
+ *
+ *				double snr_i
+ *				SNR of the sum of the interferers (dB)
+ */
+
+static double compute_interference_snr (const Buff_Info_Packet * info_packet, double prop_delay_transmitter, double * prop_delay_ptr)
+{
+	Buff_Collision * collision;
+	double snr_i, prop_delay, delta_delay, min_delta_delay;
+	int i;
+	
+	FIN (compute_interference_snr (info_packet, prop_delay_transmitter, prop_delay_ptr));
+	
+	snr_batch_clear (&interferer_batch);
+	for (collision = info_packet->collisions; collision != NULL; collision = collision->next_collision)
+		snr_batch_add (&interferer_batch, collision->packet->tx_x, collision->packet->tx_y, collision->packet->power, collision->packet->frequency);
+	
+	snr_i = snr_15_4a_batch (&interferer_batch, info_packet->rx_x, info_packet->rx_y);
+	
+	/* the collision list may be shorter than the collision count */
+	*prop_delay_ptr = prop_delay_transmitter;
+	min_delta_delay = -1.0;
+	for (i = 0; i < interferer_batch.size; i++)
+		{
+		prop_delay = interferer_batch.distance[i] / LIGHT_SPEED;
+		delta_delay = fabs (prop_delay - prop_delay_transmitter);
+		if (min_delta_delay < 0.0 || delta_delay < min_delta_delay)
+			{
+			min_delta_delay = delta_delay;
+			*prop_delay_ptr = prop_delay;
+			}
+		}
+	
+	FRET (snr_i);
+}
+
+
 /*
  * Function:	fec
  *
- * Description	
+ * Description:	check if the FEC corrects the bit errors of a packet
+ *
+ * ParamIn:		double ber
+ *				bit error rate
+ *
+ *				int packet_size
+ *				size of the packet (bits)
+ *
+ * ParamOut:	int correct
+ *				1 if the packet is correct
  */
 
 static int fec (double ber, int packet_size)
-{	int i, j; // loop variable
-	int Nsegments, Nerr ;
+{
+	int Nsegments;
 	int segment_size = 330;
 	int max_error = 4;
 	int last_segment_size, max_error_last_segment;
+	double success;
 	
 		
 	FIN (fec (ber, packet_size));
@@ -846,21 +929,15 @@ static int fec (double ber, int packet_size)
 		
 	if(DEBUG_Channel) 
 		fprintf(fp_channel_debug, "packet_size = %d -- segment_size = %d -- Nsegments = %d -- last_segment_size = %d -- max_error_last_segment = %d\n", packet_size, segment_size, Nsegments, last_segment_size, max_error_last_segment);
-		
-	for(j=0; j<Nsegments; j++)
-		{
-		Nerr=0;
-		for (i=0; i<segment_size; i++)
-			if (op_dist_uniform (1.0) < ber)						Nerr++;
-		
-		if (Nerr>max_error) FRET (0);
-		}
 	
-	Nerr=0;
-	for (i=0; i<last_segment_size; i++)
-		if (op_dist_uniform (1.0) < ber)	 Nerr++;
+	/* the segments are independent: the packet is correct with the product of their probabilities */
+	success = pow (fec_success_probability (ber, segment_size, max_error), Nsegments);
+	success *= fec_success_probability (ber, last_segment_size, max_error_last_segment);
+	
+	if (success >= 1.0)		FRET (1);
 	
-	if (Nerr>max_error_last_segment) 	FRET (0);						
+	/* one draw for the whole packet */
+	if (op_dist_uniform (1.0) >= success) 	FRET (0);						
 	
 	FRET (1);
 }
@@ -877,6 +954,7 @@ wlan_flag_transmission (const Buff_Info_Packet * info_packet)
 {	
 	Ici * wlan_rx, *wlan_rx_beginning, *wlan_rx_end;
 	int nb_wlan,i;
+	Wpan_Node_Param ** wlan_nodes;
 	Wpan_Node_Param * element;
 	double prop_delay;
 	double delivery_time;
@@ -900,13 +978,13 @@ wlan_flag_transmission (const Buff_Info_Packet * info_packet)
 			lr_wpan_chan_error ("wpan_update_wlan_flag:", "No packet information found.", OPC_NIL);
 	
 		/* get the number of WLAN in the topology */
-		nb_wlan = wpan_list_size_get_wlan_node ();
+		nb_wlan = wpan_wlan_nodes_get (&wlan_nodes);
 		
 		/* For each WLAN, we need to send an interuption */
 		for (i = 0; i < nb_wlan; i++)
 			{
 			/* get the WLAN device */
-			element = wpan_search_wlan_node (i);
+			element = wlan_nodes[i];
 			//printf(" device %d, packet %d,\n", element->objid, info_packet->dest_objid );
 			
 			if( element->objid == info_packet->dest_objid)
@@ -1004,6 +1082,7 @@ wpan_update_wlan_flag (const Buff_Info_Packet * info_packet)
 	Ici * wlan_rx;
 	int nb_wlan;
 	int i; // loop variable
+	Wpan_Node_Param ** wlan_nodes;
 	Wpan_Node_Param * element;
 	double prop_delay;
 	double delivery_time;
@@ -1015,13 +1094,13 @@ wpan_update_wlan_flag (const Buff_Info_Packet * info_packet)
 		lr_wpan_chan_error ("wpan_update_wlan_flag:", "No packet information found.", OPC_NIL);
 	
 	/* get the number of WLAN in the topology */
-	nb_wlan = wpan_list_size_get_wlan_node ();
+	nb_wlan = wpan_wlan_nodes_get (&wlan_nodes);
 		
 	/* For each WLAN, we need to send an interuption */
 	for (i = 0; i < nb_wlan; i++)
 		{
 		/* get the WLAN device */
-		element = wpan_search_wlan_node (i);
+		element = wlan_nodes[i];
 		
 		/* compute the propagation delay */
 		prop_delay = sqrt((info_packet->tx_x - element->x)*(info_packet->tx_x - element->x) + 
@@ -1064,7 +1143,9 @@ static void
 wpan_flag_cca (const Buff_Info_Packet * info_packet)
 {
 	Wpan_Node_Param * element;
-	int list_size = op_prg_list_size (wpan_node_param_list);
+	Wpan_Node_Param * tx_node;
+	Wpan_Node_Param ** neighbors;
+	int nb_neighbors;
 	int i; // loop variable
 	double distance;
 	double prop_delay;
@@ -1082,14 +1163,20 @@ wpan_flag_cca (const Buff_Info_Packet * info_packet)
 	//if(DEBUG_Channel) printf("CHANNEL MODULE: CCA schedule remote, test coord. x %f\n", info_packet->tx_x);
 	//if(DEBUG_Channel) printf("CHANNEL MODULE: CCA schedule remote, test coord. y %f\n", info_packet->tx_y);
 	
+	/* get the transmitter node to use the propagation delays already computed */
+	tx_node = wpan_node_search_at (info_packet->src_objid, info_packet->tx_x, info_packet->tx_y);
+	
+	/* get the nodes in the sensing area of the transmitter */
+	nb_neighbors = wpan_node_neighbors_get (info_packet->tx_x, info_packet->tx_y, cca_sensing_radius, &neighbors);
+	
 	/*
-	 * We check all the node list to know whether we need
+	 * We check all these nodes to know whether we need
 	 * to send an interuption for the CCA
 	 */
-	for (i=0; i<list_size; i++)
+	for (i=0; i<nb_neighbors; i++)
 		{
 		/* get the element in the node list */
-		element = op_prg_list_access (wpan_node_param_list, i);
+		element = neighbors[i];
 		/* if the node asks for a CCA */
 		// equality of frequencies depends on detection mechanism
 		//if ((element->cca_requirement) && (element->frequency_wpan == info_packet->frequency))
@@ -1097,18 +1184,25 @@ wpan_flag_cca (const Buff_Info_Packet * info_packet)
 			{
 			//if(DEBUG_Channel) printf("X: %f, Y: %f\n", element->x, element->y);
 			
-			deltaX = info_packet->tx_x - element->x;
-			deltaY = info_packet->tx_y - element->y;
-			
-			deltaXsquare = deltaX*deltaX;
-			deltaYsquare = deltaY*deltaY;
-			
-			/* compute the distance between the two nodes */
-			distance = sqrt(deltaXsquare + deltaYsquare);
-			//distance = sqrt((info_packet->tx_x - element->x)*(info_packet->tx_x - element->x) + (info_packet->tx_y - element->y)*(info_packet->tx_y - element->y));		
-			
-			/* compute the propagation delay */
-			prop_delay = distance/LIGHT_SPEED;
+			if (tx_node != NULL)
+				{
+				/* get the propagation delay between the two nodes */
+				prop_delay = wpan_node_prop_delay_get (tx_node, element);
+				}
+			else
+				{
+				deltaX = info_packet->tx_x - element->x;
+				deltaY = info_packet->tx_y - element->y;
+				
+				deltaXsquare = deltaX*deltaX;
+				deltaYsquare = deltaY*deltaY;
+				
+				/* compute the distance between the two nodes */
+				distance = sqrt(deltaXsquare + deltaYsquare);
+				
+				/* compute the propagation delay */
+				prop_delay = distance/LIGHT_SPEED;
+				}
 				
 			/* schedule an event for the CCA period */
 			op_intrpt_schedule_remote (op_sim_time () + prop_delay, WPAN_CCA_CODE, element->objid);
@@ -1176,6 +1270,10 @@ static void channel_collect_stat ()
 	
 	char report_name[20] = "channel.txt";
 	char report_name_m[20] = "channel_matlab.txt";
+	char report_name_pool[20] = "channel_pool.txt";
+	
+	Buff_Pool_Stat pool_stat;
+	Buff_Pool_Stat collision_pool_stat;
 	
 	
 	//char traffic_name[20] = "_G_";
@@ -1238,7 +1336,7 @@ static void channel_collect_stat ()
 		double_to_string (op_sim_time (), strlen ("simulation time")),
 		date_str);
 		
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
 	
 	
 	/* cretae a  .txt file without headers, for Matlab postprocessing */
@@ -1255,7 +1353,37 @@ static void channel_collect_stat ()
 		integer_to_string ((int)N_occupied_slots_PSMA, 15),
 		double_to_string (op_sim_time (), strlen ("simulation time")));
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
+	
+	/* write the statistics of the channel buffer pools */
+	channel_buffer_pool_stat_get (&pool_stat, &collision_pool_stat);
+	
+	fp = lr_wpan_open_report_file (report_name_pool, &exist);
+	
+	if (!exist)
+		{
+		fprintf (fp, "\n\t*** Channel buffer cell pool ***\n");
+		fprintf (fp, "\tCreation date: %s\n", date_str);
+		
+		fprintf (fp, "Cells allocated\t Cells freed\t Cells in use\t Max cells in use\t Slabs\t Collisions allocated\t Collisions freed\t Collisions in use\t Max collisions in use\t Collision slabs\t Simulation time\n\n");
+		}
+	
+	fprintf (fp, "%15.0f\t %15.0f\t %s\t %s\t %s\t",
+		pool_stat.nb_alloc,
+		pool_stat.nb_free,
+		integer_to_string (pool_stat.nb_in_use, 15),
+		integer_to_string (pool_stat.max_in_use, 15),
+		integer_to_string (pool_stat.nb_slabs, 15));
+	
+	fprintf (fp, " %15.0f\t %15.0f\t %s\t %s\t %s\t %s\n",
+		collision_pool_stat.nb_alloc,
+		collision_pool_stat.nb_free,
+		integer_to_string (collision_pool_stat.nb_in_use, 15),
+		integer_to_string (collision_pool_stat.max_in_use, 15),
+		integer_to_string (collision_pool_stat.nb_slabs, 15),
+		double_to_string (op_sim_time (), strlen ("simulation time")));
+	
+	lr_wpan_close_report_file (fp);
 	
 	for(i=0;i<STAT_FILE_LENGTH;i++)
 		{
@@ -1265,10 +1393,10 @@ static void channel_collect_stat ()
 		}
 	fprintf(fp_busy, "\n");
 	fprintf(fp_idle, "\n");
-	fclose (fp_busy);
-	fclose (fp_idle);
+	lr_wpan_close_report_file (fp_busy);
+	lr_wpan_close_report_file (fp_idle);
 	fprintf(fp_useful, "\n");
-	fclose (fp_useful);
+	lr_wpan_close_report_file (fp_useful);
 	
 	
 	FOUT;
@@ -1599,6 +1727,12 @@ lr_wpan_channel_PSMA (OP_SIM_CONTEXT_ARG_OPT)
 					
 					channel_collect_stat();
 					
+					/* give back the memory of the channel buffer */
+					channel_buffer_release ();
+
+					/* give back the memory of the interferer batch */
+					snr_batch_release (&interferer_batch);
+					
 					if(DEBUG_Channel)
 						fclose(fp_channel_debug);
 					
@@ -1712,7 +1846,6 @@ _op_lr_wpan_channel_PSMA_terminate (OP_SIM_CONTEXT_ARG_OPT)
 #undef intrpt_type
 #undef intrpt_stream
 #undef intrpt_code
-#undef channel_pkt_queue
 #undef DEBUG_Channel
 #undef buffer_size_handle
 #undef buffer_size_pkts
@@ -1723,6 +1856,8 @@ _op_lr_wpan_channel_PSMA_terminate (OP_SIM_CONTEXT_ARG_OPT)
 #undef last_time_inc_N_occ
 #undef N_occupied_slots_PSMA
 #undef capture_effect_enabled
+#undef cca_sensing_radius
+#undef multi_interferer_capture
 #undef useful_slots
 #undef busy_slots
 #undef idle_slots
@@ -1810,11 +1945,6 @@ _op_lr_wpan_channel_PSMA_svar (void * gen_ptr, const char * var_name, void ** va
 		*var_p_ptr = (void *) (&prs_ptr->intrpt_code);
 		FOUT
 		}
-	if (strcmp ("channel_pkt_queue" , var_name) == 0)
-		{
-		*var_p_ptr = (void *) (&prs_ptr->channel_pkt_queue);
-		FOUT
-		}
 	if (strcmp ("DEBUG_Channel" , var_name) == 0)
 		{
 		*var_p_ptr = (void *) (&prs_ptr->DEBUG_Channel);
@@ -1865,6 +1995,16 @@ _op_lr_wpan_channel_PSMA_svar (void * gen_ptr, const char * var_name, void ** va
 		*var_p_ptr = (void *) (&prs_ptr->capture_effect_enabled);
 		FOUT
 		}
+	if (strcmp ("cca_sensing_radius" , var_name) == 0)
+		{
+		*var_p_ptr = (void *) (&prs_ptr->cca_sensing_radius);
+		FOUT
+		}
+	if (strcmp ("multi_interferer_capture" , var_name) == 0)
+		{
+		*var_p_ptr = (void *) (&prs_ptr->multi_interferer_capture);
+		FOUT
+		}
 	if (strcmp ("useful_slots" , var_name) == 0)
 		{
 		*var_p_ptr = (void *) (&prs_ptr->useful_slots);
@@ -369,7 +369,7 @@ lr_wpan_ss_pkt_recv (void)
 		lr_wpan_mac_error ("lr_wpan_ss_pkt_recv:", "Cannot access the source node parameters.", OPC_NIL);
 		
 	/* get the information */
-	element = op_prg_list_access (wpan_node_param_list, pos_index);
+	element = wpan_node_get (pos_index);
 	
 	/* update the share statistic */
 	element->share_statistic ++;
@@ -432,7 +432,7 @@ lr_wpan_ss_collect_stat (void)
 		lr_wpan_mac_error ("lr_wpan_ss_pkt_recv:", "Cannot access the curent node parameters.", OPC_NIL);
 		
 	/* get the information */
-	element = op_prg_list_access (wpan_node_param_list, pos_index);
+	element = wpan_node_get (pos_index);
 	
 	/* start printing report */
 	/* get the report name */
@@ -465,7 +465,7 @@ lr_wpan_ss_collect_stat (void)
 		double_to_string (op_sim_time (), strlen ("Simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
   
 	
 	FOUT;
@@ -28,6 +28,56 @@
 
 /* include header */
 #include "lr_wpan_stat_write.h"
+#include <math.h>
+
+/* number of report files kept open at once */
+#define LR_WPAN_REPORT_CACHE_SIZE	32
+
+/* size of the write buffer of a report file */
+#define LR_WPAN_REPORT_BUFFER_SIZE	65536
+
+/* strings returned by integer_to_string and double_to_string: each */
+/* one stays valid for the next LR_WPAN_STRING_POOL_SIZE - 1 calls   */
+#define LR_WPAN_STRING_POOL_SIZE	64
+#define LR_WPAN_STRING_SIZE			64
+
+/* number of records of a stream kept in memory between two writes */
+#define LR_WPAN_RECORD_CHUNK_SIZE	256
+
+/* record of a time histogram */
+typedef struct {
+	double	time;
+	int		value;
+	int		nb_events;
+} Wpan_Histogram_Record;
+
+/* report file kept open by lr_wpan_open_report_file */
+typedef struct {
+	char *			name;
+	FILE *			fp;
+	unsigned long	last_use;
+} Wpan_Report_File;
+
+static Wpan_Report_File	report_files[LR_WPAN_REPORT_CACHE_SIZE];
+static int				nb_report_files = 0;
+static unsigned long	report_use_clock = 0;
+
+static char				string_pool[LR_WPAN_STRING_POOL_SIZE][LR_WPAN_STRING_SIZE];
+static int				string_pool_index = 0;
+
+/* directory of the reports, read from the WPAN channel */
+static char				report_directory[256];
+static int				report_directory_size = 0;
+
+/* ring buffer of the binary trace, one for the simulation */
+static Wpan_Trace_Record *	trace_records = NULL;
+static int					trace_nb_records = 0;
+static unsigned int			trace_nb_events = 0;
+static char *				trace_report_name = NULL;
+
+/* local function prototypes */
+static char *	lr_wpan_report_path_get (const char * name);
+static char *	lr_wpan_pad_string (const char * buffer, int str_size);
 
 
 /*
@@ -58,89 +108,153 @@ void lr_wpan_stat_error (const char * fcnt, const char * msg, const char * opt)
 
 
 /*
- * Function:	lr_wpan_open_report_file
+ * Function:	lr_wpan_report_path_get
  *
- * Description:	open a file and return the file pointer
- *				to it.
+ * Description:	get the total name of a report file, in the
+ *				report directory of the WPAN channel
  *
  * ParamIn:		const char * name
- *				total name of the file to open
- *
- *				Boolean * already_created
- *				if the file exists, this flag will be true,
- *				otherswise, it is false
+ *				name of the report file
  *
- * ParamOut:	FILE * fp
- *				file pointer
+ * ParamOut:	char * total_report_name
+ *				total name of the file, to free
  */
 
-FILE * lr_wpan_open_report_file (const char * name, Boolean * already_created)
+static char * lr_wpan_report_path_get (const char * name)
 {
-	FILE * fp; // return value
-	Boolean is_already_exists = OPC_FALSE;
 	char * total_report_name;
 	int total_report_name_size;
 	const char * default_path = "C:\\Users\\bgebreme\\op_reports\\";
 	char message[256];
 	
-	static char directory_path[256];
-	static int directory_path_size = 0;
-	
+	FIN (lr_wpan_report_path_get (name));
 	
-	FIN (lr_wpan_open_report_file (name, already_created));
-		
 	/* get the report directory path */
-	if (directory_path_size == 0)
+	if (report_directory_size == 0)
 		{
 		/* access the global attribute in the channel */
-		//if (op_ima_sim_attr_get_str ("Directory Path", 256, directory_path) == OPC_COMPCODE_FAILURE)
-		if (op_ima_obj_attr_get_str (wpan_channel_objid, "Report Path", 256, directory_path) == OPC_COMPCODE_FAILURE)
+		//if (op_ima_sim_attr_get_str ("Directory Path", 256, report_directory) == OPC_COMPCODE_FAILURE)
+		if (op_ima_obj_attr_get_str (wpan_channel_objid, "Report Path", 256, report_directory) == OPC_COMPCODE_FAILURE)
 			{
 			/* set the message to display */
 			sprintf (message, "Path set to default: %s", default_path);
 			
-			/*printf ("Report Path: %s\n", directory_path);*/
+			/*printf ("Report Path: %s\n", report_directory);*/
 			/* print the message */
 			op_sim_message ("lr_wpan_open_report_file: Unable to read the report directory path.\nCheck if the WPAN Channel is present in the topology", message);
 			
 			/* set the path to default */
-			strcpy (directory_path, default_path);
+			strcpy (report_directory, default_path);
 			}
 		
-		/* get the size of the string "directory_path" */
-		directory_path_size = strlen (directory_path);
+		/* get the size of the string "report_directory" */
+		report_directory_size = strlen (report_directory);
 		}
 	
 	/* compute the size of the string "total_report_name" */
-	total_report_name_size = directory_path_size + strlen (name) + 1;
+	total_report_name_size = report_directory_size + strlen (name) + 1;
 	
 	/* allocate memory and get the total report name */
 	total_report_name = (char *) op_prg_mem_alloc (total_report_name_size * sizeof (char));
-	sprintf (total_report_name, "%s%s", directory_path, name);
+	sprintf (total_report_name, "%s%s", report_directory, name);
 	/* printf ("total report name: %s\n", total_report_name);*/
+	
+	FRET (total_report_name);
+}
 
-		
-	/* open the file in read mode */
-	if ((fp = fopen (total_report_name, "r")) != NULL)
+
+/*
+ * Function:	lr_wpan_open_report_file
+ *
+ * Description:	open a file and return the file pointer
+ *				to it. The file is opened once in append
+ *				mode with a large buffer and kept open:
+ *				the caller releases it with
+ *				lr_wpan_close_report_file. At most
+ *				LR_WPAN_REPORT_CACHE_SIZE files are open
+ *				at once, the least recently used one is
+ *				closed to open a new one.
+ *
+ * ParamIn:		const char * name
+ *				total name of the file to open
+ *
+ *				Boolean * already_created
+ *				if the file exists, this flag will be true,
+ *				otherswise, it is false
+ *
+ * ParamOut:	FILE * fp
+ *				file pointer
+ */
+
+FILE * lr_wpan_open_report_file (const char * name, Boolean * already_created)
+{
+	FILE * fp; // return value
+	Boolean is_already_exists = OPC_FALSE;
+	char * total_report_name;
+	Wpan_Report_File * report;
+	int i; // loop variable
+	
+	
+	FIN (lr_wpan_open_report_file (name, already_created));
+	
+	total_report_name = lr_wpan_report_path_get (name);
+	
+	/* the file is already open: it has been created before */
+	for (i = 0; i < nb_report_files; i++)
+		{
+		if (!strcmp (report_files[i].name, total_report_name))
+			{
+			op_prg_mem_free (total_report_name);
+			
+			report_files[i].last_use = ++report_use_clock;
+			*already_created = OPC_TRUE;
+			
+			FRET (report_files[i].fp);
+			}
+		}
+	
+	/* make room for the file: close the least recently used one */
+	if (nb_report_files == LR_WPAN_REPORT_CACHE_SIZE)
 		{
-		/* the file is already created */
-		is_already_exists = OPC_TRUE;
+		report = &report_files[0];
+		for (i = 1; i < nb_report_files; i++)
+			{
+			if (report_files[i].last_use < report->last_use)
+				report = &report_files[i];
+			}
 		
-		/* we close the file in order to open it again in "append" mode */
-		fclose (fp);
+		fclose (report->fp);
+		op_prg_mem_free (report->name);
+		
+		*report = report_files[--nb_report_files];
 		}
 		
 	if ((fp = fopen (total_report_name, "a")) == NULL)
 		lr_wpan_stat_error ("lr_wpan_open_report_file:", "Unable to open or create the report file:", name);
-	else if (ODB_STAT_WRITE)
+	else
 		{
-		/* printing information */
-		printf ("+------------------------------------------------------\n");
-		printf ("| Statistic Report Printing.\n");
-		printf ("| \tLocation: %s\n", directory_path);
-		printf ("| \tFile name: %s\n", name);
-		printf ("| \t%s\n", is_already_exists ? "the file already exists: we append it" : "The file doesn't exist, we create it");
-		printf ("+------------------------------------------------------\n");
+		setvbuf (fp, NULL, _IOFBF, LR_WPAN_REPORT_BUFFER_SIZE);
+		
+		/* the file is already created if it is not empty */
+		fseek (fp, 0, SEEK_END);
+		is_already_exists = (ftell (fp) > 0) ? OPC_TRUE : OPC_FALSE;
+		
+		/* keep the file open */
+		report = &report_files[nb_report_files++];
+		report->name = total_report_name;
+		report->fp = fp;
+		report->last_use = ++report_use_clock;
+		
+		if (ODB_STAT_WRITE)
+			{
+			/* printing information */
+			printf ("+------------------------------------------------------\n");
+			printf ("| Statistic Report Printing.\n");
+			printf ("| \tLocation: %s\n", report_directory);
+			printf ("| \tFile name: %s\n", name);
+			printf ("| \t%s\n", is_already_exists ? "the file already exists: we append it" : "The file doesn't exist, we create it");
+			printf ("+------------------------------------------------------\n");
+			}
 		}
 	
 	/* update the flag in parameter */
@@ -150,6 +264,101 @@ FILE * lr_wpan_open_report_file (const char * name, Boolean * already_created)
 }
 
 
+/*
+ * Function:	lr_wpan_close_report_file
+ *
+ * Description:	release a file returned by
+ *				lr_wpan_open_report_file. The file stays
+ *				open and its buffer is written when it is
+ *				closed by lr_wpan_close_report_files.
+ *
+ * ParamIn:		FILE * fp
+ *				file pointer
+ */
+
+void lr_wpan_close_report_file (FILE * fp)
+{
+	int i; // loop variable
+	
+	FIN (lr_wpan_close_report_file (fp));
+	
+	for (i = 0; i < nb_report_files; i++)
+		{
+		if (report_files[i].fp == fp)
+			FOUT;
+		}
+	
+	/* not a report file */
+	fclose (fp);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_close_report_files
+ *
+ * Description:	close all the report files kept open.
+ *				The files still open at the end of the
+ *				simulation process are also written by
+ *				its exit.
+ *
+ * No parameter
+ */
+
+void lr_wpan_close_report_files (void)
+{
+	int i; // loop variable
+	
+	FIN (lr_wpan_close_report_files ());
+	
+	for (i = 0; i < nb_report_files; i++)
+		{
+		fclose (report_files[i].fp);
+		op_prg_mem_free (report_files[i].name);
+		}
+	
+	nb_report_files = 0;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_pad_string
+ *
+ * Description:	take a string of the pool and copy the
+ *				buffer in it, right aligned on str_size
+ *				characters
+ *
+ * ParamIn:		const char * buffer
+ *				characters to copy
+ *
+ *				int str_size
+ *				number of character of the string
+ *
+ * ParamOut:	char * string
+ *				string of the pool
+ */
+
+static char * lr_wpan_pad_string (const char * buffer, int str_size)
+{
+	char * string;
+	
+	FIN (lr_wpan_pad_string (buffer, str_size));
+	
+	string = string_pool[string_pool_index];
+	string_pool_index = (string_pool_index + 1) % LR_WPAN_STRING_POOL_SIZE;
+	
+	if (str_size >= LR_WPAN_STRING_SIZE)
+		str_size = LR_WPAN_STRING_SIZE - 1;
+	
+	snprintf (string, LR_WPAN_STRING_SIZE, "%*s", str_size, buffer);
+	
+	FRET (string);
+}
+
+
 /*
  * Function:	integer_to_string
  *
@@ -169,9 +378,6 @@ FILE * lr_wpan_open_report_file (const char * name, Boolean * already_created)
 char * integer_to_string (int integer, int str_size)
 {
 	char buffer[32];
-	char * string;
-	int size;
-	int i; // loop variable
 	
 	FIN (integer_to_string (integer, str_size));
 	
@@ -181,34 +387,7 @@ char * integer_to_string (int integer, int str_size)
 	else
 		sprintf (buffer, "%d", integer);
 	
-	if ((size = strlen(buffer)) >= str_size)
-		{
-		/* allocate the string */
-		string = (char *) op_prg_mem_alloc ((size + 1) * sizeof (char));
-		
-		/* copy the buffer*/
-		strcpy (string, buffer);
-		}
-	else
-		{
-		/* allocate the string */
-		string = (char *) op_prg_mem_alloc ((str_size + 1) * sizeof (char));
-		
-		/* complete the first cell with a space */
-		for (i=0; i< (str_size - size); i++)
-			string[i] = ' ';
-		
-		string[i] = '\0';
-		
-		/* complete the string */
-		if (integer == -1)
-			strcat (string, "N/A");
-		else
-			sprintf (string, "%s%d", string, integer);
-		}
-	
-	
-	FRET (string);
+	FRET (lr_wpan_pad_string (buffer, str_size));
 }
 
 
@@ -231,10 +410,7 @@ char * integer_to_string (int integer, int str_size)
 
 char * double_to_string (double a_double, int str_size)
 {
-	char buffer[32];
-	char * string;
-	int size;
-	int i; // loop variable
+	char buffer[LR_WPAN_STRING_SIZE];
 	
 	FIN (double_to_string (a_double, str_size));
 	
@@ -242,35 +418,9 @@ char * double_to_string (double a_double, int str_size)
 	if (a_double == -1.0)
 		strcpy (buffer, "N/A");
 	else
-		sprintf (buffer, "%.6f", a_double);
-	
-	if ((size = strlen(buffer)) >= str_size)
-		{
-		/* allocate the string */
-		string = (char *) op_prg_mem_alloc ((size + 1) * sizeof (char));
-		
-		/* copy the buffer*/
-		strcpy (string, buffer);
-		}
-	else
-		{
-		/* allocate the string */
-		string = (char *) op_prg_mem_alloc ((str_size + 1) * sizeof (char));
-		
-		/* complete the first cell with a space */
-		for (i=0; i< (str_size - size); i++)
-			string[i] = ' ';
-		
-		string[i] = '\0';
-		
-		/* complete the string */
-		if (a_double == -1.0)
-			strcat (string, "N/A");
-		else
-			sprintf (string, "%s%.6f", string, a_double);
-		}
+		snprintf (buffer, sizeof (buffer), "%.6f", a_double);
 	
-	FRET (string);
+	FRET (lr_wpan_pad_string (buffer, str_size));
 }
 
 /*
@@ -327,7 +477,475 @@ void wlan_mac_collect_stat (const WlanT_Mac_Stat wlan_stat, const char * wlan_na
 		double_to_string (op_sim_time (), strlen ("Simulation time")),
 		date_str);
 	
-	fclose (fp);
+	lr_wpan_close_report_file (fp);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_record_stream_create
+ *
+ * Description:	create a stream of records written in a
+ *				report by chunks of LR_WPAN_RECORD_CHUNK_SIZE
+ *				records, so that the memory used does not grow
+ *				with the simulated time and the report can be
+ *				followed during the simulation
+ *
+ * ParamIn:		const char * report_name
+ *				name of the report file
+ *
+ *				const char * header
+ *				header written when the file is created
+ *
+ *				int record_size
+ *				size of a record
+ *
+ *				Wpan_Record_Proc record_proc
+ *				function writing a record in the file
+ *
+ * ParamOut:	Wpan_Record_Stream * stream
+ *				the stream
+ */
+
+Wpan_Record_Stream * lr_wpan_record_stream_create (const char * report_name, const char * header, int record_size, Wpan_Record_Proc record_proc)
+{
+	Wpan_Record_Stream * stream;
+	
+	FIN (lr_wpan_record_stream_create (report_name, header, record_size, record_proc));
+	
+	stream = (Wpan_Record_Stream *) op_prg_mem_alloc (sizeof (Wpan_Record_Stream));
+	
+	stream->report_name = (char *) op_prg_mem_alloc ((strlen (report_name) + 1) * sizeof (char));
+	strcpy (stream->report_name, report_name);
+	stream->header = (char *) op_prg_mem_alloc ((strlen (header) + 1) * sizeof (char));
+	strcpy (stream->header, header);
+	
+	stream->record_proc = record_proc;
+	stream->record_size = record_size;
+	stream->nb_records = 0;
+	stream->records = (char *) op_prg_mem_alloc (LR_WPAN_RECORD_CHUNK_SIZE * record_size);
+	
+	FRET (stream);
+}
+
+
+/*
+ * Function:	lr_wpan_record_stream_append
+ *
+ * Description:	add a record to the stream, the records
+ *				kept are written first if the chunk is full
+ *
+ * ParamIn:		Wpan_Record_Stream * stream
+ *				the stream
+ *
+ * ParamOut:	void * record
+ *				the record to fill, valid until the next
+ *				call on the stream
+ */
+
+void * lr_wpan_record_stream_append (Wpan_Record_Stream * stream)
+{
+	FIN (lr_wpan_record_stream_append (stream));
+	
+	if (stream->nb_records == LR_WPAN_RECORD_CHUNK_SIZE)
+		lr_wpan_record_stream_flush (stream);
+	
+	FRET (stream->records + (stream->nb_records++) * stream->record_size);
+}
+
+
+/*
+ * Function:	lr_wpan_record_stream_flush
+ *
+ * Description:	write the records kept in the report file
+ *				(with the header if the file is created) and
+ *				push them to the disk
+ *
+ * ParamIn:		Wpan_Record_Stream * stream
+ *				the stream
+ */
+
+void lr_wpan_record_stream_flush (Wpan_Record_Stream * stream)
+{
+	FILE * fp;
+	Boolean exist;
+	int i; // loop variable
+	
+	FIN (lr_wpan_record_stream_flush (stream));
+	
+	fp = lr_wpan_open_report_file (stream->report_name, &exist);
+	
+	/* write a header in the file if it has been created now */
+	if (!exist)
+		fputs (stream->header, fp);
+	
+	for (i = 0; i < stream->nb_records; i++)
+		stream->record_proc (fp, stream->records + i * stream->record_size);
+	
+	stream->nb_records = 0;
+	
+	fflush (fp);
+	lr_wpan_close_report_file (fp);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_record_stream_close
+ *
+ * Description:	write the last records and the end mark of
+ *				the stream, and free it
+ *
+ * ParamIn:		Wpan_Record_Stream * stream
+ *				the stream
+ */
+
+void lr_wpan_record_stream_close (Wpan_Record_Stream * stream)
+{
+	FILE * fp;
+	Boolean exist;
+	
+	FIN (lr_wpan_record_stream_close (stream));
+	
+	lr_wpan_record_stream_flush (stream);
+	
+	fp = lr_wpan_open_report_file (stream->report_name, &exist);
+	fprintf (fp, "--------------------------------------------------\n");
+	lr_wpan_close_report_file (fp);
+	
+	op_prg_mem_free (stream->records);
+	op_prg_mem_free (stream->header);
+	op_prg_mem_free (stream->report_name);
+	op_prg_mem_free (stream);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_write_event_record
+ *
+ * Description:	write the record of a single event: its
+ *				time and the value of the counter
+ */
+
+static void lr_wpan_write_event_record (FILE * fp, const void * record)
+{
+	const Wpan_Histogram_Record * elem_ptr = (const Wpan_Histogram_Record *) record;
+	
+	FIN (lr_wpan_write_event_record (fp, record));
+	
+	fprintf (fp, "%s\t %s\n",
+		double_to_string (elem_ptr->time, 10),
+		integer_to_string (elem_ptr->value, 10));
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_write_bin_record
+ *
+ * Description:	write the record of a bin: its end time,
+ *				the value of the counter at the last event
+ *				and the number of events in the bin
+ */
+
+static void lr_wpan_write_bin_record (FILE * fp, const void * record)
+{
+	const Wpan_Histogram_Record * elem_ptr = (const Wpan_Histogram_Record *) record;
+	
+	FIN (lr_wpan_write_bin_record (fp, record));
+	
+	fprintf (fp, "%s\t %s\t %s\n",
+		double_to_string (elem_ptr->time, 10),
+		integer_to_string (elem_ptr->value, 10),
+		integer_to_string (elem_ptr->nb_events, 10));
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_time_histogram_create
+ *
+ * Description:	create the histogram of a counter over the
+ *				simulated time, written in a report file.
+ *				The memory used and the size of the report
+ *				depend on the number of bins only.
+ *
+ * ParamIn:		const char * report_name
+ *				name of the report file
+ *
+ *				const char * header
+ *				header written when the file is created
+ *
+ *				double bin_width
+ *				width of a bin in seconds, 0 to write
+ *				every event
+ *
+ * ParamOut:	Wpan_Time_Histogram * histogram
+ *				the histogram
+ */
+
+Wpan_Time_Histogram * lr_wpan_time_histogram_create (const char * report_name, const char * header, double bin_width)
+{
+	Wpan_Time_Histogram * histogram;
+	
+	FIN (lr_wpan_time_histogram_create (report_name, header, bin_width));
+	
+	histogram = (Wpan_Time_Histogram *) op_prg_mem_alloc (sizeof (Wpan_Time_Histogram));
+	
+	histogram->bin_width = (bin_width > 0.0) ? bin_width : 0.0;
+	histogram->stream = lr_wpan_record_stream_create (report_name, header, sizeof (Wpan_Histogram_Record),
+		(histogram->bin_width > 0.0) ? lr_wpan_write_bin_record : lr_wpan_write_event_record);
+	histogram->bin = -1;
+	histogram->time = 0.0;
+	histogram->value = 0;
+	histogram->nb_events = 0;
+	
+	FRET (histogram);
+}
+
+
+/*
+ * Function:	lr_wpan_time_histogram_write_bin
+ *
+ * Description:	write the current bin of the histogram
+ *				if it holds an event
+ */
+
+static void lr_wpan_time_histogram_write_bin (Wpan_Time_Histogram * histogram)
+{
+	Wpan_Histogram_Record * record;
+	
+	FIN (lr_wpan_time_histogram_write_bin (histogram));
+	
+	if (histogram->nb_events > 0)
+		{
+		record = (Wpan_Histogram_Record *) lr_wpan_record_stream_append (histogram->stream);
+		record->time = histogram->time;
+		record->value = histogram->value;
+		record->nb_events = histogram->nb_events;
+		histogram->nb_events = 0;
+		}
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_time_histogram_add
+ *
+ * Description:	record an event of the counter
+ *
+ * ParamIn:		Wpan_Time_Histogram * histogram
+ *				the histogram
+ *
+ *				double time
+ *				time of the event
+ *
+ *				int value
+ *				value of the counter after the event
+ */
+
+void lr_wpan_time_histogram_add (Wpan_Time_Histogram * histogram, double time, int value)
+{
+	int bin;
+	
+	FIN (lr_wpan_time_histogram_add (histogram, time, value));
+	
+	if (histogram->bin_width == 0.0)
+		{
+		/* every event has its own record */
+		histogram->time = time;
+		histogram->value = value;
+		histogram->nb_events = 1;
+		lr_wpan_time_histogram_write_bin (histogram);
+		FOUT;
+		}
+	
+	/* close the current bin if the event is after it */
+	bin = (int) floor (time / histogram->bin_width);
+	if (bin != histogram->bin)
+		{
+		lr_wpan_time_histogram_write_bin (histogram);
+		histogram->bin = bin;
+		histogram->time = (bin + 1) * histogram->bin_width;
+		}
+	
+	histogram->value = value;
+	histogram->nb_events++;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_time_histogram_close
+ *
+ * Description:	write the last bin and the end of the
+ *				report, and free the histogram
+ *
+ * ParamIn:		Wpan_Time_Histogram * histogram
+ *				the histogram
+ */
+
+void lr_wpan_time_histogram_close (Wpan_Time_Histogram * histogram)
+{
+	FIN (lr_wpan_time_histogram_close (histogram));
+	
+	lr_wpan_time_histogram_write_bin (histogram);
+	lr_wpan_record_stream_close (histogram->stream);
+	op_prg_mem_free (histogram);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_trace_buffer_create
+ *
+ * Description:	create the ring buffer of the binary trace of the
+ *				MAC events. It keeps the last nb_records events,
+ *				written in the report file when it is closed. The
+ *				first call creates the buffer, the next ones are
+ *				ignored.
+ *
+ * ParamIn:		const char * report_name
+ *				name of the binary report file
+ *
+ *				int nb_records
+ *				number of events kept
+ */
+
+void lr_wpan_trace_buffer_create (const char * report_name, int nb_records)
+{
+	FIN (lr_wpan_trace_buffer_create (report_name, nb_records));
+	
+	if (trace_records != NULL || nb_records <= 0)
+		FOUT;
+	
+	trace_records = (Wpan_Trace_Record *) op_prg_mem_alloc (nb_records * sizeof (Wpan_Trace_Record));
+	trace_nb_records = nb_records;
+	trace_nb_events = 0;
+	
+	trace_report_name = (char *) op_prg_mem_alloc ((strlen (report_name) + 1) * sizeof (char));
+	strcpy (trace_report_name, report_name);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_trace_buffer_active
+ *
+ * Description:	check if the MAC events are recorded
+ */
+
+Boolean lr_wpan_trace_buffer_active (void)
+{
+	FIN (lr_wpan_trace_buffer_active ());
+	
+	FRET ((trace_records != NULL) ? OPC_TRUE : OPC_FALSE);
+}
+
+
+/*
+ * Function:	lr_wpan_trace_record
+ *
+ * Description:	record a MAC event in the ring buffer, over the
+ *				oldest one if the buffer is full
+ *
+ * ParamIn:		double time
+ *				time of the event
+ *
+ *				int mac_address
+ *				MAC address of the node
+ *
+ *				const char * state
+ *				name of the state exited
+ *
+ *				int intrpt_type, intrpt_code
+ *				type and code (or stream) of the interruption
+ */
+
+void lr_wpan_trace_record (double time, int mac_address, const char * state, int intrpt_type, int intrpt_code)
+{
+	Wpan_Trace_Record * record;
+	
+	FIN (lr_wpan_trace_record (time, mac_address, state, intrpt_type, intrpt_code));
+	
+	/* the buffer may have been closed by the end of the simulation */
+	if (trace_records == NULL)
+		FOUT;
+	
+	record = &trace_records[(trace_nb_events++) % trace_nb_records];
+	
+	record->time = time;
+	record->mac_address = mac_address;
+	record->intrpt_type = intrpt_type;
+	record->intrpt_code = intrpt_code;
+	strncpy (record->state, state, LR_WPAN_TRACE_STATE_SIZE - 1);
+	record->state[LR_WPAN_TRACE_STATE_SIZE - 1] = '\0';
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	lr_wpan_trace_buffer_close
+ *
+ * Description:	write the events of the ring buffer, the oldest
+ *				first, in the binary report file, and free the
+ *				buffer
+ *
+ * No parameter
+ */
+
+void lr_wpan_trace_buffer_close (void)
+{
+	FILE * fp;
+	char * total_report_name;
+	Wpan_Trace_Header header;
+	int first, i;
+	
+	FIN (lr_wpan_trace_buffer_close ());
+	
+	if (trace_records == NULL)
+		FOUT;
+	
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, LR_WPAN_TRACE_MAGIC, sizeof (header.magic));
+	header.record_size = sizeof (Wpan_Trace_Record);
+	header.nb_records = (trace_nb_events < (unsigned int) trace_nb_records) ? (int) trace_nb_events : trace_nb_records;
+	header.nb_events = trace_nb_events;
+	
+	/* the binary file is not a report file of the cache */
+	total_report_name = lr_wpan_report_path_get (trace_report_name);
+	
+	if ((fp = fopen (total_report_name, "wb")) == NULL)
+		lr_wpan_stat_error ("lr_wpan_trace_buffer_close:", "Unable to create the trace file:", trace_report_name);
+	else
+		{
+		first = (trace_nb_events > (unsigned int) trace_nb_records) ? (int) (trace_nb_events % trace_nb_records) : 0;
+		
+		fwrite (&header, sizeof (header), 1, fp);
+		for (i = 0; i < header.nb_records; i++)
+			fwrite (&trace_records[(first + i) % trace_nb_records], sizeof (Wpan_Trace_Record), 1, fp);
+		
+		fclose (fp);
+		}
+	
+	op_prg_mem_free (total_report_name);
+	op_prg_mem_free (trace_report_name);
+	op_prg_mem_free (trace_records);
+	
+	trace_records = NULL;
+	trace_report_name = NULL;
+	trace_nb_records = 0;
 	
 	FOUT;
 }
@@ -46,12 +46,74 @@ typedef struct {
 } WlanT_Mac_Stat;
 
 
+/* write a record in a report file */
+typedef void (*Wpan_Record_Proc) (FILE * fp, const void * record);
+
+/* records of a report written by chunks during the simulation */
+typedef struct {
+	char *				report_name;
+	char *				header;
+	Wpan_Record_Proc	record_proc;
+	int					record_size;
+	int					nb_records;
+	char *				records;
+} Wpan_Record_Stream;
+
+/* counter sampled on a fixed time resolution: one record per bin
+   of bin_width seconds, or one per event when bin_width is 0 */
+typedef struct {
+	Wpan_Record_Stream *	stream;
+	double					bin_width;
+	int						bin;
+	double					time;
+	int						value;
+	int						nb_events;
+} Wpan_Time_Histogram;
+
+
+/* binary trace of the MAC events: a file starts with a
+   Wpan_Trace_Header followed by nb_records Wpan_Trace_Record */
+#define LR_WPAN_TRACE_MAGIC			"WPANTRC1"
+#define LR_WPAN_TRACE_STATE_SIZE	16
+
+typedef struct {
+	char			magic[8];
+	int				record_size;
+	int				nb_records;
+	unsigned int	nb_events;		// events recorded, the oldest ones are lost if greater than nb_records
+} Wpan_Trace_Header;
+
+typedef struct {
+	double	time;
+	int		mac_address;
+	int		intrpt_type;
+	int		intrpt_code;			// code, or stream of a stream interrupt
+	char	state[LR_WPAN_TRACE_STATE_SIZE];
+} Wpan_Trace_Record;
+
+
 /* function prototypes */
 void 	lr_wpan_stat_error (const char * fcnt, const char * msg, const char * opt);
 FILE *	lr_wpan_open_report_file (const char * name, Boolean * already_created);
+void	lr_wpan_close_report_file (FILE * fp);
+void	lr_wpan_close_report_files (void);
 char *	integer_to_string (int integer, int str_size);
 char *	double_to_string (double a_double, int str_size);
 void 	wlan_mac_collect_stat (const WlanT_Mac_Stat wlan_stat, const char * wlan_name);
 
+Wpan_Record_Stream *	lr_wpan_record_stream_create (const char * report_name, const char * header, int record_size, Wpan_Record_Proc record_proc);
+void *					lr_wpan_record_stream_append (Wpan_Record_Stream * stream);
+void					lr_wpan_record_stream_flush (Wpan_Record_Stream * stream);
+void					lr_wpan_record_stream_close (Wpan_Record_Stream * stream);
+
+Wpan_Time_Histogram *	lr_wpan_time_histogram_create (const char * report_name, const char * header, double bin_width);
+void					lr_wpan_time_histogram_add (Wpan_Time_Histogram * histogram, double time, int value);
+void					lr_wpan_time_histogram_close (Wpan_Time_Histogram * histogram);
+
+void					lr_wpan_trace_buffer_create (const char * report_name, int nb_records);
+Boolean					lr_wpan_trace_buffer_active (void);
+void					lr_wpan_trace_record (double time, int mac_address, const char * state, int intrpt_type, int intrpt_code);
+void					lr_wpan_trace_buffer_close (void);
+
 
 #endif // end of __LR_WPAN_STAT_WRITE__
@@ -29,6 +29,19 @@
 #include "lr_wpan_support_15_4a.h"
 #include "Physical_Layer.h"
 
+/* keys of the hash indexes of the registered nodes */
+typedef enum {
+	WPAN_NODE_KEY_MAC_ADDRESS,
+	WPAN_NODE_KEY_OBJID,
+	WPAN_NODE_KEY_PARENT_ID,
+	WPAN_NODE_NB_KEYS
+} Wpan_Node_Key;
+
+/* local function prototypes */
+static Wpan_Node_Param *	wpan_node_index_search (Wpan_Node_Key key_type, int key);
+static void					wpan_node_index_insert (Wpan_Node_Key key_type, Wpan_Node_Param * element);
+static void					wpan_node_index_remove (Wpan_Node_Key key_type, Wpan_Node_Param * element);
+
 /*
  * Function:	lr_wpan_mac_error
  *
@@ -137,7 +150,7 @@ int wpan_node_list_compare_proc (const Wpan_Node_Param * element1, const Wpan_No
 
 int wpan_search_mac_address (int mac_address)
 {
-	int i, pos_index = -1;
+	int pos_index = -1;
 	Wpan_Node_Param * element;
 	int nbElement = op_prg_list_size (wpan_node_param_list);
 	
@@ -146,16 +159,9 @@ int wpan_search_mac_address (int mac_address)
 	if (!nbElement)
 		lr_wpan_mac_error ("wpan_search_mac_address:", "No device registered.", OPC_NIL);
 
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
-		{
-		/* access the element */
-		element = op_prg_list_access (wpan_node_param_list, i);
-		
-		/* check the MAC address*/
-		if (element->mac_address == mac_address)
-			pos_index = i;
-		}
+	/* search the element in the index of the MAC addresses */
+	if ((element = wpan_node_index_search (WPAN_NODE_KEY_MAC_ADDRESS, mac_address)) != NULL)
+		pos_index = element->node_index;
 
 	FRET (pos_index);
 }
@@ -198,221 +204,1257 @@ void wpan_store_stranger_node (int mac_address, const char type[5], WlanT_Rx_Sta
 	op_ima_obj_attr_get (parent, "delta x", &d_x);
 	op_ima_obj_attr_get (parent, "delta y", &d_y);
 
-	x = x + d_x;
-	y = y + d_y;
-	/* end addition Milcom 05 */
+	x = x + d_x;
+	y = y + d_y;
+	/* end addition Milcom 05 */
+	
+	
+	/* create a new element */
+	new_elt = (Wpan_Node_Param *) op_prg_mem_alloc (sizeof(Wpan_Node_Param));
+	
+	/* fill out this new element */
+	new_elt->parent_id = parent;
+	new_elt->objid = parent;
+	new_elt->mac_address = mac_address;
+	new_elt->group = 0;
+	new_elt->slotted_enable = OPC_FALSE;
+	new_elt->master_enable = OPC_FALSE;
+	new_elt->x = x;
+	new_elt->y = y;
+	new_elt->cca_requirement = OPC_FALSE;
+	new_elt->share_statistic = 0;
+	new_elt->wlan_info = wlan_info;;
+	strcpy (new_elt->type, type);
+	
+	/* register the node into the list */
+	wpan_node_register (new_elt);
+	
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wlan_state_variable_get
+ *
+ * Description:	get a pointer to the state variable called
+ *				"rx_state_info_ptr" in the MAC layer of the WLAN
+ *				to update the field "rx_end_time"
+ *
+ * ParamIn:		Objid objid
+ *				ID of the process RX of the custom WLAN
+ *
+ * ParamOut:	pointer to the state variable of the MAC layer
+ *
+ * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
+ * DEVICES BE RECORDED IN THE DEVICE LIST.
+ */
+
+WlanT_Rx_State_Info * wlan_state_variable_get (Objid objid)
+{
+	Wpan_Node_Param * element;
+	int nbElement = op_prg_list_size (wpan_node_param_list);
+	
+	
+	FIN (wlan_state_variable_get (objid));
+	
+	/* check if the list is not empty */
+	if (!nbElement)
+		lr_wpan_mac_error ("wlan_state_variable_get:", "No device registered.", OPC_NIL);
+
+	/* search the element in the index of the object IDs */
+	if ((element = wpan_node_index_search (WPAN_NODE_KEY_OBJID, objid)) != NULL)
+		{
+		FRET ((WlanT_Rx_State_Info *) element->wlan_info);
+		}
+	
+	/* we shouldn't be here */
+	lr_wpan_mac_error ("wlan_state_variable_get:", "No device found.", OPC_NIL);
+	
+	FRET (NULL);
+}
+
+
+/*
+ * Function:	wpan_get_mac_address
+ *
+ * description:	get the MAC address of the Node according
+ *				to its ID
+ *				The node must be registered in the list
+ *				wpan_node_param_list
+ *
+ * ParamIn:		Objid node_id
+ *				ID of the node
+ *
+ * ParamOut:	int 
+ *				MAC address of the node
+ *
+ * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
+ * DEVICES BE RECORDED IN THE DEVICE LIST.
+ */
+
+int	wpan_get_mac_address (Objid node_id)
+{
+	Wpan_Node_Param * element;
+	int nbElement = op_prg_list_size (wpan_node_param_list);
+	
+	FIN (wpan_get_mac_address (node_id));
+	
+	/* check if the list is not empty */
+	if (!nbElement)
+		lr_wpan_mac_error ("wpan_get_mac_address:", "No device registered.", OPC_NIL);
+
+	/* search the element in the index of the node IDs */
+	if ((element = wpan_node_index_search (WPAN_NODE_KEY_PARENT_ID, node_id)) != NULL)
+		{
+		FRET (element->mac_address);
+		}
+	
+	/* we shouldn't be here */
+	lr_wpan_mac_error ("wpan_get_mac_address:", "No device found.", OPC_NIL);
+	
+	FRET (-1);
+}
+
+
+/*
+ * Function:	wpan_search_wlan_node
+ *
+ * Description:	search a wlan node
+ *
+ * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
+ * DEVICES BE RECORDED IN THE DEVICE LIST.
+ */
+
+Wpan_Node_Param * wpan_search_wlan_node (int index)
+{
+	Wpan_Node_Param ** wlan_nodes;
+	int nb_wlan;
+	
+	FIN (wpan_search_wlan_node (index));
+	
+	/* check if the list is not empty */
+	if (op_prg_list_size (wpan_node_param_list) == 0)
+		lr_wpan_mac_error ("wpan_search_wlan_node:", "No device found.", OPC_NIL);
+
+	/* the WLAN devices are kept in the order of the list of nodes */
+	nb_wlan = wpan_wlan_nodes_get (&wlan_nodes);
+	
+	if (index >= 0 && index < nb_wlan)
+		{
+		FRET (wlan_nodes[index]);
+		}
+	
+	/* we shouldn't be here */
+	if (index > nb_wlan)
+		{
+		/* if the index is too high, we print a special error message */
+		lr_wpan_mac_error ("wpan_search_wlan_node:", "The given index is too high.", OPC_NIL);
+		}
+	
+	/* otherwise, we print the standard error message */
+	lr_wpan_mac_error ("wpan_search_wlan_node:", "No device match the index.", OPC_NIL);
+	
+	FRET (OPC_NIL);
+}
+
+
+/*
+ * Function:	wpan_list_size_get_wlan_node
+ *
+ * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
+ * DEVICES BE RECORDED IN THE DEVICE LIST.
+ */
+int wpan_list_size_get_wlan_node ()
+{
+	Wpan_Node_Param ** wlan_nodes;
+	
+	FIN (wpan_list_size_get_wlan_node ());
+	
+	/* check if the list is not empty */
+	if (op_prg_list_size (wpan_node_param_list) == 0)
+		lr_wpan_mac_error ("wpan_list_size_get_wlan_node:", "No device found.", OPC_NIL);
+
+	FRET (wpan_wlan_nodes_get (&wlan_nodes));
+}
+
+
+/* arrays of the registered nodes, in the order of wpan_node_param_list */
+typedef struct {
+	Wpan_Node_Param **	nodes;
+	int					size;
+	int					capacity;
+} Wpan_Node_Array;
+
+static Wpan_Node_Array		wpan_all_nodes = {NULL, 0, 0};
+static Wpan_Node_Array		wpan_wpan_nodes = {NULL, 0, 0};	// nodes of type "wpan"
+static Wpan_Node_Array		wpan_wlan_nodes = {NULL, 0, 0};	// nodes of type "wlan"
+
+/*
+ * open addressing hash indexes of the registered nodes (linear probing).
+ * The nodes with the same key are all kept, the searches return the
+ * same node as a scan of the node list.
+ */
+typedef struct {
+	Wpan_Node_Param **	slots;
+	int					nb_slots;		// power of 2
+	int					nb_entries;
+} Wpan_Node_Index;
+
+static Wpan_Node_Index		wpan_node_indexes[WPAN_NODE_NB_KEYS];
+
+/* uniform grid over the node positions, stored as a hash table of cells */
+#define WPAN_GRID_DEFAULT_CELL_SIZE		10.0
+
+typedef struct T_wpan_grid_entry {
+	Wpan_Node_Param *			node;
+	int							cell_x;
+	int							cell_y;
+	struct T_wpan_grid_entry *	next_entry;
+} Wpan_Grid_Entry;
+
+static Wpan_Grid_Entry **	wpan_grid_buckets = NULL;
+static Wpan_Grid_Entry *	wpan_grid_entries = NULL;
+static int					wpan_grid_nb_buckets = 0;
+static int					wpan_grid_nb_nodes = 0; // number of nodes in the grid
+static double				wpan_grid_cell_size = 0.0;
+
+/* nodes returned by wpan_node_neighbors_get */
+static Wpan_Node_Param **	wpan_grid_neighbors = NULL;
+
+/* propagation delays between the nodes, computed on demand (negative if not computed yet) */
+#define WPAN_PROP_DELAY_MAX_NODES		1024
+
+static double *				wpan_prop_delay_table = NULL;
+static int					wpan_prop_delay_nb_nodes = 0;
+
+/* local function prototypes */
+static void		wpan_node_array_append (Wpan_Node_Array * array, Wpan_Node_Param * element);
+static int		wpan_node_key_get (Wpan_Node_Key key_type, const Wpan_Node_Param * element);
+static int		wpan_node_index_slot (const Wpan_Node_Index * index, int key);
+static void		wpan_node_grid_build (double cell_size);
+static int		wpan_node_grid_bucket (int cell_x, int cell_y);
+
+
+/*
+ * Function:	wpan_node_register
+ *
+ * Description:	record a node into the node list
+ *				and into the spatial index of the nodes
+ *
+ * ParamIn:		Wpan_Node_Param * element
+ *				parameters of the node (the position must be set)
+ */
+
+void wpan_node_register (Wpan_Node_Param * element)
+{
+	FIN (wpan_node_register (element));
+	
+	/* initialize the node list if it is not done */
+	if (wpan_node_param_list == OPC_NIL)
+		wpan_node_param_list = op_prg_list_create ();
+	
+	/* register the node into the list */
+	element->node_index = op_prg_list_size (wpan_node_param_list);
+	op_prg_list_insert (wpan_node_param_list, element, OPC_LISTPOS_TAIL);
+	
+	/* keep the node in the array of nodes and in the array of its type */
+	wpan_node_array_append (&wpan_all_nodes, element);
+	
+	if (strcmp (element->type, "wpan") == 0)
+		wpan_node_array_append (&wpan_wpan_nodes, element);
+	else if (strcmp (element->type, "wlan") == 0)
+		wpan_node_array_append (&wpan_wlan_nodes, element);
+	
+	/* index the node by MAC address and by IDs */
+	wpan_node_index_insert (WPAN_NODE_KEY_MAC_ADDRESS, element);
+	wpan_node_index_insert (WPAN_NODE_KEY_OBJID, element);
+	wpan_node_index_insert (WPAN_NODE_KEY_PARENT_ID, element);
+	
+	/* the grid is built again on the next request */
+	wpan_grid_nb_nodes = 0;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wpan_node_mac_address_set
+ *
+ * Description:	change the MAC address of a node and update
+ *				the index of the MAC addresses
+ *
+ * ParamIn:		Wpan_Node_Param * element
+ *				parameters of the node
+ *
+ *				int mac_address
+ *				new MAC address of the node
+ */
+
+void wpan_node_mac_address_set (Wpan_Node_Param * element, int mac_address)
+{
+	Boolean registered;
+	
+	FIN (wpan_node_mac_address_set (element, mac_address));
+	
+	/* the index is only updated if the node is already registered */
+	registered = (element->node_index >= 0 && element->node_index < wpan_all_nodes.size &&
+		wpan_all_nodes.nodes[element->node_index] == element);
+	
+	if (registered)
+		wpan_node_index_remove (WPAN_NODE_KEY_MAC_ADDRESS, element);
+	
+	element->mac_address = mac_address;
+	
+	if (registered)
+		wpan_node_index_insert (WPAN_NODE_KEY_MAC_ADDRESS, element);
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wpan_node_get
+ *
+ * Description:	get a node according to its position in the node list
+ *
+ * ParamIn:		int node_index
+ *				position of the node in wpan_node_param_list
+ *
+ * ParamOut:	Wpan_Node_Param * element
+ *				node found, NULL if the index is out of range
+ */
+
+Wpan_Node_Param * wpan_node_get (int node_index)
+{
+	FIN (wpan_node_get (node_index));
+	
+	if (node_index < 0 || node_index >= wpan_all_nodes.size)
+		FRET (NULL);
+	
+	FRET (wpan_all_nodes.nodes[node_index]);
+}
+
+
+/*
+ * Function:	wpan_wpan_nodes_get
+ *
+ * Description:	get the WPAN devices, in the order of the node list
+ *
+ * ParamOut:	Wpan_Node_Param *** nodes_ptr
+ *				array of the WPAN devices
+ *
+ *				int nb_nodes
+ *				number of WPAN devices
+ */
+
+int wpan_wpan_nodes_get (Wpan_Node_Param *** nodes_ptr)
+{
+	FIN (wpan_wpan_nodes_get (nodes_ptr));
+	
+	*nodes_ptr = wpan_wpan_nodes.nodes;
+	
+	FRET (wpan_wpan_nodes.size);
+}
+
+
+/*
+ * Function:	wpan_wlan_nodes_get
+ *
+ * Description:	get the WLAN devices, in the order of the node list
+ *
+ * ParamOut:	Wpan_Node_Param *** nodes_ptr
+ *				array of the WLAN devices
+ *
+ *				int nb_nodes
+ *				number of WLAN devices
+ */
+
+int wpan_wlan_nodes_get (Wpan_Node_Param *** nodes_ptr)
+{
+	FIN (wpan_wlan_nodes_get (nodes_ptr));
+	
+	*nodes_ptr = wpan_wlan_nodes.nodes;
+	
+	FRET (wpan_wlan_nodes.size);
+}
+
+
+/*
+ * Function:	wpan_node_neighbors_get
+ *
+ * Description:	get the nodes located within a radius around a position,
+ *				in the order of the node list
+ *
+ * ParamIn:		double x, double y
+ *				coordinates of the center
+ *
+ *				double radius
+ *				radius of the area (all the nodes if not positive)
+ *
+ * ParamOut:	Wpan_Node_Param *** neighbors_ptr
+ *				array of the nodes found (valid until the next call)
+ *
+ *				int nb_neighbors
+ *				number of nodes found
+ */
+
+int wpan_node_neighbors_get (double x, double y, double radius, Wpan_Node_Param *** neighbors_ptr)
+{
+	Wpan_Grid_Entry * entry;
+	Wpan_Node_Param * node;
+	int cell_x, cell_y, i, j;
+	int nb_neighbors = 0;
+	double delta_x, delta_y;
+	
+	FIN (wpan_node_neighbors_get (x, y, radius, neighbors_ptr));
+	
+	/* without radius, all the nodes are neighbors */
+	if (radius <= 0.0)
+		{
+		*neighbors_ptr = wpan_all_nodes.nodes;
+		FRET (wpan_all_nodes.size);
+		}
+	
+	/* the cells of the grid have the size of the radius */
+	if (wpan_grid_nb_nodes != wpan_all_nodes.size || wpan_grid_cell_size != radius)
+		wpan_node_grid_build (radius);
+	
+	cell_x = (int) floor (x / radius);
+	cell_y = (int) floor (y / radius);
+	
+	/* browse the cell of the position and the 8 cells around it */
+	for (i = cell_x - 1; i <= cell_x + 1; i++)
+		{
+		for (j = cell_y - 1; j <= cell_y + 1; j++)
+			{
+			for (entry = wpan_grid_buckets[wpan_node_grid_bucket (i, j)]; entry != NULL; entry = entry->next_entry)
+				{
+				if (entry->cell_x != i || entry->cell_y != j)
+					continue;
+				
+				delta_x = x - entry->node->x;
+				delta_y = y - entry->node->y;
+				
+				if (delta_x * delta_x + delta_y * delta_y <= radius * radius)
+					wpan_grid_neighbors[nb_neighbors++] = entry->node;
+				}
+			}
+		}
+	
+	/* sort the nodes found according to their position in the node list */
+	for (i = 1; i < nb_neighbors; i++)
+		{
+		node = wpan_grid_neighbors[i];
+		
+		for (j = i - 1; j >= 0 && wpan_grid_neighbors[j]->node_index > node->node_index; j--)
+			wpan_grid_neighbors[j + 1] = wpan_grid_neighbors[j];
+		
+		wpan_grid_neighbors[j + 1] = node;
+		}
+	
+	*neighbors_ptr = wpan_grid_neighbors;
+	
+	FRET (nb_neighbors);
+}
+
+
+/*
+ * Function:	wpan_node_search_at
+ *
+ * Description:	search the node of a module located at a given position
+ *
+ * ParamIn:		Objid objid
+ *				ID of the module of the node
+ *
+ *				double x, double y
+ *				coordinates of the node
+ *
+ * ParamOut:	Wpan_Node_Param * node
+ *				node found, NULL otherwise
+ */
+
+Wpan_Node_Param * wpan_node_search_at (Objid objid, double x, double y)
+{
+	Wpan_Grid_Entry * entry;
+	double cell_size;
+	int cell_x, cell_y;
+	
+	FIN (wpan_node_search_at (objid, x, y));
+	
+	if (wpan_all_nodes.size == 0)
+		FRET (NULL);
+	
+	/* keep the current grid if it is up to date */
+	cell_size = (wpan_grid_cell_size > 0.0) ? wpan_grid_cell_size : WPAN_GRID_DEFAULT_CELL_SIZE;
+	
+	if (wpan_grid_nb_nodes != wpan_all_nodes.size)
+		wpan_node_grid_build (cell_size);
+	
+	cell_x = (int) floor (x / wpan_grid_cell_size);
+	cell_y = (int) floor (y / wpan_grid_cell_size);
+	
+	for (entry = wpan_grid_buckets[wpan_node_grid_bucket (cell_x, cell_y)]; entry != NULL; entry = entry->next_entry)
+		{
+		if (entry->node->objid == objid && entry->node->x == x && entry->node->y == y)
+			FRET (entry->node);
+		}
+	
+	FRET (NULL);
+}
+
+
+/*
+ * Function:	wpan_node_prop_delay_get
+ *
+ * Description:	get the propagation delay between two nodes. The delays
+ *				are computed once and kept for the next requests.
+ *
+ * ParamIn:		const Wpan_Node_Param * tx_node
+ *				transmitter
+ *
+ *				const Wpan_Node_Param * rx_node
+ *				receiver
+ *
+ * ParamOut:	double prop_delay
+ *				propagation delay (in seconds)
+ */
+
+double wpan_node_prop_delay_get (const Wpan_Node_Param * tx_node, const Wpan_Node_Param * rx_node)
+{
+	double deltaX, deltaY;
+	double * delay_ptr = NULL;
+	int i;
+	
+	FIN (wpan_node_prop_delay_get (tx_node, rx_node));
+	
+	/* the table is allocated again when some nodes are registered */
+	if (wpan_prop_delay_nb_nodes != wpan_all_nodes.size && wpan_all_nodes.size <= WPAN_PROP_DELAY_MAX_NODES)
+		{
+		if (wpan_prop_delay_table != NULL)
+			op_prg_mem_free (wpan_prop_delay_table);
+		
+		wpan_prop_delay_nb_nodes = wpan_all_nodes.size;
+		wpan_prop_delay_table = (double *) op_prg_mem_alloc (wpan_prop_delay_nb_nodes * wpan_prop_delay_nb_nodes * sizeof (double));
+		
+		for (i = 0; i < wpan_prop_delay_nb_nodes * wpan_prop_delay_nb_nodes; i++)
+			wpan_prop_delay_table[i] = -1.0;
+		}
+	
+	if (wpan_prop_delay_nb_nodes == wpan_all_nodes.size)
+		{
+		delay_ptr = &wpan_prop_delay_table[tx_node->node_index * wpan_prop_delay_nb_nodes + rx_node->node_index];
+		
+		if (*delay_ptr >= 0.0)
+			FRET (*delay_ptr);
+		}
+	
+	/* compute the distance between the two nodes and the propagation delay */
+	deltaX = tx_node->x - rx_node->x;
+	deltaY = tx_node->y - rx_node->y;
+	
+	if (delay_ptr == NULL)
+		FRET (sqrt (deltaX*deltaX + deltaY*deltaY) / LIGHT_SPEED);
+	
+	*delay_ptr = sqrt (deltaX*deltaX + deltaY*deltaY) / LIGHT_SPEED;
+	
+	FRET (*delay_ptr);
+}
+
+
+/*
+ * Function:	wpan_node_array_append
+ *
+ * Description:	add a node at the end of an array of nodes
+ *
+ * ParamIn:		Wpan_Node_Array * array
+ *				array of nodes
+ *
+ *				Wpan_Node_Param * element
+ *				node to add
+ */
+
+static void wpan_node_array_append (Wpan_Node_Array * array, Wpan_Node_Param * element)
+{
+	FIN (wpan_node_array_append (array, element));
+	
+	if (array->size == array->capacity)
+		{
+		array->capacity = (array->capacity == 0) ? 64 : 2 * array->capacity;
+		
+		if (array->nodes == NULL)
+			array->nodes = (Wpan_Node_Param **) op_prg_mem_alloc (array->capacity * sizeof (Wpan_Node_Param *));
+		else
+			array->nodes = (Wpan_Node_Param **) op_prg_mem_realloc (array->nodes, array->capacity * sizeof (Wpan_Node_Param *));
+		}
+	
+	array->nodes[array->size++] = element;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wpan_node_key_get
+ *
+ * Description:	get the key of a node in an index
+ */
+
+static int wpan_node_key_get (Wpan_Node_Key key_type, const Wpan_Node_Param * element)
+{
+	FIN (wpan_node_key_get (key_type, element));
+	
+	switch (key_type)
+		{
+		case WPAN_NODE_KEY_MAC_ADDRESS:	FRET (element->mac_address);
+		case WPAN_NODE_KEY_OBJID:		FRET ((int) element->objid);
+		case WPAN_NODE_KEY_PARENT_ID:	FRET ((int) element->parent_id);
+		default:						break;
+		}
+	
+	lr_wpan_mac_error ("wpan_node_key_get:", "Unknown index key.", OPC_NIL);
+	
+	FRET (0);
+}
+
+
+/*
+ * Function:	wpan_node_index_slot
+ *
+ * Description:	get the first slot to probe for a key
+ */
+
+static int wpan_node_index_slot (const Wpan_Node_Index * index, int key)
+{
+	unsigned int hash;
+	
+	FIN (wpan_node_index_slot (index, key));
+	
+	/* multiplicative hashing (Knuth), the high bits are the most mixed */
+	hash = ((unsigned int) key * 2654435761u);
+	hash ^= hash >> 16;
+	
+	FRET ((int) (hash & (unsigned int) (index->nb_slots - 1)));
+}
+
+
+/*
+ * Function:	wpan_node_index_search
+ *
+ * Description:	search a node in an index. If several nodes have the
+ *				same key, the last registered node is returned for
+ *				the MAC addresses and the first one for the IDs, as
+ *				the former scans of the node list did.
+ *
+ * ParamIn:		Wpan_Node_Key key_type
+ *				index to use
+ *
+ *				int key
+ *				key of the node
+ *
+ * ParamOut:	Wpan_Node_Param * element
+ *				node found, NULL otherwise
+ */
+
+static Wpan_Node_Param * wpan_node_index_search (Wpan_Node_Key key_type, int key)
+{
+	Wpan_Node_Index * index = &wpan_node_indexes[key_type];
+	Wpan_Node_Param * element;
+	Wpan_Node_Param * found = NULL;
+	int i;
+	
+	FIN (wpan_node_index_search (key_type, key));
+	
+	if (index->nb_entries == 0)
+		FRET (NULL);
+	
+	/* browse the cluster of the key until an empty slot */
+	for (i = wpan_node_index_slot (index, key); (element = index->slots[i]) != NULL; i = (i + 1) & (index->nb_slots - 1))
+		{
+		if (wpan_node_key_get (key_type, element) != key)
+			continue;
+		
+		if (found == NULL ||
+			(key_type == WPAN_NODE_KEY_MAC_ADDRESS && element->node_index > found->node_index) ||
+			(key_type != WPAN_NODE_KEY_MAC_ADDRESS && element->node_index < found->node_index))
+			found = element;
+		}
+	
+	FRET (found);
+}
+
+
+/*
+ * Function:	wpan_node_index_insert
+ *
+ * Description:	add a node into an index, the index is enlarged
+ *				when it is half full
+ *
+ * ParamIn:		Wpan_Node_Key key_type
+ *				index to use
+ *
+ *				Wpan_Node_Param * element
+ *				node to add
+ */
+
+static void wpan_node_index_insert (Wpan_Node_Key key_type, Wpan_Node_Param * element)
+{
+	Wpan_Node_Index * index = &wpan_node_indexes[key_type];
+	Wpan_Node_Param ** old_slots;
+	int old_nb_slots;
+	int i;
+	
+	FIN (wpan_node_index_insert (key_type, element));
+	
+	if (2 * (index->nb_entries + 1) > index->nb_slots)
+		{
+		old_slots = index->slots;
+		old_nb_slots = index->nb_slots;
+		
+		index->nb_slots = (old_nb_slots == 0) ? 64 : 2 * old_nb_slots;
+		index->slots = (Wpan_Node_Param **) op_prg_mem_alloc (index->nb_slots * sizeof (Wpan_Node_Param *));
+		index->nb_entries = 0;
+		
+		for (i = 0; i < index->nb_slots; i++)
+			index->slots[i] = NULL;
+		
+		/* record the nodes of the previous table */
+		for (i = 0; i < old_nb_slots; i++)
+			{
+			if (old_slots[i] != NULL)
+				wpan_node_index_insert (key_type, old_slots[i]);
+			}
+		
+		if (old_slots != NULL)
+			op_prg_mem_free (old_slots);
+		}
+	
+	for (i = wpan_node_index_slot (index, wpan_node_key_get (key_type, element)); index->slots[i] != NULL; i = (i + 1) & (index->nb_slots - 1));
+	
+	index->slots[i] = element;
+	index->nb_entries++;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wpan_node_index_remove
+ *
+ * Description:	remove a node from an index. The next nodes of the
+ *				cluster are shifted back, so no search stops too early.
+ *
+ * ParamIn:		Wpan_Node_Key key_type
+ *				index to use
+ *
+ *				Wpan_Node_Param * element
+ *				node to remove (its key must not have changed)
+ */
+
+static void wpan_node_index_remove (Wpan_Node_Key key_type, Wpan_Node_Param * element)
+{
+	Wpan_Node_Index * index = &wpan_node_indexes[key_type];
+	int mask = index->nb_slots - 1;
+	int i, j, home;
+	
+	FIN (wpan_node_index_remove (key_type, element));
+	
+	if (index->nb_entries == 0)
+		FOUT;
+	
+	/* search the slot of the node */
+	for (i = wpan_node_index_slot (index, wpan_node_key_get (key_type, element)); index->slots[i] != element; i = (i + 1) & mask)
+		{
+		if (index->slots[i] == NULL)
+			FOUT;
+		}
+	
+	/* shift back the nodes which cannot be reached anymore */
+	for (j = (i + 1) & mask; index->slots[j] != NULL; j = (j + 1) & mask)
+		{
+		home = wpan_node_index_slot (index, wpan_node_key_get (key_type, index->slots[j]));
+		
+		/* the node stays if its first slot is cyclically in ]i, j] */
+		if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+			continue;
+		
+		index->slots[i] = index->slots[j];
+		i = j;
+		}
+	
+	index->slots[i] = NULL;
+	index->nb_entries--;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wpan_node_grid_build
+ *
+ * Description:	record all the registered nodes into the grid
+ *
+ * ParamIn:		double cell_size
+ *				size of the cells of the grid
+ */
+
+static void wpan_node_grid_build (double cell_size)
+{
+	Wpan_Grid_Entry * entry;
+	int i, bucket;
+	
+	FIN (wpan_node_grid_build (cell_size));
+	
+	/* free the previous grid */
+	if (wpan_grid_buckets != NULL)
+		{
+		op_prg_mem_free (wpan_grid_buckets);
+		op_prg_mem_free (wpan_grid_entries);
+		op_prg_mem_free (wpan_grid_neighbors);
+		}
+	
+	/* use a power of 2 number of buckets, at least twice the number of nodes */
+	for (wpan_grid_nb_buckets = 16; wpan_grid_nb_buckets < 2 * wpan_all_nodes.size; wpan_grid_nb_buckets *= 2);
+	
+	wpan_grid_buckets = (Wpan_Grid_Entry **) op_prg_mem_alloc (wpan_grid_nb_buckets * sizeof (Wpan_Grid_Entry *));
+	wpan_grid_entries = (Wpan_Grid_Entry *) op_prg_mem_alloc ((wpan_all_nodes.size + 1) * sizeof (Wpan_Grid_Entry));
+	wpan_grid_neighbors = (Wpan_Node_Param **) op_prg_mem_alloc ((wpan_all_nodes.size + 1) * sizeof (Wpan_Node_Param *));
+	wpan_grid_cell_size = cell_size;
+	
+	for (i = 0; i < wpan_grid_nb_buckets; i++)
+		wpan_grid_buckets[i] = NULL;
+	
+	/* record the nodes backward, so each cell keeps the nodes in the order of the list */
+	for (i = wpan_all_nodes.size - 1; i >= 0; i--)
+		{
+		entry = &wpan_grid_entries[i];
+		entry->node = wpan_all_nodes.nodes[i];
+		entry->cell_x = (int) floor (entry->node->x / cell_size);
+		entry->cell_y = (int) floor (entry->node->y / cell_size);
+		
+		bucket = wpan_node_grid_bucket (entry->cell_x, entry->cell_y);
+		entry->next_entry = wpan_grid_buckets[bucket];
+		wpan_grid_buckets[bucket] = entry;
+		}
+	
+	wpan_grid_nb_nodes = wpan_all_nodes.size;
+	
+	FOUT;
+}
+
+
+/*
+ * Function:	wpan_node_grid_bucket
+ *
+ * Description:	get the bucket of a cell of the grid
+ */
+
+static int wpan_node_grid_bucket (int cell_x, int cell_y)
+{
+	unsigned int hash;
+	
+	FIN (wpan_node_grid_bucket (cell_x, cell_y));
+	
+	hash = ((unsigned int) cell_x * 73856093u) ^ ((unsigned int) cell_y * 19349663u);
+	
+	FRET ((int) (hash & (unsigned int) (wpan_grid_nb_buckets - 1)));
+}
+
+
+/* link budgets between the nodes, recorded by (transmitter, receiver, frequency) in a hash table of cells */
+typedef struct T_wpan_link_budget_cell {
+	Wpan_Link_Budget					link;
+	struct T_wpan_link_budget_cell *	next_cell;
+} Wpan_Link_Budget_Cell;
+
+static Wpan_Link_Budget_Cell **	wpan_link_budget_buckets = NULL;
+static int						wpan_link_budget_nb_buckets = 0;
+static int						wpan_link_budget_nb_cells = 0;
+
+/* local function prototypes */
+static Wpan_Link_Budget_Cell **	wpan_link_budget_bucket (int tx_node_index, int rx_node_index, double frequency);
+
+
+/*
+ * Function:	wpan_link_budget_get
+ *
+ * Description:	get the budget of the link between two registered
+ *				nodes. The budget is computed the first time and kept
+ *				until the position of one of the nodes or the power
+ *				of the transmitter changes.
+ *
+ * ParamIn:		int tx_node_index, int rx_node_index
+ *				positions of the transmitter and of the receiver
+ *				in the node list
+ *
+ *				double frequency
+ *				transmission frequency
+ *
+ *				double power
+ *				TX power (in mW)
+ *
+ * ParamOut:	const Wpan_Link_Budget * link
+ *				budget of the link, NULL if a node is not registered
+ */
+
+const Wpan_Link_Budget * wpan_link_budget_get (int tx_node_index, int rx_node_index, double frequency, double power)
+{
+	Wpan_Link_Budget_Cell ** old_buckets;
+	Wpan_Link_Budget_Cell ** bucket_ptr;
+	Wpan_Link_Budget_Cell * cell;
+	Wpan_Link_Budget_Cell * next_cell;
+	Wpan_Link_Budget * link;
+	const Wpan_Node_Param * tx_node;
+	const Wpan_Node_Param * rx_node;
+	double delta_x, delta_y;
+	int old_nb_buckets;
+	int i;
+	
+	FIN (wpan_link_budget_get (tx_node_index, rx_node_index, frequency, power));
+	
+	if ((tx_node = wpan_node_get (tx_node_index)) == NULL || (rx_node = wpan_node_get (rx_node_index)) == NULL)
+		FRET (NULL);
+	
+	/* search the link in the table */
+	if (wpan_link_budget_nb_cells > 0)
+		{
+		for (cell = *wpan_link_budget_bucket (tx_node_index, rx_node_index, frequency); cell != NULL; cell = cell->next_cell)
+			{
+			if (cell->link.tx_node_index == tx_node_index && cell->link.rx_node_index == rx_node_index && cell->link.frequency == frequency)
+				break;
+			}
+		}
+	else
+		cell = NULL;
+	
+	if (cell == NULL)
+		{
+		/* keep less than one cell per bucket in average */
+		if (wpan_link_budget_nb_cells >= wpan_link_budget_nb_buckets)
+			{
+			old_buckets = wpan_link_budget_buckets;
+			old_nb_buckets = wpan_link_budget_nb_buckets;
+			
+			wpan_link_budget_nb_buckets = (old_nb_buckets == 0) ? 256 : 2 * old_nb_buckets;
+			wpan_link_budget_buckets = (Wpan_Link_Budget_Cell **) op_prg_mem_alloc (wpan_link_budget_nb_buckets * sizeof (Wpan_Link_Budget_Cell *));
+			
+			for (i = 0; i < wpan_link_budget_nb_buckets; i++)
+				wpan_link_budget_buckets[i] = NULL;
+			
+			for (i = 0; i < old_nb_buckets; i++)
+				{
+				for (cell = old_buckets[i]; cell != NULL; cell = next_cell)
+					{
+					next_cell = cell->next_cell;
+					bucket_ptr = wpan_link_budget_bucket (cell->link.tx_node_index, cell->link.rx_node_index, cell->link.frequency);
+					cell->next_cell = *bucket_ptr;
+					*bucket_ptr = cell;
+					}
+				}
+			
+			if (old_buckets != NULL)
+				op_prg_mem_free (old_buckets);
+			}
+		
+		/* record a new link, computed below */
+		cell = (Wpan_Link_Budget_Cell *) op_prg_mem_alloc (sizeof (Wpan_Link_Budget_Cell));
+		cell->link.tx_node_index = tx_node_index;
+		cell->link.rx_node_index = rx_node_index;
+		cell->link.frequency = frequency;
+		cell->link.power = -1.0;
+		
+		bucket_ptr = wpan_link_budget_bucket (tx_node_index, rx_node_index, frequency);
+		cell->next_cell = *bucket_ptr;
+		*bucket_ptr = cell;
+		wpan_link_budget_nb_cells++;
+		}
+	
+	link = &cell->link;
+	
+	/* compute the budget again if a node moved or if the power changed */
+	if (link->power != power ||
+		link->tx_x != tx_node->x || link->tx_y != tx_node->y ||
+		link->rx_x != rx_node->x || link->rx_y != rx_node->y)
+		{
+		link->power = power;
+		link->tx_x = tx_node->x;
+		link->tx_y = tx_node->y;
+		link->rx_x = rx_node->x;
+		link->rx_y = rx_node->y;
+		
+		delta_x = link->rx_x - link->tx_x;
+		delta_y = link->rx_y - link->tx_y;
+		link->distance = sqrt (delta_x * delta_x + delta_y * delta_y);
+		link->prop_delay = link->distance / LIGHT_SPEED;
+		link->path_loss = path_loss_attenuation (link->distance, frequency);
+		link->snr = snr_15_4a_path_loss (power, link->path_loss);
+		}
+	
+	FRET (link);
+}
+
+
+/*
+ * Function:	wpan_link_budget_bucket
+ *
+ * Description:	get the bucket of a link in the table of link budgets
+ */
+
+static Wpan_Link_Budget_Cell ** wpan_link_budget_bucket (int tx_node_index, int rx_node_index, double frequency)
+{
+	unsigned int hash;
+	
+	FIN (wpan_link_budget_bucket (tx_node_index, rx_node_index, frequency));
+	
+	hash = ((unsigned int) tx_node_index * 73856093u) ^ ((unsigned int) rx_node_index * 19349663u) ^ ((unsigned int) (frequency / 1.0e6) * 83492791u);
+	
+	FRET (&wpan_link_budget_buckets[hash & (unsigned int) (wpan_link_budget_nb_buckets - 1)]);
+}
+
+
+/* transmission descriptors, recorded by ICI in a hash table of cells */
+typedef struct T_wpan_tx_descriptor_cell {
+	Ici *								ici_ptr;
+	Wpan_Tx_Descriptor					descriptor;
+	struct T_wpan_tx_descriptor_cell *	next_cell;
+} Wpan_Tx_Descriptor_Cell;
+
+static Wpan_Tx_Descriptor_Cell **	wpan_tx_descriptor_buckets = NULL;
+static Wpan_Tx_Descriptor_Cell *	wpan_tx_descriptor_free_cells = NULL;
+static int							wpan_tx_descriptor_nb_buckets = 0;
+static int							wpan_tx_descriptor_nb_cells = 0;
+
+/* local function prototypes */
+static Wpan_Tx_Descriptor_Cell **	wpan_tx_descriptor_bucket (Ici * ici_ptr);
+
+
+/*
+ * Function:	wpan_pkt_format_get
+ *
+ * Description:	get the format of a packet sent to the channel
+ *
+ * ParamIn:		Packet * pkptr
+ *				packet
+ *
+ * ParamOut:	Wpan_Pkt_Format format
+ *				format of the packet
+ */
+
+Wpan_Pkt_Format wpan_pkt_format_get (Packet * pkptr)
+{
+	char format[64];
 	
+	FIN (wpan_pkt_format_get (pkptr));
 	
-	/* create a new element */
-	new_elt = (Wpan_Node_Param *) op_prg_mem_alloc (sizeof(Wpan_Node_Param));
+	op_pk_format (pkptr, format);
 	
-	/* fill out this new element */
-	new_elt->parent_id = parent;
-	new_elt->objid = parent;
-	new_elt->mac_address = mac_address;
-	new_elt->group = 0;
-	new_elt->slotted_enable = OPC_FALSE;
-	new_elt->master_enable = OPC_FALSE;
-	new_elt->x = x;
-	new_elt->y = y;
-	new_elt->cca_requirement = OPC_FALSE;
-	new_elt->share_statistic = 0;
-	new_elt->wlan_info = wlan_info;;
-	strcpy (new_elt->type, type);
+	if (!strcmp (format, "lr_wpan_mac"))
+		FRET (WPAN_FORMAT_MAC);
 	
-	/* initialize the node list if it is not done */
-	if (wpan_node_param_list == OPC_NIL)
-		wpan_node_param_list = op_prg_list_create ();
+	if (!strcmp (format, "lr_wpan_ack"))
+		FRET (WPAN_FORMAT_ACK);
 	
-	/* register the node into the list */
-	op_prg_list_insert (wpan_node_param_list, new_elt, OPC_LISTPOS_TAIL);
+	if (!strcmp (format, "lr_wpan_beacon"))
+		FRET (WPAN_FORMAT_BEACON);
 	
+	if (!strcmp (format, "lr_wpan_beacon_GADGET"))
+		FRET (WPAN_FORMAT_BEACON_GADGET);
 	
-	FOUT;
+	FRET (WPAN_FORMAT_OTHER);
 }
 
 
 /*
- * Function:	wlan_state_variable_get
- *
- * Description:	get a pointer to the state variable called
- *				"rx_state_info_ptr" in the MAC layer of the WLAN
- *				to update the field "rx_end_time"
+ * Function:	wpan_tx_ici_create
  *
- * ParamIn:		Objid objid
- *				ID of the process RX of the custom WLAN
+ * Description:	create the ICI associated with a packet sent to
+ *				the channel and record the description of the
+ *				transmission with it. The channel reads the whole
+ *				description at once. The ICI attributes are set
+ *				too, for the other readers of the ICI.
  *
- * ParamOut:	pointer to the state variable of the MAC layer
+ * ParamIn:		const Wpan_Tx_Descriptor * descriptor
+ *				description of the transmission
  *
- * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
- * DEVICES BE RECORDED IN THE DEVICE LIST.
+ * ParamOut:	Ici * ici_ptr
+ *				ICI to associate with the packet
  */
 
-WlanT_Rx_State_Info * wlan_state_variable_get (Objid objid)
+Ici * wpan_tx_ici_create (const Wpan_Tx_Descriptor * descriptor)
 {
-	int i; // loop variable
-	Wpan_Node_Param * element;
-	int nbElement = op_prg_list_size (wpan_node_param_list);
+	Wpan_Tx_Descriptor_Cell ** old_buckets;
+	Wpan_Tx_Descriptor_Cell ** bucket_ptr;
+	Wpan_Tx_Descriptor_Cell * cell;
+	Wpan_Tx_Descriptor_Cell * next_cell;
+	int old_nb_buckets;
+	int i;
+	Ici * ici_ptr;
 	
+	FIN (wpan_tx_ici_create (descriptor));
 	
-	FIN (wlan_state_variable_get (objid));
+	ici_ptr = op_ici_create ("ici_channel");
 	
-	/* check if the list is not empty */
-	if (!nbElement)
-		lr_wpan_mac_error ("wlan_state_variable_get:", "No device registered.", OPC_NIL);
-
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
+	/* set the ICI attributes */
+	if (op_ici_attr_set_dbl (ici_ptr, "txrx distance", descriptor->txrx_distance) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "bit rate", descriptor->bit_rate) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "channel", descriptor->frequency) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "power", descriptor->power) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_int32 (ici_ptr, "packet type", descriptor->packet_type) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_int32 (ici_ptr, "dest address", descriptor->dest_address) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "Tx x", descriptor->tx_x) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "Tx y", descriptor->tx_y) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "Rx x", descriptor->rx_x) == OPC_COMPCODE_FAILURE ||
+		op_ici_attr_set_dbl (ici_ptr, "Rx y", descriptor->rx_y) == OPC_COMPCODE_FAILURE)
+		lr_wpan_mac_error ("wpan_tx_ici_create:", "Unable to set the ICI pointer.", OPC_NIL);
+	
+	/* an ICI destroyed by op_ici_destroy leaves its record, which a new ICI at the same address replaces */
+	if (wpan_tx_descriptor_nb_cells > 0)
 		{
-		/* access the element */
-		element = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, i);
+		for (cell = *wpan_tx_descriptor_bucket (ici_ptr); cell != NULL; cell = cell->next_cell)
+			{
+			if (cell->ici_ptr == ici_ptr)
+				{
+				cell->descriptor = *descriptor;
+				FRET (ici_ptr);
+				}
+			}
+		}
+	
+	/* keep less than one cell per bucket in average */
+	if (wpan_tx_descriptor_nb_cells >= wpan_tx_descriptor_nb_buckets)
+		{
+		old_buckets = wpan_tx_descriptor_buckets;
+		old_nb_buckets = wpan_tx_descriptor_nb_buckets;
 		
-		/* check the MAC address*/
-		if (element->objid == objid)
+		wpan_tx_descriptor_nb_buckets = (old_nb_buckets == 0) ? 256 : 2 * old_nb_buckets;
+		wpan_tx_descriptor_buckets = (Wpan_Tx_Descriptor_Cell **) op_prg_mem_alloc (wpan_tx_descriptor_nb_buckets * sizeof (Wpan_Tx_Descriptor_Cell *));
+		
+		for (i = 0; i < wpan_tx_descriptor_nb_buckets; i++)
+			wpan_tx_descriptor_buckets[i] = NULL;
+		
+		for (i = 0; i < old_nb_buckets; i++)
 			{
-			FRET ((WlanT_Rx_State_Info *) element->wlan_info);
+			for (cell = old_buckets[i]; cell != NULL; cell = next_cell)
+				{
+				next_cell = cell->next_cell;
+				bucket_ptr = wpan_tx_descriptor_bucket (cell->ici_ptr);
+				cell->next_cell = *bucket_ptr;
+				*bucket_ptr = cell;
+				}
 			}
+		
+		if (old_buckets != NULL)
+			op_prg_mem_free (old_buckets);
 		}
 	
-	/* we shouldn't be here */
-	lr_wpan_mac_error ("wlan_state_variable_get:", "No device found.", OPC_NIL);
+	/* reuse a released cell if possible */
+	if ((cell = wpan_tx_descriptor_free_cells) != NULL)
+		wpan_tx_descriptor_free_cells = cell->next_cell;
+	else
+		cell = (Wpan_Tx_Descriptor_Cell *) op_prg_mem_alloc (sizeof (Wpan_Tx_Descriptor_Cell));
 	
-	FRET (NULL);
+	cell->ici_ptr = ici_ptr;
+	cell->descriptor = *descriptor;
+	
+	bucket_ptr = wpan_tx_descriptor_bucket (ici_ptr);
+	cell->next_cell = *bucket_ptr;
+	*bucket_ptr = cell;
+	wpan_tx_descriptor_nb_cells++;
+	
+	FRET (ici_ptr);
 }
 
 
 /*
- * Function:	wpan_get_mac_address
- *
- * description:	get the MAC address of the Node according
- *				to its ID
- *				The node must be registered in the list
- *				wpan_node_param_list
+ * Function:	wpan_tx_descriptor_get
  *
- * ParamIn:		Objid node_id
- *				ID of the node
+ * Description:	get the description of the transmission
+ *				recorded with an ICI
  *
- * ParamOut:	int 
- *				MAC address of the node
+ * ParamIn:		Ici * ici_ptr
+ *				ICI associated with the packet
  *
- * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
- * DEVICES BE RECORDED IN THE DEVICE LIST.
+ * ParamOut:	const Wpan_Tx_Descriptor * descriptor
+ *				description of the transmission, NULL if the ICI
+ *				was not created by wpan_tx_ici_create (WLAN packets)
  */
 
-int	wpan_get_mac_address (Objid node_id)
+const Wpan_Tx_Descriptor * wpan_tx_descriptor_get (Ici * ici_ptr)
 {
-	int i; // loop variable
-	Wpan_Node_Param * element;
-	int nbElement = op_prg_list_size (wpan_node_param_list);
+	Wpan_Tx_Descriptor_Cell * cell;
 	
-	FIN (wpan_get_mac_address (node_id));
+	FIN (wpan_tx_descriptor_get (ici_ptr));
 	
-	/* check if the list is not empty */
-	if (!nbElement)
-		lr_wpan_mac_error ("wpan_get_mac_address:", "No device registered.", OPC_NIL);
-
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
+	if (wpan_tx_descriptor_nb_cells == 0 || ici_ptr == OPC_NIL)
+		FRET (NULL);
+	
+	for (cell = *wpan_tx_descriptor_bucket (ici_ptr); cell != NULL; cell = cell->next_cell)
 		{
-		/* access the element */
-		element = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, i);
-		
-		/* check the MAC address*/
-		if (element->parent_id == node_id)
-			{
-			FRET (element->mac_address);
-			}
+		if (cell->ici_ptr == ici_ptr)
+			FRET (&cell->descriptor);
 		}
 	
-	/* we shouldn't be here */
-	lr_wpan_mac_error ("wpan_get_mac_address:", "No device found.", OPC_NIL);
-	
-	FRET (-1);
+	FRET (NULL);
 }
 
 
 /*
- * Function:	wpan_search_wlan_node
+ * Function:	wpan_tx_ici_destroy
  *
- * Description:	search a wlan node
+ * Description:	destroy an ICI and the description
+ *				of the transmission recorded with it
  *
- * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
- * DEVICES BE RECORDED IN THE DEVICE LIST.
+ * ParamIn:		Ici * ici_ptr
+ *				ICI to destroy
  */
 
-Wpan_Node_Param * wpan_search_wlan_node (int index)
+void wpan_tx_ici_destroy (Ici * ici_ptr)
 {
-	Wpan_Node_Param * element = NULL;
-	int nbElement = op_prg_list_size (wpan_node_param_list);
-	int i;
-	int current_index = 0;
+	Wpan_Tx_Descriptor_Cell ** cell_ptr;
+	Wpan_Tx_Descriptor_Cell * cell;
 	
-	FIN (wpan_search_wlan_node (index));
+	FIN (wpan_tx_ici_destroy (ici_ptr));
 	
-	/* check if the list is not empty */
-	if (!nbElement)
-		lr_wpan_mac_error ("wpan_search_wlan_node:", "No device found.", OPC_NIL);
-
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
+	/* the ICI may be reused by OPNET once destroyed, so the record is removed first */
+	if (wpan_tx_descriptor_nb_cells > 0)
 		{
-		/* access the element */
-		element = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, i);
-		
-		/* check the type of device and the current index */
-		if ((strcmp (element->type, "wlan") == 0) && (current_index++ == index))
+		for (cell_ptr = wpan_tx_descriptor_bucket (ici_ptr); (cell = *cell_ptr) != NULL; cell_ptr = &cell->next_cell)
 			{
-			FRET (element);
+			if (cell->ici_ptr == ici_ptr)
+				{
+				*cell_ptr = cell->next_cell;
+				cell->next_cell = wpan_tx_descriptor_free_cells;
+				wpan_tx_descriptor_free_cells = cell;
+				wpan_tx_descriptor_nb_cells--;
+				break;
+				}
 			}
 		}
 	
-	/* we shouldn't be here */
-	if (index > current_index)
-		{
-		/* if the index is too high, we print a special error message */
-		lr_wpan_mac_error ("wpan_search_wlan_node:", "The given index is too high.", OPC_NIL);
-		}
-	
-	/* otherwise, we print the standard error message */
-	lr_wpan_mac_error ("wpan_search_wlan_node:", "No device match the index.", OPC_NIL);
+	op_ici_destroy (ici_ptr);
 	
-	FRET (OPC_NIL);
+	FOUT;
 }
 
 
 /*
- * Function:	wpan_list_size_get_wlan_node
+ * Function:	wpan_tx_descriptor_bucket
  *
- * WARNING: THIS FUNCTION MUST BE USED AFTER THAT ALL THE WPAN
- * DEVICES BE RECORDED IN THE DEVICE LIST.
+ * Description:	get the bucket of an ICI in the table of descriptors
  */
-int wpan_list_size_get_wlan_node ()
+
+static Wpan_Tx_Descriptor_Cell ** wpan_tx_descriptor_bucket (Ici * ici_ptr)
 {
-	int list_size = 0;
-	Wpan_Node_Param * element = NULL;
-	int nbElement = op_prg_list_size (wpan_node_param_list);
-	int i; // loop variable
+	size_t hash;
 	
-	FIN (wpan_list_size_get_wlan_node ());
+	FIN (wpan_tx_descriptor_bucket (ici_ptr));
 	
-	/* check if the list is not empty */
-	if (!nbElement)
-		lr_wpan_mac_error ("wpan_list_size_get_wlan_node:", "No device found.", OPC_NIL);
-
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
-		{
-		/* access the element */
-		element = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, i);
-		
-		/* check the type of device and the current index */
-		if (strcmp (element->type, "wlan") == 0)
-			{
-			list_size++;
-			}
-		}
+	/* the low bits of the address are the same for all the ICIs (alignment) */
+	hash = (size_t) ici_ptr;
+	hash ^= hash >> 4;
+	hash ^= hash >> 12;
 	
-	FRET (list_size);
+	FRET (&wpan_tx_descriptor_buckets[hash & (size_t) (wpan_tx_descriptor_nb_buckets - 1)]);
 }
 
 
@@ -438,7 +1480,9 @@ int wpan_list_size_get_wlan_node ()
 void lr_wpan_slotted_consistency (Wpan_Node_Param * master_elt)
 {
 	Wpan_Node_Param * element = NULL;
+	Wpan_Node_Param ** wpan_nodes;
 	int nbElement = op_prg_list_size (wpan_node_param_list);
+	int nb_wpan;
 	int i; // loop variable
 	char error_msg[256], name[64];
 	
@@ -449,15 +1493,16 @@ void lr_wpan_slotted_consistency (Wpan_Node_Param * master_elt)
 	if (!nbElement)
 		lr_wpan_mac_error ("lr_wpan_slotted_consistency:", "No device found.", "Check if you call the function at the right place !");
 
-	/* search the element in the list of nodes */
-	for (i = 0; i < nbElement; i++)
+	/* search the element in the WPAN devices */
+	nb_wpan = wpan_wpan_nodes_get (&wpan_nodes);
+	
+	for (i = 0; i < nb_wpan; i++)
 		{
 		/* access the element */
-		element = (Wpan_Node_Param *) op_prg_list_access (wpan_node_param_list, i);
+		element = wpan_nodes[i];
 		
 		/* search the element in the same group than the master element */
 		if (element != master_elt &&
-			!strcmp (element->type, "wpan") &&
 			element->group == master_elt->group)
 			{
 			/* if an element is also a master, we end the simulation with an error message */
@@ -546,32 +1591,116 @@ void lr_wpan_slotted_generate_addr_table (Wpan_Node_Param * master_elt, Wpan_Bea
 
 
 /*
- * Function:	lr_wpan_slotted_check_time
+ * Function:	lr_wpan_slot_clock_index
  *
- * Description:	compute the time to reach the boundary of
- *				one slot.
- 
+ * Description:	slot clock of the superframe: the time is
+ *				counted in whole periods (backoff periods,
+ *				slots) of period_symbols symbols from the
+ *				start of the superframe, so that the cost
+ *				does not depend on the simulated time.
+ *				Return the index of the period holding the
+ *				time.
+ *
+ * ParamIn:		double origin
+ *				start of the superframe (s)
+ *
+ *				int period_symbols
+ *				length of a period (symbols)
+ *
+ *				double time
+ *				absolute time (s)
+ *
+ * ParamOut:	int index
+ *				number of whole periods since the origin
+ */
 
-double lr_wpan_slotted_boundary_time (void)
+int lr_wpan_slot_clock_index (double origin, int period_symbols, double time)
 {
-	double time = op_sim_time ();
-	double remainder = time;
+	const double period = LR_WPAN_SYMBOLS_DURATION (period_symbols);
 	
-	const double unit = LR_WPAN_BACKOFF_UNIT;//WPAN_CCA_PERIOD + WPAN_TURN_AROUND_TIME;
+	FIN (lr_wpan_slot_clock_index (origin, period_symbols, time));
 	
+	FRET ((int) floor ((time - origin) / period));
+}
+
+
+/*
+ * Function:	lr_wpan_slot_clock_next_boundary
+ *
+ * Description:	compute the time of the next boundary of
+ *				the periods of the slot clock
+ *
+ * ParamIn:		double origin
+ *				start of the superframe (s)
+ *
+ *				int period_symbols
+ *				length of a period (symbols)
+ *
+ *				double time
+ *				absolute time (s)
+ *
+ * ParamOut:	double boundary
+ *				absolute time of the boundary, the time itself
+ *				if it is on a boundary
+ */
+
+double lr_wpan_slot_clock_next_boundary (double origin, int period_symbols, double time)
+{
+	const double period = LR_WPAN_SYMBOLS_DURATION (period_symbols);
+	int index;
 	
-	FIN (lr_wpan_slotted_boundary ());
+	FIN (lr_wpan_slot_clock_next_boundary (origin, period_symbols, time));
 	
-	// compute the remainder 
-	while (remainder >= unit) remainder -= unit;
+	index = lr_wpan_slot_clock_index (origin, period_symbols, time);
 	
-	// if the remainder is not zero, we compute the next odd time 
-	if (remainder > 0.0000001)
-		time += (unit - remainder);
+	if ((time - origin) - index * period > LR_WPAN_SLOT_CLOCK_TOLERANCE)
+		FRET (origin + (index + 1) * period);
 	
 	FRET (time);
 }
-*/
+
+
+/*
+ * Function:	lr_wpan_slot_clock_remaining
+ *
+ * Description:	compute the number of whole periods between
+ *				the next boundary and the end of a part of
+ *				the superframe (the CAP for instance)
+ *
+ * ParamIn:		double origin
+ *				start of the superframe (s)
+ *
+ *				int period_symbols
+ *				length of a period (symbols)
+ *
+ *				int end_symbols
+ *				end of the part from the origin (symbols)
+ *
+ *				double time
+ *				absolute time (s)
+ *
+ * ParamOut:	int remaining
+ *				number of periods left, 0 after the end
+ */
+
+int lr_wpan_slot_clock_remaining (double origin, int period_symbols, int end_symbols, double time)
+{
+	const double period = LR_WPAN_SYMBOLS_DURATION (period_symbols);
+	int index;
+	int remaining;
+	
+	FIN (lr_wpan_slot_clock_remaining (origin, period_symbols, end_symbols, time));
+	
+	index = lr_wpan_slot_clock_index (origin, period_symbols, time);
+	
+	/* count from the next boundary */
+	if ((time - origin) - index * period > LR_WPAN_SLOT_CLOCK_TOLERANCE)
+		index++;
+	
+	remaining = end_symbols / period_symbols - index;
+	
+	FRET ((remaining > 0) ? remaining : 0);
+}
 
 /*
  * Function:	uniform_random_value by FRancesco Pantisano
@@ -590,6 +1719,12 @@ double uniform_random_value (double a)
 	FRET (value);
 }
 
+/* Pmd curve, sampled the first time it is used */
+static Util_dB_Table	pmd_802_15_4a_table;
+static Boolean			pmd_802_15_4a_table_built = OPC_FALSE;
+
+static double			pmd_802_15_4a_curve (double snrDB);
+
 /*
  * Function:	Pmd_802_15_4a
  *
@@ -607,6 +1742,38 @@ double uniform_random_value (double a)
  */
 
 double Pmd_802_15_4a (double snrDB) 
+{
+  double Prob_md;
+  
+  FIN (Pmd_802_15_4a (snrDB));
+  
+  if (pmd_802_15_4a_table_built == OPC_FALSE)
+    {
+    util_dB_table_build (&pmd_802_15_4a_table, DB_TABLE_MIN, DB_TABLE_MAX, DB_TABLE_STEP, pmd_802_15_4a_curve);
+    pmd_802_15_4a_table_built = OPC_TRUE;
+    }
+  
+  if (snrDB >= DB_TABLE_MIN && snrDB <= DB_TABLE_MAX)
+    Prob_md = util_dB_table_lookup (&pmd_802_15_4a_table, snrDB);
+  else
+    Prob_md = pmd_802_15_4a_curve (snrDB);
+  
+  FRET (Prob_md);
+}
+
+/*
+ * Function:	pmd_802_15_4a_curve
+ *
+ * Description:	probability of missdetection read from the Pmd curve
+ *
+ * ParamIn:		double snrDB
+ *				Signal To Noise ratio (dB)
+ *
+ * ParamOut:	double Prob_mp
+ *				Probability of missdetection
+ */
+
+static double pmd_802_15_4a_curve (double snrDB) 
 {
   double EbN0,Prob_md;
   double snr = util_inverse_dB (snrDB);
@@ -620,7 +1787,7 @@ double Pmd_802_15_4a (double snrDB)
   Modulation_Handle			modulation_table;
   double EbN0dB;
   
-  FIN (Pmd_802_15_4a (snrDB));
+  FIN (pmd_802_15_4a_curve (snrDB));
   
   //EbN0 = snr*(BW/Rb);	// conversion from SNR to EbN0
   EbN0 = snr + sqrt(snr*(snr+(Tint*BW))); 	//conversion from SNR to EbN0
@@ -634,6 +1801,91 @@ double Pmd_802_15_4a (double snrDB)
   FRET (Prob_md);
 }
 
+/* success probabilities of the FEC, recorded by (BER, segment size, max errors) in a direct-mapped table */
+#define FEC_CACHE_SIZE		256
+
+typedef struct {
+	double	ber;
+	int		segment_size;
+	int		max_error;
+	double	success;
+} Fec_Cache_Entry;
+
+static Fec_Cache_Entry	fec_cache [FEC_CACHE_SIZE];
+static Boolean			fec_cache_init = OPC_FALSE;
+
+
+/*
+ * Function:	fec_success_probability
+ *
+ * Description:	probability that a segment is corrected by the FEC, i.e.
+ *				that at most max_error of its bits are in error when each
+ *				bit is wrong with probability ber (binomial distribution).
+ *				The last values are kept, since the same BER is found for
+ *				all the segments of a packet.
+ *
+ * ParamIn:		double ber
+ *				bit error rate
+ *
+ *				int segment_size
+ *				number of bits of the segment
+ *
+ *				int max_error
+ *				number of errors corrected in the segment
+ *
+ * ParamOut:	double success
+ *				probability of a correct segment
+ */
+
+double fec_success_probability (double ber, int segment_size, int max_error)
+{
+	Fec_Cache_Entry * entry;
+	double term, success;
+	unsigned int hash;
+	int k;
+	
+	FIN (fec_success_probability (ber, segment_size, max_error));
+	
+	/* a uniform value in [0,1) is never below a null BER */
+	if (ber <= 0.0 || max_error >= segment_size)
+		FRET (1.0);
+	
+	if (ber >= 1.0 || max_error < 0)
+		FRET (0.0);
+	
+	if (fec_cache_init == OPC_FALSE)
+		{
+		for (k = 0; k < FEC_CACHE_SIZE; k++)
+			fec_cache[k].segment_size = -1;
+		fec_cache_init = OPC_TRUE;
+		}
+	
+	hash = ((unsigned int) (ber * 4294967295.0) * 2654435761u) ^ ((unsigned int) segment_size * 73856093u) ^ (unsigned int) max_error;
+	entry = &fec_cache[(hash >> 8) & (FEC_CACHE_SIZE - 1)];
+	
+	if (entry->segment_size == segment_size && entry->max_error == max_error && entry->ber == ber)
+		FRET (entry->success);
+	
+	/* P(k errors) = C(n,k) ber^k (1-ber)^(n-k), each term computed from the previous one */
+	term = exp (segment_size * log1p (-ber));
+	success = term;
+	for (k = 0; k < max_error; k++)
+		{
+		term *= ((double) (segment_size - k) / (double) (k + 1)) * (ber / (1.0 - ber));
+		success += term;
+		}
+	
+	if (success > 1.0)
+		success = 1.0;
+	
+	entry->ber = ber;
+	entry->segment_size = segment_size;
+	entry->max_error = max_error;
+	entry->success = success;
+	
+	FRET (success);
+}
+
 /*
  * Function:	compute_center_frequency
  *
@@ -650,7 +1902,7 @@ double Pmd_802_15_4a (double snrDB)
 
 double compute_center_frequency (int channel_number) 
 {
-  double fc;
+  double fc = 0.0; // unknown channel
   
   
   FIN (compute_center_frequency (int channel_number));
@@ -828,8 +2080,10 @@ double compute_lecim_dsss_center_frequency (int channel_number)
 	case 33:
 		fc = fc_channel33;
 		break;	
+  }
+
   FRET (fc);
- }
+}
  
  /*
  * Function:	compute_datarate 
@@ -1026,5 +2280,7 @@ double compute_lecim_dsss_center_frequency (int channel_number)
 	case 59:
 		d_rate = data_rate59;
 		break;
-	FRET (d_rate);
-}
\ No newline at end of file
+  }
+
+  FRET (d_rate);
+}
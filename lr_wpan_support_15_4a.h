@@ -55,6 +55,20 @@
 #define ODB_GENERATOR_ENABLED (op_prg_odb_ltrace_active("generator") == OPC_TRUE)
 #define ODB_WLAN_TRANSMISSION (op_prg_odb_ltrace_active("wlan_transmission") == OPC_TRUE)
 
+/*
+ * traces of the MAC events: the MAC computes a mask of the active
+ * traces once per event. Building with WPAN_NO_TRACE removes them.
+ */
+#define WPAN_TRACE_STATE		0x1		// "wpan_state" ODB trace
+#define WPAN_TRACE_FLAG			0x2		// "wpan_flag" ODB trace
+#define WPAN_TRACE_RECORD		0x4		// binary records (lr_wpan_trace_record)
+
+#if defined (WPAN_NO_TRACE)
+#define WPAN_TRACE_ACTIVE(mask, trace)	(0)
+#else
+#define WPAN_TRACE_ACTIVE(mask, trace)	((mask) & (trace))
+#endif
+
 /* general constants */
 //light speed in m/s
 #define LIGHT_SPEED		300000000.0
@@ -304,8 +318,12 @@
 //#define LR_WPAN_BACKOFF_UNIT 				(aUnitBackoffPeriod*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE)
 //#define LR_WPAN_BACKOFF_PERIOD_DURATION  	(aUnitBackoffPeriod*LR_WPAN_BITS_PER_SYMBOL/LR_WPAN_BIT_RATE)
 
+/* duration of a number of symbols (in seconds) */
+#define LR_WPAN_SYMBOLS_DURATION(symbols)	(((symbols)*LR_WPAN_BITS_PER_SYMBOL)/LR_WPAN_BIT_RATE)
+
+/* a time closer than this to a boundary of the slot clock is on the boundary (in seconds) */
+#define LR_WPAN_SLOT_CLOCK_TOLERANCE		0.0000001
 
-#define MAX_NUMBER_OF_BACKOFF_PERIODS 	786432
 
 /* define the maximum sequence number (8 bits) = 2^8 */
 #define MAX_MAC_SEQN			256
@@ -333,6 +351,48 @@ typedef enum {
 	BT_SLA_PKT_TYPE	
 } Wpan_Pkt_Type;
 
+/* define the formats of the packets sent to the channel */
+typedef enum {
+	WPAN_FORMAT_OTHER,			// any other format (WLAN packets, ...)
+	WPAN_FORMAT_MAC,			// "lr_wpan_mac"
+	WPAN_FORMAT_ACK,			// "lr_wpan_ack"
+	WPAN_FORMAT_BEACON,			// "lr_wpan_beacon"
+	WPAN_FORMAT_BEACON_GADGET	// "lr_wpan_beacon_GADGET"
+} Wpan_Pkt_Format;
+
+/* description of a transmission, given by the MAC layer to the channel */
+typedef struct {
+	double			txrx_distance; // distance between TX and RX
+	double			bit_rate;
+	double			frequency; // transmission frequency
+	double			power; // TX power
+	Wpan_Pkt_Type	packet_type;
+	Wpan_Pkt_Format	format;
+	int				dest_address; // MAC address of the destination
+	double			tx_x; // coordinates of
+	double			tx_y; // the transmitter
+	double			rx_x; // coordinates of
+	double			rx_y; // the receiver
+	int				tx_node_index; // position of the transmitter in the node list
+	int				rx_node_index; // position of the receiver in the node list
+} Wpan_Tx_Descriptor;
+
+/* budget of the link between two nodes */
+typedef struct {
+	int		tx_node_index; // position of the transmitter in the node list
+	int		rx_node_index; // position of the receiver in the node list
+	double	frequency; // transmission frequency
+	double	power; // TX power
+	double	tx_x; // coordinates of
+	double	tx_y; // the transmitter
+	double	rx_x; // coordinates of
+	double	rx_y; // the receiver
+	double	distance; // distance between TX and RX
+	double	prop_delay; // propagation delay
+	double	path_loss; // attenuation due to the path loss (dB)
+	double	snr; // SNR at the receiver (dB)
+} Wpan_Link_Budget;
+
 
 /* structure for the WPAN frame types */
 typedef enum WPAN_MAC_Frame_Type
@@ -367,7 +427,6 @@ typedef struct {
   int 		CAP_period_length_symbols;
   double 	CAP_period_length_seconds;
   double	CAP_start_time;
-  int 		remaining_CAP_backoff_periods;
   double 	end_of_the_CAP_period;
   int 		GTS_period_length_symbols;
   double 	GTS_period_length_seconds;
@@ -385,8 +444,6 @@ typedef struct {
   Boolean 	CPA4_ACTIVE;
   Boolean 	GTS_PERIOD_ACTIVE;
   Boolean 	INACTIVE_PERIOD;
-  int *		backoff_period_boundary_symbols;
-  int *		time_slot_boundary_symbols;
  } Wpan_Superframe_Param;
 
 
@@ -429,6 +486,10 @@ typedef struct {
   int value; // code value of the packet priority ( emergency = 3, regular = 2)
 } Packet_Priority_Type_Field;
 
+/* codes of the "Type of Priority" attribute of the ICI lr_wpan_traffic_ici_format */
+#define WPAN_PRIORITY_REGULAR	2
+#define WPAN_PRIORITY_EMERGENCY	3
+
 typedef struct {
 	Objid	parent_id; // ID of the node
 	Objid	objid;	// ID of the module which received the packets
@@ -445,6 +506,7 @@ typedef struct {
 	double	power;			// Power of the transmission
 	double  frequency;      // frequency center of WLAN
 	WlanT_Rx_State_Info * wlan_info; // info on the WLAN
+	int		node_index; // position of the node in wpan_node_param_list
 } Wpan_Node_Param;
 
 /* Define the Beacon parameters */
@@ -483,12 +545,28 @@ WlanT_Rx_State_Info * 	wlan_state_variable_get (Objid objid);
 int					wpan_get_mac_address (Objid node_id);
 Wpan_Node_Param *	wpan_search_wlan_node (int index);
 int					wpan_list_size_get_wlan_node (void);
+int					wpan_wpan_nodes_get (Wpan_Node_Param *** nodes_ptr);
+int					wpan_wlan_nodes_get (Wpan_Node_Param *** nodes_ptr);
+void				wpan_node_register (Wpan_Node_Param * element);
+void				wpan_node_mac_address_set (Wpan_Node_Param * element, int mac_address);
+Wpan_Node_Param *	wpan_node_get (int node_index);
+int					wpan_node_neighbors_get (double x, double y, double radius, Wpan_Node_Param *** neighbors_ptr);
+Wpan_Node_Param *	wpan_node_search_at (Objid objid, double x, double y);
+double				wpan_node_prop_delay_get (const Wpan_Node_Param * tx_node, const Wpan_Node_Param * rx_node);
+Wpan_Pkt_Format		wpan_pkt_format_get (Packet * pkptr);
+Ici *				wpan_tx_ici_create (const Wpan_Tx_Descriptor * descriptor);
+const Wpan_Tx_Descriptor *	wpan_tx_descriptor_get (Ici * ici_ptr);
+void				wpan_tx_ici_destroy (Ici * ici_ptr);
+const Wpan_Link_Budget *	wpan_link_budget_get (int tx_node_index, int rx_node_index, double frequency, double power);
 void 				lr_wpan_slotted_consistency (Wpan_Node_Param * master_elt);
 void				lr_wpan_slotted_generate_addr_table (Wpan_Node_Param * master_elt, Wpan_Beacon_Param * beacon_ptr);
-//double				lr_wpan_slotted_boundary_time (void);
+int					lr_wpan_slot_clock_index (double origin, int period_symbols, double time);
+double				lr_wpan_slot_clock_next_boundary (double origin, int period_symbols, double time);
+int					lr_wpan_slot_clock_remaining (double origin, int period_symbols, int end_symbols, double time);
 
 double	            uniform_random_value (double a);
 double              Pmd_802_15_4a (double snrDB); 
+double				fec_success_probability (double ber, int segment_size, int max_error);
 
 double 				compute_center_frequency (int channel_number); 
 double 				compute_lecim_dsss_center_frequency (int channel_number); 
@@ -0,0 +1,39 @@
+/*
+** oms_auto_addr_support.h :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  automatic assignment of the MAC addresses
+*/
+
+#ifndef __OMS_AUTO_ADDR_SUPPORT_STANDALONE_H__
+#define __OMS_AUTO_ADDR_SUPPORT_STANDALONE_H__
+
+/* standard includes */
+#include <opnet.h>
+
+/* value of an address attribute set to "Auto Assigned" */
+#define OMSC_AA_AUTO_ASSIGN		-2
+
+typedef struct OpT_Kernel_Aa_Pool *	OmsT_Aa_Address_Handle;
+
+OmsT_Aa_Address_Handle	oms_aa_address_handle_get (const char * pool_name, const char * attr_name);
+Compcode				oms_aa_address_resolve (OmsT_Aa_Address_Handle aa_handle, Objid module_objid, int * address_ptr);
+
+#endif // end of __OMS_AUTO_ADDR_SUPPORT_STANDALONE_H__
@@ -0,0 +1,35 @@
+/*
+** oms_dist_support.h :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  distributions loaded from their textual description
+*/
+
+#ifndef __OMS_DIST_SUPPORT_STANDALONE_H__
+#define __OMS_DIST_SUPPORT_STANDALONE_H__
+
+/* standard includes */
+#include <opnet.h>
+
+/* load a distribution from a string like "exponential (1.0)" */
+OmsT_Dist_Handle	oms_dist_load_from_string (const char * dist_string);
+double				oms_dist_outcome (OmsT_Dist_Handle dist_handle);
+
+#endif // end of __OMS_DIST_SUPPORT_STANDALONE_H__
@@ -0,0 +1,49 @@
+/*
+** oms_pr.h :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  process registry, kept to what the MAC models register
+*/
+
+#ifndef __OMS_PR_STANDALONE_H__
+#define __OMS_PR_STANDALONE_H__
+
+/* standard includes */
+#include <opnet.h>
+
+/* attribute types of the process registry */
+#define OMSC_PR_STRING		0
+#define OMSC_PR_NUMBER		1
+#define OMSC_PR_OBJID		2
+#define OMSC_PR_ADDRESS		3
+#define OMSC_PR_POINTER		4
+
+typedef struct OpT_Kernel_Pr_Record *	OmsT_Pr_Handle;
+
+OmsT_Pr_Handle	oms_pr_process_register (Objid node_objid, Objid module_objid, Prohandle pro_handle, const char * proc_model_name);
+
+/* the registry is only consulted by the IP stack, absent from the standalone runs */
+static inline Compcode oms_pr_attr_set (OmsT_Pr_Handle pr_handle, ...)
+{
+	(void) pr_handle;
+	return OPC_COMPCODE_SUCCESS;
+}
+
+#endif // end of __OMS_PR_STANDALONE_H__
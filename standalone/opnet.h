@@ -0,0 +1,400 @@
+/*
+** opnet.h :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  subset of the OPNET kernel API used by the WPAN
+**                      models, implemented by the standalone kernel
+**                      (opnet_kernel.c) for headless batch runs
+*/
+
+#ifndef __OPNET_STANDALONE_H__
+#define __OPNET_STANDALONE_H__
+
+/* standard includes */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* basic types */
+typedef int					Boolean;
+typedef int					Compcode;
+typedef int					Objid;
+typedef int					OpT_Int32;
+typedef long long			OpT_Int64;
+typedef unsigned long long	OpT_uInt64;
+typedef long long			OpT_Packet_Id;
+typedef double				OpT_Packet_Size;
+typedef long long			Evid;
+typedef int					Stathandle;
+typedef int					OpT_Obj_Type;
+
+typedef struct OpT_Kernel_Packet		Packet;
+typedef struct OpT_Kernel_Ici			Ici;
+typedef struct OpT_Kernel_List			List;
+typedef struct OpT_Kernel_Event *		OpT_Kernel_Event_Ptr;
+typedef struct OpT_Kernel_Modulation *	Modulation_Handle;
+typedef struct OpT_Kernel_Dist *		OmsT_Dist_Handle;
+typedef struct OpT_Kernel_Dist			Distribution;
+
+/* handle on a scheduled event, valid until the event is executed or cancelled */
+typedef struct {
+	OpT_Kernel_Event_Ptr	event;
+	Evid					id;
+} Evhandle;
+
+/* handle on the process running in a module */
+typedef struct {
+	Objid	objid;
+} Prohandle;
+
+/* procedures used to copy and free the structure fields of the packets */
+typedef void *	(*OpT_Kernel_Copy_Proc) (const void * mem_ptr, size_t size);
+typedef void	(*OpT_Kernel_Free_Proc) (void * mem_ptr);
+
+/* general constants */
+#define OPC_NIL					0
+#define OPC_TRUE				1
+#define OPC_FALSE				0
+#define OPC_COMPCODE_SUCCESS	0
+#define OPC_COMPCODE_FAILURE	-1
+#define OPC_OBJID_INVALID		-1
+#define OPC_EV_INVALID			{OPC_NIL, -1}
+
+/* list positions */
+#define OPC_LISTPOS_HEAD		0
+#define OPC_LISTPOS_TAIL		-1
+
+/* interrupt types */
+#define OPC_INTRPT_SELF			1
+#define OPC_INTRPT_STRM			2
+#define OPC_INTRPT_ENDSIM		3
+#define OPC_INTRPT_BEGSIM		4
+#define OPC_INTRPT_REMOTE		5
+#define OPC_INTRPT_PROCESS		6
+#define OPC_INTRPT_FAIL			7
+#define OPC_INTRPT_RECOVER		8
+
+/* object types */
+#define OPC_OBJTYPE_GENERIC		0
+#define OPC_OBJTYPE_SUBNET_FIX	1
+#define OPC_OBJTYPE_NODE_FIX	2
+#define OPC_OBJTYPE_PROC		3
+#define OPC_OBJTYPE_QUEUE		4
+#define OPC_OBJTYPE_COMP_ATTR	5
+
+/* statistics */
+#define OPC_STAT_INDEX_NONE		-1
+#define OPC_STAT_LOCAL			0
+#define OPC_STAT_GLOBAL			1
+
+/* simulation attribute types */
+#define OPC_IMA_INTEGER			0
+#define OPC_IMA_DOUBLE			1
+#define OPC_IMA_STRING			2
+#define OPC_IMA_TOGGLE			3
+
+/* value of a variadic field or attribute, typed at compile time */
+typedef struct {
+	int				type;
+	long long		integer;
+	double			real;
+	const void *	pointer;
+} OpT_Kernel_Value;
+
+#define OPC_KERNEL_VALUE_INT	1
+#define OPC_KERNEL_VALUE_DBL	2
+#define OPC_KERNEL_VALUE_STR	3
+#define OPC_KERNEL_VALUE_PTR	4
+#define OPC_KERNEL_VALUE_PKT	5
+
+OpT_Kernel_Value	op_kernel_value_int (long long value);
+OpT_Kernel_Value	op_kernel_value_dbl (double value);
+OpT_Kernel_Value	op_kernel_value_str (const char * value);
+OpT_Kernel_Value	op_kernel_value_ptr (const void * value);
+
+#define OP_KERNEL_VALUE(x)	_Generic ((x),						\
+	char:					op_kernel_value_int,			\
+	signed char:			op_kernel_value_int,			\
+	unsigned char:			op_kernel_value_int,			\
+	short:					op_kernel_value_int,			\
+	unsigned short:			op_kernel_value_int,			\
+	int:					op_kernel_value_int,			\
+	unsigned int:			op_kernel_value_int,			\
+	long:					op_kernel_value_int,			\
+	unsigned long:			op_kernel_value_int,			\
+	long long:				op_kernel_value_int,			\
+	unsigned long long:		op_kernel_value_int,			\
+	float:					op_kernel_value_dbl,			\
+	double:					op_kernel_value_dbl,			\
+	char *:					op_kernel_value_str,			\
+	const char *:			op_kernel_value_str,			\
+	default:				op_kernel_value_ptr) (x)
+
+/* pick the n-th argument of a variadic call, padded by the caller */
+#define OP_KERNEL_ARG1(a, ...)				a
+#define OP_KERNEL_ARG2(a, b, ...)			b
+#define OP_KERNEL_ARG3(a, b, c, ...)		c
+#define OP_KERNEL_ARG4(a, b, c, d, ...)		d
+
+/* state of the running process, reached through OP_SIM_CONTEXT_PTR */
+typedef struct {
+	void *	_op_mod_state_ptr;
+} OpT_Kernel_Context;
+
+extern OpT_Kernel_Context *	op_kernel_context_ptr;
+
+#define OP_SIM_CONTEXT_PTR		op_kernel_context_ptr
+#define OP_SIM_CONTEXT_ARG_OPT	void
+
+/* memory of the process state variables */
+typedef struct OpT_Kernel_Obtype *	VosT_Obtype;
+typedef void *						VosT_Address;
+
+VosT_Obtype		Vos_Define_Object_Prstate (const char * name, size_t size);
+VosT_Address	Vos_Alloc_Object (VosT_Obtype obtype);
+void			Vos_Poolmem_Dealloc (void * ptr);
+
+/* function entry and exit; the process models redefine the preamble */
+#define VOSD_NO_FIN
+#define FIN_PREAMBLE_DEC
+#define FIN_PREAMBLE_CODE
+#define FIN_TRACING
+#define FOUTRET_TRACING
+#define FIN_LOCAL_FIELD(field)
+#define FIN(function)			FIN_PREAMBLE_DEC FIN_PREAMBLE_CODE
+#define FIN_MT(function)		FIN_PREAMBLE_DEC FIN_PREAMBLE_CODE
+#define FOUT					return;
+#define FRET(value)				return (value);
+
+/* finite state machine of the process models */
+#define FSM_SYS_STATE	\
+	int				_op_current_block;	\
+	const char *	_op_current_state;
+
+#define FSM_ENTER(name)	\
+	int _op_trans = -1; int _op_dflt = -1; int _op_ncond = 0; (void) _op_ncond; (void) _op_dflt;
+
+#define FSM_BLOCK_SWITCH	switch (op_sv_ptr->_op_current_block)
+
+/* the enter executives of a forced state go on with its exit executives */
+#if defined (__GNUC__) && __GNUC__ >= 7
+#define FSM_FALLTHROUGH		__attribute__ ((fallthrough));
+#else
+#define FSM_FALLTHROUGH
+#endif
+
+#define FSM_STATE_ENTER_UNFORCED(index, name, label, trace)		case 2 * (index): label: ;
+#define FSM_STATE_ENTER_FORCED(index, name, label, trace)		case 2 * (index): label: ;
+#define FSM_STATE_ENTER_UNFORCED_NOLABEL(index, name, trace)	case 2 * (index): ;
+#define FSM_STATE_ENTER_FORCED_NOLABEL(index, name, trace)		case 2 * (index): ;
+#define FSM_STATE_EXIT_UNFORCED(index, name, trace)				case 2 * (index) + 1: ;
+#define FSM_STATE_EXIT_FORCED(index, name, trace)				FSM_FALLTHROUGH case 2 * (index) + 1: ;
+
+#define FSM_EXIT(block, name)	\
+	{ op_sv_ptr->_op_current_block = (block); return; }
+
+/* all the conditions are evaluated, as OPNET does, and the first true one is taken */
+#define FSM_INIT_COND(cond)	\
+	_op_ncond = 0; _op_trans = -1; _op_dflt = -1; if (cond) _op_trans = 0;
+#define FSM_TEST_COND(cond)	\
+	_op_ncond++; if ((cond) && _op_trans < 0) _op_trans = _op_ncond;
+#define FSM_DFLT_COND	\
+	_op_ncond++; _op_dflt = _op_ncond;
+#define FSM_TEST_LOGIC(state)	\
+	if (_op_trans < 0)	\
+		{	\
+		if (_op_dflt < 0)	\
+			{ op_kernel_fsm_no_transition (state); return; }	\
+		_op_trans = _op_dflt;	\
+		}
+
+/* FSM_TEST_LOGIC leaves a valid transition, the default label only tells the compiler that every case ends with a goto */
+#define FSM_TRANSIT_SWITCH	switch (_op_trans) default:
+#define FSM_CASE_TRANSIT(cond_index, to_state, label, exec, ...)	\
+	case cond_index: { exec; goto label; }
+#define FSM_TRANSIT_FORCE(to_state, label, exec, ...)	\
+	{ exec; goto label; }
+
+#define FSM_PROFILE_SECTION_IN(name, label)
+#define FSM_PROFILE_SECTION_OUT(label)
+
+void		op_kernel_fsm_no_transition (const char * state_name);
+
+/* simulation */
+double		op_sim_time (void);
+void		op_sim_end (const char * line0, const char * line1, const char * line2, const char * line3);
+void		op_sim_message (const char * line0, const char * line1);
+Boolean		op_sim_debug (void);
+
+/* interrupts */
+int			op_intrpt_type (void);
+int			op_intrpt_code (void);
+int			op_intrpt_strm (void);
+Objid		op_intrpt_source (void);
+Ici *		op_intrpt_ici (void);
+Evhandle	op_intrpt_schedule_self (double time, int code);
+Evhandle	op_intrpt_schedule_remote (double time, int code, Objid mod_objid);
+Compcode	op_intrpt_priority_set (int type, int code, int priority);
+
+/* events */
+Boolean		op_ev_valid (Evhandle evhandle);
+Compcode	op_ev_cancel (Evhandle evhandle);
+Evhandle	op_ev_current (void);
+Evid		op_ev_id (Evhandle evhandle);
+
+/* packets */
+Packet *	op_pk_create (OpT_Packet_Size bulk_size);
+Packet *	op_pk_create_fmt (const char * format_name);
+Packet *	op_pk_copy (Packet * pkptr);
+void		op_pk_destroy (Packet * pkptr);
+void		op_pk_send (Packet * pkptr, int outstrm_index);
+void		op_pk_deliver (Packet * pkptr, Objid mod_objid, int instrm_index);
+Packet *	op_pk_get (int instrm_index);
+OpT_Packet_Id	op_pk_id (Packet * pkptr);
+Compcode	op_pk_format (Packet * pkptr, char * format_name);
+OpT_Packet_Size	op_pk_total_size_get (Packet * pkptr);
+void		op_pk_total_size_set (Packet * pkptr, OpT_Packet_Size size);
+void		op_pk_stamp (Packet * pkptr);
+double		op_pk_stamp_time_get (Packet * pkptr);
+Objid		op_pk_stamp_mod_get (Packet * pkptr);
+void		op_pk_ici_set (Packet * pkptr, Ici * iciptr);
+Ici *		op_pk_ici_get (Packet * pkptr);
+
+Compcode	op_kernel_pk_nfd_set (Packet * pkptr, const char * fd_name, OpT_Kernel_Value value,
+				OpT_Kernel_Copy_Proc copy_proc, OpT_Kernel_Free_Proc free_proc, size_t size);
+Compcode	op_pk_nfd_get (Packet * pkptr, const char * fd_name, void * value_ptr);
+Compcode	op_pk_nfd_access (Packet * pkptr, const char * fd_name, void * value_ptr);
+Compcode	op_pk_nfd_set_int32 (Packet * pkptr, const char * fd_name, OpT_Int32 value);
+Compcode	op_pk_nfd_set_dbl (Packet * pkptr, const char * fd_name, double value);
+Compcode	op_pk_nfd_set_ptr (Packet * pkptr, const char * fd_name, void * value,
+				OpT_Kernel_Copy_Proc copy_proc, OpT_Kernel_Free_Proc free_proc, size_t size);
+Compcode	op_pk_nfd_set_pkt (Packet * pkptr, const char * fd_name, Packet * value);
+Compcode	op_pk_nfd_get_int32 (Packet * pkptr, const char * fd_name, OpT_Int32 * value_ptr);
+Compcode	op_pk_nfd_get_dbl (Packet * pkptr, const char * fd_name, double * value_ptr);
+Compcode	op_pk_nfd_get_ptr (Packet * pkptr, const char * fd_name, void * value_ptr);
+Compcode	op_pk_nfd_get_pkt (Packet * pkptr, const char * fd_name, Packet ** value_ptr);
+
+/* op_pk_nfd_set (pkptr, fd_name, value [, copy_proc, free_proc, size]) */
+#define op_pk_nfd_set(pkptr, fd_name, ...)	\
+	op_kernel_pk_nfd_set ((pkptr), (fd_name),	\
+		OP_KERNEL_VALUE (OP_KERNEL_ARG1 (__VA_ARGS__, 0)),	\
+		OP_KERNEL_ARG2 (__VA_ARGS__, OPC_NIL, OPC_NIL),	\
+		OP_KERNEL_ARG3 (__VA_ARGS__, OPC_NIL, OPC_NIL, OPC_NIL),	\
+		OP_KERNEL_ARG4 (__VA_ARGS__, 0, 0, 0, 0))
+
+/* interface control information */
+Ici *		op_ici_create (const char * fmt_name);
+void		op_ici_destroy (Ici * iciptr);
+void		op_ici_install (Ici * iciptr);
+Compcode	op_kernel_ici_attr_set (Ici * iciptr, const char * attr_name, OpT_Kernel_Value value);
+Compcode	op_ici_attr_get (Ici * iciptr, const char * attr_name, void * value_ptr);
+Compcode	op_ici_attr_set_int32 (Ici * iciptr, const char * attr_name, OpT_Int32 value);
+Compcode	op_ici_attr_set_dbl (Ici * iciptr, const char * attr_name, double value);
+Compcode	op_ici_attr_set_ptr (Ici * iciptr, const char * attr_name, void * value);
+Compcode	op_ici_attr_get_int32 (Ici * iciptr, const char * attr_name, OpT_Int32 * value_ptr);
+Compcode	op_ici_attr_get_dbl (Ici * iciptr, const char * attr_name, double * value_ptr);
+Compcode	op_ici_attr_get_ptr (Ici * iciptr, const char * attr_name, void * value_ptr);
+Boolean		op_ici_attr_exists (Ici * iciptr, const char * attr_name);
+
+#define op_ici_attr_set(iciptr, attr_name, value)	\
+	op_kernel_ici_attr_set ((iciptr), (attr_name), OP_KERNEL_VALUE (value))
+
+/* topology and attributes */
+Objid		op_id_self (void);
+Prohandle	op_pro_self (void);
+Objid		op_id_from_hierarchical_name (const char * hier_name);
+Objid		op_topo_parent (Objid objid);
+Objid		op_topo_child (Objid parent_objid, OpT_Obj_Type child_type, int child_index);
+int			op_topo_child_count (Objid parent_objid, OpT_Obj_Type child_type);
+int			op_topo_object_count (OpT_Obj_Type obj_type);
+
+Boolean		op_ima_obj_attr_exists (Objid objid, const char * attr_name);
+Compcode	op_ima_obj_attr_get (Objid objid, const char * attr_name, void * value_ptr);
+Compcode	op_ima_obj_attr_get_int32 (Objid objid, const char * attr_name, OpT_Int32 * value_ptr);
+Compcode	op_ima_obj_attr_get_dbl (Objid objid, const char * attr_name, double * value_ptr);
+Compcode	op_ima_obj_attr_get_toggle (Objid objid, const char * attr_name, Boolean * value_ptr);
+Compcode	op_ima_obj_attr_get_str (Objid objid, const char * attr_name, int size, char * value_ptr);
+Compcode	op_kernel_ima_obj_attr_set (Objid objid, const char * attr_name, OpT_Kernel_Value value);
+Compcode	op_ima_obj_attr_set_toggle (Objid objid, const char * attr_name, Boolean value);
+Compcode	op_ima_obj_attr_set_int32 (Objid objid, const char * attr_name, OpT_Int32 value);
+Compcode	op_ima_obj_attr_set_dbl (Objid objid, const char * attr_name, double value);
+Compcode	op_ima_obj_attr_set_str (Objid objid, const char * attr_name, const char * value);
+
+#define op_ima_obj_attr_set(objid, attr_name, value)	\
+	op_kernel_ima_obj_attr_set ((objid), (attr_name), OP_KERNEL_VALUE (value))
+
+Boolean		op_ima_sim_attr_exists (const char * attr_name);
+Compcode	op_ima_sim_attr_get (int attr_type, const char * attr_name, void * value_ptr);
+Compcode	op_ima_sim_attr_get_str (const char * attr_name, int size, char * value_ptr);
+
+/* lists */
+List *		op_prg_list_create (void);
+int			op_prg_list_size (List * list_ptr);
+void *		op_prg_list_access (List * list_ptr, int index);
+void		op_prg_list_insert (List * list_ptr, void * elem_ptr, int index);
+void *		op_prg_list_remove (List * list_ptr, int index);
+void		op_prg_list_free (List * list_ptr);
+void		op_prg_list_elems_copy (List * src_list_ptr, List * dest_list_ptr);
+
+/* memory */
+void *		op_prg_mem_alloc (size_t size);
+void *		op_prg_mem_realloc (void * mem_ptr, size_t size);
+void *		op_prg_mem_copy_create (const void * mem_ptr, size_t size);
+void		op_prg_mem_free (void * mem_ptr);
+
+/* debugger */
+Boolean		op_prg_odb_ltrace_active (const char * label);
+void		op_prg_odb_bkpt (const char * label);
+void		op_kernel_odb_print_major (const char * lines[]);
+
+#define op_prg_odb_print_major(...)	\
+	op_kernel_odb_print_major ((const char * []) {__VA_ARGS__, OPC_NIL})
+
+/* statistics */
+Stathandle	op_stat_reg (const char * stat_name, int stat_index, int stat_type);
+void		op_stat_write (Stathandle stat_handle, double value);
+
+/* distributions */
+double		op_dist_uniform (double limit);
+double		op_dist_exponential (double mean);
+Distribution *	op_dist_load (const char * dist_name, double arg0, double arg1);
+double		op_dist_outcome (Distribution * dist_ptr);
+
+/* modulation curves */
+Modulation_Handle	op_tbl_modulation_get (const char * modulation_name);
+double		op_tbl_mod_ber (Modulation_Handle modulation, double eff_snr);
+
+/* files: the models build their report names with Windows separators */
+FILE *		op_kernel_fopen (const char * path, const char * mode);
+
+#define fopen(path, mode)	op_kernel_fopen ((path), (mode))
+
+#if defined (__cplusplus)
+} /* end of 'extern "C"' */
+#endif
+
+#endif // end of __OPNET_STANDALONE_H__
@@ -0,0 +1,2766 @@
+/*
+** opnet_kernel.c :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  minimal discrete event kernel implementing the
+**                      OPNET API used by the WPAN models, so that the
+**                      process models (.pr.c) and the external files
+**                      (.ex.c) run headless on Linux
+*/
+
+/* standard includes */
+#include <limits.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "opnet_kernel.h"
+#include "oms_dist_support.h"
+#include "oms_pr.h"
+#include "oms_auto_addr_support.h"
+
+
+/* memory blocks: every block carries its kind, so that a packet or a list */
+/* handed to op_prg_mem_free by mistake is recognized instead of corrupted */
+#define OPC_KERNEL_MEM_MAGIC	0x4b4d5057u
+
+typedef enum {
+	OPC_KERNEL_MEM_FREED = 0,
+	OPC_KERNEL_MEM_BLOCK,
+	OPC_KERNEL_MEM_PACKET,
+	OPC_KERNEL_MEM_ICI,
+	OPC_KERNEL_MEM_LIST
+} OpT_Kernel_Mem_Kind;
+
+typedef union {
+	struct {
+		unsigned int	magic;
+		unsigned int	kind;
+		size_t			size;
+	} info;
+	max_align_t		align;
+} OpT_Kernel_Mem_Header;
+
+/* named and typed value, used for the packet fields and the ICI attributes */
+typedef struct {
+	char					name[48];
+	int						type;
+	int						integer;
+	double					real;
+	void *					pointer;
+	OpT_Kernel_Copy_Proc	copy_proc;
+	OpT_Kernel_Free_Proc	free_proc;
+	size_t					size;
+} OpT_Kernel_Field;
+
+struct OpT_Kernel_Packet {
+	char				format[48];
+	OpT_Packet_Id		id;
+	OpT_Packet_Size		size;
+	double				stamp_time;
+	Objid				stamp_mod;
+	Ici *				ici;
+	OpT_Kernel_Field *	fields;
+	int					nb_fields;
+	int					capacity;
+};
+
+struct OpT_Kernel_Ici {
+	char				format[48];
+	OpT_Kernel_Field *	fields;
+	int					nb_fields;
+	int					capacity;
+};
+
+/* list stored as a ring buffer: the queues pop their head in O(1) */
+struct OpT_Kernel_List {
+	void **	elems;
+	int		head;
+	int		size;
+	int		capacity;
+};
+
+/* attribute of an object */
+typedef struct {
+	char *	name;
+	int		type;
+	int		integer;
+	double	real;
+	char *	string;
+} OpT_Kernel_Attr;
+
+/* connection of an output stream */
+typedef struct {
+	Objid	dest_objid;
+	int		instrm_index;
+} OpT_Kernel_Stream;
+
+/* interrupt priority set by a process */
+typedef struct {
+	int		type;
+	int		code;
+	int		priority;
+} OpT_Kernel_Priority;
+
+/* object of the topology: subnet, node, module or compound attribute */
+typedef struct {
+	Objid								objid;
+	OpT_Obj_Type						objtype;
+	Objid								parent_objid;
+	char *								name;
+	char *								hier_name;
+	OpT_Kernel_Attr *					attrs;
+	int									nb_attrs;
+	Objid *								children;
+	int									nb_children;
+	const OpT_Kernel_Process_Model *	model;
+	OpT_Kernel_Context					context;
+	OpT_Kernel_Stream *					outstrms;
+	int									nb_outstrms;
+	List **								instrms;
+	int									nb_instrms;
+	Ici *								installed_ici;
+	OpT_Kernel_Priority *				priorities;
+	int									nb_priorities;
+} OpT_Kernel_Object;
+
+/* event of the simulation */
+typedef enum {
+	OPC_KERNEL_EV_FREE = 0,
+	OPC_KERNEL_EV_PENDING,
+	OPC_KERNEL_EV_CANCELLED,
+	OPC_KERNEL_EV_RUNNING
+} OpT_Kernel_Ev_State;
+
+struct OpT_Kernel_Event {
+	double						time;
+	int							priority;
+	OpT_uInt64					seq;
+	Evid						id;
+	int							type;
+	int							code;
+	int							strm;
+	Objid						module_objid;
+	Objid						source_objid;
+	Ici *						ici;
+	Packet *					pkptr;
+	OpT_Kernel_Ev_State			state;
+	struct OpT_Kernel_Event *	next_free;
+};
+
+struct OpT_Kernel_Obtype {
+	const char *	name;
+	size_t			size;
+};
+
+/* statistic */
+typedef struct {
+	char *		name;
+	Objid		module_objid;
+	OpT_uInt64	count;
+	double		sum;
+	double		min;
+	double		max;
+	double		last;
+} OpT_Kernel_Stat;
+
+/* distribution */
+typedef enum {
+	OPC_KERNEL_DIST_CONSTANT,
+	OPC_KERNEL_DIST_UNIFORM,
+	OPC_KERNEL_DIST_UNIFORM_INT,
+	OPC_KERNEL_DIST_EXPONENTIAL
+} OpT_Kernel_Dist_Type;
+
+struct OpT_Kernel_Dist {
+	OpT_Kernel_Dist_Type	type;
+	double					arg0;
+	double					arg1;
+};
+
+/* modulation curve, given by a procedure or by a table of points */
+struct OpT_Kernel_Modulation {
+	char *							name;
+	OpT_Kernel_Ber_Proc				ber_proc;
+	double *						snr;
+	double *						ber;
+	int								nb_points;
+	struct OpT_Kernel_Modulation *	next;
+};
+
+/* packet format: initial size and integer fields set by default */
+typedef struct {
+	char				format[48];
+	OpT_Packet_Size		size;
+	OpT_Kernel_Field *	fields;
+	int					nb_fields;
+	int					capacity;
+} OpT_Kernel_Format;
+
+struct OpT_Kernel_Pr_Record {
+	Objid	node_objid;
+	Objid	module_objid;
+	char	proc_model_name[64];
+};
+
+struct OpT_Kernel_Aa_Pool {
+	int		next_address;
+};
+
+
+/* context of the running process */
+OpT_Kernel_Context *	op_kernel_context_ptr = OPC_NIL;
+
+/* topology */
+static OpT_Kernel_Object **	op_kernel_objects = OPC_NIL;
+static int					op_kernel_nb_objects = 0;
+static int					op_kernel_objects_capacity = 0;
+
+/* event list, as a binary heap ordered by time, priority and scheduling order */
+static struct OpT_Kernel_Event **	op_kernel_heap = OPC_NIL;
+static int							op_kernel_heap_size = 0;
+static int							op_kernel_heap_capacity = 0;
+static struct OpT_Kernel_Event *	op_kernel_free_events = OPC_NIL;
+static OpT_uInt64					op_kernel_seq = 0;
+static Evid							op_kernel_next_evid = 1;
+static OpT_uInt64					op_kernel_nb_events = 0;
+
+/* state of the simulation */
+static double						op_kernel_time = 0.0;
+static struct OpT_Kernel_Event *	op_kernel_current_event = OPC_NIL;
+static OpT_Kernel_Object *			op_kernel_current_module = OPC_NIL;
+static Boolean						op_kernel_end_requested = OPC_FALSE;
+static Boolean						op_kernel_running = OPC_FALSE;
+static OpT_Packet_Id				op_kernel_next_pk_id = 0;
+
+/* random number generator (xoshiro256**) */
+static OpT_uInt64	op_kernel_rng_state[4];
+static Boolean		op_kernel_rng_seeded = OPC_FALSE;
+
+/* statistics */
+static OpT_Kernel_Stat *	op_kernel_stats = OPC_NIL;
+static int					op_kernel_nb_stats = 0;
+static int					op_kernel_stats_capacity = 0;
+
+/* models */
+static struct OpT_Kernel_Modulation *	op_kernel_modulations = OPC_NIL;
+static OpT_Kernel_Format *				op_kernel_formats = OPC_NIL;
+static int								op_kernel_nb_formats = 0;
+static char **							op_kernel_ltraces = OPC_NIL;
+static int								op_kernel_nb_ltraces = 0;
+
+/* local function prototypes */
+static void					op_kernel_error (const char * fcnt, const char * msg, const char * opt);
+static void *				op_kernel_alloc (size_t size, OpT_Kernel_Mem_Kind kind);
+static void					op_kernel_dealloc (void * ptr, OpT_Kernel_Mem_Kind kind);
+static OpT_Kernel_Mem_Header *	op_kernel_header (const void * ptr, const char * fcnt);
+static char *				op_kernel_strdup (const char * str);
+static OpT_Kernel_Object *	op_kernel_object (Objid objid, const char * fcnt);
+static Objid				op_kernel_object_create (Objid parent_objid, OpT_Obj_Type objtype, const char * name);
+static OpT_Kernel_Attr *	op_kernel_attr_find (Objid objid, const char * attr_name, Boolean create);
+static OpT_Kernel_Field *	op_kernel_field_find (OpT_Kernel_Field ** fields_ptr, int * nb_ptr, int * capacity_ptr, const char * name, Boolean create);
+static void					op_kernel_field_release (OpT_Kernel_Field * field);
+static OpT_Kernel_Format *	op_kernel_format_find (const char * format_name, Boolean create);
+static Compcode				op_kernel_field_read (OpT_Kernel_Field * field, void * value_ptr);
+static Evhandle				op_kernel_schedule (double time, int type, int code, int strm, Objid module_objid, Packet * pkptr);
+static void					op_kernel_heap_push (struct OpT_Kernel_Event * event);
+static struct OpT_Kernel_Event *	op_kernel_heap_pop (void);
+static void					op_kernel_event_release (struct OpT_Kernel_Event * event);
+static void					op_kernel_invoke (OpT_Kernel_Object * module, struct OpT_Kernel_Event * event);
+static double				op_kernel_uniform (void);
+
+
+/*
+ * Function:	op_kernel_error
+ *
+ * Description:	report a misuse of the kernel by the driver and exit
+ *
+ * ParamIn:		const char * fcnt
+ *				function where the error happened
+ *
+ *				const char * msg
+ *				error message
+ *
+ *				const char * opt
+ *				optional message
+ */
+
+static void op_kernel_error (const char * fcnt, const char * msg, const char * opt)
+{
+	fprintf (stderr, "Standalone kernel error in %s: %s %s\n", fcnt, msg, (opt == OPC_NIL) ? "" : opt);
+	exit (EXIT_FAILURE);
+}
+
+
+/*
+ * Function:	op_kernel_alloc
+ *
+ * Description:	allocate a zeroed memory block of a given kind
+ *
+ * ParamIn:		size_t size
+ *				size of the block
+ *
+ *				OpT_Kernel_Mem_Kind kind
+ *				kind of the block
+ *
+ * ParamOut:	void * ptr
+ *				allocated block
+ */
+
+static void * op_kernel_alloc (size_t size, OpT_Kernel_Mem_Kind kind)
+{
+	OpT_Kernel_Mem_Header * header;
+
+	if ((header = (OpT_Kernel_Mem_Header *) calloc (1, sizeof (OpT_Kernel_Mem_Header) + size)) == OPC_NIL)
+		op_kernel_error ("op_kernel_alloc", "Out of memory.", OPC_NIL);
+
+	header->info.magic = OPC_KERNEL_MEM_MAGIC;
+	header->info.kind = kind;
+	header->info.size = size;
+
+	return (header + 1);
+}
+
+
+/*
+ * Function:	op_kernel_header
+ *
+ * Description:	get the header of a block allocated by the kernel
+ *
+ * ParamIn:		const void * ptr
+ *				allocated block
+ *
+ *				const char * fcnt
+ *				calling function, for the error message
+ *
+ * ParamOut:	OpT_Kernel_Mem_Header * header
+ *				header of the block
+ */
+
+static OpT_Kernel_Mem_Header * op_kernel_header (const void * ptr, const char * fcnt)
+{
+	OpT_Kernel_Mem_Header * header;
+
+	header = ((OpT_Kernel_Mem_Header *) ptr) - 1;
+
+	if (header->info.magic != OPC_KERNEL_MEM_MAGIC)
+		op_kernel_error (fcnt, "The memory was not allocated by the kernel.", OPC_NIL);
+
+	if (header->info.kind == OPC_KERNEL_MEM_FREED)
+		op_kernel_error (fcnt, "The memory was already deallocated.", OPC_NIL);
+
+	return (header);
+}
+
+
+/*
+ * Function:	op_kernel_dealloc
+ *
+ * Description:	deallocate a memory block of a given kind
+ *
+ * ParamIn:		void * ptr
+ *				allocated block
+ *
+ *				OpT_Kernel_Mem_Kind kind
+ *				expected kind of the block
+ */
+
+static void op_kernel_dealloc (void * ptr, OpT_Kernel_Mem_Kind kind)
+{
+	OpT_Kernel_Mem_Header * header;
+
+	header = op_kernel_header (ptr, "op_kernel_dealloc");
+
+	if (header->info.kind != (unsigned int) kind)
+		op_kernel_error ("op_kernel_dealloc", "The memory block has not the expected kind.", OPC_NIL);
+
+	header->info.kind = OPC_KERNEL_MEM_FREED;
+	free (header);
+}
+
+
+/*
+ * Function:	op_kernel_strdup
+ *
+ * Description:	duplicate a string
+ */
+
+static char * op_kernel_strdup (const char * str)
+{
+	char * copy;
+
+	if ((copy = (char *) malloc (strlen (str) + 1)) == OPC_NIL)
+		op_kernel_error ("op_kernel_strdup", "Out of memory.", OPC_NIL);
+
+	return (strcpy (copy, str));
+}
+
+
+/*
+ * Function:	op_prg_mem_alloc, op_prg_mem_realloc, op_prg_mem_copy_create, op_prg_mem_free
+ *
+ * Description:	dynamic memory of the models
+ */
+
+void * op_prg_mem_alloc (size_t size)
+{
+	return (op_kernel_alloc (size, OPC_KERNEL_MEM_BLOCK));
+}
+
+void * op_prg_mem_realloc (void * mem_ptr, size_t size)
+{
+	OpT_Kernel_Mem_Header * header;
+
+	if (mem_ptr == OPC_NIL)
+		return (op_prg_mem_alloc (size));
+
+	header = op_kernel_header (mem_ptr, "op_prg_mem_realloc");
+
+	if ((header = (OpT_Kernel_Mem_Header *) realloc (header, sizeof (OpT_Kernel_Mem_Header) + size)) == OPC_NIL)
+		op_kernel_error ("op_prg_mem_realloc", "Out of memory.", OPC_NIL);
+
+	header->info.size = size;
+
+	return (header + 1);
+}
+
+void * op_prg_mem_copy_create (const void * mem_ptr, size_t size)
+{
+	void * copy;
+
+	copy = op_prg_mem_alloc (size);
+
+	if (mem_ptr != OPC_NIL)
+		memcpy (copy, mem_ptr, size);
+
+	return (copy);
+}
+
+void op_prg_mem_free (void * mem_ptr)
+{
+	OpT_Kernel_Mem_Header * header;
+
+	if (mem_ptr == OPC_NIL)
+		return;
+
+	header = op_kernel_header (mem_ptr, "op_prg_mem_free");
+
+	/* packets, ICIs and lists are left to their own destroy functions */
+	if (header->info.kind == OPC_KERNEL_MEM_BLOCK)
+		op_kernel_dealloc (mem_ptr, OPC_KERNEL_MEM_BLOCK);
+	else if (header->info.kind == OPC_KERNEL_MEM_LIST)
+		{
+		free (((List *) mem_ptr)->elems);
+		op_kernel_dealloc (mem_ptr, OPC_KERNEL_MEM_LIST);
+		}
+}
+
+
+/*
+ * Function:	Vos_Define_Object_Prstate, Vos_Alloc_Object, Vos_Poolmem_Dealloc
+ *
+ * Description:	memory of the state variables of the processes
+ */
+
+VosT_Obtype Vos_Define_Object_Prstate (const char * name, size_t size)
+{
+	VosT_Obtype obtype;
+
+	obtype = (VosT_Obtype) op_kernel_alloc (sizeof (struct OpT_Kernel_Obtype), OPC_KERNEL_MEM_BLOCK);
+	obtype->name = name;
+	obtype->size = size;
+
+	return (obtype);
+}
+
+VosT_Address Vos_Alloc_Object (VosT_Obtype obtype)
+{
+	return (op_kernel_alloc (obtype->size, OPC_KERNEL_MEM_BLOCK));
+}
+
+void Vos_Poolmem_Dealloc (void * ptr)
+{
+	op_prg_mem_free (ptr);
+}
+
+
+/*
+ * Function:	op_kernel_value_int, op_kernel_value_dbl, op_kernel_value_str, op_kernel_value_ptr
+ *
+ * Description:	build the typed value of a variadic field or attribute
+ */
+
+OpT_Kernel_Value op_kernel_value_int (long long value)
+{
+	OpT_Kernel_Value kernel_value = {OPC_KERNEL_VALUE_INT, 0, 0.0, OPC_NIL};
+
+	kernel_value.integer = value;
+
+	return (kernel_value);
+}
+
+OpT_Kernel_Value op_kernel_value_dbl (double value)
+{
+	OpT_Kernel_Value kernel_value = {OPC_KERNEL_VALUE_DBL, 0, 0.0, OPC_NIL};
+
+	kernel_value.real = value;
+
+	return (kernel_value);
+}
+
+OpT_Kernel_Value op_kernel_value_str (const char * value)
+{
+	OpT_Kernel_Value kernel_value = {OPC_KERNEL_VALUE_STR, 0, 0.0, OPC_NIL};
+
+	kernel_value.pointer = value;
+
+	return (kernel_value);
+}
+
+OpT_Kernel_Value op_kernel_value_ptr (const void * value)
+{
+	OpT_Kernel_Value kernel_value = {OPC_KERNEL_VALUE_PTR, 0, 0.0, OPC_NIL};
+
+	kernel_value.pointer = value;
+
+	return (kernel_value);
+}
+
+
+/*
+ * Function:	op_kernel_object
+ *
+ * Description:	get an object of the topology from its ID
+ *
+ * ParamIn:		Objid objid
+ *				ID of the object
+ *
+ *				const char * fcnt
+ *				calling function, for the error message
+ *
+ * ParamOut:	OpT_Kernel_Object * object
+ *				object, OPC_NIL if the ID is invalid
+ */
+
+static OpT_Kernel_Object * op_kernel_object (Objid objid, const char * fcnt)
+{
+	char objid_str[32];
+
+	if (objid < 0 || objid >= op_kernel_nb_objects)
+		{
+		sprintf (objid_str, "(objid %d)", objid);
+		op_sim_end ("Standalone kernel error:", fcnt, "Invalid object ID.", objid_str);
+		return (OPC_NIL);
+		}
+
+	return (op_kernel_objects[objid]);
+}
+
+
+/*
+ * Function:	op_kernel_object_create
+ *
+ * Description:	create an object of the topology. The top object,
+ *				holding the simulation attributes, is created first.
+ *
+ * ParamIn:		Objid parent_objid
+ *				ID of the parent object
+ *
+ *				OpT_Obj_Type objtype
+ *				type of the object
+ *
+ *				const char * name
+ *				name of the object
+ *
+ * ParamOut:	Objid objid
+ *				ID of the new object
+ */
+
+static Objid op_kernel_object_create (Objid parent_objid, OpT_Obj_Type objtype, const char * name)
+{
+	OpT_Kernel_Object * object;
+	OpT_Kernel_Object * parent;
+
+	if (op_kernel_running)
+		op_kernel_error ("op_kernel_object_create", "The topology cannot change during the simulation.", name);
+
+	/* create the top object */
+	if (op_kernel_nb_objects == 0 && parent_objid != OPC_OBJID_INVALID)
+		op_kernel_object_create (OPC_OBJID_INVALID, OPC_OBJTYPE_GENERIC, "top");
+
+	if (parent_objid != OPC_OBJID_INVALID && (parent_objid < 0 || parent_objid >= op_kernel_nb_objects))
+		op_kernel_error ("op_kernel_object_create", "Invalid parent object.", name);
+
+	if (op_kernel_nb_objects == op_kernel_objects_capacity)
+		{
+		op_kernel_objects_capacity = (op_kernel_objects_capacity == 0) ? 64 : 2 * op_kernel_objects_capacity;
+		op_kernel_objects = (OpT_Kernel_Object **) realloc (op_kernel_objects, op_kernel_objects_capacity * sizeof (OpT_Kernel_Object *));
+		if (op_kernel_objects == OPC_NIL)
+			op_kernel_error ("op_kernel_object_create", "Out of memory.", OPC_NIL);
+		}
+
+	if ((object = (OpT_Kernel_Object *) calloc (1, sizeof (OpT_Kernel_Object))) == OPC_NIL)
+		op_kernel_error ("op_kernel_object_create", "Out of memory.", OPC_NIL);
+
+	object->objid = op_kernel_nb_objects;
+	object->objtype = objtype;
+	object->parent_objid = parent_objid;
+	object->name = op_kernel_strdup (name);
+	op_kernel_objects[op_kernel_nb_objects++] = object;
+
+	/* the hierarchical name starts below the top object */
+	if (parent_objid <= 0)
+		object->hier_name = op_kernel_strdup (name);
+	else
+		{
+		parent = op_kernel_objects[parent_objid];
+		object->hier_name = (char *) malloc (strlen (parent->hier_name) + strlen (name) + 2);
+		if (object->hier_name == OPC_NIL)
+			op_kernel_error ("op_kernel_object_create", "Out of memory.", OPC_NIL);
+		sprintf (object->hier_name, "%s.%s", parent->hier_name, name);
+		}
+
+	if (parent_objid != OPC_OBJID_INVALID)
+		{
+		parent = op_kernel_objects[parent_objid];
+		parent->children = (Objid *) realloc (parent->children, (parent->nb_children + 1) * sizeof (Objid));
+		if (parent->children == OPC_NIL)
+			op_kernel_error ("op_kernel_object_create", "Out of memory.", OPC_NIL);
+		parent->children[parent->nb_children++] = object->objid;
+		}
+
+	op_kernel_attr_set_str (object->objid, "name", name);
+
+	return (object->objid);
+}
+
+
+/*
+ * Function:	op_kernel_subnet_create, op_kernel_node_create, op_kernel_module_create
+ *
+ * Description:	build the topology of the simulated network
+ */
+
+Objid op_kernel_subnet_create (Objid parent_objid, const char * name)
+{
+	return (op_kernel_object_create ((parent_objid == OPC_OBJID_INVALID) ? 0 : parent_objid, OPC_OBJTYPE_SUBNET_FIX, name));
+}
+
+Objid op_kernel_node_create (Objid subnet_objid, const char * name)
+{
+	return (op_kernel_object_create (subnet_objid, OPC_OBJTYPE_NODE_FIX, name));
+}
+
+Objid op_kernel_module_create (Objid node_objid, const char * name, const OpT_Kernel_Process_Model * model)
+{
+	Objid objid;
+
+	objid = op_kernel_object_create (node_objid, (model == OPC_NIL) ? OPC_OBJTYPE_QUEUE : OPC_OBJTYPE_PROC, name);
+	op_kernel_objects[objid]->model = model;
+
+	if (model != OPC_NIL)
+		op_kernel_attr_set_str (objid, "process model", model->name);
+
+	return (objid);
+}
+
+
+/*
+ * Function:	op_kernel_attr_compound_create
+ *
+ * Description:	create a compound attribute with a single row and
+ *				return the row, which holds the sub-attributes
+ *
+ * ParamIn:		Objid objid
+ *				object holding the attribute
+ *
+ *				const char * attr_name
+ *				name of the attribute
+ *
+ * ParamOut:	Objid row_objid
+ *				ID of the row of the compound attribute
+ */
+
+Objid op_kernel_attr_compound_create (Objid objid, const char * attr_name)
+{
+	Objid comp_objid;
+
+	comp_objid = op_kernel_object_create (objid, OPC_OBJTYPE_COMP_ATTR, attr_name);
+	op_kernel_attr_set_int (objid, attr_name, comp_objid);
+
+	return (op_kernel_object_create (comp_objid, OPC_OBJTYPE_COMP_ATTR, "row 0"));
+}
+
+
+/*
+ * Function:	op_kernel_stream_connect
+ *
+ * Description:	connect an output stream of a module to an input stream
+ *				of another module
+ */
+
+void op_kernel_stream_connect (Objid src_objid, int outstrm_index, Objid dest_objid, int instrm_index)
+{
+	OpT_Kernel_Object * src;
+	int i;
+
+	if (src_objid <= 0 || src_objid >= op_kernel_nb_objects || dest_objid <= 0 || dest_objid >= op_kernel_nb_objects ||
+		outstrm_index < 0 || instrm_index < 0)
+		op_kernel_error ("op_kernel_stream_connect", "Invalid stream.", OPC_NIL);
+
+	src = op_kernel_objects[src_objid];
+
+	if (outstrm_index >= src->nb_outstrms)
+		{
+		src->outstrms = (OpT_Kernel_Stream *) realloc (src->outstrms, (outstrm_index + 1) * sizeof (OpT_Kernel_Stream));
+		if (src->outstrms == OPC_NIL)
+			op_kernel_error ("op_kernel_stream_connect", "Out of memory.", OPC_NIL);
+		for (i = src->nb_outstrms; i <= outstrm_index; i++)
+			src->outstrms[i].dest_objid = OPC_OBJID_INVALID;
+		src->nb_outstrms = outstrm_index + 1;
+		}
+
+	src->outstrms[outstrm_index].dest_objid = dest_objid;
+	src->outstrms[outstrm_index].instrm_index = instrm_index;
+}
+
+
+/*
+ * Function:	op_kernel_attr_find
+ *
+ * Description:	find an attribute of an object
+ *
+ * ParamIn:		Objid objid
+ *				ID of the object
+ *
+ *				const char * attr_name
+ *				name of the attribute
+ *
+ *				Boolean create
+ *				create the attribute if it doesn't exist
+ *
+ * ParamOut:	OpT_Kernel_Attr * attr
+ *				attribute, OPC_NIL if it doesn't exist
+ */
+
+static OpT_Kernel_Attr * op_kernel_attr_find (Objid objid, const char * attr_name, Boolean create)
+{
+	OpT_Kernel_Object * object;
+	OpT_Kernel_Attr * attr;
+	int i;
+
+	if (objid < 0 || objid >= op_kernel_nb_objects)
+		{
+		if (create)
+			op_kernel_error ("op_kernel_attr_find", "Invalid object ID.", attr_name);
+		return (OPC_NIL);
+		}
+
+	object = op_kernel_objects[objid];
+
+	for (i = 0; i < object->nb_attrs; i++)
+		{
+		if (!strcmp (object->attrs[i].name, attr_name))
+			return (&object->attrs[i]);
+		}
+
+	if (!create)
+		return (OPC_NIL);
+
+	object->attrs = (OpT_Kernel_Attr *) realloc (object->attrs, (object->nb_attrs + 1) * sizeof (OpT_Kernel_Attr));
+	if (object->attrs == OPC_NIL)
+		op_kernel_error ("op_kernel_attr_find", "Out of memory.", OPC_NIL);
+
+	attr = &object->attrs[object->nb_attrs++];
+	memset (attr, 0, sizeof (OpT_Kernel_Attr));
+	attr->name = op_kernel_strdup (attr_name);
+
+	return (attr);
+}
+
+
+/*
+ * Function:	op_kernel_attr_set_int, op_kernel_attr_set_dbl, op_kernel_attr_set_str
+ *
+ * Description:	set the attributes of the objects. The type given here
+ *				is the type the models read the attribute with.
+ */
+
+void op_kernel_attr_set_int (Objid objid, const char * attr_name, int value)
+{
+	OpT_Kernel_Attr * attr;
+
+	if (op_kernel_nb_objects == 0)
+		op_kernel_object_create (OPC_OBJID_INVALID, OPC_OBJTYPE_GENERIC, "top");
+
+	attr = op_kernel_attr_find (objid, attr_name, OPC_TRUE);
+	free (attr->string);
+	attr->string = OPC_NIL;
+	attr->type = OPC_KERNEL_VALUE_INT;
+	attr->integer = value;
+}
+
+void op_kernel_attr_set_dbl (Objid objid, const char * attr_name, double value)
+{
+	OpT_Kernel_Attr * attr;
+
+	if (op_kernel_nb_objects == 0)
+		op_kernel_object_create (OPC_OBJID_INVALID, OPC_OBJTYPE_GENERIC, "top");
+
+	attr = op_kernel_attr_find (objid, attr_name, OPC_TRUE);
+	free (attr->string);
+	attr->string = OPC_NIL;
+	attr->type = OPC_KERNEL_VALUE_DBL;
+	attr->real = value;
+}
+
+void op_kernel_attr_set_str (Objid objid, const char * attr_name, const char * value)
+{
+	OpT_Kernel_Attr * attr;
+	char * copy;
+
+	if (op_kernel_nb_objects == 0)
+		op_kernel_object_create (OPC_OBJID_INVALID, OPC_OBJTYPE_GENERIC, "top");
+
+	attr = op_kernel_attr_find (objid, attr_name, OPC_TRUE);
+	copy = op_kernel_strdup (value);
+	free (attr->string);
+	attr->type = OPC_KERNEL_VALUE_STR;
+	attr->string = copy;
+}
+
+
+/*
+ * Function:	op_ima_obj_attr_*
+ *
+ * Description:	read and write the attributes of the objects
+ */
+
+Boolean op_ima_obj_attr_exists (Objid objid, const char * attr_name)
+{
+	return (op_kernel_attr_find (objid, attr_name, OPC_FALSE) != OPC_NIL);
+}
+
+Compcode op_ima_obj_attr_get (Objid objid, const char * attr_name, void * value_ptr)
+{
+	OpT_Kernel_Attr * attr;
+
+	if ((attr = op_kernel_attr_find (objid, attr_name, OPC_FALSE)) == OPC_NIL)
+		{
+		fprintf (stderr, "Warning: attribute \"%s\" not found (objid %d).\n", attr_name, objid);
+		return (OPC_COMPCODE_FAILURE);
+		}
+
+	switch (attr->type)
+		{
+		case OPC_KERNEL_VALUE_INT:
+			*((int *) value_ptr) = attr->integer;
+			break;
+
+		case OPC_KERNEL_VALUE_DBL:
+			*((double *) value_ptr) = attr->real;
+			break;
+
+		default:
+			strcpy ((char *) value_ptr, attr->string);
+			break;
+		}
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ima_obj_attr_get_int32 (Objid objid, const char * attr_name, OpT_Int32 * value_ptr)
+{
+	OpT_Kernel_Attr * attr;
+
+	if ((attr = op_kernel_attr_find (objid, attr_name, OPC_FALSE)) == OPC_NIL || attr->type == OPC_KERNEL_VALUE_STR)
+		return (OPC_COMPCODE_FAILURE);
+
+	*value_ptr = (attr->type == OPC_KERNEL_VALUE_INT) ? attr->integer : (OpT_Int32) attr->real;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ima_obj_attr_get_dbl (Objid objid, const char * attr_name, double * value_ptr)
+{
+	OpT_Kernel_Attr * attr;
+
+	if ((attr = op_kernel_attr_find (objid, attr_name, OPC_FALSE)) == OPC_NIL || attr->type == OPC_KERNEL_VALUE_STR)
+		return (OPC_COMPCODE_FAILURE);
+
+	*value_ptr = (attr->type == OPC_KERNEL_VALUE_INT) ? (double) attr->integer : attr->real;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ima_obj_attr_get_toggle (Objid objid, const char * attr_name, Boolean * value_ptr)
+{
+	return (op_ima_obj_attr_get_int32 (objid, attr_name, value_ptr));
+}
+
+Compcode op_ima_obj_attr_get_str (Objid objid, const char * attr_name, int size, char * value_ptr)
+{
+	OpT_Kernel_Attr * attr;
+
+	if ((attr = op_kernel_attr_find (objid, attr_name, OPC_FALSE)) == OPC_NIL || attr->type != OPC_KERNEL_VALUE_STR || size <= 0)
+		return (OPC_COMPCODE_FAILURE);
+
+	strncpy (value_ptr, attr->string, size - 1);
+	value_ptr[size - 1] = '\0';
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_kernel_ima_obj_attr_set (Objid objid, const char * attr_name, OpT_Kernel_Value value)
+{
+	if (op_kernel_attr_find (objid, attr_name, OPC_FALSE) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	if (value.type == OPC_KERNEL_VALUE_INT)
+		op_kernel_attr_set_int (objid, attr_name, (int) value.integer);
+	else if (value.type == OPC_KERNEL_VALUE_DBL)
+		op_kernel_attr_set_dbl (objid, attr_name, value.real);
+	else if (value.type == OPC_KERNEL_VALUE_STR)
+		op_kernel_attr_set_str (objid, attr_name, (const char *) value.pointer);
+	else
+		return (OPC_COMPCODE_FAILURE);
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ima_obj_attr_set_toggle (Objid objid, const char * attr_name, Boolean value)
+{
+	return (op_kernel_ima_obj_attr_set (objid, attr_name, op_kernel_value_int (value)));
+}
+
+Compcode op_ima_obj_attr_set_int32 (Objid objid, const char * attr_name, OpT_Int32 value)
+{
+	return (op_kernel_ima_obj_attr_set (objid, attr_name, op_kernel_value_int (value)));
+}
+
+Compcode op_ima_obj_attr_set_dbl (Objid objid, const char * attr_name, double value)
+{
+	return (op_kernel_ima_obj_attr_set (objid, attr_name, op_kernel_value_dbl (value)));
+}
+
+Compcode op_ima_obj_attr_set_str (Objid objid, const char * attr_name, const char * value)
+{
+	return (op_kernel_ima_obj_attr_set (objid, attr_name, op_kernel_value_str (value)));
+}
+
+
+/*
+ * Function:	op_ima_sim_attr_*
+ *
+ * Description:	simulation attributes, held by the top object
+ */
+
+Boolean op_ima_sim_attr_exists (const char * attr_name)
+{
+	return (op_ima_obj_attr_exists (0, attr_name));
+}
+
+Compcode op_ima_sim_attr_get (int attr_type, const char * attr_name, void * value_ptr)
+{
+	switch (attr_type)
+		{
+		case OPC_IMA_INTEGER:
+		case OPC_IMA_TOGGLE:
+			return (op_ima_obj_attr_get_int32 (0, attr_name, (OpT_Int32 *) value_ptr));
+
+		case OPC_IMA_DOUBLE:
+			return (op_ima_obj_attr_get_dbl (0, attr_name, (double *) value_ptr));
+
+		default:
+			return (op_ima_obj_attr_get (0, attr_name, value_ptr));
+		}
+}
+
+Compcode op_ima_sim_attr_get_str (const char * attr_name, int size, char * value_ptr)
+{
+	return (op_ima_obj_attr_get_str (0, attr_name, size, value_ptr));
+}
+
+
+/*
+ * Function:	op_id_self, op_pro_self, op_id_from_hierarchical_name, op_topo_*
+ *
+ * Description:	navigation in the topology
+ */
+
+Objid op_id_self (void)
+{
+	return ((op_kernel_current_module == OPC_NIL) ? OPC_OBJID_INVALID : op_kernel_current_module->objid);
+}
+
+Prohandle op_pro_self (void)
+{
+	Prohandle pro_handle;
+
+	pro_handle.objid = op_id_self ();
+
+	return (pro_handle);
+}
+
+Objid op_id_from_hierarchical_name (const char * hier_name)
+{
+	int i;
+
+	for (i = 1; i < op_kernel_nb_objects; i++)
+		{
+		if (op_kernel_objects[i]->objtype != OPC_OBJTYPE_COMP_ATTR && !strcmp (op_kernel_objects[i]->hier_name, hier_name))
+			return (i);
+		}
+
+	return (OPC_OBJID_INVALID);
+}
+
+Objid op_topo_parent (Objid objid)
+{
+	OpT_Kernel_Object * object;
+
+	if ((object = op_kernel_object (objid, "op_topo_parent")) == OPC_NIL)
+		return (OPC_OBJID_INVALID);
+
+	return (object->parent_objid);
+}
+
+Objid op_topo_child (Objid parent_objid, OpT_Obj_Type child_type, int child_index)
+{
+	OpT_Kernel_Object * parent;
+	int i;
+
+	if ((parent = op_kernel_object (parent_objid, "op_topo_child")) == OPC_NIL)
+		return (OPC_OBJID_INVALID);
+
+	for (i = 0; i < parent->nb_children; i++)
+		{
+		if (child_type == OPC_OBJTYPE_GENERIC || op_kernel_objects[parent->children[i]]->objtype == child_type)
+			{
+			if (child_index-- == 0)
+				return (parent->children[i]);
+			}
+		}
+
+	return (OPC_OBJID_INVALID);
+}
+
+int op_topo_child_count (Objid parent_objid, OpT_Obj_Type child_type)
+{
+	OpT_Kernel_Object * parent;
+	int count = 0;
+	int i;
+
+	if ((parent = op_kernel_object (parent_objid, "op_topo_child_count")) == OPC_NIL)
+		return (0);
+
+	for (i = 0; i < parent->nb_children; i++)
+		{
+		if (child_type == OPC_OBJTYPE_GENERIC || op_kernel_objects[parent->children[i]]->objtype == child_type)
+			count++;
+		}
+
+	return (count);
+}
+
+int op_topo_object_count (OpT_Obj_Type obj_type)
+{
+	int count = 0;
+	int i;
+
+	for (i = 1; i < op_kernel_nb_objects; i++)
+		{
+		if (op_kernel_objects[i]->objtype == obj_type)
+			count++;
+		}
+
+	return (count);
+}
+
+
+/*
+ * Function:	op_kernel_heap_push, op_kernel_heap_pop
+ *
+ * Description:	event list. The events are ordered by time, then by
+ *				decreasing priority, then by scheduling order.
+ */
+
+#define OP_KERNEL_EV_BEFORE(a, b)	\
+	((a)->time < (b)->time || ((a)->time == (b)->time &&	\
+	((a)->priority > (b)->priority || ((a)->priority == (b)->priority && (a)->seq < (b)->seq))))
+
+static void op_kernel_heap_push (struct OpT_Kernel_Event * event)
+{
+	int child;
+	int parent;
+
+	if (op_kernel_heap_size == op_kernel_heap_capacity)
+		{
+		op_kernel_heap_capacity = (op_kernel_heap_capacity == 0) ? 1024 : 2 * op_kernel_heap_capacity;
+		op_kernel_heap = (struct OpT_Kernel_Event **) realloc (op_kernel_heap, op_kernel_heap_capacity * sizeof (struct OpT_Kernel_Event *));
+		if (op_kernel_heap == OPC_NIL)
+			op_kernel_error ("op_kernel_heap_push", "Out of memory.", OPC_NIL);
+		}
+
+	for (child = op_kernel_heap_size++; child > 0; child = parent)
+		{
+		parent = (child - 1) / 2;
+		if (!OP_KERNEL_EV_BEFORE (event, op_kernel_heap[parent]))
+			break;
+		op_kernel_heap[child] = op_kernel_heap[parent];
+		}
+
+	op_kernel_heap[child] = event;
+}
+
+static struct OpT_Kernel_Event * op_kernel_heap_pop (void)
+{
+	struct OpT_Kernel_Event * top;
+	struct OpT_Kernel_Event * last;
+	int parent;
+	int child;
+
+	if (op_kernel_heap_size == 0)
+		return (OPC_NIL);
+
+	top = op_kernel_heap[0];
+	last = op_kernel_heap[--op_kernel_heap_size];
+
+	for (parent = 0; (child = 2 * parent + 1) < op_kernel_heap_size; parent = child)
+		{
+		if (child + 1 < op_kernel_heap_size && OP_KERNEL_EV_BEFORE (op_kernel_heap[child + 1], op_kernel_heap[child]))
+			child++;
+		if (!OP_KERNEL_EV_BEFORE (op_kernel_heap[child], last))
+			break;
+		op_kernel_heap[parent] = op_kernel_heap[child];
+		}
+
+	if (op_kernel_heap_size > 0)
+		op_kernel_heap[parent] = last;
+
+	return (top);
+}
+
+
+/*
+ * Function:	op_kernel_event_release
+ *
+ * Description:	give an executed or cancelled event back to the pool
+ */
+
+static void op_kernel_event_release (struct OpT_Kernel_Event * event)
+{
+	event->state = OPC_KERNEL_EV_FREE;
+	event->pkptr = OPC_NIL;
+	event->ici = OPC_NIL;
+	event->next_free = op_kernel_free_events;
+	op_kernel_free_events = event;
+}
+
+
+/*
+ * Function:	op_kernel_schedule
+ *
+ * Description:	schedule an interrupt for a module
+ *
+ * ParamIn:		double time
+ *				time of the interrupt
+ *
+ *				int type, code, strm
+ *				type, code and stream of the interrupt
+ *
+ *				Objid module_objid
+ *				module to interrupt
+ *
+ *				Packet * pkptr
+ *				packet arriving with a stream interrupt
+ *
+ * ParamOut:	Evhandle evhandle
+ *				handle of the event
+ */
+
+static Evhandle op_kernel_schedule (double time, int type, int code, int strm, Objid module_objid, Packet * pkptr)
+{
+	struct OpT_Kernel_Event * event;
+	OpT_Kernel_Object * module;
+	Evhandle evhandle = {OPC_NIL, -1};
+	char time_str[64];
+	int i;
+
+	if ((module = op_kernel_object (module_objid, "op_kernel_schedule")) == OPC_NIL)
+		return (evhandle);
+
+	if (module->model == OPC_NIL)
+		{
+		op_sim_end ("Standalone kernel error:", "Interrupt scheduled for a module without process.", module->hier_name, OPC_NIL);
+		return (evhandle);
+		}
+
+	if (time < op_kernel_time)
+		{
+		sprintf (time_str, "(%.12f s < %.12f s)", time, op_kernel_time);
+		op_sim_end ("Standalone kernel error:", "Interrupt scheduled in the past.", module->hier_name, time_str);
+		return (evhandle);
+		}
+
+	if ((event = op_kernel_free_events) != OPC_NIL)
+		op_kernel_free_events = event->next_free;
+	else if ((event = (struct OpT_Kernel_Event *) malloc (sizeof (struct OpT_Kernel_Event))) == OPC_NIL)
+		op_kernel_error ("op_kernel_schedule", "Out of memory.", OPC_NIL);
+
+	event->time = time;
+	event->priority = 0;
+	event->seq = op_kernel_seq++;
+	event->id = op_kernel_next_evid++;
+	event->type = type;
+	event->code = code;
+	event->strm = strm;
+	event->module_objid = module_objid;
+	event->source_objid = op_id_self ();
+	event->ici = (op_kernel_current_module == OPC_NIL) ? OPC_NIL : op_kernel_current_module->installed_ici;
+	event->pkptr = pkptr;
+	event->state = OPC_KERNEL_EV_PENDING;
+	event->next_free = OPC_NIL;
+
+	for (i = 0; i < module->nb_priorities; i++)
+		{
+		if (module->priorities[i].type == type && module->priorities[i].code == code)
+			{
+			event->priority = module->priorities[i].priority;
+			break;
+			}
+		}
+
+	op_kernel_heap_push (event);
+
+	evhandle.event = event;
+	evhandle.id = event->id;
+
+	return (evhandle);
+}
+
+
+/*
+ * Function:	op_intrpt_*
+ *
+ * Description:	interrupts of the processes
+ */
+
+Evhandle op_intrpt_schedule_self (double time, int code)
+{
+	return (op_kernel_schedule (time, OPC_INTRPT_SELF, code, -1, op_id_self (), OPC_NIL));
+}
+
+Evhandle op_intrpt_schedule_remote (double time, int code, Objid mod_objid)
+{
+	return (op_kernel_schedule (time, OPC_INTRPT_REMOTE, code, -1, mod_objid, OPC_NIL));
+}
+
+Compcode op_intrpt_priority_set (int type, int code, int priority)
+{
+	OpT_Kernel_Object * module;
+	int i;
+
+	if ((module = op_kernel_current_module) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	for (i = 0; i < module->nb_priorities; i++)
+		{
+		if (module->priorities[i].type == type && module->priorities[i].code == code)
+			{
+			module->priorities[i].priority = priority;
+			return (OPC_COMPCODE_SUCCESS);
+			}
+		}
+
+	module->priorities = (OpT_Kernel_Priority *) realloc (module->priorities, (module->nb_priorities + 1) * sizeof (OpT_Kernel_Priority));
+	if (module->priorities == OPC_NIL)
+		op_kernel_error ("op_intrpt_priority_set", "Out of memory.", OPC_NIL);
+
+	module->priorities[module->nb_priorities].type = type;
+	module->priorities[module->nb_priorities].code = code;
+	module->priorities[module->nb_priorities].priority = priority;
+	module->nb_priorities++;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+int op_intrpt_type (void)
+{
+	return ((op_kernel_current_event == OPC_NIL) ? OPC_INTRPT_BEGSIM : op_kernel_current_event->type);
+}
+
+int op_intrpt_code (void)
+{
+	return ((op_kernel_current_event == OPC_NIL) ? 0 : op_kernel_current_event->code);
+}
+
+int op_intrpt_strm (void)
+{
+	return ((op_kernel_current_event == OPC_NIL) ? -1 : op_kernel_current_event->strm);
+}
+
+Objid op_intrpt_source (void)
+{
+	return ((op_kernel_current_event == OPC_NIL) ? OPC_OBJID_INVALID : op_kernel_current_event->source_objid);
+}
+
+Ici * op_intrpt_ici (void)
+{
+	return ((op_kernel_current_event == OPC_NIL) ? OPC_NIL : op_kernel_current_event->ici);
+}
+
+
+/*
+ * Function:	op_ev_*
+ *
+ * Description:	handles on the scheduled events
+ */
+
+Boolean op_ev_valid (Evhandle evhandle)
+{
+	return (evhandle.event != OPC_NIL && evhandle.event->id == evhandle.id && evhandle.event->state == OPC_KERNEL_EV_PENDING);
+}
+
+Compcode op_ev_cancel (Evhandle evhandle)
+{
+	if (!op_ev_valid (evhandle))
+		return (OPC_COMPCODE_FAILURE);
+
+	/* the event stays in the list and is dropped when it comes out */
+	evhandle.event->state = OPC_KERNEL_EV_CANCELLED;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Evhandle op_ev_current (void)
+{
+	Evhandle evhandle = {OPC_NIL, -1};
+
+	if (op_kernel_current_event != OPC_NIL)
+		{
+		evhandle.event = op_kernel_current_event;
+		evhandle.id = op_kernel_current_event->id;
+		}
+
+	return (evhandle);
+}
+
+Evid op_ev_id (Evhandle evhandle)
+{
+	return (evhandle.id);
+}
+
+
+/*
+ * Function:	op_sim_time, op_sim_end, op_sim_message
+ *
+ * Description:	control of the simulation
+ */
+
+double op_sim_time (void)
+{
+	return (op_kernel_time);
+}
+
+void op_sim_end (const char * line0, const char * line1, const char * line2, const char * line3)
+{
+	const char * lines[4];
+	int i;
+
+	lines[0] = line0;
+	lines[1] = line1;
+	lines[2] = line2;
+	lines[3] = line3;
+
+	fprintf (stderr, "Simulation end at %.9f s", op_kernel_time);
+	if (op_kernel_current_module != OPC_NIL)
+		fprintf (stderr, " in %s", op_kernel_current_module->hier_name);
+	fprintf (stderr, ":\n");
+
+	for (i = 0; i < 4; i++)
+		{
+		if (lines[i] != OPC_NIL && lines[i][0] != '\0')
+			fprintf (stderr, "\t%s\n", lines[i]);
+		}
+
+	/* the simulation stops once the current event is processed */
+	op_kernel_end_requested = OPC_TRUE;
+}
+
+void op_sim_message (const char * line0, const char * line1)
+{
+	printf ("%s %s\n", (line0 == OPC_NIL) ? "" : line0, (line1 == OPC_NIL) ? "" : line1);
+}
+
+/* the simulation is in debug mode when line traces are enabled */
+Boolean op_sim_debug (void)
+{
+	return ((op_kernel_nb_ltraces > 0) ? OPC_TRUE : OPC_FALSE);
+}
+
+void op_kernel_fsm_no_transition (const char * state_name)
+{
+	/* the processes without end of simulation transition ignore the interrupt */
+	if (op_intrpt_type () == OPC_INTRPT_ENDSIM)
+		return;
+
+	op_sim_end ("Standalone kernel error:", "No transition condition is true in state", state_name, OPC_NIL);
+}
+
+
+/*
+ * Function:	op_kernel_field_find
+ *
+ * Description:	find a field of a packet or an attribute of an ICI
+ *
+ * ParamIn:		OpT_Kernel_Field ** fields_ptr, int * nb_ptr, int * capacity_ptr
+ *				table of the fields
+ *
+ *				const char * name
+ *				name of the field
+ *
+ *				Boolean create
+ *				create the field if it doesn't exist
+ *
+ * ParamOut:	OpT_Kernel_Field * field
+ *				field, OPC_NIL if it doesn't exist
+ */
+
+static OpT_Kernel_Field * op_kernel_field_find (OpT_Kernel_Field ** fields_ptr, int * nb_ptr, int * capacity_ptr, const char * name, Boolean create)
+{
+	OpT_Kernel_Field * field;
+	int i;
+
+	for (i = 0; i < *nb_ptr; i++)
+		{
+		if (!strcmp ((*fields_ptr)[i].name, name))
+			return (&(*fields_ptr)[i]);
+		}
+
+	if (!create)
+		return (OPC_NIL);
+
+	if (strlen (name) >= sizeof (field->name))
+		op_kernel_error ("op_kernel_field_find", "Field name too long.", name);
+
+	if (*nb_ptr == *capacity_ptr)
+		{
+		*capacity_ptr = (*capacity_ptr == 0) ? 4 : 2 * *capacity_ptr;
+		if ((*fields_ptr = (OpT_Kernel_Field *) realloc (*fields_ptr, *capacity_ptr * sizeof (OpT_Kernel_Field))) == OPC_NIL)
+			op_kernel_error ("op_kernel_field_find", "Out of memory.", OPC_NIL);
+		}
+
+	field = &(*fields_ptr)[(*nb_ptr)++];
+	memset (field, 0, sizeof (OpT_Kernel_Field));
+	strcpy (field->name, name);
+
+	return (field);
+}
+
+
+/*
+ * Function:	op_kernel_field_release
+ *
+ * Description:	destroy the value owned by a field and unset it
+ */
+
+static void op_kernel_field_release (OpT_Kernel_Field * field)
+{
+	if (field->type == OPC_KERNEL_VALUE_PKT && field->pointer != OPC_NIL)
+		op_pk_destroy ((Packet *) field->pointer);
+	else if (field->type == OPC_KERNEL_VALUE_PTR && field->pointer != OPC_NIL && field->free_proc != OPC_NIL)
+		field->free_proc (field->pointer);
+
+	field->type = 0;
+	field->pointer = OPC_NIL;
+	field->copy_proc = OPC_NIL;
+	field->free_proc = OPC_NIL;
+	field->size = 0;
+}
+
+
+/*
+ * Function:	op_kernel_field_read
+ *
+ * Description:	write the value of a field in the variable of the model,
+ *				according to the type the field was set with
+ */
+
+static Compcode op_kernel_field_read (OpT_Kernel_Field * field, void * value_ptr)
+{
+	if (field == OPC_NIL || field->type == 0)
+		return (OPC_COMPCODE_FAILURE);
+
+	switch (field->type)
+		{
+		case OPC_KERNEL_VALUE_INT:
+			*((int *) value_ptr) = field->integer;
+			break;
+
+		case OPC_KERNEL_VALUE_DBL:
+			*((double *) value_ptr) = field->real;
+			break;
+
+		default:
+			*((void **) value_ptr) = field->pointer;
+			break;
+		}
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+
+/*
+ * Function:	op_pk_*
+ *
+ * Description:	packets
+ */
+
+static OpT_Kernel_Format * op_kernel_format_find (const char * format_name, Boolean create)
+{
+	OpT_Kernel_Format * format;
+	int i;
+
+	for (i = 0; i < op_kernel_nb_formats; i++)
+		{
+		if (!strcmp (op_kernel_formats[i].format, format_name))
+			return (&op_kernel_formats[i]);
+		}
+
+	if (!create)
+		return (OPC_NIL);
+
+	if (strlen (format_name) >= sizeof (op_kernel_formats[0].format))
+		op_kernel_error ("op_kernel_format_find", "Format name too long.", format_name);
+
+	op_kernel_formats = (OpT_Kernel_Format *) realloc (op_kernel_formats, (op_kernel_nb_formats + 1) * sizeof (OpT_Kernel_Format));
+	if (op_kernel_formats == OPC_NIL)
+		op_kernel_error ("op_kernel_format_find", "Out of memory.", OPC_NIL);
+
+	format = &op_kernel_formats[op_kernel_nb_formats++];
+	memset (format, 0, sizeof (OpT_Kernel_Format));
+	strcpy (format->format, format_name);
+
+	return (format);
+}
+
+void op_kernel_pk_format_size_set (const char * format_name, OpT_Packet_Size size)
+{
+	op_kernel_format_find (format_name, OPC_TRUE)->size = size;
+}
+
+void op_kernel_pk_format_field_set (const char * format_name, const char * fd_name, int default_value)
+{
+	OpT_Kernel_Format * format;
+	OpT_Kernel_Field * field;
+
+	format = op_kernel_format_find (format_name, OPC_TRUE);
+	field = op_kernel_field_find (&format->fields, &format->nb_fields, &format->capacity, fd_name, OPC_TRUE);
+	field->type = OPC_KERNEL_VALUE_INT;
+	field->integer = default_value;
+}
+
+Packet * op_pk_create (OpT_Packet_Size bulk_size)
+{
+	Packet * pkptr;
+
+	pkptr = (Packet *) op_kernel_alloc (sizeof (Packet), OPC_KERNEL_MEM_PACKET);
+	strcpy (pkptr->format, "NONE");
+	pkptr->id = op_kernel_next_pk_id++;
+	pkptr->size = bulk_size;
+	pkptr->stamp_time = op_kernel_time;
+	pkptr->stamp_mod = op_id_self ();
+
+	return (pkptr);
+}
+
+Packet * op_pk_create_fmt (const char * format_name)
+{
+	OpT_Kernel_Format * format;
+	Packet * pkptr;
+
+	pkptr = op_pk_create (0.0);
+	strncpy (pkptr->format, format_name, sizeof (pkptr->format) - 1);
+
+	/* the integer fields with a default value are set at the creation */
+	if ((format = op_kernel_format_find (format_name, OPC_FALSE)) != OPC_NIL)
+		{
+		pkptr->size = format->size;
+
+		if (format->nb_fields > 0)
+			{
+			if ((pkptr->fields = (OpT_Kernel_Field *) malloc (format->nb_fields * sizeof (OpT_Kernel_Field))) == OPC_NIL)
+				op_kernel_error ("op_pk_create_fmt", "Out of memory.", OPC_NIL);
+			memcpy (pkptr->fields, format->fields, format->nb_fields * sizeof (OpT_Kernel_Field));
+			pkptr->nb_fields = format->nb_fields;
+			pkptr->capacity = format->nb_fields;
+			}
+		}
+
+	return (pkptr);
+}
+
+Packet * op_pk_copy (Packet * pkptr)
+{
+	Packet * copy;
+	OpT_Kernel_Field * field;
+	int i;
+
+	if (pkptr == OPC_NIL)
+		return (OPC_NIL);
+
+	copy = (Packet *) op_kernel_alloc (sizeof (Packet), OPC_KERNEL_MEM_PACKET);
+	*copy = *pkptr;
+	copy->id = op_kernel_next_pk_id++;
+	copy->fields = OPC_NIL;
+	copy->capacity = pkptr->nb_fields;
+
+	if (pkptr->nb_fields > 0)
+		{
+		if ((copy->fields = (OpT_Kernel_Field *) malloc (pkptr->nb_fields * sizeof (OpT_Kernel_Field))) == OPC_NIL)
+			op_kernel_error ("op_pk_copy", "Out of memory.", OPC_NIL);
+		memcpy (copy->fields, pkptr->fields, pkptr->nb_fields * sizeof (OpT_Kernel_Field));
+		}
+
+	/* the copy owns its own structures and encapsulated packets */
+	for (i = 0; i < copy->nb_fields; i++)
+		{
+		field = &copy->fields[i];
+
+		if (field->type == OPC_KERNEL_VALUE_PKT && field->pointer != OPC_NIL)
+			field->pointer = op_pk_copy ((Packet *) field->pointer);
+		else if (field->type == OPC_KERNEL_VALUE_PTR && field->pointer != OPC_NIL && field->copy_proc != OPC_NIL)
+			field->pointer = field->copy_proc (field->pointer, field->size);
+		}
+
+	return (copy);
+}
+
+void op_pk_destroy (Packet * pkptr)
+{
+	int i;
+
+	if (pkptr == OPC_NIL)
+		return;
+
+	for (i = 0; i < pkptr->nb_fields; i++)
+		op_kernel_field_release (&pkptr->fields[i]);
+
+	free (pkptr->fields);
+	op_kernel_dealloc (pkptr, OPC_KERNEL_MEM_PACKET);
+}
+
+void op_pk_send (Packet * pkptr, int outstrm_index)
+{
+	OpT_Kernel_Object * module;
+
+	module = op_kernel_current_module;
+
+	if (module == OPC_NIL || outstrm_index < 0 || outstrm_index >= module->nb_outstrms ||
+		module->outstrms[outstrm_index].dest_objid == OPC_OBJID_INVALID)
+		{
+		/* packets sent on an unconnected stream are lost */
+		op_pk_destroy (pkptr);
+		return;
+		}
+
+	op_kernel_schedule (op_kernel_time, OPC_INTRPT_STRM, 0, module->outstrms[outstrm_index].instrm_index,
+		module->outstrms[outstrm_index].dest_objid, pkptr);
+}
+
+void op_pk_deliver (Packet * pkptr, Objid mod_objid, int instrm_index)
+{
+	op_kernel_schedule (op_kernel_time, OPC_INTRPT_STRM, 0, instrm_index, mod_objid, pkptr);
+}
+
+Packet * op_pk_get (int instrm_index)
+{
+	OpT_Kernel_Object * module;
+
+	module = op_kernel_current_module;
+
+	if (module == OPC_NIL || instrm_index < 0 || instrm_index >= module->nb_instrms ||
+		op_prg_list_size (module->instrms[instrm_index]) == 0)
+		return (OPC_NIL);
+
+	return ((Packet *) op_prg_list_remove (module->instrms[instrm_index], OPC_LISTPOS_HEAD));
+}
+
+OpT_Packet_Id op_pk_id (Packet * pkptr)
+{
+	return (pkptr->id);
+}
+
+Compcode op_pk_format (Packet * pkptr, char * format_name)
+{
+	strcpy (format_name, pkptr->format);
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+OpT_Packet_Size op_pk_total_size_get (Packet * pkptr)
+{
+	return (pkptr->size);
+}
+
+void op_pk_total_size_set (Packet * pkptr, OpT_Packet_Size size)
+{
+	pkptr->size = size;
+}
+
+void op_pk_stamp (Packet * pkptr)
+{
+	pkptr->stamp_time = op_kernel_time;
+	pkptr->stamp_mod = op_id_self ();
+}
+
+double op_pk_stamp_time_get (Packet * pkptr)
+{
+	return (pkptr->stamp_time);
+}
+
+Objid op_pk_stamp_mod_get (Packet * pkptr)
+{
+	return (pkptr->stamp_mod);
+}
+
+void op_pk_ici_set (Packet * pkptr, Ici * iciptr)
+{
+	pkptr->ici = iciptr;
+}
+
+Ici * op_pk_ici_get (Packet * pkptr)
+{
+	return (pkptr->ici);
+}
+
+
+/*
+ * Function:	op_pk_nfd_*
+ *
+ * Description:	fields of the packets. The structure and packet fields
+ *				belong to the packet until they are read with a "get"
+ *				function, which hands them over to the caller.
+ */
+
+Compcode op_kernel_pk_nfd_set (Packet * pkptr, const char * fd_name, OpT_Kernel_Value value,
+	OpT_Kernel_Copy_Proc copy_proc, OpT_Kernel_Free_Proc free_proc, size_t size)
+{
+	OpT_Kernel_Field * field;
+
+	if (pkptr == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	field = op_kernel_field_find (&pkptr->fields, &pkptr->nb_fields, &pkptr->capacity, fd_name, OPC_TRUE);
+	op_kernel_field_release (field);
+
+	field->type = (value.type == OPC_KERNEL_VALUE_STR) ? OPC_KERNEL_VALUE_PTR : value.type;
+	field->integer = (int) value.integer;
+	field->real = value.real;
+	field->pointer = (void *) value.pointer;
+	field->copy_proc = copy_proc;
+	field->free_proc = free_proc;
+	field->size = size;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_pk_nfd_set_int32 (Packet * pkptr, const char * fd_name, OpT_Int32 value)
+{
+	return (op_kernel_pk_nfd_set (pkptr, fd_name, op_kernel_value_int (value), OPC_NIL, OPC_NIL, 0));
+}
+
+Compcode op_pk_nfd_set_dbl (Packet * pkptr, const char * fd_name, double value)
+{
+	return (op_kernel_pk_nfd_set (pkptr, fd_name, op_kernel_value_dbl (value), OPC_NIL, OPC_NIL, 0));
+}
+
+Compcode op_pk_nfd_set_ptr (Packet * pkptr, const char * fd_name, void * value,
+	OpT_Kernel_Copy_Proc copy_proc, OpT_Kernel_Free_Proc free_proc, size_t size)
+{
+	return (op_kernel_pk_nfd_set (pkptr, fd_name, op_kernel_value_ptr (value), copy_proc, free_proc, size));
+}
+
+Compcode op_pk_nfd_set_pkt (Packet * pkptr, const char * fd_name, Packet * value)
+{
+	OpT_Kernel_Value kernel_value;
+
+	kernel_value = op_kernel_value_ptr (value);
+	kernel_value.type = OPC_KERNEL_VALUE_PKT;
+
+	return (op_kernel_pk_nfd_set (pkptr, fd_name, kernel_value, OPC_NIL, OPC_NIL, 0));
+}
+
+Compcode op_pk_nfd_get (Packet * pkptr, const char * fd_name, void * value_ptr)
+{
+	OpT_Kernel_Field * field;
+
+	if (pkptr == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	field = op_kernel_field_find (&pkptr->fields, &pkptr->nb_fields, &pkptr->capacity, fd_name, OPC_FALSE);
+
+	if (op_kernel_field_read (field, value_ptr) == OPC_COMPCODE_FAILURE)
+		return (OPC_COMPCODE_FAILURE);
+
+	/* hand the structure or the packet over to the caller */
+	if (field->type == OPC_KERNEL_VALUE_PTR || field->type == OPC_KERNEL_VALUE_PKT)
+		{
+		field->type = 0;
+		field->pointer = OPC_NIL;
+		}
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_pk_nfd_access (Packet * pkptr, const char * fd_name, void * value_ptr)
+{
+	if (pkptr == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	return (op_kernel_field_read (op_kernel_field_find (&pkptr->fields, &pkptr->nb_fields, &pkptr->capacity, fd_name, OPC_FALSE), value_ptr));
+}
+
+Compcode op_pk_nfd_get_int32 (Packet * pkptr, const char * fd_name, OpT_Int32 * value_ptr)
+{
+	OpT_Kernel_Field * field;
+
+	if (pkptr == OPC_NIL ||
+		(field = op_kernel_field_find (&pkptr->fields, &pkptr->nb_fields, &pkptr->capacity, fd_name, OPC_FALSE)) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	if (field->type == OPC_KERNEL_VALUE_INT)
+		*value_ptr = field->integer;
+	else if (field->type == OPC_KERNEL_VALUE_DBL)
+		*value_ptr = (OpT_Int32) field->real;
+	else
+		return (OPC_COMPCODE_FAILURE);
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_pk_nfd_get_dbl (Packet * pkptr, const char * fd_name, double * value_ptr)
+{
+	OpT_Kernel_Field * field;
+
+	if (pkptr == OPC_NIL ||
+		(field = op_kernel_field_find (&pkptr->fields, &pkptr->nb_fields, &pkptr->capacity, fd_name, OPC_FALSE)) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	if (field->type == OPC_KERNEL_VALUE_DBL)
+		*value_ptr = field->real;
+	else if (field->type == OPC_KERNEL_VALUE_INT)
+		*value_ptr = (double) field->integer;
+	else
+		return (OPC_COMPCODE_FAILURE);
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_pk_nfd_get_ptr (Packet * pkptr, const char * fd_name, void * value_ptr)
+{
+	return (op_pk_nfd_get (pkptr, fd_name, value_ptr));
+}
+
+Compcode op_pk_nfd_get_pkt (Packet * pkptr, const char * fd_name, Packet ** value_ptr)
+{
+	return (op_pk_nfd_get (pkptr, fd_name, value_ptr));
+}
+
+
+/*
+ * Function:	op_ici_*
+ *
+ * Description:	interface control information
+ */
+
+Ici * op_ici_create (const char * fmt_name)
+{
+	Ici * iciptr;
+
+	iciptr = (Ici *) op_kernel_alloc (sizeof (Ici), OPC_KERNEL_MEM_ICI);
+	strncpy (iciptr->format, fmt_name, sizeof (iciptr->format) - 1);
+
+	return (iciptr);
+}
+
+void op_ici_destroy (Ici * iciptr)
+{
+	int i;
+
+	if (iciptr == OPC_NIL)
+		return;
+
+	for (i = 0; i < op_kernel_nb_objects; i++)
+		{
+		if (op_kernel_objects[i]->installed_ici == iciptr)
+			op_kernel_objects[i]->installed_ici = OPC_NIL;
+		}
+
+	free (iciptr->fields);
+	op_kernel_dealloc (iciptr, OPC_KERNEL_MEM_ICI);
+}
+
+void op_ici_install (Ici * iciptr)
+{
+	if (op_kernel_current_module != OPC_NIL)
+		op_kernel_current_module->installed_ici = iciptr;
+}
+
+Compcode op_kernel_ici_attr_set (Ici * iciptr, const char * attr_name, OpT_Kernel_Value value)
+{
+	OpT_Kernel_Field * field;
+
+	if (iciptr == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	field = op_kernel_field_find (&iciptr->fields, &iciptr->nb_fields, &iciptr->capacity, attr_name, OPC_TRUE);
+
+	field->type = (value.type == OPC_KERNEL_VALUE_STR) ? OPC_KERNEL_VALUE_PTR : value.type;
+	field->integer = (int) value.integer;
+	field->real = value.real;
+	field->pointer = (void *) value.pointer;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ici_attr_get (Ici * iciptr, const char * attr_name, void * value_ptr)
+{
+	if (iciptr == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	return (op_kernel_field_read (op_kernel_field_find (&iciptr->fields, &iciptr->nb_fields, &iciptr->capacity, attr_name, OPC_FALSE), value_ptr));
+}
+
+Compcode op_ici_attr_set_int32 (Ici * iciptr, const char * attr_name, OpT_Int32 value)
+{
+	return (op_kernel_ici_attr_set (iciptr, attr_name, op_kernel_value_int (value)));
+}
+
+Compcode op_ici_attr_set_dbl (Ici * iciptr, const char * attr_name, double value)
+{
+	return (op_kernel_ici_attr_set (iciptr, attr_name, op_kernel_value_dbl (value)));
+}
+
+Compcode op_ici_attr_set_ptr (Ici * iciptr, const char * attr_name, void * value)
+{
+	return (op_kernel_ici_attr_set (iciptr, attr_name, op_kernel_value_ptr (value)));
+}
+
+Compcode op_ici_attr_get_int32 (Ici * iciptr, const char * attr_name, OpT_Int32 * value_ptr)
+{
+	OpT_Kernel_Field * field;
+
+	if (iciptr == OPC_NIL ||
+		(field = op_kernel_field_find (&iciptr->fields, &iciptr->nb_fields, &iciptr->capacity, attr_name, OPC_FALSE)) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	if (field->type == OPC_KERNEL_VALUE_INT)
+		*value_ptr = field->integer;
+	else if (field->type == OPC_KERNEL_VALUE_DBL)
+		*value_ptr = (OpT_Int32) field->real;
+	else
+		return (OPC_COMPCODE_FAILURE);
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ici_attr_get_dbl (Ici * iciptr, const char * attr_name, double * value_ptr)
+{
+	OpT_Kernel_Field * field;
+
+	if (iciptr == OPC_NIL ||
+		(field = op_kernel_field_find (&iciptr->fields, &iciptr->nb_fields, &iciptr->capacity, attr_name, OPC_FALSE)) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	if (field->type == OPC_KERNEL_VALUE_DBL)
+		*value_ptr = field->real;
+	else if (field->type == OPC_KERNEL_VALUE_INT)
+		*value_ptr = (double) field->integer;
+	else
+		return (OPC_COMPCODE_FAILURE);
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_ici_attr_get_ptr (Ici * iciptr, const char * attr_name, void * value_ptr)
+{
+	return (op_ici_attr_get (iciptr, attr_name, value_ptr));
+}
+
+Boolean op_ici_attr_exists (Ici * iciptr, const char * attr_name)
+{
+	if (iciptr == OPC_NIL)
+		return (OPC_FALSE);
+
+	return (op_kernel_field_find (&iciptr->fields, &iciptr->nb_fields, &iciptr->capacity, attr_name, OPC_FALSE) != OPC_NIL);
+}
+
+
+/*
+ * Function:	op_prg_list_*
+ *
+ * Description:	lists of pointers
+ */
+
+List * op_prg_list_create (void)
+{
+	return ((List *) op_kernel_alloc (sizeof (List), OPC_KERNEL_MEM_LIST));
+}
+
+int op_prg_list_size (List * list_ptr)
+{
+	return ((list_ptr == OPC_NIL) ? 0 : list_ptr->size);
+}
+
+void * op_prg_list_access (List * list_ptr, int index)
+{
+	if (list_ptr == OPC_NIL || list_ptr->size == 0)
+		return (OPC_NIL);
+
+	if (index == OPC_LISTPOS_TAIL)
+		index = list_ptr->size - 1;
+
+	if (index < 0 || index >= list_ptr->size)
+		return (OPC_NIL);
+
+	return (list_ptr->elems[(list_ptr->head + index) % list_ptr->capacity]);
+}
+
+void op_prg_list_insert (List * list_ptr, void * elem_ptr, int index)
+{
+	void ** elems;
+	int i;
+
+	if (list_ptr == OPC_NIL)
+		return;
+
+	if (index == OPC_LISTPOS_TAIL || index > list_ptr->size)
+		index = list_ptr->size;
+
+	if (index < 0)
+		index = 0;
+
+	/* grow the ring buffer, unrolling it */
+	if (list_ptr->size == list_ptr->capacity)
+		{
+		if ((elems = (void **) malloc (((list_ptr->capacity == 0) ? 8 : 2 * list_ptr->capacity) * sizeof (void *))) == OPC_NIL)
+			op_kernel_error ("op_prg_list_insert", "Out of memory.", OPC_NIL);
+
+		for (i = 0; i < list_ptr->size; i++)
+			elems[i] = list_ptr->elems[(list_ptr->head + i) % list_ptr->capacity];
+
+		free (list_ptr->elems);
+		list_ptr->elems = elems;
+		list_ptr->head = 0;
+		list_ptr->capacity = (list_ptr->capacity == 0) ? 8 : 2 * list_ptr->capacity;
+		}
+
+	if (index == 0)
+		{
+		list_ptr->head = (list_ptr->head + list_ptr->capacity - 1) % list_ptr->capacity;
+		}
+	else
+		{
+		for (i = list_ptr->size; i > index; i--)
+			list_ptr->elems[(list_ptr->head + i) % list_ptr->capacity] = list_ptr->elems[(list_ptr->head + i - 1) % list_ptr->capacity];
+		}
+
+	list_ptr->elems[(list_ptr->head + index) % list_ptr->capacity] = elem_ptr;
+	list_ptr->size++;
+}
+
+void * op_prg_list_remove (List * list_ptr, int index)
+{
+	void * elem_ptr;
+	int i;
+
+	if (list_ptr == OPC_NIL || list_ptr->size == 0)
+		return (OPC_NIL);
+
+	if (index == OPC_LISTPOS_TAIL)
+		index = list_ptr->size - 1;
+
+	if (index < 0 || index >= list_ptr->size)
+		return (OPC_NIL);
+
+	elem_ptr = list_ptr->elems[(list_ptr->head + index) % list_ptr->capacity];
+
+	if (index == 0)
+		{
+		list_ptr->head = (list_ptr->head + 1) % list_ptr->capacity;
+		}
+	else
+		{
+		for (i = index; i < list_ptr->size - 1; i++)
+			list_ptr->elems[(list_ptr->head + i) % list_ptr->capacity] = list_ptr->elems[(list_ptr->head + i + 1) % list_ptr->capacity];
+		}
+
+	list_ptr->size--;
+
+	return (elem_ptr);
+}
+
+void op_prg_list_free (List * list_ptr)
+{
+	/* deallocate the elements, the list itself is kept */
+	while (op_prg_list_size (list_ptr) > 0)
+		op_prg_mem_free (op_prg_list_remove (list_ptr, OPC_LISTPOS_HEAD));
+}
+
+void op_prg_list_elems_copy (List * src_list_ptr, List * dest_list_ptr)
+{
+	int i;
+
+	for (i = 0; i < op_prg_list_size (src_list_ptr); i++)
+		op_prg_list_insert (dest_list_ptr, op_prg_list_access (src_list_ptr, i), OPC_LISTPOS_TAIL);
+}
+
+
+/*
+ * Function:	op_prg_odb_*
+ *
+ * Description:	debugger hooks: the line traces are enabled by the driver
+ */
+
+void op_kernel_ltrace_enable (const char * label)
+{
+	op_kernel_ltraces = (char **) realloc (op_kernel_ltraces, (op_kernel_nb_ltraces + 1) * sizeof (char *));
+	if (op_kernel_ltraces == OPC_NIL)
+		op_kernel_error ("op_kernel_ltrace_enable", "Out of memory.", OPC_NIL);
+
+	op_kernel_ltraces[op_kernel_nb_ltraces++] = op_kernel_strdup (label);
+}
+
+Boolean op_prg_odb_ltrace_active (const char * label)
+{
+	int i;
+
+	for (i = 0; i < op_kernel_nb_ltraces; i++)
+		{
+		if (!strcmp (op_kernel_ltraces[i], label))
+			return (OPC_TRUE);
+		}
+
+	return (OPC_FALSE);
+}
+
+void op_prg_odb_bkpt (const char * label)
+{
+	(void) label;
+}
+
+void op_kernel_odb_print_major (const char * lines[])
+{
+	int i;
+
+	for (i = 0; lines[i] != OPC_NIL; i++)
+		fprintf (stderr, "%s%s\n", (i == 0) ? "" : "\t", lines[i]);
+}
+
+
+/*
+ * Function:	op_stat_reg, op_stat_write, op_kernel_stat_dump
+ *
+ * Description:	statistics, summarized by their number of values, sum,
+ *				minimum, maximum and last value
+ */
+
+Stathandle op_stat_reg (const char * stat_name, int stat_index, int stat_type)
+{
+	Objid module_objid;
+	int i;
+
+	(void) stat_index;
+	module_objid = (stat_type == OPC_STAT_GLOBAL) ? OPC_OBJID_INVALID : op_id_self ();
+
+	for (i = 0; i < op_kernel_nb_stats; i++)
+		{
+		if (op_kernel_stats[i].module_objid == module_objid && !strcmp (op_kernel_stats[i].name, stat_name))
+			return (i);
+		}
+
+	if (op_kernel_nb_stats == op_kernel_stats_capacity)
+		{
+		op_kernel_stats_capacity = (op_kernel_stats_capacity == 0) ? 64 : 2 * op_kernel_stats_capacity;
+		op_kernel_stats = (OpT_Kernel_Stat *) realloc (op_kernel_stats, op_kernel_stats_capacity * sizeof (OpT_Kernel_Stat));
+		if (op_kernel_stats == OPC_NIL)
+			op_kernel_error ("op_stat_reg", "Out of memory.", OPC_NIL);
+		}
+
+	memset (&op_kernel_stats[op_kernel_nb_stats], 0, sizeof (OpT_Kernel_Stat));
+	op_kernel_stats[op_kernel_nb_stats].name = op_kernel_strdup (stat_name);
+	op_kernel_stats[op_kernel_nb_stats].module_objid = module_objid;
+
+	return (op_kernel_nb_stats++);
+}
+
+void op_stat_write (Stathandle stat_handle, double value)
+{
+	OpT_Kernel_Stat * stat;
+
+	if (stat_handle < 0 || stat_handle >= op_kernel_nb_stats)
+		return;
+
+	stat = &op_kernel_stats[stat_handle];
+
+	if (stat->count == 0 || value < stat->min)
+		stat->min = value;
+	if (stat->count == 0 || value > stat->max)
+		stat->max = value;
+
+	stat->count++;
+	stat->sum += value;
+	stat->last = value;
+}
+
+void op_kernel_stat_dump (FILE * stream)
+{
+	OpT_Kernel_Stat * stat;
+	int i;
+
+	fprintf (stream, "module\tstatistic\tcount\tsum\tmean\tmin\tmax\tlast\n");
+
+	for (i = 0; i < op_kernel_nb_stats; i++)
+		{
+		stat = &op_kernel_stats[i];
+
+		if (stat->count == 0)
+			continue;
+
+		fprintf (stream, "%s\t%s\t%llu\t%.12g\t%.12g\t%.12g\t%.12g\t%.12g\n",
+			(stat->module_objid == OPC_OBJID_INVALID) ? "global" : op_kernel_objects[stat->module_objid]->hier_name,
+			stat->name, stat->count, stat->sum, stat->sum / (double) stat->count, stat->min, stat->max, stat->last);
+		}
+}
+
+
+/*
+ * Function:	op_kernel_seed_set, op_kernel_uniform
+ *
+ * Description:	random number generator (xoshiro256**, seeded with splitmix64)
+ */
+
+void op_kernel_seed_set (OpT_uInt64 seed)
+{
+	OpT_uInt64 z;
+	int i;
+
+	for (i = 0; i < 4; i++)
+		{
+		seed += 0x9e3779b97f4a7c15ULL;
+		z = seed;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		op_kernel_rng_state[i] = z ^ (z >> 31);
+		}
+
+	op_kernel_rng_seeded = OPC_TRUE;
+}
+
+#define OP_KERNEL_ROTL(x, k)	(((x) << (k)) | ((x) >> (64 - (k))))
+
+static double op_kernel_uniform (void)
+{
+	OpT_uInt64 * s = op_kernel_rng_state;
+	OpT_uInt64 result;
+	OpT_uInt64 t;
+
+	if (!op_kernel_rng_seeded)
+		op_kernel_seed_set (128);
+
+	result = OP_KERNEL_ROTL (s[1] * 5, 7) * 9;
+	t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = OP_KERNEL_ROTL (s[3], 45);
+
+	/* 53 random bits in [0, 1) */
+	return ((double) (result >> 11) * (1.0 / 9007199254740992.0));
+}
+
+
+/*
+ * Function:	op_dist_*, oms_dist_*
+ *
+ * Description:	random distributions
+ */
+
+double op_dist_uniform (double limit)
+{
+	return (limit * op_kernel_uniform ());
+}
+
+double op_dist_exponential (double mean)
+{
+	return (-mean * log (1.0 - op_kernel_uniform ()));
+}
+
+Distribution * op_dist_load (const char * dist_name, double arg0, double arg1)
+{
+	Distribution * dist_ptr;
+
+	dist_ptr = (Distribution *) op_prg_mem_alloc (sizeof (Distribution));
+	dist_ptr->arg0 = arg0;
+	dist_ptr->arg1 = arg1;
+
+	if (!strcmp (dist_name, "constant"))
+		dist_ptr->type = OPC_KERNEL_DIST_CONSTANT;
+	else if (!strcmp (dist_name, "uniform"))
+		dist_ptr->type = OPC_KERNEL_DIST_UNIFORM;
+	else if (!strcmp (dist_name, "uniform_int"))
+		dist_ptr->type = OPC_KERNEL_DIST_UNIFORM_INT;
+	else if (!strcmp (dist_name, "exponential"))
+		dist_ptr->type = OPC_KERNEL_DIST_EXPONENTIAL;
+	else
+		{
+		op_prg_mem_free (dist_ptr);
+		op_sim_end ("Standalone kernel error:", "Unknown distribution", dist_name, OPC_NIL);
+		return (OPC_NIL);
+		}
+
+	return (dist_ptr);
+}
+
+double op_dist_outcome (Distribution * dist_ptr)
+{
+	if (dist_ptr == OPC_NIL)
+		return (0.0);
+
+	switch (dist_ptr->type)
+		{
+		case OPC_KERNEL_DIST_UNIFORM:
+			return (dist_ptr->arg0 + (dist_ptr->arg1 - dist_ptr->arg0) * op_kernel_uniform ());
+
+		case OPC_KERNEL_DIST_UNIFORM_INT:
+			return (floor (dist_ptr->arg0 + (dist_ptr->arg1 - dist_ptr->arg0 + 1.0) * op_kernel_uniform ()));
+
+		case OPC_KERNEL_DIST_EXPONENTIAL:
+			return (op_dist_exponential (dist_ptr->arg0));
+
+		default:
+			return (dist_ptr->arg0);
+		}
+}
+
+OmsT_Dist_Handle oms_dist_load_from_string (const char * dist_string)
+{
+	char dist_name[64];
+	double args[2] = {0.0, 0.0};
+	const char * ptr;
+	char * end_ptr;
+	int length;
+	int i;
+
+	/* "name (arg0[, arg1])" */
+	for (ptr = dist_string; isspace ((unsigned char) *ptr); ptr++);
+
+	for (length = 0; ptr[length] != '\0' && ptr[length] != '(' && !isspace ((unsigned char) ptr[length]); length++);
+
+	if (length == 0 || length >= (int) sizeof (dist_name))
+		{
+		op_sim_end ("Standalone kernel error:", "Invalid distribution", dist_string, OPC_NIL);
+		return (OPC_NIL);
+		}
+
+	memcpy (dist_name, ptr, length);
+	dist_name[length] = '\0';
+
+	if ((ptr = strchr (ptr + length, '(')) != OPC_NIL)
+		{
+		ptr++;
+		for (i = 0; i < 2; i++)
+			{
+			args[i] = strtod (ptr, &end_ptr);
+			if (end_ptr == ptr)
+				break;
+			for (ptr = end_ptr; isspace ((unsigned char) *ptr) || *ptr == ','; ptr++);
+			}
+		}
+
+	return (op_dist_load (dist_name, args[0], args[1]));
+}
+
+double oms_dist_outcome (OmsT_Dist_Handle dist_handle)
+{
+	return (op_dist_outcome (dist_handle));
+}
+
+
+/*
+ * Function:	oms_pr_process_register, oms_aa_*
+ *
+ * Description:	process registry and automatic addressing
+ */
+
+OmsT_Pr_Handle oms_pr_process_register (Objid node_objid, Objid module_objid, Prohandle pro_handle, const char * proc_model_name)
+{
+	OmsT_Pr_Handle pr_handle;
+
+	(void) pro_handle;
+	pr_handle = (OmsT_Pr_Handle) op_prg_mem_alloc (sizeof (struct OpT_Kernel_Pr_Record));
+	pr_handle->node_objid = node_objid;
+	pr_handle->module_objid = module_objid;
+	strncpy (pr_handle->proc_model_name, proc_model_name, sizeof (pr_handle->proc_model_name) - 1);
+
+	return (pr_handle);
+}
+
+OmsT_Aa_Address_Handle oms_aa_address_handle_get (const char * pool_name, const char * attr_name)
+{
+	static struct OpT_Kernel_Aa_Pool pool = {1};
+
+	(void) pool_name;
+	(void) attr_name;
+
+	return (&pool);
+}
+
+Compcode oms_aa_address_resolve (OmsT_Aa_Address_Handle aa_handle, Objid module_objid, int * address_ptr)
+{
+	(void) module_objid;
+
+	if (*address_ptr == OMSC_AA_AUTO_ASSIGN)
+		*address_ptr = aa_handle->next_address++;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+
+/*
+ * Function:	op_kernel_modulation_register, op_kernel_modulation_load
+ *
+ * Description:	register the bit error rate curve of a modulation,
+ *				given by a procedure or by a text file of
+ *				"Eb/N0 (dB)  BER" lines, sorted by Eb/N0
+ */
+
+Compcode op_kernel_modulation_register (const char * modulation_name, OpT_Kernel_Ber_Proc ber_proc)
+{
+	struct OpT_Kernel_Modulation * modulation;
+
+	if ((modulation = (struct OpT_Kernel_Modulation *) calloc (1, sizeof (struct OpT_Kernel_Modulation))) == OPC_NIL)
+		op_kernel_error ("op_kernel_modulation_register", "Out of memory.", OPC_NIL);
+
+	modulation->name = op_kernel_strdup (modulation_name);
+	modulation->ber_proc = ber_proc;
+	modulation->next = op_kernel_modulations;
+	op_kernel_modulations = modulation;
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+Compcode op_kernel_modulation_load (const char * modulation_name, const char * path)
+{
+	struct OpT_Kernel_Modulation * modulation;
+	char line[256];
+	double snr;
+	double ber;
+	FILE * fp;
+	int capacity = 0;
+
+	if ((fp = fopen (path, "r")) == OPC_NIL)
+		return (OPC_COMPCODE_FAILURE);
+
+	op_kernel_modulation_register (modulation_name, OPC_NIL);
+	modulation = op_kernel_modulations;
+
+	while (fgets (line, sizeof (line), fp) != OPC_NIL)
+		{
+		if (line[0] == '#' || sscanf (line, "%lf %lf", &snr, &ber) != 2)
+			continue;
+
+		if (modulation->nb_points == capacity)
+			{
+			capacity = (capacity == 0) ? 64 : 2 * capacity;
+			modulation->snr = (double *) realloc (modulation->snr, capacity * sizeof (double));
+			modulation->ber = (double *) realloc (modulation->ber, capacity * sizeof (double));
+			if (modulation->snr == OPC_NIL || modulation->ber == OPC_NIL)
+				op_kernel_error ("op_kernel_modulation_load", "Out of memory.", OPC_NIL);
+			}
+
+		modulation->snr[modulation->nb_points] = snr;
+		modulation->ber[modulation->nb_points] = ber;
+		modulation->nb_points++;
+		}
+
+	fclose (fp);
+
+	return ((modulation->nb_points > 0) ? OPC_COMPCODE_SUCCESS : OPC_COMPCODE_FAILURE);
+}
+
+
+/*
+ * Function:	op_tbl_modulation_get, op_tbl_mod_ber
+ *
+ * Description:	bit error rate of the registered modulations. The
+ *				tables are interpolated linearly on log10 (BER).
+ */
+
+Modulation_Handle op_tbl_modulation_get (const char * modulation_name)
+{
+	struct OpT_Kernel_Modulation * modulation;
+
+	for (modulation = op_kernel_modulations; modulation != OPC_NIL; modulation = modulation->next)
+		{
+		if (!strcmp (modulation->name, modulation_name))
+			return (modulation);
+		}
+
+	op_sim_end ("Standalone kernel error:", "Modulation curve not registered:", modulation_name, OPC_NIL);
+
+	return (OPC_NIL);
+}
+
+double op_tbl_mod_ber (Modulation_Handle modulation, double eff_snr)
+{
+	double ratio;
+	double low;
+	double high;
+	int lo;
+	int hi;
+	int mid;
+
+	if (modulation == OPC_NIL)
+		return (0.5);
+
+	if (modulation->ber_proc != OPC_NIL)
+		return (modulation->ber_proc (eff_snr));
+
+	if (eff_snr <= modulation->snr[0])
+		return (modulation->ber[0]);
+
+	if (eff_snr >= modulation->snr[modulation->nb_points - 1])
+		return (modulation->ber[modulation->nb_points - 1]);
+
+	for (lo = 0, hi = modulation->nb_points - 1; hi - lo > 1; )
+		{
+		mid = (lo + hi) / 2;
+		if (modulation->snr[mid] <= eff_snr)
+			lo = mid;
+		else
+			hi = mid;
+		}
+
+	ratio = (eff_snr - modulation->snr[lo]) / (modulation->snr[hi] - modulation->snr[lo]);
+	low = modulation->ber[lo];
+	high = modulation->ber[hi];
+
+	if (low <= 0.0 || high <= 0.0)
+		return (low + ratio * (high - low));
+
+	return (pow (10.0, log10 (low) + ratio * (log10 (high) - log10 (low))));
+}
+
+
+/*
+ * Function:	op_kernel_fopen
+ *
+ * Description:	fopen of the models. The report names are built with the
+ *				Windows separators ("\\nodes\\", "\\retransmissions\\"): they
+ *				are mapped to '/', and the missing directories of the path
+ *				are created when the file is opened for writing.
+ */
+
+FILE * op_kernel_fopen (const char * path, const char * mode)
+{
+	char * local_path;
+	char * separator;
+	FILE * fp;
+
+	local_path = op_kernel_strdup (path);
+	for (separator = local_path; *separator != '\0'; separator++)
+		if (*separator == '\\')
+			*separator = '/';
+
+	if (mode[0] == 'w' || mode[0] == 'a')
+		{
+		/* create the directories one level at a time, as mkdir -p */
+		for (separator = strchr (local_path + 1, '/'); separator != OPC_NIL; separator = strchr (separator + 1, '/'))
+			{
+			*separator = '\0';
+			if (mkdir (local_path, 0777) != 0 && errno != EEXIST)
+				op_kernel_error ("op_kernel_fopen", "Unable to create the directory:", local_path);
+			*separator = '/';
+			}
+		}
+
+	/* the parentheses keep the standard fopen out of the macro of opnet.h */
+	fp = (fopen) (local_path, mode);
+	free (local_path);
+
+	return (fp);
+}
+
+
+/*
+ * Function:	op_kernel_invoke
+ *
+ * Description:	invoke the process of a module for an interrupt
+ */
+
+static void op_kernel_invoke (OpT_Kernel_Object * module, struct OpT_Kernel_Event * event)
+{
+	op_kernel_current_module = module;
+	op_kernel_current_event = event;
+	op_kernel_context_ptr = &module->context;
+
+	module->model->entry ();
+
+	op_kernel_current_module = OPC_NIL;
+	op_kernel_current_event = OPC_NIL;
+	op_kernel_context_ptr = OPC_NIL;
+}
+
+
+/*
+ * Function:	op_kernel_run
+ *
+ * Description:	run the simulation: create the processes, invoke them
+ *				once at time 0, process the events
+ *				until the duration is reached, the event list is
+ *				empty or a model calls op_sim_end, then deliver the
+ *				end of simulation interrupts
+ *
+ * ParamIn:		double duration
+ *				duration of the simulation (seconds)
+ *
+ * ParamOut:	Compcode status
+ *				OPC_COMPCODE_FAILURE if a model ended the simulation
+ */
+
+Compcode op_kernel_run (double duration)
+{
+	struct OpT_Kernel_Event * event;
+	struct OpT_Kernel_Event sim_event;
+	OpT_Kernel_Object * module;
+	VosT_Obtype obtype;
+	int init_block;
+	int i;
+
+	if (op_kernel_running || op_kernel_nb_objects == 0)
+		op_kernel_error ("op_kernel_run", "Nothing to run.", OPC_NIL);
+
+	op_kernel_running = OPC_TRUE;
+
+	/* create the processes, in the order of the modules */
+	for (i = 1; i < op_kernel_nb_objects; i++)
+		{
+		module = op_kernel_objects[i];
+
+		if (module->model == OPC_NIL)
+			continue;
+
+		obtype = module->model->init (&init_block);
+		module->context._op_mod_state_ptr = module->model->alloc (obtype, init_block);
+		}
+
+	/* every process gets its first invocation before any scheduled event */
+	memset (&sim_event, 0, sizeof (sim_event));
+	sim_event.type = OPC_INTRPT_BEGSIM;
+	sim_event.id = -1;
+	sim_event.strm = -1;
+	sim_event.state = OPC_KERNEL_EV_RUNNING;
+
+	for (i = 1; i < op_kernel_nb_objects && !op_kernel_end_requested; i++)
+		{
+		module = op_kernel_objects[i];
+
+		if (module->model == OPC_NIL)
+			continue;
+
+		sim_event.module_objid = module->objid;
+		sim_event.source_objid = module->objid;
+		op_kernel_invoke (module, &sim_event);
+		}
+
+	while (!op_kernel_end_requested && (event = op_kernel_heap_pop ()) != OPC_NIL)
+		{
+		if (event->state == OPC_KERNEL_EV_CANCELLED)
+			{
+			op_kernel_event_release (event);
+			continue;
+			}
+
+		if (event->time > duration)
+			{
+			op_kernel_heap_push (event);
+			op_kernel_time = duration;
+			break;
+			}
+
+		op_kernel_time = event->time;
+		module = op_kernel_objects[event->module_objid];
+
+		/* the packet waits in the input stream until the process gets it */
+		if (event->type == OPC_INTRPT_STRM)
+			{
+			if (event->strm >= module->nb_instrms)
+				{
+				module->instrms = (List **) realloc (module->instrms, (event->strm + 1) * sizeof (List *));
+				if (module->instrms == OPC_NIL)
+					op_kernel_error ("op_kernel_run", "Out of memory.", OPC_NIL);
+				while (module->nb_instrms <= event->strm)
+					module->instrms[module->nb_instrms++] = op_prg_list_create ();
+				}
+
+			op_prg_list_insert (module->instrms[event->strm], event->pkptr, OPC_LISTPOS_TAIL);
+			}
+
+		event->state = OPC_KERNEL_EV_RUNNING;
+		op_kernel_nb_events++;
+
+		op_kernel_invoke (module, event);
+
+		op_kernel_event_release (event);
+		}
+
+	/* end of simulation interrupts */
+	sim_event.type = OPC_INTRPT_ENDSIM;
+
+	for (i = 1; i < op_kernel_nb_objects; i++)
+		{
+		module = op_kernel_objects[i];
+
+		if (module->model == OPC_NIL)
+			continue;
+
+		sim_event.module_objid = module->objid;
+		sim_event.source_objid = module->objid;
+		op_kernel_invoke (module, &sim_event);
+		}
+
+	return (op_kernel_end_requested ? OPC_COMPCODE_FAILURE : OPC_COMPCODE_SUCCESS);
+}
+
+
+/*
+ * Function:	op_kernel_event_count
+ *
+ * Description:	number of events processed by the simulation
+ */
+
+OpT_uInt64 op_kernel_event_count (void)
+{
+	return (op_kernel_nb_events);
+}
@@ -0,0 +1,86 @@
+/*
+** opnet_kernel.h :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  driver interface of the standalone kernel: build
+**                      the topology, set the attributes and run
+*/
+
+#ifndef __OPNET_KERNEL_H__
+#define __OPNET_KERNEL_H__
+
+/* standard includes */
+#include <opnet.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* entry points of a compiled process model (.pr.c) */
+typedef struct {
+	const char *	name;
+	void			(*entry) (void);
+	VosT_Obtype		(*init) (int * init_block_ptr);
+	VosT_Address	(*alloc) (VosT_Obtype obtype, int init_block);
+	void			(*terminate) (void);
+} OpT_Kernel_Process_Model;
+
+/* declare the descriptor <name>_model of the process model <name> */
+#define OP_KERNEL_PROCESS_MODEL(name)											\
+	void			name (void);												\
+	VosT_Obtype		_op_##name##_init (int * init_block_ptr);					\
+	VosT_Address	_op_##name##_alloc (VosT_Obtype obtype, int init_block);	\
+	void			_op_##name##_terminate (void);								\
+	static const OpT_Kernel_Process_Model name##_model =						\
+		{#name, name, _op_##name##_init, _op_##name##_alloc, _op_##name##_terminate}
+
+/* procedure giving the bit error rate of a modulation */
+typedef double (*OpT_Kernel_Ber_Proc) (double eff_snr);
+
+/* topology */
+Objid		op_kernel_subnet_create (Objid parent_objid, const char * name);
+Objid		op_kernel_node_create (Objid subnet_objid, const char * name);
+Objid		op_kernel_module_create (Objid node_objid, const char * name, const OpT_Kernel_Process_Model * model);
+Objid		op_kernel_attr_compound_create (Objid objid, const char * attr_name);
+void		op_kernel_stream_connect (Objid src_objid, int outstrm_index, Objid dest_objid, int instrm_index);
+
+/* attributes (the simulation attributes are held by the top object, 0) */
+void		op_kernel_attr_set_int (Objid objid, const char * attr_name, int value);
+void		op_kernel_attr_set_dbl (Objid objid, const char * attr_name, double value);
+void		op_kernel_attr_set_str (Objid objid, const char * attr_name, const char * value);
+
+/* models */
+void		op_kernel_pk_format_size_set (const char * format_name, OpT_Packet_Size size);
+void		op_kernel_pk_format_field_set (const char * format_name, const char * fd_name, int default_value);
+Compcode	op_kernel_modulation_register (const char * modulation_name, OpT_Kernel_Ber_Proc ber_proc);
+Compcode	op_kernel_modulation_load (const char * modulation_name, const char * path);
+void		op_kernel_ltrace_enable (const char * label);
+
+/* run */
+void		op_kernel_seed_set (OpT_uInt64 seed);
+Compcode	op_kernel_run (double duration);
+OpT_uInt64	op_kernel_event_count (void);
+void		op_kernel_stat_dump (FILE * stream);
+
+#if defined (__cplusplus)
+} /* end of 'extern "C"' */
+#endif
+
+#endif // end of __OPNET_KERNEL_H__
@@ -0,0 +1,34 @@
+/*
+** wlan_support.h :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  WLAN types referenced by the WPAN models
+*/
+
+#ifndef __WLAN_SUPPORT_STANDALONE_H__
+#define __WLAN_SUPPORT_STANDALONE_H__
+
+/* standard includes */
+#include <opnet.h>
+
+/* receiver state of a WLAN MAC, only handled through pointers by the WPAN models */
+typedef struct WlanT_Rx_State_Info WlanT_Rx_State_Info;
+
+#endif // end of __WLAN_SUPPORT_STANDALONE_H__
@@ -0,0 +1,550 @@
+/*
+** wpan_batch.c :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  headless batch run of the GADGET scenario on the
+**                      standalone kernel: a channel node, a coordinator
+**                      and N devices placed on a circle around it
+*/
+
+/* standard includes */
+#include <unistd.h>
+#include "opnet_kernel.h"
+#include "wpan_batch.h"
+#include "lr_wpan_stat_write.h"
+
+/* process models of the GADGET scenario */
+OP_KERNEL_PROCESS_MODEL (lr_wpan_channel_PSMA_GADGET);
+OP_KERNEL_PROCESS_MODEL (WPAN_802_15_4a_MAC_PSMA_and_Slotted_ALOHA_GADGET);
+OP_KERNEL_PROCESS_MODEL (lr_wpan_source_UWB_GADGET);
+
+/* size of the acknowledgement format (Frame Ctrl, Seqn and FCS fields) */
+#define WPAN_BATCH_ACK_SIZE		40.0
+
+/* integer fields set to zero at the creation, as in the .pk.m files */
+static const char * wpan_batch_mac_fields [] = {"Seqn", "FCS", "Accept", "Segmentation", "Request", "Noise", OPC_NIL};
+static const char * wpan_batch_ack_fields [] = {"Frame Ctrl", "Seqn", "FCS", "Accept", "Noise", OPC_NIL};
+static const char * wpan_batch_beacon_fields [] = {"Seqn", "GTS", "Pending Address", "FCS", "Accept", "Noise", OPC_NIL};
+static const char * wpan_batch_beacon_gadget_fields [] = {"Seqn", "GTS", "Pending Address", "FCS", "Accept", "Noise", "protocol used", OPC_NIL};
+static const char * wpan_batch_bulk_data_fields [] = {"Address", "Src address", OPC_NIL};
+
+/* local function prototypes */
+static void		wpan_batch_usage (const char * name);
+static Objid	wpan_batch_node_create (Objid subnet_objid, const char * name, double x, double y,
+					Boolean coordinator, const Wpan_Batch_Settings * settings);
+static void		wpan_batch_channel_create (Objid subnet_objid, const Wpan_Batch_Settings * settings);
+static void		wpan_batch_format_fields_set (const char * format_name, const char ** fd_names);
+static const char **	wpan_batch_list_split (char * list, int delimiter, int * nb_values_ptr);
+static Boolean	wpan_batch_mode_is_valid (const char * mode);
+static int		wpan_batch_trace_decode (const char * path);
+
+
+/*
+ * Function:	wpan_batch_usage
+ *
+ * Description:	print the command line options and exit
+ */
+
+static void wpan_batch_usage (const char * name)
+{
+	fprintf (stderr, "Usage: %s -b ber_curve -m pmd_curve [options]\n", name);
+	fprintf (stderr, "  -b file   Eb/N0 (dB) / BER curve of the CustomPPM modulation\n");
+	fprintf (stderr, "  -m file   Eb/N0 (dB) / Pmd curve of the preamble detection\n");
+	fprintf (stderr, "  -n N      number of devices (default 10)\n");
+	fprintf (stderr, "  -t secs   simulated duration (default 10)\n");
+	fprintf (stderr, "  -s seed   random seed (default 128)\n");
+	fprintf (stderr, "  -d m      distance of the devices to the coordinator (default 10)\n");
+	fprintf (stderr, "  -g G      traffic intensity (default 1)\n");
+	fprintf (stderr, "  -i dist   packet interarrival time (default \"exponential (1.0)\")\n");
+	fprintf (stderr, "  -k dist   packet size in bits (default \"constant (1024)\")\n");
+	fprintf (stderr, "  -P        disable PSMA\n");
+	fprintf (stderr, "  -A        enable slotted ALOHA\n");
+	fprintf (stderr, "  -G        disable GADGET\n");
+	fprintf (stderr, "  -w secs   time resolution of the (re)transmission lists (default 0, every frame)\n");
+	fprintf (stderr, "  -T N      keep the last N MAC events in the binary trace <scenario>_trace.bin\n");
+	fprintf (stderr, "  -l label  enable an ODB line trace (wpan_state, wpan_flag, ...), repeatable\n");
+	fprintf (stderr, "  -D file   print a binary trace as text and exit\n");
+	fprintf (stderr, "  -r path   directory of the reports (default \"./\")\n");
+	fprintf (stderr, "  -c name   scenario name (default \"batch\")\n");
+	fprintf (stderr, "  -S        print the statistics on the standard output\n");
+	fprintf (stderr, "Sweep, one process per run:\n");
+	fprintf (stderr, "  -o path   directory of the runs and of the merged CSV summaries\n");
+	fprintf (stderr, "  -M list   modes separated by ',', each a set of the letters P (PSMA),\n");
+	fprintf (stderr, "            A (slotted ALOHA) and G (GADGET), with at least P or A\n");
+	fprintf (stderr, "            (default: -P, -A and -G)\n");
+	fprintf (stderr, "  -I list   interarrival times separated by ';' (default: -i)\n");
+	fprintf (stderr, "  -R N      replications, with the seeds seed .. seed + N - 1 (default 1)\n");
+	fprintf (stderr, "  -j N      runs at once (default: number of cores)\n");
+	exit (EXIT_FAILURE);
+}
+
+
+/*
+ * Function:	wpan_batch_node_create
+ *
+ * Description:	create a WPAN node: a source on top of the MAC
+ *
+ * ParamIn:		Objid subnet_objid
+ *				subnet of the node
+ *
+ *				const char * name
+ *				name of the node
+ *
+ *				double x, y
+ *				position of the node
+ *
+ *				Boolean coordinator
+ *				the node is the PAN coordinator
+ *
+ *				const Wpan_Batch_Settings * settings
+ *				settings of the run
+ *
+ * ParamOut:	Objid node_objid
+ *				ID of the node
+ */
+
+static Objid wpan_batch_node_create (Objid subnet_objid, const char * name, double x, double y,
+	Boolean coordinator, const Wpan_Batch_Settings * settings)
+{
+	Objid node_objid;
+	Objid mac_objid;
+	Objid source_objid;
+	Objid row_objid;
+
+	node_objid = op_kernel_node_create (subnet_objid, name);
+	op_kernel_attr_set_dbl (node_objid, "x position", x);
+	op_kernel_attr_set_dbl (node_objid, "y position", y);
+	op_kernel_attr_set_dbl (node_objid, "delta x", 0.0);
+	op_kernel_attr_set_dbl (node_objid, "delta y", 0.0);
+
+	/* MAC layer */
+	mac_objid = op_kernel_module_create (node_objid, "MAC", &WPAN_802_15_4a_MAC_PSMA_and_Slotted_ALOHA_GADGET_model);
+	op_kernel_attr_set_int (mac_objid, "Channel", 11);
+	op_kernel_attr_set_dbl (mac_objid, "Power", 1.0);
+	op_kernel_attr_set_int (mac_objid, "Source Type", OPC_TRUE);
+	op_kernel_attr_set_int (mac_objid, "Acknowledgement", OPC_TRUE);
+	op_kernel_attr_set_int (mac_objid, "Channel Access", OPC_TRUE);
+	op_kernel_attr_set_int (mac_objid, "Mode", coordinator);
+	op_kernel_attr_set_int (mac_objid, "Nb of transmission retries", 3);
+	op_kernel_attr_set_int (mac_objid, "Group number", 0);
+	op_kernel_attr_set_int (mac_objid, "Address", -2);
+	op_kernel_attr_set_str (mac_objid, "Scenario", settings->scenario);
+	op_kernel_attr_set_int (mac_objid, "PSMA_Enabled", settings->psma_enabled);
+	op_kernel_attr_set_int (mac_objid, "S_Aloha_Enabled", settings->s_aloha_enabled);
+	op_kernel_attr_set_int (mac_objid, "Ideal_Poisson_Traffic", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "GADGET_enabled", settings->gadget_enabled);
+	op_kernel_attr_set_dbl (mac_objid, "Statistic bin width", settings->stat_bin_width);
+	op_kernel_attr_set_int (mac_objid, "Trace buffer size", settings->trace_buffer_size);
+	op_kernel_attr_set_int (mac_objid, "ALOHA_max_delay_retx", 8);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_BEACON_RCVD", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_TX_BEACON", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_MAC_APPLICATION", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_DATA_TX", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_RX_DATA", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_IDLE_STATE", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_TX_ACK", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_RX_ACK", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_STATE", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_BACKOFF", OPC_FALSE);
+	op_kernel_attr_set_int (mac_objid, "DEBUG_TEST", OPC_FALSE);
+
+	row_objid = op_kernel_attr_compound_create (mac_objid, "CSMA-CA Parameters");
+	op_kernel_attr_set_int (row_objid, "Maximum backoff number", 4);
+	op_kernel_attr_set_int (row_objid, "Minimum backoff exponent", 3);
+	op_kernel_attr_set_int (row_objid, "Maximum backoff exponent", 5);
+
+	row_objid = op_kernel_attr_compound_create (mac_objid, "Superframe parameters");
+	op_kernel_attr_set_int (row_objid, "Beacon order", 6);
+	op_kernel_attr_set_int (row_objid, "Superframe order", 6);
+	op_kernel_attr_set_int (row_objid, "Final CAP slot", 15);
+
+	/* packet source */
+	source_objid = op_kernel_module_create (node_objid, "source", &lr_wpan_source_UWB_GADGET_model);
+	op_kernel_attr_set_int (source_objid, "Traffic intensity", settings->traffic_intensity);
+	op_kernel_attr_set_int (source_objid, "Mac Address Destination", -1);
+	op_kernel_attr_set_int (source_objid, "Predefined Profiles", -1);
+	op_kernel_attr_set_int (source_objid, "Group number", 0);
+	op_kernel_attr_set_str (source_objid, "Packet Interarrival Time", settings->interarrival);
+	op_kernel_attr_set_str (source_objid, "Packet Size", settings->packet_size);
+	op_kernel_attr_set_dbl (source_objid, "Start Time", coordinator ? -1.0 : 0.0);
+	op_kernel_attr_set_dbl (source_objid, "Stop Time", -1.0);
+	op_kernel_attr_set_dbl (source_objid, "Start time shift", 0.0);
+
+	op_kernel_stream_connect (source_objid, 0, mac_objid, 0);
+	op_kernel_stream_connect (mac_objid, 0, source_objid, 0);
+
+	return (node_objid);
+}
+
+
+/*
+ * Function:	wpan_batch_channel_create
+ *
+ * Description:	create the channel node, first in the topology so
+ *				that the channel is initialized before the nodes
+ */
+
+static void wpan_batch_channel_create (Objid subnet_objid, const Wpan_Batch_Settings * settings)
+{
+	Objid node_objid;
+	Objid channel_objid;
+	Objid row_objid;
+
+	node_objid = op_kernel_node_create (subnet_objid, "channel");
+	op_kernel_attr_set_dbl (node_objid, "x position", 0.0);
+	op_kernel_attr_set_dbl (node_objid, "y position", 0.0);
+	op_kernel_attr_set_dbl (node_objid, "delta x", 0.0);
+	op_kernel_attr_set_dbl (node_objid, "delta y", 0.0);
+
+	channel_objid = op_kernel_module_create (node_objid, "channel", &lr_wpan_channel_PSMA_GADGET_model);
+	op_kernel_attr_set_int (channel_objid, "AWGN_Enabled", OPC_TRUE);
+	op_kernel_attr_set_int (channel_objid, "Nakagami_Enabled", OPC_FALSE);
+	op_kernel_attr_set_int (channel_objid, "Capture_effect_enabled", OPC_FALSE);
+	op_kernel_attr_set_int (channel_objid, "Multi-Interferer Capture", OPC_FALSE);
+	op_kernel_attr_set_int (channel_objid, "DEBUG_CHANNEL", OPC_FALSE);
+	op_kernel_attr_set_dbl (channel_objid, "CCA Sensing Radius", 2.0 * settings->radius + 1.0);
+	op_kernel_attr_set_str (channel_objid, "Report Path", settings->report_path);
+
+	row_objid = op_kernel_attr_compound_create (channel_objid, "CCA Parameters");
+	op_kernel_attr_set_int (row_objid, "WPAN node", OPC_TRUE);
+	op_kernel_attr_set_int (row_objid, "WLAN node", OPC_TRUE);
+}
+
+
+/*
+ * Function:	wpan_batch_format_fields_set
+ *
+ * Description:	set to zero by default the listed integer fields of a format
+ */
+
+static void wpan_batch_format_fields_set (const char * format_name, const char ** fd_names)
+{
+	for (; *fd_names != OPC_NIL; fd_names++)
+		op_kernel_pk_format_field_set (format_name, *fd_names, 0);
+}
+
+
+/*
+ * Function:	wpan_batch_run
+ *
+ * Description:	run the scenario once, in the kernel of this process
+ *
+ * ParamIn:		const Wpan_Batch_Settings * settings
+ *				settings of the run
+ *
+ *				FILE * stat_stream
+ *				stream receiving the statistics, or OPC_NIL
+ *
+ * ParamOut:	Compcode status
+ *				OPC_COMPCODE_FAILURE if the run was ended by an error
+ */
+
+Compcode wpan_batch_run (const Wpan_Batch_Settings * settings, FILE * stat_stream)
+{
+	Objid subnet_objid;
+	char name[64];
+	double angle;
+	Compcode status;
+	int i;
+
+	/* the modulation curves of the .md.m files, exported as text */
+	if (op_kernel_modulation_load ("CustomPPM", settings->ber_path) == OPC_COMPCODE_FAILURE ||
+		op_kernel_modulation_load ("Pmd", settings->pmd_path) == OPC_COMPCODE_FAILURE)
+		{
+		fprintf (stderr, "Cannot read the modulation curves %s and %s.\n", settings->ber_path, settings->pmd_path);
+		return (OPC_COMPCODE_FAILURE);
+		}
+
+	/* the formats whose size is set by their fields */
+	op_kernel_pk_format_size_set ("lr_wpan_ack", WPAN_BATCH_ACK_SIZE);
+
+	/* the integer fields that the .pk.m files do not leave unset */
+	wpan_batch_format_fields_set ("lr_wpan_mac", wpan_batch_mac_fields);
+	wpan_batch_format_fields_set ("lr_wpan_ack", wpan_batch_ack_fields);
+	wpan_batch_format_fields_set ("lr_wpan_beacon", wpan_batch_beacon_fields);
+	wpan_batch_format_fields_set ("lr_wpan_beacon_GADGET", wpan_batch_beacon_gadget_fields);
+	wpan_batch_format_fields_set ("lr_wpan_bulk_data", wpan_batch_bulk_data_fields);
+
+	op_kernel_seed_set (settings->seed);
+	srand ((unsigned int) settings->seed);
+
+	/* topology */
+	subnet_objid = op_kernel_subnet_create (OPC_OBJID_INVALID, "Office Network");
+	wpan_batch_channel_create (subnet_objid, settings);
+	wpan_batch_node_create (subnet_objid, "coordinator", 0.0, 0.0, OPC_TRUE, settings);
+
+	for (i = 0; i < settings->nb_devices; i++)
+		{
+		angle = 2.0 * M_PI * i / settings->nb_devices;
+		sprintf (name, "device_%d", i);
+		wpan_batch_node_create (subnet_objid, name, settings->radius * cos (angle), settings->radius * sin (angle), OPC_FALSE, settings);
+		}
+
+	status = op_kernel_run (settings->duration);
+
+	/* write the reports kept open by the model */
+	lr_wpan_close_report_files ();
+
+	fprintf (stderr, "%llu events, %.6f s simulated\n", op_kernel_event_count (), op_sim_time ());
+
+	if (stat_stream != OPC_NIL)
+		op_kernel_stat_dump (stat_stream);
+
+	return (status);
+}
+
+
+/*
+ * Function:	wpan_batch_list_split
+ *
+ * Description:	split in place a list of values separated by a
+ *				delimiter, the blanks around the values are removed
+ *
+ * ParamIn:		char * list
+ *				list to split, modified
+ *
+ *				int delimiter
+ *				separator of the values
+ *
+ * ParamOut:	const char ** values
+ *				array of the values, to free
+ *
+ *				int * nb_values_ptr
+ *				number of values
+ */
+
+static const char ** wpan_batch_list_split (char * list, int delimiter, int * nb_values_ptr)
+{
+	const char ** values;
+	char * value;
+	char * next;
+	char * end;
+	int nb_values;
+
+	values = (const char **) malloc ((strlen (list) + 1) * sizeof (const char *));
+	if (values == OPC_NIL)
+		{
+		fprintf (stderr, "Out of memory.\n");
+		exit (EXIT_FAILURE);
+		}
+
+	for (nb_values = 0, value = list; value != OPC_NIL; value = next)
+		{
+		if ((next = strchr (value, delimiter)) != OPC_NIL)
+			*next++ = '\0';
+
+		while (isspace ((unsigned char) *value))
+			value++;
+		for (end = value + strlen (value); end > value && isspace ((unsigned char) end[-1]); end--)
+			end[-1] = '\0';
+
+		if (*value != '\0')
+			values[nb_values++] = value;
+		}
+
+	*nb_values_ptr = nb_values;
+	return (values);
+}
+
+
+/*
+ * Function:	wpan_batch_mode_is_valid
+ *
+ * Description:	check a mode of a sweep: a set of the letters P (PSMA),
+ *				A (slotted ALOHA) and G (GADGET), with at least one
+ *				channel access protocol
+ *
+ * ParamIn:		const char * mode
+ *				mode to check
+ *
+ * ParamOut:	Boolean valid
+ *				OPC_TRUE if the mode can be run
+ */
+
+static Boolean wpan_batch_mode_is_valid (const char * mode)
+{
+	if (mode[strspn (mode, "PAG")] != '\0')
+		return (OPC_FALSE);
+
+	return (strpbrk (mode, "PA") != OPC_NIL);
+}
+
+
+/*
+ * Function:	wpan_batch_trace_decode
+ *
+ * Description:	print the records of a binary trace of the MAC
+ *				events (lr_wpan_trace_buffer_close), one per line
+ *
+ * ParamIn:		const char * path
+ *				binary trace file
+ *
+ * ParamOut:	int status
+ *				EXIT_SUCCESS, or EXIT_FAILURE if the file is not a trace
+ */
+
+static int wpan_batch_trace_decode (const char * path)
+{
+	FILE * fp;
+	Wpan_Trace_Header header;
+	Wpan_Trace_Record record;
+	const char * intrpt_name;
+	int i;
+
+	if ((fp = fopen (path, "rb")) == OPC_NIL)
+		{
+		fprintf (stderr, "Cannot open the trace %s.\n", path);
+		return (EXIT_FAILURE);
+		}
+
+	if (fread (&header, sizeof (header), 1, fp) != 1 ||
+		memcmp (header.magic, LR_WPAN_TRACE_MAGIC, sizeof (header.magic)) != 0 ||
+		header.record_size != (int) sizeof (Wpan_Trace_Record))
+		{
+		fprintf (stderr, "%s is not a trace of this build.\n", path);
+		fclose (fp);
+		return (EXIT_FAILURE);
+		}
+
+	printf ("# %u events, the last %d kept\n", header.nb_events, header.nb_records);
+	printf ("# time\tMAC address\tstate exited\tinterrupt\tcode or stream\n");
+
+	for (i = 0; i < header.nb_records && fread (&record, sizeof (record), 1, fp) == 1; i++)
+		{
+		switch (record.intrpt_type)
+			{
+			case OPC_INTRPT_SELF: intrpt_name = "self"; break;
+			case OPC_INTRPT_REMOTE: intrpt_name = "remote"; break;
+			case OPC_INTRPT_STRM: intrpt_name = "stream"; break;
+			case OPC_INTRPT_ENDSIM: intrpt_name = "endsim"; break;
+			default: intrpt_name = "other"; break;
+			}
+
+		printf ("%.9f\t%d\t%s\t%s\t%d\n", record.time, record.mac_address, record.state, intrpt_name, record.intrpt_code);
+		}
+
+	fclose (fp);
+
+	return ((i == header.nb_records) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+int main (int argc, char * argv[])
+{
+	Wpan_Batch_Settings settings;
+	Wpan_Sweep_Plan plan;
+	char * modes = OPC_NIL;
+	char * interarrivals = OPC_NIL;
+	Compcode status;
+	int option;
+	int i;
+
+	settings.nb_devices = 10;
+	settings.duration = 10.0;
+	settings.seed = 128;
+	settings.radius = 10.0;
+	settings.traffic_intensity = 1;
+	settings.interarrival = "exponential (1.0)";
+	settings.packet_size = "constant (1024)";
+	settings.psma_enabled = OPC_TRUE;
+	settings.s_aloha_enabled = OPC_FALSE;
+	settings.gadget_enabled = OPC_TRUE;
+	settings.stat_bin_width = 0.0;
+	settings.trace_buffer_size = 0;
+	settings.ber_path = OPC_NIL;
+	settings.pmd_path = OPC_NIL;
+	settings.report_path = "./";
+	settings.scenario = "batch";
+	settings.stat_dump = OPC_FALSE;
+
+	memset (&plan, 0, sizeof (plan));
+	plan.nb_replications = 1;
+	plan.nb_jobs = (int) sysconf (_SC_NPROCESSORS_ONLN);
+
+	while ((option = getopt (argc, argv, "b:m:n:t:s:d:g:i:k:PAGw:T:l:D:r:c:So:M:I:R:j:")) != -1)
+		{
+		switch (option)
+			{
+			case 'b': settings.ber_path = optarg; break;
+			case 'm': settings.pmd_path = optarg; break;
+			case 'n': settings.nb_devices = atoi (optarg); break;
+			case 't': settings.duration = atof (optarg); break;
+			case 's': settings.seed = strtoul (optarg, OPC_NIL, 10); break;
+			case 'd': settings.radius = atof (optarg); break;
+			case 'g': settings.traffic_intensity = atoi (optarg); break;
+			case 'i': settings.interarrival = optarg; break;
+			case 'k': settings.packet_size = optarg; break;
+			case 'P': settings.psma_enabled = OPC_FALSE; break;
+			case 'A': settings.s_aloha_enabled = OPC_TRUE; break;
+			case 'G': settings.gadget_enabled = OPC_FALSE; break;
+			case 'w': settings.stat_bin_width = atof (optarg); break;
+			case 'T': settings.trace_buffer_size = atoi (optarg); break;
+			case 'l': op_kernel_ltrace_enable (optarg); break;
+			case 'D': return (wpan_batch_trace_decode (optarg));
+			case 'r': settings.report_path = optarg; break;
+			case 'c': settings.scenario = optarg; break;
+			case 'S': settings.stat_dump = OPC_TRUE; break;
+			case 'o': plan.output_path = optarg; break;
+			case 'M': modes = optarg; break;
+			case 'I': interarrivals = optarg; break;
+			case 'R': plan.nb_replications = atoi (optarg); break;
+			case 'j': plan.nb_jobs = atoi (optarg); break;
+			default: wpan_batch_usage (argv[0]);
+			}
+		}
+
+	if (settings.ber_path == OPC_NIL || settings.pmd_path == OPC_NIL || settings.nb_devices < 1 || settings.duration <= 0.0)
+		wpan_batch_usage (argv[0]);
+
+	/* a single run in this process */
+	if (plan.output_path == OPC_NIL)
+		{
+		status = wpan_batch_run (&settings, settings.stat_dump ? stdout : OPC_NIL);
+		return ((status == OPC_COMPCODE_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+
+	/* a sweep: by default, the mode and the interarrival time of the options */
+	if (modes != OPC_NIL)
+		plan.modes = wpan_batch_list_split (modes, ',', &plan.nb_modes);
+	else if (!settings.psma_enabled && !settings.s_aloha_enabled)
+		wpan_batch_usage (argv[0]);
+	for (i = 0; i < plan.nb_modes; i++)
+		{
+		if (!wpan_batch_mode_is_valid (plan.modes[i]))
+			{
+			fprintf (stderr, "Invalid mode %s: use the letters P, A and G, with at least P or A.\n", plan.modes[i]);
+			wpan_batch_usage (argv[0]);
+			}
+		}
+	if (interarrivals != OPC_NIL)
+		plan.interarrivals = wpan_batch_list_split (interarrivals, ';', &plan.nb_interarrivals);
+	if (plan.nb_interarrivals == 0)
+		{
+		plan.interarrivals = &settings.interarrival;
+		plan.nb_interarrivals = 1;
+		}
+
+	if (plan.nb_replications < 1 || plan.nb_jobs < 1)
+		wpan_batch_usage (argv[0]);
+
+	status = wpan_sweep_run (&settings, &plan);
+
+	return ((status == OPC_COMPCODE_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,71 @@
+/*
+** wpan_batch.c :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  settings of a headless batch run of the GADGET
+**                      scenario, and the sweep of several runs over the
+**                      local cores
+*/
+
+#ifndef __WPAN_BATCH_H__
+#define __WPAN_BATCH_H__
+
+/* standard includes */
+#include <stdio.h>
+#include <opnet.h>
+
+/* settings of a batch run */
+typedef struct {
+	int				nb_devices;
+	double			duration;
+	unsigned long	seed;
+	double			radius;
+	int				traffic_intensity;
+	const char *	interarrival;
+	const char *	packet_size;
+	Boolean			psma_enabled;
+	Boolean			s_aloha_enabled;
+	Boolean			gadget_enabled;
+	double			stat_bin_width;
+	int				trace_buffer_size;
+	const char *	ber_path;
+	const char *	pmd_path;
+	const char *	report_path;
+	const char *	scenario;
+	Boolean			stat_dump;
+} Wpan_Batch_Settings;
+
+/* sweep: the runs of the cross product of the modes and interarrival
+   times, with nb_replications seeds each, nb_jobs at once */
+typedef struct {
+	const char **	modes;
+	int				nb_modes;
+	const char **	interarrivals;
+	int				nb_interarrivals;
+	int				nb_replications;
+	int				nb_jobs;
+	const char *	output_path;
+} Wpan_Sweep_Plan;
+
+/* function prototypes */
+Compcode	wpan_batch_run (const Wpan_Batch_Settings * settings, FILE * stat_stream);
+Compcode	wpan_sweep_run (const Wpan_Batch_Settings * settings, const Wpan_Sweep_Plan * plan);
+
+#endif
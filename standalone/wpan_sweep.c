@@ -0,0 +1,510 @@
+/*
+** wpan_sweep.c :
+**
+** Low Rate WPAN model in Opnet
+** National Institute of Standards and Technology
+**
+** This model was developed at the National Institute of Standards
+** and Technology by employees of the Federal Government in the course
+** of their official duties. Pursuant to title 17 Section 105 of the
+** United States Code this software is not subject to copyright
+** protection and is in the public domain. This is an experimental
+** system.  NIST assumes no responsibility whatsoever for its use by
+** other parties, and makes no guarantees, expressed or implied,
+** about its quality, reliability, or any other characteristic.
+**
+** We would appreciate acknowledgement if the model is used.
+**
+** NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION
+** AND DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER
+** RESULTING FROM THE USE OF THIS SOFTWARE.
+**
+** Module description:  sweep of the batch runs over the modes, the packet
+**                      interarrival times and the seeds. The kernel holds
+**                      a single simulation, so each run is a child process
+**                      writing its reports in its own directory; the
+**                      statistics of the runs are merged in CSV files
+*/
+
+/* standard includes */
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "wpan_batch.h"
+
+/* files of a sweep */
+#define WPAN_SWEEP_RUNS_FILE		"runs.csv"
+#define WPAN_SWEEP_STATS_FILE		"stats.csv"
+#define WPAN_SWEEP_SUMMARY_FILE		"summary.csv"
+#define WPAN_SWEEP_RUN_STATS_FILE	"stats.txt"
+#define WPAN_SWEEP_RUN_LOG_FILE		"log.txt"
+
+#define WPAN_SWEEP_PATH_SIZE		512
+#define WPAN_SWEEP_LINE_SIZE		1024
+
+/* a run of the sweep */
+typedef struct {
+	int				mode_index;
+	int				interarrival_index;
+	unsigned long	seed;
+	char			directory[WPAN_SWEEP_PATH_SIZE];
+	pid_t			pid;
+	int				exit_status;
+} Wpan_Sweep_Run;
+
+/* value of a statistic in a run, grouped by point of the sweep */
+typedef struct {
+	int		point;
+	char *	module;
+	char *	statistic;
+	double	count;
+	double	mean;
+} Wpan_Sweep_Sample;
+
+/* local function prototypes */
+static Compcode	wpan_sweep_mode_apply (Wpan_Batch_Settings * settings, const char * mode);
+static Compcode	wpan_sweep_directory_create (const char * path);
+static void		wpan_sweep_child (const Wpan_Batch_Settings * settings, const Wpan_Sweep_Run * run);
+static void		wpan_sweep_csv_string (FILE * fp, const char * value);
+static int		wpan_sweep_sample_compare (const void * a, const void * b);
+static void		wpan_sweep_summary_write (FILE * fp, Wpan_Sweep_Sample * samples, int nb_samples,
+					const char ** mode_labels, const Wpan_Sweep_Plan * plan);
+
+
+/*
+ * Function:	wpan_sweep_mode_apply
+ *
+ * Description:	set the protocols of a run from a mode, a set of the
+ *				letters P (PSMA), A (slotted ALOHA) and G (GADGET)
+ *
+ * ParamIn:		const char * mode
+ *				mode of the run
+ *
+ * ParamOut:	Wpan_Batch_Settings * settings
+ *				settings of the run
+ *
+ *				Compcode status
+ *				OPC_COMPCODE_FAILURE for an unknown letter
+ */
+
+static Compcode wpan_sweep_mode_apply (Wpan_Batch_Settings * settings, const char * mode)
+{
+	settings->psma_enabled = OPC_FALSE;
+	settings->s_aloha_enabled = OPC_FALSE;
+	settings->gadget_enabled = OPC_FALSE;
+
+	for (; *mode != '\0'; mode++)
+		{
+		switch (*mode)
+			{
+			case 'P': settings->psma_enabled = OPC_TRUE; break;
+			case 'A': settings->s_aloha_enabled = OPC_TRUE; break;
+			case 'G': settings->gadget_enabled = OPC_TRUE; break;
+			default: return (OPC_COMPCODE_FAILURE);
+			}
+		}
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+
+/*
+ * Function:	wpan_sweep_directory_create
+ *
+ * Description:	create a directory, if it does not exist yet
+ */
+
+static Compcode wpan_sweep_directory_create (const char * path)
+{
+	if (mkdir (path, 0777) != 0 && errno != EEXIST)
+		{
+		fprintf (stderr, "Cannot create the directory %s: %s.\n", path, strerror (errno));
+		return (OPC_COMPCODE_FAILURE);
+		}
+
+	return (OPC_COMPCODE_SUCCESS);
+}
+
+
+/*
+ * Function:	wpan_sweep_child
+ *
+ * Description:	body of the child process of a run: the output goes to
+ *				the log of the run, the reports and the statistics to
+ *				its directory. Does not return.
+ */
+
+static void wpan_sweep_child (const Wpan_Batch_Settings * settings, const Wpan_Sweep_Run * run)
+{
+	Wpan_Batch_Settings run_settings;
+	char path[WPAN_SWEEP_PATH_SIZE + 32];
+	char report_path[WPAN_SWEEP_PATH_SIZE + 2];
+	FILE * stat_stream;
+	Compcode status;
+
+	sprintf (path, "%s/%s", run->directory, WPAN_SWEEP_RUN_LOG_FILE);
+	if (freopen (path, "w", stdout) == OPC_NIL || dup2 (fileno (stdout), fileno (stderr)) < 0)
+		_exit (EXIT_FAILURE);
+
+	sprintf (path, "%s/%s", run->directory, WPAN_SWEEP_RUN_STATS_FILE);
+	if ((stat_stream = fopen (path, "w")) == OPC_NIL)
+		_exit (EXIT_FAILURE);
+
+	/* the model appends the name of the report to the path */
+	sprintf (report_path, "%s/", run->directory);
+
+	run_settings = *settings;
+	run_settings.report_path = report_path;
+	run_settings.seed = run->seed;
+
+	status = wpan_batch_run (&run_settings, stat_stream);
+
+	fclose (stat_stream);
+	fflush (stdout);
+
+	_exit ((status == OPC_COMPCODE_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+/*
+ * Function:	wpan_sweep_csv_string
+ *
+ * Description:	write a quoted CSV string
+ */
+
+static void wpan_sweep_csv_string (FILE * fp, const char * value)
+{
+	fputc ('"', fp);
+	for (; *value != '\0'; value++)
+		{
+		if (*value == '"')
+			fputc ('"', fp);
+		fputc (*value, fp);
+		}
+	fputc ('"', fp);
+}
+
+
+/*
+ * Function:	wpan_sweep_sample_compare
+ *
+ * Description:	order the samples by point, module and statistic
+ */
+
+static int wpan_sweep_sample_compare (const void * a, const void * b)
+{
+	const Wpan_Sweep_Sample * sample_a = (const Wpan_Sweep_Sample *) a;
+	const Wpan_Sweep_Sample * sample_b = (const Wpan_Sweep_Sample *) b;
+	int order;
+
+	if (sample_a->point != sample_b->point)
+		return ((sample_a->point < sample_b->point) ? -1 : 1);
+
+	if ((order = strcmp (sample_a->module, sample_b->module)) != 0)
+		return (order);
+
+	return (strcmp (sample_a->statistic, sample_b->statistic));
+}
+
+
+/*
+ * Function:	wpan_sweep_summary_write
+ *
+ * Description:	write the statistics over the replications of each
+ *				point: mean number of values, and mean, standard
+ *				deviation, minimum and maximum of the mean of a run
+ */
+
+static void wpan_sweep_summary_write (FILE * fp, Wpan_Sweep_Sample * samples, int nb_samples,
+	const char ** mode_labels, const Wpan_Sweep_Plan * plan)
+{
+	Wpan_Sweep_Sample * first;
+	double count_sum, mean_sum, mean_square_sum, mean_min, mean_max;
+	double average, variance;
+	int nb_replications;
+	int i, j;
+
+	qsort (samples, nb_samples, sizeof (Wpan_Sweep_Sample), wpan_sweep_sample_compare);
+
+	fprintf (fp, "mode,interarrival,module,statistic,replications,count,mean,stddev,min,max\n");
+
+	for (i = 0; i < nb_samples; i = j)
+		{
+		first = &samples[i];
+		count_sum = mean_sum = mean_square_sum = 0.0;
+		mean_min = mean_max = first->mean;
+
+		for (j = i; j < nb_samples && wpan_sweep_sample_compare (first, &samples[j]) == 0; j++)
+			{
+			count_sum += samples[j].count;
+			mean_sum += samples[j].mean;
+			mean_square_sum += samples[j].mean * samples[j].mean;
+			if (samples[j].mean < mean_min)
+				mean_min = samples[j].mean;
+			if (samples[j].mean > mean_max)
+				mean_max = samples[j].mean;
+			}
+
+		nb_replications = j - i;
+		average = mean_sum / nb_replications;
+		variance = (nb_replications > 1) ? (mean_square_sum - nb_replications * average * average) / (nb_replications - 1) : 0.0;
+
+		wpan_sweep_csv_string (fp, mode_labels[first->point / plan->nb_interarrivals]);
+		fputc (',', fp);
+		wpan_sweep_csv_string (fp, plan->interarrivals[first->point % plan->nb_interarrivals]);
+		fputc (',', fp);
+		wpan_sweep_csv_string (fp, first->module);
+		fputc (',', fp);
+		wpan_sweep_csv_string (fp, first->statistic);
+		fprintf (fp, ",%d,%.12g,%.12g,%.12g,%.12g,%.12g\n", nb_replications, count_sum / nb_replications,
+			average, (variance > 0.0) ? sqrt (variance) : 0.0, mean_min, mean_max);
+		}
+}
+
+
+/*
+ * Function:	wpan_sweep_run
+ *
+ * Description:	run every point of the sweep nb_replications times, at
+ *				most nb_jobs child processes at once, then merge the
+ *				statistics of the runs:
+ *				* runs.csv: the runs, their directory and exit status
+ *				* stats.csv: the statistics of every run
+ *				* summary.csv: the statistics over the replications
+ *
+ * ParamIn:		const Wpan_Batch_Settings * settings
+ *				settings common to the runs
+ *
+ *				const Wpan_Sweep_Plan * plan
+ *				values of the sweep
+ *
+ * ParamOut:	Compcode status
+ *				OPC_COMPCODE_FAILURE if a run failed
+ */
+
+Compcode wpan_sweep_run (const Wpan_Batch_Settings * settings, const Wpan_Sweep_Plan * plan)
+{
+	Wpan_Batch_Settings point_settings;
+	Wpan_Sweep_Run * runs;
+	Wpan_Sweep_Run * run;
+	Wpan_Sweep_Sample * samples = OPC_NIL;
+	int nb_samples = 0, samples_capacity = 0;
+	const char ** mode_labels;
+	char default_mode[4];
+	char path[WPAN_SWEEP_PATH_SIZE + 32];
+	char line[WPAN_SWEEP_LINE_SIZE];
+	char * fields[8];
+	int nb_modes, nb_runs, nb_running, nb_failed;
+	int next, status, i, k;
+	pid_t pid;
+	FILE * runs_fp;
+	FILE * stats_fp;
+	FILE * summary_fp;
+	FILE * fp;
+
+	/* without -M, the single mode of the -P, -A and -G options */
+	if (plan->nb_modes > 0)
+		{
+		mode_labels = plan->modes;
+		nb_modes = plan->nb_modes;
+		}
+	else
+		{
+		k = 0;
+		if (settings->psma_enabled)
+			default_mode[k++] = 'P';
+		if (settings->s_aloha_enabled)
+			default_mode[k++] = 'A';
+		if (settings->gadget_enabled)
+			default_mode[k++] = 'G';
+		default_mode[k] = '\0';
+
+		mode_labels = (const char **) malloc (sizeof (const char *));
+		mode_labels[0] = default_mode;
+		nb_modes = 1;
+		}
+
+	for (i = 0; i < nb_modes; i++)
+		{
+		if (wpan_sweep_mode_apply (&point_settings, mode_labels[i]) == OPC_COMPCODE_FAILURE)
+			{
+			fprintf (stderr, "Unknown mode %s: use the letters P, A and G.\n", mode_labels[i]);
+			return (OPC_COMPCODE_FAILURE);
+			}
+		}
+
+	if (strlen (plan->output_path) >= WPAN_SWEEP_PATH_SIZE - 16 || wpan_sweep_directory_create (plan->output_path) == OPC_COMPCODE_FAILURE)
+		return (OPC_COMPCODE_FAILURE);
+
+	/* the runs, ordered by mode, interarrival time and seed */
+	nb_runs = nb_modes * plan->nb_interarrivals * plan->nb_replications;
+	runs = (Wpan_Sweep_Run *) calloc (nb_runs, sizeof (Wpan_Sweep_Run));
+	if (runs == OPC_NIL)
+		{
+		fprintf (stderr, "Out of memory.\n");
+		return (OPC_COMPCODE_FAILURE);
+		}
+
+	for (k = 0; k < nb_runs; k++)
+		{
+		runs[k].mode_index = k / (plan->nb_interarrivals * plan->nb_replications);
+		runs[k].interarrival_index = (k / plan->nb_replications) % plan->nb_interarrivals;
+		runs[k].seed = settings->seed + k % plan->nb_replications;
+		runs[k].pid = -1;
+		sprintf (runs[k].directory, "%s/run_%04d", plan->output_path, k);
+
+		if (wpan_sweep_directory_create (runs[k].directory) == OPC_COMPCODE_FAILURE)
+			return (OPC_COMPCODE_FAILURE);
+		}
+
+	/* nothing buffered may be written twice by the children */
+	fflush (stdout);
+	fflush (stderr);
+
+	for (next = 0, nb_running = 0, nb_failed = 0; next < nb_runs || nb_running > 0; )
+		{
+		if (next < nb_runs && nb_running < plan->nb_jobs)
+			{
+			run = &runs[next++];
+
+			point_settings = *settings;
+			point_settings.interarrival = plan->interarrivals[run->interarrival_index];
+			wpan_sweep_mode_apply (&point_settings, mode_labels[run->mode_index]);
+
+			if ((pid = fork ()) < 0)
+				{
+				fprintf (stderr, "Cannot start the run %s: %s.\n", run->directory, strerror (errno));
+				run->exit_status = EXIT_FAILURE;
+				nb_failed++;
+				continue;
+				}
+
+			if (pid == 0)
+				wpan_sweep_child (&point_settings, run);
+
+			run->pid = pid;
+			nb_running++;
+			continue;
+			}
+
+		if ((pid = waitpid (-1, &status, 0)) < 0)
+			{
+			if (errno == EINTR)
+				continue;
+			break;
+			}
+
+		for (k = 0; k < nb_runs && runs[k].pid != pid; k++);
+		if (k == nb_runs)
+			continue;
+
+		runs[k].exit_status = (WIFEXITED (status)) ? WEXITSTATUS (status) : EXIT_FAILURE;
+		if (runs[k].exit_status != EXIT_SUCCESS)
+			{
+			fprintf (stderr, "Run %s failed, see its %s.\n", runs[k].directory, WPAN_SWEEP_RUN_LOG_FILE);
+			nb_failed++;
+			}
+
+		nb_running--;
+		}
+
+	/* merge the statistics of the runs */
+	sprintf (path, "%s/%s", plan->output_path, WPAN_SWEEP_RUNS_FILE);
+	runs_fp = fopen (path, "w");
+	sprintf (path, "%s/%s", plan->output_path, WPAN_SWEEP_STATS_FILE);
+	stats_fp = fopen (path, "w");
+	sprintf (path, "%s/%s", plan->output_path, WPAN_SWEEP_SUMMARY_FILE);
+	summary_fp = fopen (path, "w");
+
+	if (runs_fp == OPC_NIL || stats_fp == OPC_NIL || summary_fp == OPC_NIL)
+		{
+		fprintf (stderr, "Cannot create the summaries in %s.\n", plan->output_path);
+		return (OPC_COMPCODE_FAILURE);
+		}
+
+	fprintf (runs_fp, "run,mode,interarrival,seed,directory,status\n");
+	fprintf (stats_fp, "run,mode,interarrival,seed,module,statistic,count,sum,mean,min,max,last\n");
+
+	for (k = 0; k < nb_runs; k++)
+		{
+		run = &runs[k];
+
+		fprintf (runs_fp, "%d,", k);
+		wpan_sweep_csv_string (runs_fp, mode_labels[run->mode_index]);
+		fputc (',', runs_fp);
+		wpan_sweep_csv_string (runs_fp, plan->interarrivals[run->interarrival_index]);
+		fprintf (runs_fp, ",%lu,", run->seed);
+		wpan_sweep_csv_string (runs_fp, run->directory);
+		fprintf (runs_fp, ",%d\n", run->exit_status);
+
+		/* the statistics of a failed run are left out */
+		sprintf (path, "%s/%s", run->directory, WPAN_SWEEP_RUN_STATS_FILE);
+		if (run->exit_status != EXIT_SUCCESS || (fp = fopen (path, "r")) == OPC_NIL)
+			continue;
+
+		/* the first line is the header of the dump */
+		fgets (line, sizeof (line), fp);
+
+		while (fgets (line, sizeof (line), fp) != OPC_NIL)
+			{
+			line[strcspn (line, "\r\n")] = '\0';
+
+			for (i = 0, fields[0] = strtok (line, "\t"); i < 7 && fields[i] != OPC_NIL; )
+				fields[++i] = strtok (OPC_NIL, "\t");
+			if (i < 7 || fields[7] == OPC_NIL)
+				continue;
+
+			fprintf (stats_fp, "%d,", k);
+			wpan_sweep_csv_string (stats_fp, mode_labels[run->mode_index]);
+			fputc (',', stats_fp);
+			wpan_sweep_csv_string (stats_fp, plan->interarrivals[run->interarrival_index]);
+			fprintf (stats_fp, ",%lu,", run->seed);
+			wpan_sweep_csv_string (stats_fp, fields[0]);
+			fputc (',', stats_fp);
+			wpan_sweep_csv_string (stats_fp, fields[1]);
+			fprintf (stats_fp, ",%s,%s,%s,%s,%s,%s\n", fields[2], fields[3], fields[4], fields[5], fields[6], fields[7]);
+
+			if (nb_samples == samples_capacity)
+				{
+				samples_capacity = (samples_capacity == 0) ? 256 : 2 * samples_capacity;
+				samples = (Wpan_Sweep_Sample *) realloc (samples, samples_capacity * sizeof (Wpan_Sweep_Sample));
+				if (samples == OPC_NIL)
+					{
+					fprintf (stderr, "Out of memory.\n");
+					return (OPC_COMPCODE_FAILURE);
+					}
+				}
+
+			samples[nb_samples].point = run->mode_index * plan->nb_interarrivals + run->interarrival_index;
+			samples[nb_samples].module = strdup (fields[0]);
+			samples[nb_samples].statistic = strdup (fields[1]);
+			samples[nb_samples].count = atof (fields[2]);
+			samples[nb_samples].mean = atof (fields[4]);
+			nb_samples++;
+			}
+
+		fclose (fp);
+		}
+
+	wpan_sweep_summary_write (summary_fp, samples, nb_samples, mode_labels, plan);
+
+	fclose (runs_fp);
+	fclose (stats_fp);
+	fclose (summary_fp);
+
+	for (i = 0; i < nb_samples; i++)
+		{
+		free (samples[i].module);
+		free (samples[i].statistic);
+		}
+	free (samples);
+	free (runs);
+	if (mode_labels != plan->modes)
+		free (mode_labels);
+
+	fprintf (stderr, "%d runs, %d failed, summaries in %s\n", nb_runs, nb_failed, plan->output_path);
+
+	return ((nb_failed == 0) ? OPC_COMPCODE_SUCCESS : OPC_COMPCODE_FAILURE);
+}